@@ -23,9 +23,23 @@ def get_doc_classes():
         "MLPPConvolutions",
         "MLPPLinAlg",
 
+        "MLPPOptimizer",
+        "MLPPOptimizerSGD",
+        "MLPPOptimizerMomentum",
+        "MLPPOptimizerAdagrad",
+        "MLPPOptimizerAdadelta",
+        "MLPPOptimizerAdamBase",
+        "MLPPOptimizerAdam",
+        "MLPPOptimizerAdamax",
+        "MLPPOptimizerNadam",
+        "MLPPOptimizerAMSGrad",
+        "MLPPParameterArena",
+
         "MLPPHiddenLayer",
         "MLPPOutputLayer",
         "MLPPMultiOutputLayer",
+        "MLPPConvLayer",
+        "MLPPPoolLayer",
 
         "MLPPKNN",
         "MLPPKMeans",
@@ -0,0 +1,591 @@
+/*************************************************************************/
+/*  autodiff_tape.cpp                                                    */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "autodiff_tape.h"
+
+int MLPPAutodiffTape::constant(const Ref<MLPPMatrix> &p_value) {
+	ERR_FAIL_COND_V(!p_value.is_valid(), -1);
+	ERR_FAIL_COND_V(_backward_done, -1);
+
+	return _push(OPERATION_CONSTANT, -1, -1, p_value);
+}
+
+int MLPPAutodiffTape::parameter(const Ref<MLPPMatrix> &p_value) {
+	ERR_FAIL_COND_V(!p_value.is_valid(), -1);
+	ERR_FAIL_COND_V(_backward_done, -1);
+
+	for (int i = 0; i < _nodes.size(); ++i) {
+		if (_nodes[i].source_matrix == p_value) {
+			return i;
+		}
+	}
+
+	int index = _push(OPERATION_PARAMETER, -1, -1, p_value);
+
+	Node &n = _nodes.write[index];
+	n.source_matrix = p_value;
+	n.requires_gradient = true;
+
+	return index;
+}
+
+int MLPPAutodiffTape::parameter_vector(const Ref<MLPPVector> &p_value) {
+	ERR_FAIL_COND_V(!p_value.is_valid(), -1);
+	ERR_FAIL_COND_V(_backward_done, -1);
+
+	for (int i = 0; i < _nodes.size(); ++i) {
+		if (_nodes[i].source_vector == p_value) {
+			return i;
+		}
+	}
+
+	// The tape never writes into values, the view only shares the data.
+	Ref<MLPPMatrix> row;
+	row.instance();
+	row->set_view(const_cast<real_t *>(p_value->ptr()), Size2i(p_value->size(), 1));
+
+	int index = _push(OPERATION_PARAMETER, -1, -1, row);
+
+	Node &n = _nodes.write[index];
+	n.source_vector = p_value;
+	n.requires_gradient = true;
+
+	return index;
+}
+
+int MLPPAutodiffTape::matmul(const int p_a, const int p_b) {
+	ERR_FAIL_COND_V(!_is_usable(p_a) || !_is_usable(p_b), -1);
+
+	const Ref<MLPPMatrix> &a = _nodes[p_a].value;
+	const Ref<MLPPMatrix> &b = _nodes[p_b].value;
+
+	ERR_FAIL_COND_V(a->size().x != b->size().y, -1);
+
+	return _push(OPERATION_MATMUL, p_a, p_b, a->multn(b));
+}
+
+int MLPPAutodiffTape::add(const int p_a, const int p_b) {
+	ERR_FAIL_COND_V(!_is_usable(p_a) || !_is_usable(p_b), -1);
+	ERR_FAIL_COND_V(_nodes[p_a].value->size() != _nodes[p_b].value->size(), -1);
+
+	return _push(OPERATION_ADD, p_a, p_b, _nodes[p_a].value->addn(_nodes[p_b].value));
+}
+
+int MLPPAutodiffTape::sub(const int p_a, const int p_b) {
+	ERR_FAIL_COND_V(!_is_usable(p_a) || !_is_usable(p_b), -1);
+	ERR_FAIL_COND_V(_nodes[p_a].value->size() != _nodes[p_b].value->size(), -1);
+
+	return _push(OPERATION_SUB, p_a, p_b, _nodes[p_a].value->subn(_nodes[p_b].value));
+}
+
+int MLPPAutodiffTape::hadamard(const int p_a, const int p_b) {
+	ERR_FAIL_COND_V(!_is_usable(p_a) || !_is_usable(p_b), -1);
+	ERR_FAIL_COND_V(_nodes[p_a].value->size() != _nodes[p_b].value->size(), -1);
+
+	return _push(OPERATION_HADAMARD, p_a, p_b, _nodes[p_a].value->hadamard_productn(_nodes[p_b].value));
+}
+
+int MLPPAutodiffTape::scale(const int p_a, const real_t p_scalar) {
+	ERR_FAIL_COND_V(!_is_usable(p_a), -1);
+
+	int index = _push(OPERATION_SCALE, p_a, -1, _nodes[p_a].value->scalar_multiplyn(p_scalar));
+	_nodes.write[index].scalar = p_scalar;
+
+	return index;
+}
+
+int MLPPAutodiffTape::add_row(const int p_a, const int p_row) {
+	ERR_FAIL_COND_V(!_is_usable(p_a) || !_is_usable(p_row), -1);
+
+	const Ref<MLPPMatrix> &a = _nodes[p_a].value;
+	const Ref<MLPPMatrix> &row = _nodes[p_row].value;
+
+	ERR_FAIL_COND_V(row->size() != Size2i(a->size().x, 1), -1);
+
+	Size2i size = a->size();
+
+	Ref<MLPPMatrix> c = a->duplicate_fast();
+	real_t *c_ptr = c->ptrw();
+	const real_t *row_ptr = row->ptr();
+
+	for (int i = 0; i < size.y; ++i) {
+		real_t *c_row = c_ptr + i * size.x;
+
+		for (int j = 0; j < size.x; ++j) {
+			c_row[j] += row_ptr[j];
+		}
+	}
+
+	return _push(OPERATION_ADD_ROW, p_a, p_row, c);
+}
+
+int MLPPAutodiffTape::activation(const int p_a, const MLPPActivation::ActivationFunction p_func) {
+	ERR_FAIL_COND_V(!_is_usable(p_a), -1);
+
+	MLPPActivation avn;
+
+	Ref<MLPPMatrix> a = avn.run_activation_norm_matrix(p_func, _nodes[p_a].value);
+
+	// The shifted softmax has the same derivative, and both need the whole row.
+	if (p_func == MLPPActivation::ACTIVATION_FUNCTION_SOFTMAX || p_func == MLPPActivation::ACTIVATION_FUNCTION_ADJ_SOFTMAX) {
+		return _push(OPERATION_SOFTMAX, p_a, -1, a);
+	}
+
+	int index = _push(OPERATION_ACTIVATION, p_a, -1, a);
+	_nodes.write[index].activation = p_func;
+
+	return index;
+}
+
+int MLPPAutodiffTape::sum(const int p_a) {
+	ERR_FAIL_COND_V(!_is_usable(p_a), -1);
+
+	const Ref<MLPPMatrix> &a = _nodes[p_a].value;
+
+	int data_size = a->data_size();
+	const real_t *a_ptr = a->ptr();
+
+	real_t s = 0;
+	for (int i = 0; i < data_size; ++i) {
+		s += a_ptr[i];
+	}
+
+	return _push(OPERATION_SUM, p_a, -1, _scalar_matrix(s));
+}
+
+int MLPPAutodiffTape::mse(const int p_y_hat, const int p_y) {
+	ERR_FAIL_COND_V(!_is_usable(p_y_hat) || !_is_usable(p_y), -1);
+
+	const Ref<MLPPMatrix> &y_hat = _nodes[p_y_hat].value;
+	const Ref<MLPPMatrix> &y = _nodes[p_y].value;
+
+	ERR_FAIL_COND_V(y_hat->size() != y->size(), -1);
+
+	int data_size = y_hat->data_size();
+	const real_t *y_hat_ptr = y_hat->ptr();
+	const real_t *y_ptr = y->ptr();
+
+	real_t s = 0;
+	for (int i = 0; i < data_size; ++i) {
+		real_t d = y_hat_ptr[i] - y_ptr[i];
+		s += d * d;
+	}
+
+	return _push(OPERATION_MSE, p_y_hat, p_y, _scalar_matrix(s / (2 * MAX(y_hat->size().y, 1))));
+}
+
+int MLPPAutodiffTape::cross_entropy(const int p_y_hat, const int p_y) {
+	ERR_FAIL_COND_V(!_is_usable(p_y_hat) || !_is_usable(p_y), -1);
+
+	const Ref<MLPPMatrix> &y_hat = _nodes[p_y_hat].value;
+	const Ref<MLPPMatrix> &y = _nodes[p_y].value;
+
+	ERR_FAIL_COND_V(y_hat->size() != y->size(), -1);
+
+	int data_size = y_hat->data_size();
+	const real_t *y_hat_ptr = y_hat->ptr();
+	const real_t *y_ptr = y->ptr();
+
+	real_t s = 0;
+	for (int i = 0; i < data_size; ++i) {
+		s -= y_ptr[i] * Math::log(y_hat_ptr[i]);
+	}
+
+	return _push(OPERATION_CROSS_ENTROPY, p_y_hat, p_y, _scalar_matrix(s / MAX(y_hat->size().y, 1)));
+}
+
+int MLPPAutodiffTape::log_loss(const int p_y_hat, const int p_y) {
+	ERR_FAIL_COND_V(!_is_usable(p_y_hat) || !_is_usable(p_y), -1);
+
+	const Ref<MLPPMatrix> &y_hat = _nodes[p_y_hat].value;
+	const Ref<MLPPMatrix> &y = _nodes[p_y].value;
+
+	ERR_FAIL_COND_V(y_hat->size() != y->size(), -1);
+
+	int data_size = y_hat->data_size();
+	const real_t *y_hat_ptr = y_hat->ptr();
+	const real_t *y_ptr = y->ptr();
+
+	real_t eps = 1e-8;
+	real_t s = 0;
+	for (int i = 0; i < data_size; ++i) {
+		s -= y_ptr[i] * Math::log(y_hat_ptr[i] + eps) + (1 - y_ptr[i]) * Math::log(1 - y_hat_ptr[i] + eps);
+	}
+
+	return _push(OPERATION_LOG_LOSS, p_y_hat, p_y, _scalar_matrix(s / MAX(y_hat->size().y, 1)));
+}
+
+void MLPPAutodiffTape::backward(const int p_node) {
+	ERR_FAIL_COND(!_is_usable(p_node));
+	ERR_FAIL_COND(_nodes[p_node].value->size() != Size2i(1, 1));
+
+	_backward_done = true;
+
+	if (!_nodes[p_node].requires_gradient) {
+		return;
+	}
+
+	_gradient_for(p_node)->fill(1);
+
+	for (int i = p_node; i >= 0; --i) {
+		Node &n = _nodes.write[i];
+
+		if (n.operation == OPERATION_CONSTANT || n.operation == OPERATION_PARAMETER) {
+			continue;
+		}
+
+		if (n.gradient.is_valid()) {
+			_backward_node(i);
+		}
+
+		// Every consumer of this node comes after it, so nothing needs these anymore.
+		n.gradient.unref();
+
+		if (i != p_node) {
+			n.value.unref();
+		}
+	}
+}
+
+Ref<MLPPMatrix> MLPPAutodiffTape::get_value(const int p_node) const {
+	ERR_FAIL_INDEX_V(p_node, _nodes.size(), Ref<MLPPMatrix>());
+
+	return _nodes[p_node].value;
+}
+
+real_t MLPPAutodiffTape::get_scalar(const int p_node) const {
+	ERR_FAIL_INDEX_V(p_node, _nodes.size(), 0);
+
+	const Ref<MLPPMatrix> &value = _nodes[p_node].value;
+
+	ERR_FAIL_COND_V(!value.is_valid() || value->data_size() == 0, 0);
+
+	return value->ptr()[0];
+}
+
+Ref<MLPPMatrix> MLPPAutodiffTape::get_gradient(const int p_node) const {
+	ERR_FAIL_INDEX_V(p_node, _nodes.size(), Ref<MLPPMatrix>());
+
+	return _nodes[p_node].gradient;
+}
+
+Ref<MLPPMatrix> MLPPAutodiffTape::get_parameter_gradient(const Ref<MLPPMatrix> &p_value) const {
+	for (int i = 0; i < _nodes.size(); ++i) {
+		if (_nodes[i].source_matrix == p_value) {
+			return _nodes[i].gradient;
+		}
+	}
+
+	return Ref<MLPPMatrix>();
+}
+
+Ref<MLPPVector> MLPPAutodiffTape::get_parameter_gradient_vector(const Ref<MLPPVector> &p_value) const {
+	for (int i = 0; i < _nodes.size(); ++i) {
+		const Node &n = _nodes[i];
+
+		if (n.source_vector != p_value) {
+			continue;
+		}
+
+		if (!n.gradient.is_valid()) {
+			return Ref<MLPPVector>();
+		}
+
+		Ref<MLPPVector> grad;
+		grad.instance();
+		grad->resize(n.gradient->data_size());
+
+		real_t *grad_ptr = grad->ptrw();
+		const real_t *src_ptr = n.gradient->ptr();
+
+		for (int j = 0; j < grad->size(); ++j) {
+			grad_ptr[j] = src_ptr[j];
+		}
+
+		return grad;
+	}
+
+	return Ref<MLPPVector>();
+}
+
+int MLPPAutodiffTape::get_node_count() const {
+	return _nodes.size();
+}
+
+int MLPPAutodiffTape::get_live_buffer_count() const {
+	int count = 0;
+
+	for (int i = 0; i < _nodes.size(); ++i) {
+		const Node &n = _nodes[i];
+
+		if (n.value.is_valid() || n.gradient.is_valid()) {
+			++count;
+		}
+	}
+
+	return count;
+}
+
+void MLPPAutodiffTape::clear() {
+	_nodes.clear();
+	_backward_done = false;
+}
+
+MLPPAutodiffTape::MLPPAutodiffTape() {
+	_backward_done = false;
+}
+
+MLPPAutodiffTape::~MLPPAutodiffTape() {
+}
+
+int MLPPAutodiffTape::_push(const Operation p_operation, const int p_a, const int p_b, const Ref<MLPPMatrix> &p_value) {
+	Node n;
+	n.operation = p_operation;
+	n.a = p_a;
+	n.b = p_b;
+	n.value = p_value;
+	n.requires_gradient = (p_a >= 0 && _nodes[p_a].requires_gradient) || (p_b >= 0 && _nodes[p_b].requires_gradient);
+
+	_nodes.push_back(n);
+
+	return _nodes.size() - 1;
+}
+
+bool MLPPAutodiffTape::_is_usable(const int p_node) const {
+	ERR_FAIL_COND_V_MSG(_backward_done, false, "The tape was already differentiated, clear() it first.");
+	ERR_FAIL_INDEX_V(p_node, _nodes.size(), false);
+
+	return _nodes[p_node].value.is_valid();
+}
+
+Ref<MLPPMatrix> MLPPAutodiffTape::_gradient_for(const int p_node) {
+	Node &n = _nodes.write[p_node];
+
+	if (!n.gradient.is_valid()) {
+		n.gradient.instance();
+		n.gradient->resize(n.value->size());
+		n.gradient->fill(0);
+	}
+
+	return n.gradient;
+}
+
+void MLPPAutodiffTape::_backward_node(const int p_node) {
+	const Node &n = _nodes[p_node];
+
+	const Ref<MLPPMatrix> &grad = n.gradient;
+	const real_t *grad_ptr = grad->ptr();
+
+	bool a_needed = n.a >= 0 && _nodes[n.a].requires_gradient;
+	bool b_needed = n.b >= 0 && _nodes[n.b].requires_gradient;
+
+	switch (n.operation) {
+		case OPERATION_MATMUL: {
+			if (a_needed) {
+				_gradient_for(n.a)->mult_transposed_b_add(grad, _nodes[n.b].value);
+			}
+
+			if (b_needed) {
+				_gradient_for(n.b)->mult_transposed_a_add(_nodes[n.a].value, grad);
+			}
+		} break;
+		case OPERATION_ADD:
+		case OPERATION_SUB: {
+			if (a_needed) {
+				_gradient_for(n.a)->add(grad);
+			}
+
+			if (b_needed) {
+				if (n.operation == OPERATION_ADD) {
+					_gradient_for(n.b)->add(grad);
+				} else {
+					_gradient_for(n.b)->sub(grad);
+				}
+			}
+		} break;
+		case OPERATION_HADAMARD: {
+			if (a_needed) {
+				_gradient_for(n.a)->add(grad->hadamard_productn(_nodes[n.b].value));
+			}
+
+			if (b_needed) {
+				_gradient_for(n.b)->add(grad->hadamard_productn(_nodes[n.a].value));
+			}
+		} break;
+		case OPERATION_SCALE: {
+			if (a_needed) {
+				_gradient_for(n.a)->add(grad->scalar_multiplyn(n.scalar));
+			}
+		} break;
+		case OPERATION_ADD_ROW: {
+			if (a_needed) {
+				_gradient_for(n.a)->add(grad);
+			}
+
+			if (b_needed) {
+				Size2i size = grad->size();
+				real_t *row_ptr = _gradient_for(n.b)->ptrw();
+
+				for (int i = 0; i < size.y; ++i) {
+					const real_t *grad_row = grad_ptr + i * size.x;
+
+					for (int j = 0; j < size.x; ++j) {
+						row_ptr[j] += grad_row[j];
+					}
+				}
+			}
+		} break;
+		case OPERATION_ACTIVATION: {
+			if (a_needed) {
+				MLPPActivation avn;
+
+				Ref<MLPPMatrix> deriv = avn.run_activation_deriv_matrix(n.activation, _nodes[n.a].value);
+				deriv->hadamard_product(grad);
+
+				_gradient_for(n.a)->add(deriv);
+			}
+		} break;
+		case OPERATION_SOFTMAX: {
+			if (a_needed) {
+				// dz = y * (dy - sum(dy * y)), row by row.
+				Size2i size = grad->size();
+				const real_t *y_ptr = n.value->ptr();
+				real_t *dz_ptr = _gradient_for(n.a)->ptrw();
+
+				for (int i = 0; i < size.y; ++i) {
+					const real_t *y_row = y_ptr + i * size.x;
+					const real_t *grad_row = grad_ptr + i * size.x;
+					real_t *dz_row = dz_ptr + i * size.x;
+
+					real_t dot = 0;
+					for (int j = 0; j < size.x; ++j) {
+						dot += grad_row[j] * y_row[j];
+					}
+
+					for (int j = 0; j < size.x; ++j) {
+						dz_row[j] += y_row[j] * (grad_row[j] - dot);
+					}
+				}
+			}
+		} break;
+		case OPERATION_SUM: {
+			if (a_needed) {
+				_gradient_for(n.a)->scalar_add(grad_ptr[0]);
+			}
+		} break;
+		case OPERATION_MSE:
+		case OPERATION_CROSS_ENTROPY:
+		case OPERATION_LOG_LOSS: {
+			const Ref<MLPPMatrix> &y_hat = _nodes[n.a].value;
+			const Ref<MLPPMatrix> &y = _nodes[n.b].value;
+
+			const real_t *y_hat_ptr = y_hat->ptr();
+			const real_t *y_ptr = y->ptr();
+			int loss_size = y_hat->data_size();
+			real_t g = grad_ptr[0] / MAX(y_hat->size().y, 1);
+			real_t eps = 1e-8;
+
+			real_t *dy_hat_ptr = a_needed ? _gradient_for(n.a)->ptrw() : NULL;
+			real_t *dy_ptr = b_needed ? _gradient_for(n.b)->ptrw() : NULL;
+
+			for (int i = 0; i < loss_size; ++i) {
+				real_t yh = y_hat_ptr[i];
+				real_t yv = y_ptr[i];
+
+				real_t d_y_hat;
+				real_t d_y;
+
+				if (n.operation == OPERATION_MSE) {
+					d_y_hat = yh - yv;
+					d_y = yv - yh;
+				} else if (n.operation == OPERATION_CROSS_ENTROPY) {
+					d_y_hat = -yv / yh;
+					d_y = -Math::log(yh);
+				} else {
+					d_y_hat = -yv / (yh + eps) + (1 - yv) / (1 - yh + eps);
+					d_y = -Math::log(yh + eps) + Math::log(1 - yh + eps);
+				}
+
+				if (dy_hat_ptr) {
+					dy_hat_ptr[i] += g * d_y_hat;
+				}
+
+				if (dy_ptr) {
+					dy_ptr[i] += g * d_y;
+				}
+			}
+		} break;
+		case OPERATION_CONSTANT:
+		case OPERATION_PARAMETER:
+			break;
+	}
+}
+
+Ref<MLPPMatrix> MLPPAutodiffTape::_scalar_matrix(const real_t p_value) {
+	Ref<MLPPMatrix> m;
+	m.instance();
+	m->resize(Size2i(1, 1));
+	m->element_set(0, 0, p_value);
+
+	return m;
+}
+
+void MLPPAutodiffTape::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("constant", "value"), &MLPPAutodiffTape::constant);
+	ClassDB::bind_method(D_METHOD("parameter", "value"), &MLPPAutodiffTape::parameter);
+	ClassDB::bind_method(D_METHOD("parameter_vector", "value"), &MLPPAutodiffTape::parameter_vector);
+
+	ClassDB::bind_method(D_METHOD("matmul", "a", "b"), &MLPPAutodiffTape::matmul);
+	ClassDB::bind_method(D_METHOD("add", "a", "b"), &MLPPAutodiffTape::add);
+	ClassDB::bind_method(D_METHOD("sub", "a", "b"), &MLPPAutodiffTape::sub);
+	ClassDB::bind_method(D_METHOD("hadamard", "a", "b"), &MLPPAutodiffTape::hadamard);
+	ClassDB::bind_method(D_METHOD("scale", "a", "scalar"), &MLPPAutodiffTape::scale);
+	ClassDB::bind_method(D_METHOD("add_row", "a", "row"), &MLPPAutodiffTape::add_row);
+	ClassDB::bind_method(D_METHOD("activation", "a", "func"), &MLPPAutodiffTape::activation);
+	ClassDB::bind_method(D_METHOD("sum", "a"), &MLPPAutodiffTape::sum);
+
+	ClassDB::bind_method(D_METHOD("mse", "y_hat", "y"), &MLPPAutodiffTape::mse);
+	ClassDB::bind_method(D_METHOD("cross_entropy", "y_hat", "y"), &MLPPAutodiffTape::cross_entropy);
+	ClassDB::bind_method(D_METHOD("log_loss", "y_hat", "y"), &MLPPAutodiffTape::log_loss);
+
+	ClassDB::bind_method(D_METHOD("backward", "node"), &MLPPAutodiffTape::backward);
+
+	ClassDB::bind_method(D_METHOD("get_value", "node"), &MLPPAutodiffTape::get_value);
+	ClassDB::bind_method(D_METHOD("get_scalar", "node"), &MLPPAutodiffTape::get_scalar);
+
+	ClassDB::bind_method(D_METHOD("get_gradient", "node"), &MLPPAutodiffTape::get_gradient);
+	ClassDB::bind_method(D_METHOD("get_parameter_gradient", "value"), &MLPPAutodiffTape::get_parameter_gradient);
+	ClassDB::bind_method(D_METHOD("get_parameter_gradient_vector", "value"), &MLPPAutodiffTape::get_parameter_gradient_vector);
+
+	ClassDB::bind_method(D_METHOD("get_node_count"), &MLPPAutodiffTape::get_node_count);
+	ClassDB::bind_method(D_METHOD("get_live_buffer_count"), &MLPPAutodiffTape::get_live_buffer_count);
+
+	ClassDB::bind_method(D_METHOD("clear"), &MLPPAutodiffTape::clear);
+}
@@ -0,0 +1,168 @@
+#ifndef MLPP_AUTODIFF_TAPE_H
+#define MLPP_AUTODIFF_TAPE_H
+
+/*************************************************************************/
+/*  autodiff_tape.h                                                      */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifdef USING_SFW
+#include "sfw.h"
+#else
+#include "core/containers/vector.h"
+#include "core/math/math_defs.h"
+
+#include "core/object/reference.h"
+#endif
+
+#include "../core/activation.h"
+
+#include "../core/mlpp_matrix.h"
+#include "../core/mlpp_vector.h"
+
+// Reverse-mode automatic differentiation over MLPPMatrix operations.
+// Every operation is computed right away, and recorded as a node, identified by the returned index.
+// backward() then walks the nodes in reverse, and frees every intermediate value and gradient as soon as
+// the node's own backward step is done, so only the parameters' gradients and the leaf values stay around.
+// Nodes that do not depend on a parameter get no gradients at all.
+//
+// int x = tape->constant(input);
+// int h = hidden_layer->record(tape, x);
+// int loss = tape->mse(h, tape->constant(target));
+// tape->backward(loss);
+// Ref<MLPPMatrix> dw = tape->get_parameter_gradient(hidden_layer->get_weights());
+//
+// A tape is good for one backward() call, clear() it to record the next step.
+class MLPPAutodiffTape : public Reference {
+	GDCLASS(MLPPAutodiffTape, Reference);
+
+public:
+	// Leaves. Constants never get a gradient. Registering the same parameter twice returns the same node.
+	// Vector parameters (biases) are used as 1 x n matrices, that view the vector.
+	int constant(const Ref<MLPPMatrix> &p_value);
+	int parameter(const Ref<MLPPMatrix> &p_value);
+	int parameter_vector(const Ref<MLPPVector> &p_value);
+
+	int matmul(const int p_a, const int p_b);
+	int add(const int p_a, const int p_b);
+	int sub(const int p_a, const int p_b);
+	int hadamard(const int p_a, const int p_b);
+	int scale(const int p_a, const real_t p_scalar);
+	// Adds the 1 x n p_row to every row of p_a, like a bias.
+	int add_row(const int p_a, const int p_row);
+	// Element wise activations, and a row wise softmax.
+	int activation(const int p_a, const MLPPActivation::ActivationFunction p_func);
+	// Sum of every element, 1 x 1.
+	int sum(const int p_a);
+
+	// Losses, 1 x 1, averaged over the rows (samples).
+	// mse: sum((y_hat - y)^2) / (2 * rows)
+	int mse(const int p_y_hat, const int p_y);
+	// cross_entropy: -sum(y * log(y_hat)) / rows, for softmax outputs.
+	int cross_entropy(const int p_y_hat, const int p_y);
+	// log_loss: -sum(y * log(y_hat) + (1 - y) * log(1 - y_hat)) / rows, for sigmoid outputs.
+	int log_loss(const int p_y_hat, const int p_y);
+
+	// Computes the gradient of the 1 x 1 node p_node with respect to every parameter.
+	void backward(const int p_node);
+
+	// Values get freed by backward(), except for the leaves and p_node.
+	Ref<MLPPMatrix> get_value(const int p_node) const;
+	real_t get_scalar(const int p_node) const;
+
+	// Gradients of the parameters, after backward(). Null if the parameter did not contribute.
+	Ref<MLPPMatrix> get_gradient(const int p_node) const;
+	Ref<MLPPMatrix> get_parameter_gradient(const Ref<MLPPMatrix> &p_value) const;
+	Ref<MLPPVector> get_parameter_gradient_vector(const Ref<MLPPVector> &p_value) const;
+
+	int get_node_count() const;
+	// Number of nodes that still hold a value or a gradient buffer.
+	int get_live_buffer_count() const;
+
+	void clear();
+
+	MLPPAutodiffTape();
+	~MLPPAutodiffTape();
+
+protected:
+	enum Operation {
+		OPERATION_CONSTANT = 0,
+		OPERATION_PARAMETER,
+		OPERATION_MATMUL,
+		OPERATION_ADD,
+		OPERATION_SUB,
+		OPERATION_HADAMARD,
+		OPERATION_SCALE,
+		OPERATION_ADD_ROW,
+		OPERATION_ACTIVATION,
+		OPERATION_SOFTMAX,
+		OPERATION_SUM,
+		OPERATION_MSE,
+		OPERATION_CROSS_ENTROPY,
+		OPERATION_LOG_LOSS,
+	};
+
+	struct Node {
+		Operation operation;
+		int a;
+		int b;
+		real_t scalar;
+		MLPPActivation::ActivationFunction activation;
+		bool requires_gradient;
+
+		Ref<MLPPMatrix> value;
+		Ref<MLPPMatrix> gradient;
+
+		// The registered parameter, used for lookups.
+		Ref<MLPPMatrix> source_matrix;
+		Ref<MLPPVector> source_vector;
+
+		Node() {
+			operation = OPERATION_CONSTANT;
+			a = -1;
+			b = -1;
+			scalar = 0;
+			activation = MLPPActivation::ACTIVATION_FUNCTION_LINEAR;
+			requires_gradient = false;
+		}
+	};
+
+	int _push(const Operation p_operation, const int p_a, const int p_b, const Ref<MLPPMatrix> &p_value);
+	bool _is_usable(const int p_node) const;
+	Ref<MLPPMatrix> _gradient_for(const int p_node);
+	void _backward_node(const int p_node);
+
+	static Ref<MLPPMatrix> _scalar_matrix(const real_t p_value);
+
+	static void _bind_methods();
+
+	Vector<Node> _nodes;
+	bool _backward_done;
+};
+
+#endif
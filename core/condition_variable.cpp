@@ -0,0 +1,76 @@
+/*************************************************************************/
+/*  condition_variable.cpp                                               */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "condition_variable.h"
+
+#ifndef USING_SFW
+#include "core/os/os.h"
+#endif
+
+#include <chrono>
+
+void MLPPConditionVariable::wait(const BinaryMutex &p_mutex) {
+#ifndef NO_THREADS
+	_condition.wait(p_mutex);
+#endif
+}
+
+void MLPPConditionVariable::wait_until(const BinaryMutex &p_mutex, const uint64_t p_deadline_usec) {
+#ifndef NO_THREADS
+	uint64_t now = get_ticks_usec();
+
+	if (now >= p_deadline_usec) {
+		return;
+	}
+
+	_condition.wait_for(p_mutex, std::chrono::microseconds(p_deadline_usec - now));
+#endif
+}
+
+void MLPPConditionVariable::notify_one() {
+#ifndef NO_THREADS
+	_condition.notify_one();
+#endif
+}
+
+void MLPPConditionVariable::notify_all() {
+#ifndef NO_THREADS
+	_condition.notify_all();
+#endif
+}
+
+uint64_t MLPPConditionVariable::get_ticks_usec() {
+#ifdef USING_SFW
+	// SFWTime's clock starts separately on every thread.
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+	return OS::get_singleton()->get_ticks_usec();
+#endif
+}
@@ -0,0 +1,67 @@
+#ifndef MLPP_CONDITION_VARIABLE_H
+#define MLPP_CONDITION_VARIABLE_H
+
+/*************************************************************************/
+/*  condition_variable.h                                                 */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifdef USING_SFW
+#include "sfw.h"
+#else
+#include "core/os/mutex.h"
+#include "core/typedefs.h"
+#endif
+
+#ifndef NO_THREADS
+#include <condition_variable>
+#endif
+
+// Lets threads sleep until another thread changes the state that a BinaryMutex guards. Neither sfw nor the engine
+// has a condition variable, so this wraps the standard one.
+// The caller holds p_mutex (with a MutexLock, or lock()), it is released while sleeping, and held again on return.
+// Wakeups can be spurious, so wait in a loop on the guarded state. With NO_THREADS nothing ever waits.
+class MLPPConditionVariable {
+public:
+	void wait(const BinaryMutex &p_mutex);
+	// Returns once get_ticks_usec() reaches p_deadline_usec at the latest.
+	void wait_until(const BinaryMutex &p_mutex, const uint64_t p_deadline_usec);
+
+	void notify_one();
+	void notify_all();
+
+	// Monotonic, and the same on every thread.
+	static uint64_t get_ticks_usec();
+
+protected:
+#ifndef NO_THREADS
+	std::condition_variable_any _condition;
+#endif
+};
+
+#endif
@@ -30,7 +30,7 @@
 
 #include "convolutions.h"
 #include "../core/lin_alg.h"
-#include "../core/stat.h"
+#include "../core/parallel.h"
 
 #ifdef USING_SFW
 #include "sfw.h"
@@ -40,279 +40,313 @@
 
 #include <cmath>
 
-Ref<MLPPMatrix> MLPPConvolutions::convolve_2d(const Ref<MLPPMatrix> &p_input, const Ref<MLPPMatrix> &filter, const int S, const int P) {
-	MLPPLinAlg alg;
+Ref<MLPPMatrix> MLPPConvolutions::convolve_2d(const Ref<MLPPMatrix> &input, const Ref<MLPPMatrix> &filter, const int S, const int P) {
+	ERR_FAIL_COND_V(!input.is_valid() || !filter.is_valid(), Ref<MLPPMatrix>());
 
-	Ref<MLPPMatrix> input = p_input;
+	Size2i output_size = _convolution_output_size(input->size(), filter->size(), S, P);
 
-	Size2i input_size = input->size();
-	int N = input_size.y;
-	int F = filter->size().y;
-	int map_size = (N - F + 2 * P) / S + 1; // This is computed as ⌊map_size⌋ by def- thanks C++!
+	ERR_FAIL_COND_V(output_size == Size2i(), Ref<MLPPMatrix>());
 
-	if (P != 0) {
-		Ref<MLPPMatrix> padded_input;
-		padded_input.instance();
+	Ref<MLPPMatrix> feature_map;
+	feature_map.instance();
+	feature_map->resize(output_size);
+
+	const real_t *input_ptr = input->ptr();
+	real_t *output_ptr = feature_map->ptrw();
+
+	ConvolutionData data;
+	data.inputs = &input_ptr;
+	data.input_size = Size3i(input->size().x, input->size().y, 1);
+	data.filter = filter->ptr();
+	data.filter_size = filter->size();
+	data.filter_count = 1;
+	data.stride = S;
+	data.padding = P;
+	data.border_mode = _border_mode;
+	data.outputs = &output_ptr;
+	data.output_size = output_size;
+	data.batch_size = 1;
+
+	_convolve(&data);
 
-		Size2i pis = Size2i(N + 2 * P, N + 2 * P);
+	return feature_map;
+}
 
-		padded_input->resize(pis);
+Ref<MLPPTensor3> MLPPConvolutions::convolve_3d(const Ref<MLPPTensor3> &input, const Ref<MLPPTensor3> &filter, const int S, const int P) {
+	ERR_FAIL_COND_V(!input.is_valid(), Ref<MLPPTensor3>());
 
-		for (int i = 0; i < pis.y; i++) {
-			for (int j = 0; j < pis.x; j++) {
-				if (i - P < 0 || j - P < 0 || i - P > input_size.y - 1 || j - P > input_size.x - 1) {
-					padded_input->element_set(i, j, 0);
-				} else {
-					padded_input->element_set(i, j, input->element_get(i - P, j - P));
-				}
-			}
-		}
+	Vector<Ref<MLPPTensor3>> inputs;
+	inputs.push_back(input);
 
-		input = padded_input;
-	}
+	Vector<Ref<MLPPTensor3>> res = convolve_3d_batch(inputs, filter, S, P);
 
-	Ref<MLPPMatrix> feature_map;
-	feature_map.instance();
+	ERR_FAIL_COND_V(res.size() != 1, Ref<MLPPTensor3>());
 
-	feature_map->resize(Size2i(map_size, map_size));
+	return res[0];
+}
 
-	Ref<MLPPVector> filter_flattened = filter->flatten();
+Vector<Ref<MLPPTensor3>> MLPPConvolutions::convolve_3d_batch(const Vector<Ref<MLPPTensor3>> &inputs, const Ref<MLPPTensor3> &filter, const int S, const int P) {
+	Vector<Ref<MLPPTensor3>> feature_maps;
 
-	Ref<MLPPVector> convolving_input;
-	convolving_input.instance();
-	convolving_input->resize(F * F);
+	ERR_FAIL_COND_V(!filter.is_valid() || inputs.size() == 0, feature_maps);
+	ERR_FAIL_COND_V(!inputs[0].is_valid(), feature_maps);
 
-	for (int i = 0; i < map_size; i++) {
-		for (int j = 0; j < map_size; j++) {
-			int current_index = 0;
+	Size3i input_size = inputs[0]->size();
+	Size3i filter_size = filter->size();
 
-			for (int k = 0; k < F; k++) {
-				for (int p = 0; p < F; p++) {
-					real_t val;
+	ERR_FAIL_COND_V(input_size.z == 0 || filter_size.z % input_size.z != 0, feature_maps);
 
-					if (i == 0 && j == 0) {
-						val = input->element_get(i + k, j + p);
-					} else if (i == 0) {
-						val = input->element_get(i + k, j + (S - 1) + p);
-					} else if (j == 0) {
-						val = input->element_get(i + (S - 1) + k, j + p);
-					} else {
-						val = input->element_get(i + (S - 1) + k, j + (S - 1) + p);
-					}
+	int filter_count = filter_size.z / input_size.z;
+	Size2i output_size = _convolution_output_size(Size2i(input_size.x, input_size.y), Size2i(filter_size.x, filter_size.y), S, P);
 
-					convolving_input->element_set(current_index, val);
-					++current_index;
-				}
-			}
+	ERR_FAIL_COND_V(output_size == Size2i() || filter_count == 0, feature_maps);
 
-			feature_map->element_set(i, j, convolving_input->dot(filter_flattened));
-		}
+	int batch_size = inputs.size();
+
+	Vector<const real_t *> input_ptrs;
+	input_ptrs.resize(batch_size);
+	Vector<real_t *> output_ptrs;
+	output_ptrs.resize(batch_size);
+	feature_maps.resize(batch_size);
+
+	for (int i = 0; i < batch_size; ++i) {
+		const Ref<MLPPTensor3> &in = inputs[i];
+
+		ERR_FAIL_COND_V(!in.is_valid() || in->size() != input_size, Vector<Ref<MLPPTensor3>>());
+
+		Ref<MLPPTensor3> feature_map;
+		feature_map.instance();
+		feature_map->resize(Size3i(output_size.x, output_size.y, filter_count));
+
+		input_ptrs.write[i] = in->ptr();
+		output_ptrs.write[i] = feature_map->ptrw();
+		feature_maps.write[i] = feature_map;
 	}
 
-	return feature_map;
+	ConvolutionData data;
+	data.inputs = input_ptrs.ptr();
+	data.input_size = input_size;
+	data.filter = filter->ptr();
+	data.filter_size = Size2i(filter_size.x, filter_size.y);
+	data.filter_count = filter_count;
+	data.stride = S;
+	data.padding = P;
+	data.border_mode = _border_mode;
+	data.outputs = output_ptrs.ptr();
+	data.output_size = output_size;
+	data.batch_size = batch_size;
+
+	_convolve(&data);
+
+	return feature_maps;
 }
 
-Ref<MLPPTensor3> MLPPConvolutions::convolve_3d(const Ref<MLPPTensor3> &p_input, const Ref<MLPPTensor3> &filter, const int S, const int P) {
-	MLPPLinAlg alg;
-
-	Ref<MLPPTensor3> input = p_input;
+Ref<MLPPTensor3> MLPPConvolutions::convolve_3d_stacked(const Ref<MLPPTensor3> &inputs, const int channels, const Ref<MLPPTensor3> &filter, const int S, const int P) {
+	ERR_FAIL_COND_V(!inputs.is_valid() || !filter.is_valid(), Ref<MLPPTensor3>());
+	ERR_FAIL_COND_V(channels <= 0, Ref<MLPPTensor3>());
 
-	Size3i input_size = input->size();
+	Size3i stack_size = inputs->size();
 	Size3i filter_size = filter->size();
 
-	int N = input_size.y;
-	int F = filter_size.y;
-	int C = filter_size.z / input_size.z;
-	int map_size = (N - F + 2 * P) / S + 1; // This is computed as ⌊map_size⌋ by def.
+	ERR_FAIL_COND_V(stack_size.z == 0 || stack_size.z % channels != 0 || filter_size.z % channels != 0, Ref<MLPPTensor3>());
 
-	if (P != 0) {
-		Ref<MLPPTensor3> padded_input;
-		padded_input.instance();
+	Size3i input_size = Size3i(stack_size.x, stack_size.y, channels);
+	int batch_size = stack_size.z / channels;
+	int filter_count = filter_size.z / channels;
+	Size2i output_size = _convolution_output_size(Size2i(input_size.x, input_size.y), Size2i(filter_size.x, filter_size.y), S, P);
 
-		Ref<MLPPMatrix> padded_input_slice;
-		padded_input_slice.instance();
+	ERR_FAIL_COND_V(output_size == Size2i() || filter_count == 0, Ref<MLPPTensor3>());
 
-		Size2i padded_input_slice_size = Size2i(N + 2 * P, N + 2 * P);
-		padded_input_slice->resize(padded_input_slice_size);
+	Ref<MLPPTensor3> feature_maps;
+	feature_maps.instance();
+	feature_maps->resize(Size3i(output_size.x, output_size.y, batch_size * filter_count));
 
-		padded_input->resize(Size3i(padded_input_slice_size.x, padded_input_slice_size.y, input_size.z));
+	convolve_3d_stacked_ptr(inputs->ptr(), input_size, batch_size, filter->ptr(), Size2i(filter_size.x, filter_size.y), filter_count, S, P, feature_maps->ptrw());
 
-		for (int c = 0; c < input_size.z; c++) {
-			for (int i = 0; i < padded_input_slice_size.y; i++) {
-				for (int j = 0; j < padded_input_slice_size.x; j++) {
-					if (i - P < 0 || j - P < 0 || i - P > input_size.y - 1 || j - P > input_size.x - 1) {
-						padded_input_slice->element_set(i, j, 0);
-					} else {
-						padded_input_slice->element_set(i, j, input->element_get(i - P, j - P, c));
-					}
-				}
-			}
+	return feature_maps;
+}
 
-			padded_input->z_slice_set_mlpp_matrix(c, padded_input_slice);
-		}
+void MLPPConvolutions::convolve_3d_stacked_ptr(const real_t *inputs, const Size3i &input_size, const int batch_size, const real_t *filters, const Size2i &filter_size, const int filter_count, const int S, const int P, real_t *r_outputs) {
+	ERR_FAIL_COND(!inputs || !filters || !r_outputs);
+	ERR_FAIL_COND(batch_size <= 0 || filter_count <= 0 || input_size.z <= 0 || S <= 0 || P < 0);
 
-		input = padded_input;
-	}
+	Size2i output_size = _convolution_output_size(Size2i(input_size.x, input_size.y), filter_size, S, P);
 
-	Ref<MLPPTensor3> feature_map;
-	feature_map.instance();
-	feature_map->resize(Size3i(map_size, map_size, C));
-
-	Ref<MLPPVector> filter_flattened = filter->flatten();
-
-	Ref<MLPPVector> convolving_input;
-	convolving_input.instance();
-	convolving_input->resize(input_size.z * F * F);
-
-	for (int c = 0; c < C; c++) {
-		for (int i = 0; i < map_size; i++) {
-			for (int j = 0; j < map_size; j++) {
-				int current_index = 0;
-
-				for (int t = 0; t < input_size.z; t++) {
-					for (int k = 0; k < F; k++) {
-						for (int p = 0; p < F; p++) {
-							real_t val;
-
-							if (i == 0 && j == 0) {
-								val = input->element_get(i + k, j + p, t);
-							} else if (i == 0) {
-								val = input->element_get(i + k, j + (S - 1) + p, t);
-							} else if (j == 0) {
-								val = input->element_get(i + (S - 1) + k, j + p, t);
-							} else {
-								val = input->element_get(i + (S - 1) + k, j + (S - 1) + p, t);
-							}
+	ERR_FAIL_COND(output_size == Size2i());
 
-							convolving_input->element_set(current_index, val);
-							++current_index;
-						}
-					}
-				}
+	int input_data_size = input_size.x * input_size.y * input_size.z;
+	int output_data_size = output_size.x * output_size.y * filter_count;
 
-				feature_map->element_set(c, i, j, convolving_input->dot(filter_flattened));
-			}
-		}
+	Vector<const real_t *> input_ptrs;
+	input_ptrs.resize(batch_size);
+	Vector<real_t *> output_ptrs;
+	output_ptrs.resize(batch_size);
+
+	for (int i = 0; i < batch_size; ++i) {
+		input_ptrs.write[i] = inputs + i * input_data_size;
+		output_ptrs.write[i] = r_outputs + i * output_data_size;
 	}
+
+	ConvolutionData data;
+	data.inputs = input_ptrs.ptr();
+	data.input_size = input_size;
+	data.filter = filters;
+	data.filter_size = filter_size;
+	data.filter_count = filter_count;
+	data.stride = S;
+	data.padding = P;
+	data.border_mode = _border_mode;
+	data.outputs = output_ptrs.ptr();
+	data.output_size = output_size;
+	data.batch_size = batch_size;
+
+	_convolve(&data);
+}
+
+Ref<MLPPMatrix> MLPPConvolutions::convolve_2d_separable(const Ref<MLPPMatrix> &input, const Ref<MLPPVector> &vertical, const Ref<MLPPVector> &horizontal, const int S, const int P) {
+	ERR_FAIL_COND_V(!input.is_valid() || !vertical.is_valid() || !horizontal.is_valid(), Ref<MLPPMatrix>());
+
+	Size2i filter_size = Size2i(horizontal->size(), vertical->size());
+	Size2i output_size = _convolution_output_size(input->size(), filter_size, S, P);
+
+	ERR_FAIL_COND_V(output_size == Size2i(), Ref<MLPPMatrix>());
+
+	Ref<MLPPMatrix> feature_map;
+	feature_map.instance();
+	feature_map->resize(output_size);
+
+	const real_t *input_ptr = input->ptr();
+	real_t *output_ptr = feature_map->ptrw();
+
+	ConvolutionData data;
+	data.inputs = &input_ptr;
+	data.input_size = Size3i(input->size().x, input->size().y, 1);
+	data.filter = NULL;
+	data.filter_size = filter_size;
+	data.filter_count = 1;
+	data.stride = S;
+	data.padding = P;
+	data.border_mode = _border_mode;
+	data.outputs = &output_ptr;
+	data.output_size = output_size;
+	data.batch_size = 1;
+	data.separable_vertical = vertical->ptr();
+	data.separable_horizontal = horizontal->ptr();
+
+	_convolve_separable(&data);
+
 	return feature_map;
 }
 
-Ref<MLPPMatrix> MLPPConvolutions::pool_2d(const Ref<MLPPMatrix> &input, const int F, const int S, const PoolType type) {
-	MLPPLinAlg alg;
+bool MLPPConvolutions::separable_filter_decompose(const Ref<MLPPMatrix> &filter, Ref<MLPPVector> r_vertical, Ref<MLPPVector> r_horizontal, const real_t tolerance) {
+	ERR_FAIL_COND_V(!filter.is_valid() || !r_vertical.is_valid() || !r_horizontal.is_valid(), false);
+
+	Size2i filter_size = filter->size();
+
+	r_vertical->resize(filter_size.y);
+	r_horizontal->resize(filter_size.x);
+
+	return _separable_filter_decompose(filter->ptr(), filter_size, r_vertical->ptrw(), r_horizontal->ptrw(), tolerance);
+}
+
+Ref<MLPPMatrix> MLPPConvolutions::pool_2d(const Ref<MLPPMatrix> &input, const int F, const int S, const PoolType type, const int P) {
+	ERR_FAIL_COND_V(!input.is_valid(), Ref<MLPPMatrix>());
+	ERR_FAIL_COND_V(F <= 0 || S <= 0 || P < 0, Ref<MLPPMatrix>());
 
 	Size2i input_size = input->size();
+	Size2i output_size = _convolution_output_size(input_size, Size2i(F, F), S, P);
 
-	int N = input_size.y;
-	int map_size = (N - F) / S + 1;
+	ERR_FAIL_COND_V(output_size.x <= 0 || output_size.y <= 0, Ref<MLPPMatrix>());
 
 	Ref<MLPPMatrix> pooled_map;
 	pooled_map.instance();
-	pooled_map->resize(Size2i(map_size, map_size));
-
-	Ref<MLPPVector> pooling_input;
-	pooling_input.instance();
-	pooling_input->resize(F * F);
-
-	for (int i = 0; i < map_size; i++) {
-		for (int j = 0; j < map_size; j++) {
-			int current_index = 0;
-
-			for (int k = 0; k < F; k++) {
-				for (int p = 0; p < F; p++) {
-					real_t val;
-
-					if (i == 0 && j == 0) {
-						val = input->element_get(i + k, j + p);
-					} else if (i == 0) {
-						val = input->element_get(i + k, j + (S - 1) + p);
-					} else if (j == 0) {
-						val = input->element_get(i + (S - 1) + k, j + p);
-					} else {
-						val = input->element_get(i + (S - 1) + k, j + (S - 1) + p);
-					}
-
-					pooling_input->element_set(current_index, val);
-					++current_index;
-				}
-			}
-
-			if (type == POOL_TYPE_AVERAGE) {
-				MLPPStat stat;
-				pooled_map->element_set(i, j, stat.meanv(pooling_input));
-			} else if (type == POOL_TYPE_MIN) {
-				pooled_map->element_set(i, j, alg.minvr(pooling_input));
-			} else {
-				pooled_map->element_set(i, j, alg.maxvr(pooling_input));
-			}
-		}
-	}
+	pooled_map->resize(output_size);
+
+	PoolData data;
+	data.input = input->ptr();
+	data.input_size = input_size;
+	data.output = pooled_map->ptrw();
+	data.output_size = output_size;
+	data.slice_count = 1;
+	data.size = F;
+	data.stride = S;
+	data.padding = P;
+	data.type = type;
+	data.border_mode = _border_mode;
+
+	_pool(&data);
 
 	return pooled_map;
 }
 
-Ref<MLPPTensor3> MLPPConvolutions::pool_3d(const Ref<MLPPTensor3> &input, const int F, const int S, const PoolType type) {
-	Size3i input_size = input->size();
+Ref<MLPPTensor3> MLPPConvolutions::pool_3d(const Ref<MLPPTensor3> &input, const int F, const int S, const PoolType type, const int P) {
+	ERR_FAIL_COND_V(!input.is_valid(), Ref<MLPPTensor3>());
+	ERR_FAIL_COND_V(F <= 0 || S <= 0 || P < 0, Ref<MLPPTensor3>());
 
-	Ref<MLPPMatrix> z_slice;
-	z_slice.instance();
-	z_slice->resize(Size2i(input_size.x, input_size.y));
+	Size3i input_size = input->size();
+	Size2i input_slice_size = Size2i(input_size.x, input_size.y);
+	Size2i output_size = _convolution_output_size(input_slice_size, Size2i(F, F), S, P);
 
-	int N = input_size.y;
-	int map_size = (N - F) / S + 1;
+	ERR_FAIL_COND_V(output_size.x <= 0 || output_size.y <= 0, Ref<MLPPTensor3>());
 
 	Ref<MLPPTensor3> pooled_map;
 	pooled_map.instance();
-	pooled_map->resize(Size3i(map_size, map_size, input_size.z));
-
-	for (int i = 0; i < input_size.z; i++) {
-		input->z_slice_get_into_mlpp_matrix(i, z_slice);
-
-		Ref<MLPPMatrix> p = pool_2d(z_slice, F, S, type);
-
-		pooled_map->z_slice_set_mlpp_matrix(i, p);
-	}
+	pooled_map->resize(Size3i(output_size.x, output_size.y, input_size.z));
+
+	PoolData data;
+	data.input = input->ptr();
+	data.input_size = input_slice_size;
+	data.output = pooled_map->ptrw();
+	data.output_size = output_size;
+	data.slice_count = input_size.z;
+	data.size = F;
+	data.stride = S;
+	data.padding = P;
+	data.type = type;
+	data.border_mode = _border_mode;
+
+	_pool(&data);
 
 	return pooled_map;
 }
 
 real_t MLPPConvolutions::global_pool_2d(const Ref<MLPPMatrix> &input, const PoolType type) {
-	MLPPLinAlg alg;
+	ERR_FAIL_COND_V(!input.is_valid(), 0);
+	ERR_FAIL_COND_V(input->data_size() == 0, 0);
 
-	Ref<MLPPVector> f = input->flatten();
-
-	if (type == POOL_TYPE_AVERAGE) {
-		MLPPStat stat;
-		return stat.meanv(f);
-	} else if (type == POOL_TYPE_MIN) {
-		return alg.minvr(f);
-	} else {
-		return alg.maxvr(f);
-	}
+	return _global_pool_slice(input->ptr(), input->data_size(), type);
 }
 
 Ref<MLPPVector> MLPPConvolutions::global_pool_3d(const Ref<MLPPTensor3> &input, const PoolType type) {
+	ERR_FAIL_COND_V(!input.is_valid(), Ref<MLPPVector>());
+
 	Size3i input_size = input->size();
 
 	Ref<MLPPVector> pooled_map;
 	pooled_map.instance();
 	pooled_map->resize(input_size.z);
 
-	Ref<MLPPMatrix> z_slice;
-	z_slice.instance();
-	z_slice->resize(Size2i(input_size.x, input_size.y));
+	if (input_size.x * input_size.y == 0) {
+		pooled_map->fill(0);
+		return pooled_map;
+	}
 
-	for (int i = 0; i < input_size.z; i++) {
-		input->z_slice_get_into_mlpp_matrix(i, z_slice);
+	PoolData data;
+	data.input = input->ptr();
+	data.input_size = Size2i(input_size.x, input_size.y);
+	data.output = pooled_map->ptrw();
+	data.output_size = Size2i(1, 1);
+	data.slice_count = input_size.z;
+	data.type = type;
 
-		pooled_map->element_set(i, global_pool_2d(z_slice, type));
-	}
+	MLPPParallel::do_work(input_size.z, this, &MLPPConvolutions::_global_pool_range, &data, 1 + 65536 / (input_size.x * input_size.y));
 
 	return pooled_map;
 }
 
 real_t MLPPConvolutions::gaussian_2d(const real_t x, const real_t y, const real_t std) {
 	real_t std_sq = std * std;
-	return 1 / (2 * Math_PI * std_sq) * Math::exp(-(x * x + y * y) / 2 * std_sq);
+	return 1 / (2 * Math_PI * std_sq) * Math::exp(-(x * x + y * y) / (2 * std_sq));
 }
 
 Ref<MLPPMatrix> MLPPConvolutions::gaussian_filter_2d(const int size, const real_t std) {
@@ -320,9 +354,11 @@ Ref<MLPPMatrix> MLPPConvolutions::gaussian_filter_2d(const int size, const real_
 	filter.instance();
 	filter->resize(Size2i(size, size));
 
+	real_t center = (size - 1) * real_t(0.5);
+
 	for (int i = 0; i < size; i++) {
 		for (int j = 0; j < size; j++) {
-			real_t val = gaussian_2d(i - (size - 1) / 2, (size - 1) / 2 - j, std);
+			real_t val = gaussian_2d(i - center, center - j, std);
 
 			filter->element_set(i, j, val);
 		}
@@ -331,27 +367,51 @@ Ref<MLPPMatrix> MLPPConvolutions::gaussian_filter_2d(const int size, const real_
 	return filter;
 }
 
+Ref<MLPPVector> MLPPConvolutions::gaussian_filter_1d(const int size, const real_t std) {
+	Ref<MLPPVector> filter;
+	filter.instance();
+	filter->resize(size);
+
+	real_t std_sq = std * std;
+	real_t norm = 1 / (Math::sqrt(2 * Math_PI) * std);
+	real_t center = (size - 1) * real_t(0.5);
+
+	for (int i = 0; i < size; i++) {
+		real_t x = i - center;
+
+		filter->element_set(i, norm * Math::exp(-(x * x) / (2 * std_sq)));
+	}
+
+	return filter;
+}
+
 // Indeed a filter could have been used for this purpose, but I decided that it would've just
 // been easier to carry out the calculation explicitly, mainly because it is more informative,
 // and also because my convolution algorithm is only built for filters with equally sized
 // heights and widths.
 
 Ref<MLPPMatrix> MLPPConvolutions::dx(const Ref<MLPPMatrix> &input) {
+	ERR_FAIL_COND_V(!input.is_valid(), Ref<MLPPMatrix>());
+
 	Size2i input_size = input->size();
 
 	Ref<MLPPMatrix> deriv; // We assume a gray scale image.
 	deriv.instance();
 	deriv->resize(input_size);
 
+	const real_t *input_ptr = input->ptr();
+	real_t *deriv_ptr = deriv->ptrw();
+
 	for (int i = 0; i < input_size.y; i++) {
+		const real_t *input_row = input_ptr + i * input_size.x;
+		real_t *deriv_row = deriv_ptr + i * input_size.x;
+
 		for (int j = 0; j < input_size.x; j++) {
-			if (j != 0 && j != input_size.y - 1) {
-				deriv->element_set(i, j, input->element_get(i, j + 1) - input->element_get(i, j - 1));
-			} else if (j == 0) {
-				deriv->element_set(i, j, input->element_get(i, j + 1)); // E0 - 0 = Implicit zero-padding
-			} else {
-				deriv->element_set(i, j, -input->element_get(i, j - 1)); // 0 - E1 = Implicit zero-padding
-			}
+			// Implicit zero-padding
+			real_t right = j + 1 < input_size.x ? input_row[j + 1] : 0;
+			real_t left = j > 0 ? input_row[j - 1] : 0;
+
+			deriv_row[j] = right - left;
 		}
 	}
 
@@ -359,21 +419,26 @@ Ref<MLPPMatrix> MLPPConvolutions::dx(const Ref<MLPPMatrix> &input) {
 }
 
 Ref<MLPPMatrix> MLPPConvolutions::dy(const Ref<MLPPMatrix> &input) {
+	ERR_FAIL_COND_V(!input.is_valid(), Ref<MLPPMatrix>());
+
 	Size2i input_size = input->size();
 
 	Ref<MLPPMatrix> deriv; // We assume a gray scale image.
 	deriv.instance();
 	deriv->resize(input_size);
 
+	const real_t *input_ptr = input->ptr();
+	real_t *deriv_ptr = deriv->ptrw();
+
 	for (int i = 0; i < input_size.y; i++) {
+		real_t *deriv_row = deriv_ptr + i * input_size.x;
+
 		for (int j = 0; j < input_size.x; j++) {
-			if (i != 0 && i != input_size.y - 1) {
-				deriv->element_set(i, j, input->element_get(i - 1, j) - input->element_get(i + 1, j));
-			} else if (i == 0) {
-				deriv->element_set(i, j, -input->element_get(i + 1, j)); // 0 - E1 = Implicit zero-padding
-			} else {
-				deriv->element_set(i, j, input->element_get(i - 1, j)); // E0 - 0 =Implicit zero-padding
-			}
+			// Implicit zero-padding
+			real_t up = i > 0 ? input_ptr[(i - 1) * input_size.x + j] : 0;
+			real_t down = i + 1 < input_size.y ? input_ptr[(i + 1) * input_size.x + j] : 0;
+
+			deriv_row[j] = up - down;
 		}
 	}
 
@@ -381,77 +446,51 @@ Ref<MLPPMatrix> MLPPConvolutions::dy(const Ref<MLPPMatrix> &input) {
 }
 
 Ref<MLPPMatrix> MLPPConvolutions::grad_magnitude(const Ref<MLPPMatrix> &input) {
-	MLPPLinAlg alg;
-
-	Ref<MLPPMatrix> x_deriv_2 = dx(input)->hadamard_productn(dx(input));
-	Ref<MLPPMatrix> y_deriv_2 = dy(input)->hadamard_productn(dy(input));
-
-	return x_deriv_2->addn(y_deriv_2)->sqrtn();
+	return _gradient(input, true, false).magnitude;
 }
 
 Ref<MLPPMatrix> MLPPConvolutions::grad_orientation(const Ref<MLPPMatrix> &input) {
-	Ref<MLPPMatrix> deriv; // We assume a gray scale image.
-	deriv.instance();
-	deriv->resize(input->size());
-
-	Size2i deriv_size = deriv->size();
-
-	Ref<MLPPMatrix> x_deriv = dx(input);
-	Ref<MLPPMatrix> y_deriv = dy(input);
-
-	for (int i = 0; i < deriv_size.y; i++) {
-		for (int j = 0; j < deriv_size.x; j++) {
-			deriv->element_set(i, j, Math::atan2(y_deriv->element_get(i, j), x_deriv->element_get(i, j)));
-		}
-	}
+	return _gradient(input, false, true).orientation;
+}
 
-	return deriv;
+MLPPConvolutions::GradientResult MLPPConvolutions::grad_magnitude_orientation(const Ref<MLPPMatrix> &input) {
+	return _gradient(input, true, true);
 }
 
 Ref<MLPPTensor3> MLPPConvolutions::compute_m(const Ref<MLPPMatrix> &input) {
-	Size2i input_size = input->size();
-
-	real_t const SIGMA = 1;
-	real_t const GAUSSIAN_SIZE = 3;
+	ERR_FAIL_COND_V(!input.is_valid(), Ref<MLPPTensor3>());
 
-	real_t const GAUSSIAN_PADDING = ((input_size.y - 1) + GAUSSIAN_SIZE - input_size.y) / 2; // Convs must be same.
-
-	Ref<MLPPMatrix> x_deriv = dx(input);
-	Ref<MLPPMatrix> y_deriv = dy(input);
-
-	Ref<MLPPMatrix> gaussian_filter = gaussian_filter_2d(GAUSSIAN_SIZE, SIGMA); // Sigma of 1, size of 3.
-	Ref<MLPPMatrix> xx_deriv = convolve_2d(x_deriv->hadamard_productn(x_deriv), gaussian_filter, 1, GAUSSIAN_PADDING);
-	Ref<MLPPMatrix> yy_deriv = convolve_2d(y_deriv->hadamard_productn(y_deriv), gaussian_filter, 1, GAUSSIAN_PADDING);
-	Ref<MLPPMatrix> xy_deriv = convolve_2d(x_deriv->hadamard_productn(y_deriv), gaussian_filter, 1, GAUSSIAN_PADDING);
-
-	Size2i ds = xx_deriv->size();
+	Size2i input_size = input->size();
 
 	Ref<MLPPTensor3> M;
 	M.instance();
-	M->resize(Size3i(ds.x, ds.y, 3));
+	M->resize(Size3i(input_size.x, input_size.y, 3));
 
-	M->z_slice_set_mlpp_matrix(0, xx_deriv);
-	M->z_slice_set_mlpp_matrix(1, yy_deriv);
-	M->z_slice_set_mlpp_matrix(2, xy_deriv);
+	// The z slices are contiguous.
+	real_t *m_ptr = M->ptrw();
+	int slice_size = input_size.x * input_size.y;
+
+	_harris(input, m_ptr, m_ptr + slice_size, m_ptr + 2 * slice_size, NULL, 0);
 
 	return M;
 }
 
 Vector<Ref<MLPPMatrix>> MLPPConvolutions::compute_mv(const Ref<MLPPMatrix> &input) {
-	Size2i input_size = input->size();
+	ERR_FAIL_COND_V(!input.is_valid(), Vector<Ref<MLPPMatrix>>());
 
-	real_t const SIGMA = 1;
-	real_t const GAUSSIAN_SIZE = 3;
-
-	real_t const GAUSSIAN_PADDING = ((input_size.y - 1) + GAUSSIAN_SIZE - input_size.y) / 2; // Convs must be same.
+	Size2i input_size = input->size();
 
-	Ref<MLPPMatrix> x_deriv = dx(input);
-	Ref<MLPPMatrix> y_deriv = dy(input);
+	Ref<MLPPMatrix> xx_deriv;
+	xx_deriv.instance();
+	xx_deriv->resize(input_size);
+	Ref<MLPPMatrix> yy_deriv;
+	yy_deriv.instance();
+	yy_deriv->resize(input_size);
+	Ref<MLPPMatrix> xy_deriv;
+	xy_deriv.instance();
+	xy_deriv->resize(input_size);
 
-	Ref<MLPPMatrix> gaussian_filter = gaussian_filter_2d(GAUSSIAN_SIZE, SIGMA); // Sigma of 1, size of 3.
-	Ref<MLPPMatrix> xx_deriv = convolve_2d(x_deriv->hadamard_productn(x_deriv), gaussian_filter, 1, GAUSSIAN_PADDING);
-	Ref<MLPPMatrix> yy_deriv = convolve_2d(y_deriv->hadamard_productn(y_deriv), gaussian_filter, 1, GAUSSIAN_PADDING);
-	Ref<MLPPMatrix> xy_deriv = convolve_2d(x_deriv->hadamard_productn(y_deriv), gaussian_filter, 1, GAUSSIAN_PADDING);
+	_harris(input, xx_deriv->ptrw(), yy_deriv->ptrw(), xy_deriv->ptrw(), NULL, 0);
 
 	Vector<Ref<MLPPMatrix>> M;
 	M.resize(3);
@@ -463,25 +502,67 @@ Vector<Ref<MLPPMatrix>> MLPPConvolutions::compute_mv(const Ref<MLPPMatrix> &inpu
 	return M;
 }
 
+MLPPConvolutions::HarrisResult MLPPConvolutions::harris_corners(const Ref<MLPPMatrix> &input, const real_t k, const real_t threshold) {
+	HarrisResult res;
+
+	ERR_FAIL_COND_V(!input.is_valid(), res);
+
+	Size2i size = input->size();
+
+	res.response.instance();
+	res.response->resize(size);
+
+	_harris(input, NULL, NULL, NULL, res.response->ptrw(), k);
+
+	// Keypoints: local maxima of the response (in their 3x3 neighbourhood) above threshold.
+	const real_t *r = res.response->ptr();
+
+	for (int i = 0; i < size.y; ++i) {
+		for (int j = 0; j < size.x; ++j) {
+			real_t e = r[i * size.x + j];
+
+			if (e <= threshold) {
+				continue;
+			}
+
+			bool is_max = true;
+
+			for (int di = MAX(i - 1, 0); di <= MIN(i + 1, size.y - 1) && is_max; ++di) {
+				for (int dj = MAX(j - 1, 0); dj <= MIN(j + 1, size.x - 1); ++dj) {
+					real_t n = r[di * size.x + dj];
+
+					// Plateaus keep their first pixel only.
+					if (n > e || (n == e && (di < i || (di == i && dj < j)))) {
+						is_max = false;
+						break;
+					}
+				}
+			}
+
+			if (is_max) {
+				res.keypoints.push_back(Vector2i(j, i));
+			}
+		}
+	}
+
+	return res;
+}
+
 Vector<Vector<CharType>> MLPPConvolutions::harris_corner_detection(const Ref<MLPPMatrix> &input) {
 	real_t const k = 0.05; // Empirically determined wherein k -> [0.04, 0.06], though conventionally 0.05 is typically used as well.
 
-	Vector<Ref<MLPPMatrix>> M = compute_mv(input);
+	ERR_FAIL_COND_V(!input.is_valid(), Vector<Vector<CharType>>());
 
-	Ref<MLPPMatrix> M0 = M[0];
-	Ref<MLPPMatrix> M1 = M[1];
-	Ref<MLPPMatrix> M2 = M[2];
+	Ref<MLPPMatrix> r;
+	r.instance();
+	r->resize(input->size());
 
-	Ref<MLPPMatrix> det = M0->hadamard_productn(M1)->subn(M2->hadamard_productn(M2));
-	Ref<MLPPMatrix> trace = M0->addn(M1);
+	_harris(input, NULL, NULL, NULL, r->ptrw(), k);
 
-	// The reason this is not a scalar is because xx_deriv, xy_deriv, yx_deriv, and yy_deriv are not scalars.
-	Ref<MLPPMatrix> r = det->subn(trace->hadamard_productn(trace)->scalar_multiplyn(k));
 	Size2i r_size = r->size();
 
 	Vector<Vector<CharType>> image_types;
 	image_types.resize(r_size.y);
-	//alg.printMatrix(r);
 
 	for (int i = 0; i < r_size.y; i++) {
 		image_types.write[i].resize(r_size.x);
@@ -502,32 +583,1342 @@ Vector<Vector<CharType>> MLPPConvolutions::harris_corner_detection(const Ref<MLP
 	return image_types;
 }
 
-Ref<MLPPMatrix> MLPPConvolutions::get_prewitt_horizontal() const {
-	return _prewitt_horizontal;
-}
-Ref<MLPPMatrix> MLPPConvolutions::get_prewitt_vertical() const {
-	return _prewitt_vertical;
+MLPPConvolutions::GradientResult MLPPConvolutions::_gradient(const Ref<MLPPMatrix> &input, const bool p_magnitude, const bool p_orientation) {
+	GradientResult res;
+
+	ERR_FAIL_COND_V(!input.is_valid(), res);
+
+	Size2i size = input->size();
+
+	GradientData data;
+	data.input = input->ptr();
+	data.size = size;
+	data.magnitude = NULL;
+	data.orientation = NULL;
+
+	if (p_magnitude) {
+		res.magnitude.instance();
+		res.magnitude->resize(size);
+		data.magnitude = res.magnitude->ptrw();
+	}
+
+	if (p_orientation) {
+		res.orientation.instance();
+		res.orientation->resize(size);
+		data.orientation = res.orientation->ptrw();
+	}
+
+	MLPPParallel::do_work(size.y, this, &MLPPConvolutions::_gradient_range, &data, 1 + 16384 / MAX(size.x, 1));
+
+	return res;
 }
-Ref<MLPPMatrix> MLPPConvolutions::get_sobel_horizontal() const {
-	return _sobel_horizontal;
+
+void MLPPConvolutions::_gradient_range(int p_from, int p_to, GradientData *p_data) {
+	const Size2i size = p_data->size;
+	const real_t *input = p_data->input;
+
+	for (int i = p_from; i < p_to; ++i) {
+		const real_t *row = input + i * size.x;
+		const real_t *up = i > 0 ? row - size.x : NULL;
+		const real_t *down = i + 1 < size.y ? row + size.x : NULL;
+
+		for (int j = 0; j < size.x; ++j) {
+			// Same as dx() and dy().
+			real_t gx = (j + 1 < size.x ? row[j + 1] : 0) - (j > 0 ? row[j - 1] : 0);
+			real_t gy = (up ? up[j] : 0) - (down ? down[j] : 0);
+
+			if (p_data->magnitude) {
+				p_data->magnitude[i * size.x + j] = Math::sqrt(gx * gx + gy * gy);
+			}
+
+			if (p_data->orientation) {
+				p_data->orientation[i * size.x + j] = Math::atan2(gy, gx);
+			}
+		}
+	}
 }
-Ref<MLPPMatrix> MLPPConvolutions::get_sobel_vertical() const {
-	return _sobel_vertical;
+
+void MLPPConvolutions::_harris(const Ref<MLPPMatrix> &input, real_t *r_xx, real_t *r_yy, real_t *r_xy, real_t *r_response, const real_t k) {
+	Size2i size = input->size();
+
+	if (size.x == 0 || size.y == 0) {
+		return;
+	}
+
+	// Sigma of 1, size of 3. gaussian_filter_2d(3, 1) is the outer product of this with itself.
+	Ref<MLPPVector> gaussian = gaussian_filter_1d(HARRIS_GAUSSIAN_SIZE, 1);
+
+	HarrisData data;
+	data.input = input->ptr();
+	data.size = size;
+	data.xx = r_xx;
+	data.yy = r_yy;
+	data.xy = r_xy;
+	data.response = r_response;
+	data.k = k;
+
+	for (int i = 0; i < HARRIS_GAUSSIAN_SIZE; ++i) {
+		data.weights[i] = gaussian->element_get(i);
+	}
+
+	MLPPParallel::do_work(size.y, this, &MLPPConvolutions::_harris_range, &data, 1 + 8192 / size.x);
 }
-Ref<MLPPMatrix> MLPPConvolutions::get_scharr_horizontal() const {
-	return _scharr_horizontal;
+
+// Gradients, their products, the gaussian smoothing of the products (the structure tensor), and the response,
+// one row at a time. The products are kept in a ring of 3 rows, so nothing but the results goes to memory.
+void MLPPConvolutions::_harris_range(int p_from, int p_to, HarrisData *p_data) {
+	const Size2i size = p_data->size;
+	const real_t *input = p_data->input;
+	const real_t w0 = p_data->weights[0];
+	const real_t w1 = p_data->weights[1];
+	const real_t w2 = p_data->weights[2];
+
+	// 3 ring rows for xx, yy, xy, and the vertical pass result for xx, yy, xy. Every row has a zero on both sides,
+	// so the horizontal pass does not need to check the borders.
+	const int stride = size.x + 2;
+
+	Vector<real_t> buffer;
+	buffer.resize(12 * stride);
+	real_t *buffer_ptr = buffer.ptrw();
+
+	for (int i = 0; i < 12 * stride; ++i) {
+		buffer_ptr[i] = 0;
+	}
+
+	real_t *ring[3][3];
+	real_t *vertical[3];
+
+	for (int c = 0; c < 3; ++c) {
+		for (int r = 0; r < 3; ++r) {
+			ring[c][r] = buffer_ptr + (c * 3 + r) * stride + 1;
+		}
+
+		vertical[c] = buffer_ptr + (9 + c) * stride + 1;
+	}
+
+	// Rows of the products outside the image are zero (the zero padding of the old convolve_2d call).
+	for (int r = p_from - 1; r <= p_to; ++r) {
+		int slot = (r + 3) % 3;
+
+		if (r < 0 || r >= size.y) {
+			for (int c = 0; c < 3; ++c) {
+				for (int j = 0; j < size.x; ++j) {
+					ring[c][slot][j] = 0;
+				}
+			}
+		} else {
+			const real_t *row = input + r * size.x;
+			const real_t *up = r > 0 ? row - size.x : NULL;
+			const real_t *down = r + 1 < size.y ? row + size.x : NULL;
+
+			real_t *xx = ring[0][slot];
+			real_t *yy = ring[1][slot];
+			real_t *xy = ring[2][slot];
+
+			for (int j = 0; j < size.x; ++j) {
+				real_t gx = (j + 1 < size.x ? row[j + 1] : 0) - (j > 0 ? row[j - 1] : 0);
+				real_t gy = (up ? up[j] : 0) - (down ? down[j] : 0);
+
+				xx[j] = gx * gx;
+				yy[j] = gy * gy;
+				xy[j] = gx * gy;
+			}
+		}
+
+		// Row r - 1 has all 3 product rows now.
+		int i = r - 1;
+
+		if (i < p_from) {
+			continue;
+		}
+
+		int top = (i + 2) % 3;
+		int middle = (i + 3) % 3;
+		int bottom = (i + 4) % 3;
+
+		for (int c = 0; c < 3; ++c) {
+			const real_t *a = ring[c][top];
+			const real_t *b = ring[c][middle];
+			const real_t *d = ring[c][bottom];
+			real_t *v = vertical[c];
+
+			for (int j = 0; j < size.x; ++j) {
+				v[j] = w0 * a[j] + w1 * b[j] + w2 * d[j];
+			}
+		}
+
+		const real_t *vxx = vertical[0];
+		const real_t *vyy = vertical[1];
+		const real_t *vxy = vertical[2];
+
+		for (int j = 0; j < size.x; ++j) {
+			real_t sxx = w0 * vxx[j - 1] + w1 * vxx[j] + w2 * vxx[j + 1];
+			real_t syy = w0 * vyy[j - 1] + w1 * vyy[j] + w2 * vyy[j + 1];
+			real_t sxy = w0 * vxy[j - 1] + w1 * vxy[j] + w2 * vxy[j + 1];
+
+			int index = i * size.x + j;
+
+			if (p_data->xx) {
+				p_data->xx[index] = sxx;
+				p_data->yy[index] = syy;
+				p_data->xy[index] = sxy;
+			}
+
+			if (p_data->response) {
+				real_t trace = sxx + syy;
+
+				p_data->response[index] = sxx * syy - sxy * sxy - p_data->k * trace * trace;
+			}
+		}
+	}
 }
-Ref<MLPPMatrix> MLPPConvolutions::get_scharr_vertical() const {
-	return _scharr_vertical;
+
+// Maps a (possibly out of bounds) coordinate to the input coordinate it reads, -1 means zero.
+static _FORCE_INLINE_ int _border_map(int i, const int n, const MLPPConvolutions::BorderMode mode) {
+	if (likely(i >= 0 && i < n)) {
+		return i;
+	}
+
+	switch (mode) {
+		case MLPPConvolutions::BORDER_MODE_REPLICATE:
+			return CLAMP(i, 0, n - 1);
+		case MLPPConvolutions::BORDER_MODE_REFLECT: {
+			if (n == 1) {
+				return 0;
+			}
+
+			// dcb|abcd|cba
+			int period = 2 * (n - 1);
+			i = ABS(i) % period;
+			return i < n ? i : period - i;
+		}
+		case MLPPConvolutions::BORDER_MODE_WRAP:
+			i %= n;
+			return i < 0 ? i + n : i;
+		case MLPPConvolutions::BORDER_MODE_ZERO:
+		default:
+			return -1;
+	}
 }
-Ref<MLPPMatrix> MLPPConvolutions::get_roberts_horizontal() const {
-	return _roberts_horizontal;
+
+// Sliding window min / max over line with a monotonic deque, the window of output i is [i * S, i * S + F).
+// Every element is pushed and popped at most once, so this is O(count) independent of F.
+static void _pool_sliding_extreme(const real_t *line, const int out_count, const int F, const int S, const bool is_max, int *deque, real_t *out, const int out_stride) {
+	int head = 0;
+	int tail = 0;
+	int next = 0;
+
+	for (int i = 0; i < out_count; ++i) {
+		int window_end = i * S + F;
+
+		for (; next < window_end; ++next) {
+			real_t val = line[next];
+
+			if (is_max) {
+				while (tail > head && line[deque[tail - 1]] <= val) {
+					--tail;
+				}
+			} else {
+				while (tail > head && line[deque[tail - 1]] >= val) {
+					--tail;
+				}
+			}
+
+			deque[tail++] = next;
+		}
+
+		while (deque[head] < i * S) {
+			++head;
+		}
+
+		out[i * out_stride] = line[deque[head]];
+	}
 }
-Ref<MLPPMatrix> MLPPConvolutions::get_roberts_vertical() const {
-	return _roberts_vertical;
+
+void MLPPConvolutions::_pool(PoolData *p_data) {
+	const int F = p_data->size;
+	int slice_work = p_data->output_size.x * p_data->output_size.y * (p_data->stride < F ? 2 * F : F * F);
+
+	MLPPParallel::do_work(p_data->slice_count, this, &MLPPConvolutions::_pool_range, p_data, 1 + 65536 / MAX(slice_work, 1));
 }
 
-MLPPConvolutions::MLPPConvolutions() {
+void MLPPConvolutions::_pool_range(int p_from, int p_to, PoolData *p_data) {
+	const Size2i input_size = p_data->input_size;
+	const Size2i output_size = p_data->output_size;
+	const int F = p_data->size;
+	const int S = p_data->stride;
+	const int P = p_data->padding;
+	const PoolType type = p_data->type;
+	const BorderMode border_mode = p_data->border_mode;
+
+	// The part of the padded input that is covered by windows.
+	const Size2i virtual_size = Size2i((output_size.x - 1) * S + F, (output_size.y - 1) * S + F);
+
+	// Overlapping windows reuse work between neighbours: min / max is separable into a row and a column
+	// sliding window pass, and averages are read from an integral image.
+	// Non overlapping windows read everything exactly once anyway, so they are computed directly.
+	const bool sliding = S < F && F > 2;
+
+	// The padding of the average pool counts into the divisor, as if the input was padded.
+	const real_t inv_window_size = 1 / static_cast<real_t>(F * F);
+
+	Vector<real_t> line;
+	Vector<real_t> row_pass;
+	Vector<int> deque;
+	Vector<double> integral;
+
+	if (sliding) {
+		if (type == POOL_TYPE_AVERAGE) {
+			integral.resize((virtual_size.x + 1) * (virtual_size.y + 1));
+		} else {
+			line.resize(MAX(virtual_size.x, virtual_size.y));
+			row_pass.resize(virtual_size.y * output_size.x);
+			deque.resize(MAX(virtual_size.x, virtual_size.y));
+		}
+	}
+
+	for (int slice = p_from; slice < p_to; ++slice) {
+		const real_t *input = p_data->input + slice * input_size.x * input_size.y;
+		real_t *output = p_data->output + slice * output_size.x * output_size.y;
+
+		if (sliding && type == POOL_TYPE_AVERAGE) {
+			double *integral_ptr = integral.ptrw();
+			const int integral_stride = virtual_size.x + 1;
+
+			for (int j = 0; j < integral_stride; ++j) {
+				integral_ptr[j] = 0;
+			}
+
+			for (int i = 0; i < virtual_size.y; ++i) {
+				int y = _border_map(i - P, input_size.y, border_mode);
+				const double *prev_row = integral_ptr + i * integral_stride;
+				double *row = integral_ptr + (i + 1) * integral_stride;
+				double row_sum = 0;
+
+				row[0] = 0;
+
+				for (int j = 0; j < virtual_size.x; ++j) {
+					if (y >= 0) {
+						int x = _border_map(j - P, input_size.x, border_mode);
+
+						if (x >= 0) {
+							row_sum += input[y * input_size.x + x];
+						}
+					}
+
+					row[j + 1] = prev_row[j + 1] + row_sum;
+				}
+			}
+
+			for (int oy = 0; oy < output_size.y; ++oy) {
+				const double *top = integral_ptr + oy * S * integral_stride;
+				const double *bottom = top + F * integral_stride;
+
+				for (int ox = 0; ox < output_size.x; ++ox) {
+					int x0 = ox * S;
+					double sum = bottom[x0 + F] - bottom[x0] - top[x0 + F] + top[x0];
+
+					output[oy * output_size.x + ox] = static_cast<real_t>(sum) * inv_window_size;
+				}
+			}
+		} else if (sliding) {
+			const bool is_max = type != POOL_TYPE_MIN;
+			real_t *line_ptr = line.ptrw();
+			real_t *row_pass_ptr = row_pass.ptrw();
+			int *deque_ptr = deque.ptrw();
+
+			// Rows: virtual_size.y x output_size.x
+			for (int i = 0; i < virtual_size.y; ++i) {
+				int y = _border_map(i - P, input_size.y, border_mode);
+
+				if (y < 0) {
+					for (int ox = 0; ox < output_size.x; ++ox) {
+						row_pass_ptr[i * output_size.x + ox] = 0;
+					}
+
+					continue;
+				}
+
+				const real_t *input_row = input + y * input_size.x;
+
+				for (int j = 0; j < virtual_size.x; ++j) {
+					int x = j >= P && j < input_size.x + P ? j - P : _border_map(j - P, input_size.x, border_mode);
+					line_ptr[j] = x < 0 ? 0 : input_row[x];
+				}
+
+				_pool_sliding_extreme(line_ptr, output_size.x, F, S, is_max, deque_ptr, row_pass_ptr + i * output_size.x, 1);
+			}
+
+			// Columns
+			for (int ox = 0; ox < output_size.x; ++ox) {
+				for (int i = 0; i < virtual_size.y; ++i) {
+					line_ptr[i] = row_pass_ptr[i * output_size.x + ox];
+				}
+
+				_pool_sliding_extreme(line_ptr, output_size.y, F, S, is_max, deque_ptr, output + ox, output_size.x);
+			}
+		} else {
+			for (int oy = 0; oy < output_size.y; ++oy) {
+				int y0 = oy * S - P;
+				bool y_interior = y0 >= 0 && y0 + F <= input_size.y;
+
+				for (int ox = 0; ox < output_size.x; ++ox) {
+					int x0 = ox * S - P;
+					real_t result;
+
+					if (y_interior && x0 >= 0 && x0 + F <= input_size.x) {
+						const real_t *window = input + y0 * input_size.x + x0;
+						result = type == POOL_TYPE_AVERAGE ? 0 : window[0];
+
+						for (int k = 0; k < F; ++k) {
+							const real_t *row = window + k * input_size.x;
+
+							for (int l = 0; l < F; ++l) {
+								if (type == POOL_TYPE_AVERAGE) {
+									result += row[l];
+								} else if (type == POOL_TYPE_MIN) {
+									result = MIN(result, row[l]);
+								} else {
+									result = MAX(result, row[l]);
+								}
+							}
+						}
+					} else {
+						bool first = true;
+						result = 0;
+
+						for (int k = 0; k < F; ++k) {
+							int y = _border_map(y0 + k, input_size.y, border_mode);
+
+							for (int l = 0; l < F; ++l) {
+								int x = _border_map(x0 + l, input_size.x, border_mode);
+								real_t val = y < 0 || x < 0 ? 0 : input[y * input_size.x + x];
+
+								if (type == POOL_TYPE_AVERAGE) {
+									result += val;
+								} else if (first) {
+									result = val;
+								} else if (type == POOL_TYPE_MIN) {
+									result = MIN(result, val);
+								} else {
+									result = MAX(result, val);
+								}
+
+								first = false;
+							}
+						}
+					}
+
+					output[oy * output_size.x + ox] = type == POOL_TYPE_AVERAGE ? result * inv_window_size : result;
+				}
+			}
+		}
+	}
+}
+
+real_t MLPPConvolutions::_global_pool_slice(const real_t *input, const int size, const PoolType type) {
+	if (type == POOL_TYPE_AVERAGE) {
+		double sum = 0;
+
+		for (int i = 0; i < size; ++i) {
+			sum += input[i];
+		}
+
+		return static_cast<real_t>(sum / size);
+	}
+
+	real_t result = input[0];
+
+	if (type == POOL_TYPE_MIN) {
+		for (int i = 1; i < size; ++i) {
+			result = MIN(result, input[i]);
+		}
+	} else {
+		for (int i = 1; i < size; ++i) {
+			result = MAX(result, input[i]);
+		}
+	}
+
+	return result;
+}
+
+void MLPPConvolutions::_global_pool_range(int p_from, int p_to, PoolData *p_data) {
+	const int slice_size = p_data->input_size.x * p_data->input_size.y;
+
+	for (int i = p_from; i < p_to; ++i) {
+		p_data->output[i] = _global_pool_slice(p_data->input + i * slice_size, slice_size, p_data->type);
+	}
+}
+
+Size2i MLPPConvolutions::_convolution_output_size(const Size2i &p_input_size, const Size2i &p_filter_size, const int S, const int P) const {
+	ERR_FAIL_COND_V(S <= 0 || P < 0, Size2i());
+	ERR_FAIL_COND_V(p_filter_size.x <= 0 || p_filter_size.y <= 0, Size2i());
+
+	int w = p_input_size.x - p_filter_size.x + 2 * P;
+	int h = p_input_size.y - p_filter_size.y + 2 * P;
+
+	ERR_FAIL_COND_V(w < 0 || h < 0, Size2i());
+
+	return Size2i(w / S + 1, h / S + 1);
+}
+
+// Number of output pixels per im2col tile. The tile's columns (input channels * filter area rows of it)
+// should stay in cache while every filter gets multiplied with them.
+static const int CONVOLUTION_TILE_SIZE = 64;
+// Filters processed together in the GEMM micro kernel, so every loaded im2col row gets reused.
+static const int CONVOLUTION_FILTER_BLOCK = 4;
+// Upper bound (in real_t elements) of the filter spectra the FFT path keeps for a whole batch.
+// Above it, every filter spectrum is recomputed per input instead.
+static const int64_t FFT_FILTER_SPECTRA_MAX_SIZE = 1 << 23;
+// The AUTO path does not pick FFT if even its per input buffers would be larger than this (in real_t elements).
+static const int64_t FFT_WORKING_SET_MAX_SIZE = 1 << 25;
+
+void MLPPConvolutions::_convolve(ConvolutionData *p_data) {
+	bool winograd_applicable = p_data->filter_size == Size2i(3, 3) && p_data->stride == 1;
+
+	if ((_convolution_algorithm == CONVOLUTION_ALGORITHM_AUTO || _convolution_algorithm == CONVOLUTION_ALGORITHM_SEPARABLE) &&
+			p_data->input_size.z == 1 && p_data->filter_count == 1 && p_data->filter_size.x > 1 && p_data->filter_size.y > 1) {
+		Vector<real_t> vertical;
+		Vector<real_t> horizontal;
+
+		if (_separable_filter_decompose_cached(p_data->filter, p_data->filter_size, vertical, horizontal)) {
+			p_data->separable_vertical = vertical.ptr();
+			p_data->separable_horizontal = horizontal.ptr();
+
+			_convolve_separable(p_data);
+			return;
+		}
+	}
+
+	switch (_convolution_algorithm) {
+		case CONVOLUTION_ALGORITHM_IM2COL:
+		case CONVOLUTION_ALGORITHM_SEPARABLE:
+			_convolve_im2col(p_data);
+			return;
+		case CONVOLUTION_ALGORITHM_WINOGRAD:
+			if (winograd_applicable) {
+				_convolve_winograd(p_data);
+			} else {
+				_convolve_im2col(p_data);
+			}
+			return;
+		case CONVOLUTION_ALGORITHM_FFT:
+			_convolve_fft(p_data);
+			return;
+		case CONVOLUTION_ALGORITHM_AUTO:
+		default:
+			break;
+	}
+
+	if (winograd_applicable) {
+		_convolve_winograd(p_data);
+		return;
+	}
+
+	// Rough flop counts. A complex FFT of size n is ~5 n log2(n), and the FFT path does
+	// one per filter slice (for the whole batch if the spectra fit in memory, otherwise for every input),
+	// then one per input channel, and an inverse one per filter for every input.
+	const Size3i input_size = p_data->input_size;
+	const int channels = input_size.z;
+	const int filter_count = p_data->filter_count;
+
+	real_t direct_cost = real_t(2) * p_data->batch_size * p_data->output_size.x * p_data->output_size.y *
+			channels * p_data->filter_size.x * p_data->filter_size.y * filter_count;
+
+	int fft_n = MLPPTransforms::fft_good_size(input_size.x + 2 * p_data->padding) * MLPPTransforms::fft_good_size(input_size.y + 2 * p_data->padding);
+	int filter_spectra_passes = _fft_filter_spectra_shared(p_data, fft_n) ? 1 : p_data->batch_size;
+
+	real_t fft_count = real_t(p_data->batch_size) * (channels + filter_count) + real_t(filter_spectra_passes) * channels * filter_count;
+	real_t fft_cost = fft_count * 5 * fft_n * Math::log2(real_t(fft_n)) + real_t(8) * p_data->batch_size * channels * filter_count * fft_n;
+
+	// The input spectra, the accumulator, and one filter spectrum.
+	int64_t fft_working_set = int64_t(2) * fft_n * (channels + 2);
+
+	if (fft_cost < direct_cost && fft_working_set <= FFT_WORKING_SET_MAX_SIZE) {
+		_convolve_fft(p_data);
+	} else {
+		_convolve_im2col(p_data);
+	}
+}
+
+void MLPPConvolutions::_convolve_im2col(ConvolutionData *p_data) {
+	int pixel_count = p_data->output_size.x * p_data->output_size.y;
+
+	p_data->tiles_per_output = (pixel_count + CONVOLUTION_TILE_SIZE - 1) / CONVOLUTION_TILE_SIZE;
+
+	int tile_count = p_data->tiles_per_output * p_data->batch_size;
+	int tile_work = p_data->input_size.z * p_data->filter_size.x * p_data->filter_size.y * p_data->filter_count * CONVOLUTION_TILE_SIZE;
+
+	MLPPParallel::do_work(tile_count, this, &MLPPConvolutions::_convolve_im2col_range, p_data, 1 + 65536 / MAX(tile_work, 1));
+}
+
+void MLPPConvolutions::_convolve_im2col_range(int p_from, int p_to, ConvolutionData *p_data) {
+	const Size3i input_size = p_data->input_size;
+	const Size2i filter_size = p_data->filter_size;
+	const Size2i output_size = p_data->output_size;
+	const int S = p_data->stride;
+	const int P = p_data->padding;
+	const int filter_count = p_data->filter_count;
+	const BorderMode border_mode = p_data->border_mode;
+
+	const int input_slice_size = input_size.x * input_size.y;
+	const int pixel_count = output_size.x * output_size.y;
+	// Rows of the im2col matrix, this is also the length of one filter.
+	const int K = input_size.z * filter_size.x * filter_size.y;
+
+	Vector<real_t> columns;
+	columns.resize(K * CONVOLUTION_TILE_SIZE);
+	real_t *columns_ptr = columns.ptrw();
+
+	for (int tile = p_from; tile < p_to; ++tile) {
+		int batch_index = tile / p_data->tiles_per_output;
+		int pixel_start = (tile % p_data->tiles_per_output) * CONVOLUTION_TILE_SIZE;
+		int tile_size = MIN(CONVOLUTION_TILE_SIZE, pixel_count - pixel_start);
+
+		const real_t *input_ptr = p_data->inputs[batch_index];
+		real_t *output_ptr = p_data->outputs[batch_index];
+
+		// im2col: row k of the tile holds input value k of the receptive field of every output pixel in the tile.
+		// The tile is walked one output row segment at a time, so the in bounds part of each segment
+		// can be copied without any checks, and only the border pixels go through _border_map().
+		int k = 0;
+		for (int c = 0; c < input_size.z; ++c) {
+			const real_t *input_slice_ptr = input_ptr + c * input_slice_size;
+
+			for (int fy = 0; fy < filter_size.y; ++fy) {
+				for (int fx = 0; fx < filter_size.x; ++fx) {
+					real_t *column_row = columns_ptr + k * CONVOLUTION_TILE_SIZE;
+
+					// Output columns where ox * S - P + fx is inside the input.
+					int interior_start = fx >= P ? 0 : (P - fx + S - 1) / S;
+					int interior_end = input_size.x - 1 + P - fx >= 0 ? (input_size.x - 1 + P - fx) / S + 1 : 0;
+					interior_start = MIN(interior_start, output_size.x);
+					interior_end = CLAMP(interior_end, interior_start, output_size.x);
+
+					int oy = pixel_start / output_size.x;
+					int ox = pixel_start % output_size.x;
+					int j = 0;
+
+					while (j < tile_size) {
+						int segment_end = MIN(output_size.x, ox + tile_size - j);
+						int iy = _border_map(oy * S - P + fy, input_size.y, border_mode);
+
+						if (iy < 0) {
+							for (; ox < segment_end; ++ox) {
+								column_row[j++] = 0;
+							}
+						} else {
+							const real_t *input_row = input_slice_ptr + iy * input_size.x;
+
+							int i_start = CLAMP(interior_start, ox, segment_end);
+							int i_end = CLAMP(interior_end, i_start, segment_end);
+
+							for (; ox < i_start && ox < segment_end; ++ox) {
+								int ix = _border_map(ox * S - P + fx, input_size.x, border_mode);
+								column_row[j++] = ix < 0 ? 0 : input_row[ix];
+							}
+
+							if (ox < i_end) {
+								const real_t *src = input_row + ox * S - P + fx;
+								int count = i_end - ox;
+
+								if (S == 1) {
+									for (int t = 0; t < count; ++t) {
+										column_row[j + t] = src[t];
+									}
+								} else {
+									for (int t = 0; t < count; ++t) {
+										column_row[j + t] = src[t * S];
+									}
+								}
+
+								j += count;
+								ox = i_end;
+							}
+
+							for (; ox < segment_end; ++ox) {
+								int ix = _border_map(ox * S - P + fx, input_size.x, border_mode);
+								column_row[j++] = ix < 0 ? 0 : input_row[ix];
+							}
+						}
+
+						ox = 0;
+						++oy;
+					}
+
+					++k;
+				}
+			}
+		}
+
+		// GEMM: output (filter_count x tile_size) = filter (filter_count x K) * columns (K x tile_size)
+		int f = 0;
+		for (; f + CONVOLUTION_FILTER_BLOCK <= filter_count; f += CONVOLUTION_FILTER_BLOCK) {
+			const real_t *w0 = p_data->filter + (f + 0) * K;
+			const real_t *w1 = p_data->filter + (f + 1) * K;
+			const real_t *w2 = p_data->filter + (f + 2) * K;
+			const real_t *w3 = p_data->filter + (f + 3) * K;
+
+			real_t *o0 = output_ptr + (f + 0) * pixel_count + pixel_start;
+			real_t *o1 = output_ptr + (f + 1) * pixel_count + pixel_start;
+			real_t *o2 = output_ptr + (f + 2) * pixel_count + pixel_start;
+			real_t *o3 = output_ptr + (f + 3) * pixel_count + pixel_start;
+
+			for (int j = 0; j < tile_size; ++j) {
+				o0[j] = 0;
+				o1[j] = 0;
+				o2[j] = 0;
+				o3[j] = 0;
+			}
+
+			for (int kk = 0; kk < K; ++kk) {
+				const real_t *column_row = columns_ptr + kk * CONVOLUTION_TILE_SIZE;
+
+				real_t a0 = w0[kk];
+				real_t a1 = w1[kk];
+				real_t a2 = w2[kk];
+				real_t a3 = w3[kk];
+
+				for (int j = 0; j < tile_size; ++j) {
+					real_t v = column_row[j];
+
+					o0[j] += a0 * v;
+					o1[j] += a1 * v;
+					o2[j] += a2 * v;
+					o3[j] += a3 * v;
+				}
+			}
+		}
+
+		for (; f < filter_count; ++f) {
+			const real_t *w = p_data->filter + f * K;
+			real_t *o = output_ptr + f * pixel_count + pixel_start;
+
+			for (int j = 0; j < tile_size; ++j) {
+				o[j] = 0;
+			}
+
+			for (int kk = 0; kk < K; ++kk) {
+				real_t a = w[kk];
+
+				if (a == 0) {
+					continue;
+				}
+
+				const real_t *column_row = columns_ptr + kk * CONVOLUTION_TILE_SIZE;
+
+				for (int j = 0; j < tile_size; ++j) {
+					o[j] += a * column_row[j];
+				}
+			}
+		}
+	}
+}
+
+// Output tiles processed together in one Winograd work unit.
+static const int WINOGRAD_TILE_BLOCK = 32;
+
+void MLPPConvolutions::_convolve_winograd(ConvolutionData *p_data) {
+	const int channels = p_data->input_size.z;
+	const int filter_count = p_data->filter_count;
+
+	// U = G * g * G^T for every filter and channel, stored as 16 (filter_count x channels) matrices,
+	// so the elementwise products of the transformed tiles turn into 16 small GEMMs.
+	// G = [ 1 0 0 ; 1/2 1/2 1/2 ; 1/2 -1/2 1/2 ; 0 0 1 ]
+	Vector<real_t> winograd_filter;
+	winograd_filter.resize(16 * filter_count * channels);
+	real_t *u_ptr = winograd_filter.ptrw();
+
+	for (int f = 0; f < filter_count; ++f) {
+		for (int c = 0; c < channels; ++c) {
+			const real_t *g = p_data->filter + (f * channels + c) * 9;
+
+			// tmp = G * g (4x3)
+			real_t tmp[4][3];
+			for (int j = 0; j < 3; ++j) {
+				real_t g0 = g[0 * 3 + j];
+				real_t g1 = g[1 * 3 + j];
+				real_t g2 = g[2 * 3 + j];
+
+				tmp[0][j] = g0;
+				tmp[1][j] = (g0 + g1 + g2) * real_t(0.5);
+				tmp[2][j] = (g0 - g1 + g2) * real_t(0.5);
+				tmp[3][j] = g2;
+			}
+
+			// U = tmp * G^T (4x4)
+			for (int i = 0; i < 4; ++i) {
+				real_t u[4];
+				u[0] = tmp[i][0];
+				u[1] = (tmp[i][0] + tmp[i][1] + tmp[i][2]) * real_t(0.5);
+				u[2] = (tmp[i][0] - tmp[i][1] + tmp[i][2]) * real_t(0.5);
+				u[3] = tmp[i][2];
+
+				for (int j = 0; j < 4; ++j) {
+					u_ptr[((i * 4 + j) * filter_count + f) * channels + c] = u[j];
+				}
+			}
+		}
+	}
+
+	p_data->winograd_filter = u_ptr;
+	p_data->winograd_tiles = Size2i((p_data->output_size.x + 1) / 2, (p_data->output_size.y + 1) / 2);
+
+	int tiles = p_data->winograd_tiles.x * p_data->winograd_tiles.y;
+	p_data->tiles_per_output = (tiles + WINOGRAD_TILE_BLOCK - 1) / WINOGRAD_TILE_BLOCK;
+
+	int block_count = p_data->tiles_per_output * p_data->batch_size;
+	int block_work = 16 * channels * filter_count * WINOGRAD_TILE_BLOCK;
+
+	MLPPParallel::do_work(block_count, this, &MLPPConvolutions::_convolve_winograd_range, p_data, 1 + 65536 / MAX(block_work, 1));
+}
+
+void MLPPConvolutions::_convolve_winograd_range(int p_from, int p_to, ConvolutionData *p_data) {
+	const Size3i input_size = p_data->input_size;
+	const Size2i output_size = p_data->output_size;
+	const Size2i tiles_size = p_data->winograd_tiles;
+	const int P = p_data->padding;
+	const int channels = input_size.z;
+	const int filter_count = p_data->filter_count;
+	const int tile_count = tiles_size.x * tiles_size.y;
+	const int input_slice_size = input_size.x * input_size.y;
+	const int output_slice_size = output_size.x * output_size.y;
+
+	// V: 16 x channels x WINOGRAD_TILE_BLOCK, M: 16 x filter_count x WINOGRAD_TILE_BLOCK
+	Vector<real_t> v;
+	v.resize(16 * channels * WINOGRAD_TILE_BLOCK);
+	real_t *v_ptr = v.ptrw();
+
+	Vector<real_t> m;
+	m.resize(16 * filter_count * WINOGRAD_TILE_BLOCK);
+	real_t *m_ptr = m.ptrw();
+
+	for (int block = p_from; block < p_to; ++block) {
+		int batch_index = block / p_data->tiles_per_output;
+		int tile_start = (block % p_data->tiles_per_output) * WINOGRAD_TILE_BLOCK;
+		int block_size = MIN(WINOGRAD_TILE_BLOCK, tile_count - tile_start);
+
+		const real_t *input_ptr = p_data->inputs[batch_index];
+		real_t *output_ptr = p_data->outputs[batch_index];
+
+		// Input transform: V = B^T * d * B for every 4x4 input tile (stride 2).
+		// B^T = [ 1 0 -1 0 ; 0 1 1 0 ; 0 -1 1 0 ; 0 1 0 -1 ]
+		for (int t = 0; t < block_size; ++t) {
+			int tile = tile_start + t;
+			int iy0 = (tile / tiles_size.x) * 2 - P;
+			int ix0 = (tile % tiles_size.x) * 2 - P;
+
+			bool interior = iy0 >= 0 && ix0 >= 0 && iy0 + 4 <= input_size.y && ix0 + 4 <= input_size.x;
+
+			for (int c = 0; c < channels; ++c) {
+				const real_t *input_slice_ptr = input_ptr + c * input_slice_size;
+
+				real_t d[4][4];
+
+				if (interior) {
+					for (int i = 0; i < 4; ++i) {
+						const real_t *row = input_slice_ptr + (iy0 + i) * input_size.x + ix0;
+
+						d[i][0] = row[0];
+						d[i][1] = row[1];
+						d[i][2] = row[2];
+						d[i][3] = row[3];
+					}
+				} else {
+					for (int i = 0; i < 4; ++i) {
+						int iy = _border_map(iy0 + i, input_size.y, p_data->border_mode);
+
+						for (int j = 0; j < 4; ++j) {
+							int ix = _border_map(ix0 + j, input_size.x, p_data->border_mode);
+
+							d[i][j] = iy < 0 || ix < 0 ? 0 : input_slice_ptr[iy * input_size.x + ix];
+						}
+					}
+				}
+
+				real_t tmp[4][4];
+				for (int j = 0; j < 4; ++j) {
+					tmp[0][j] = d[0][j] - d[2][j];
+					tmp[1][j] = d[1][j] + d[2][j];
+					tmp[2][j] = d[2][j] - d[1][j];
+					tmp[3][j] = d[1][j] - d[3][j];
+				}
+
+				for (int i = 0; i < 4; ++i) {
+					real_t *vi = v_ptr + ((i * 4) * channels + c) * WINOGRAD_TILE_BLOCK + t;
+					const int xi_stride = channels * WINOGRAD_TILE_BLOCK;
+
+					vi[0 * xi_stride] = tmp[i][0] - tmp[i][2];
+					vi[1 * xi_stride] = tmp[i][1] + tmp[i][2];
+					vi[2 * xi_stride] = tmp[i][2] - tmp[i][1];
+					vi[3 * xi_stride] = tmp[i][1] - tmp[i][3];
+				}
+			}
+		}
+
+		// M[xi] (filter_count x block_size) = U[xi] (filter_count x channels) * V[xi] (channels x block_size)
+		for (int xi = 0; xi < 16; ++xi) {
+			const real_t *u_xi = p_data->winograd_filter + xi * filter_count * channels;
+			const real_t *v_xi = v_ptr + xi * channels * WINOGRAD_TILE_BLOCK;
+			real_t *m_xi = m_ptr + xi * filter_count * WINOGRAD_TILE_BLOCK;
+
+			for (int f = 0; f < filter_count; ++f) {
+				const real_t *u_row = u_xi + f * channels;
+				real_t *m_row = m_xi + f * WINOGRAD_TILE_BLOCK;
+
+				for (int t = 0; t < block_size; ++t) {
+					m_row[t] = 0;
+				}
+
+				for (int c = 0; c < channels; ++c) {
+					real_t a = u_row[c];
+					const real_t *v_row = v_xi + c * WINOGRAD_TILE_BLOCK;
+
+					for (int t = 0; t < block_size; ++t) {
+						m_row[t] += a * v_row[t];
+					}
+				}
+			}
+		}
+
+		// Output transform: Y = A^T * M * A, A^T = [ 1 1 1 0 ; 0 1 -1 -1 ]
+		for (int f = 0; f < filter_count; ++f) {
+			real_t *output_slice_ptr = output_ptr + f * output_slice_size;
+
+			for (int t = 0; t < block_size; ++t) {
+				real_t mt[4][4];
+
+				for (int xi = 0; xi < 16; ++xi) {
+					mt[xi / 4][xi % 4] = m_ptr[(xi * filter_count + f) * WINOGRAD_TILE_BLOCK + t];
+				}
+
+				real_t tmp[2][4];
+				for (int j = 0; j < 4; ++j) {
+					tmp[0][j] = mt[0][j] + mt[1][j] + mt[2][j];
+					tmp[1][j] = mt[1][j] - mt[2][j] - mt[3][j];
+				}
+
+				int tile = tile_start + t;
+				int oy0 = (tile / tiles_size.x) * 2;
+				int ox0 = (tile % tiles_size.x) * 2;
+
+				for (int i = 0; i < 2; ++i) {
+					int oy = oy0 + i;
+
+					if (oy >= output_size.y) {
+						break;
+					}
+
+					real_t *out_row = output_slice_ptr + oy * output_size.x;
+
+					out_row[ox0] = tmp[i][0] + tmp[i][1] + tmp[i][2];
+
+					if (ox0 + 1 < output_size.x) {
+						out_row[ox0 + 1] = tmp[i][1] - tmp[i][2] - tmp[i][3];
+					}
+				}
+			}
+		}
+	}
+}
+
+// Cross-correlation with the FFT: the padded input and the filter are zero extended to a size
+// that is large enough so the circular wrap around never reaches a valid output, then
+// out_f = IFFT(sum_c FFT(input_c) * conj(FFT(filter_f_c))). Strides just sample the full result.
+void MLPPConvolutions::_convolve_fft(ConvolutionData *p_data) {
+	const Size3i input_size = p_data->input_size;
+	const Size2i filter_size = p_data->filter_size;
+	const Size2i output_size = p_data->output_size;
+	const int S = p_data->stride;
+	const int P = p_data->padding;
+	const int channels = input_size.z;
+	const int filter_count = p_data->filter_count;
+
+	const Size2i fft_size = Size2i(MLPPTransforms::fft_good_size(input_size.x + 2 * P), MLPPTransforms::fft_good_size(input_size.y + 2 * P));
+	const int n = fft_size.x * fft_size.y;
+	const int input_slice_size = input_size.x * input_size.y;
+	const int filter_slice_size = filter_size.x * filter_size.y;
+	const int output_slice_size = output_size.x * output_size.y;
+
+	Vector<real_t> input_spectra;
+	input_spectra.resize(2 * n * channels);
+	real_t *input_spectra_ptr = input_spectra.ptrw();
+
+	// The filter spectra only depend on the filter, so with more than one input they are computed once for the whole batch,
+	// as long as they fit. Otherwise every filter spectrum is computed right before it is used, into one buffer.
+	const bool spectra_shared = _fft_filter_spectra_shared(p_data, n);
+
+	Vector<real_t> filter_spectra;
+	filter_spectra.resize(spectra_shared ? 2 * n * filter_count * channels : 2 * n);
+	real_t *filter_spectra_ptr = filter_spectra.ptrw();
+
+	if (spectra_shared) {
+		for (int i = 0; i < filter_count * channels; ++i) {
+			_fft_filter_spectrum(p_data->filter + i * filter_slice_size, filter_size, fft_size, filter_spectra_ptr + 2 * n * i);
+		}
+	}
+
+	Vector<real_t> acc;
+	acc.resize(2 * n);
+	real_t *acc_ptr = acc.ptrw();
+
+	for (int b = 0; b < p_data->batch_size; ++b) {
+		const real_t *input_ptr = p_data->inputs[b];
+		real_t *output_ptr = p_data->outputs[b];
+
+		for (int c = 0; c < channels; ++c) {
+			real_t *spectrum = input_spectra_ptr + 2 * n * c;
+			const real_t *input_slice_ptr = input_ptr + c * input_slice_size;
+
+			memset(spectrum, 0, sizeof(real_t) * 2 * n);
+
+			// The padded input is built right in the transform buffer.
+			for (int i = 0; i < input_size.y + 2 * P; ++i) {
+				int y = _border_map(i - P, input_size.y, p_data->border_mode);
+
+				if (y < 0) {
+					continue;
+				}
+
+				real_t *row = spectrum + 2 * i * fft_size.x;
+				const real_t *input_row = input_slice_ptr + y * input_size.x;
+
+				for (int j = 0; j < input_size.x + 2 * P; ++j) {
+					int x = j >= P && j < input_size.x + P ? j - P : _border_map(j - P, input_size.x, p_data->border_mode);
+
+					if (x >= 0) {
+						row[2 * j] = input_row[x];
+					}
+				}
+			}
+
+			_transforms.fft_2d_complex(spectrum, fft_size, false);
+		}
+
+		for (int f = 0; f < filter_count; ++f) {
+			memset(acc_ptr, 0, sizeof(real_t) * 2 * n);
+
+			for (int c = 0; c < channels; ++c) {
+				const real_t *x = input_spectra_ptr + 2 * n * c;
+				const real_t *h;
+
+				if (spectra_shared) {
+					h = filter_spectra_ptr + 2 * n * (f * channels + c);
+				} else {
+					_fft_filter_spectrum(p_data->filter + (f * channels + c) * filter_slice_size, filter_size, fft_size, filter_spectra_ptr);
+					h = filter_spectra_ptr;
+				}
+
+				// acc += x * conj(h)
+				for (int i = 0; i < n; ++i) {
+					real_t xr = x[2 * i];
+					real_t xi = x[2 * i + 1];
+					real_t hr = h[2 * i];
+					real_t hi = h[2 * i + 1];
+
+					acc_ptr[2 * i] += xr * hr + xi * hi;
+					acc_ptr[2 * i + 1] += xi * hr - xr * hi;
+				}
+			}
+
+			_transforms.fft_2d_complex(acc_ptr, fft_size, true);
+
+			real_t *output_slice_ptr = output_ptr + f * output_slice_size;
+
+			for (int i = 0; i < output_size.y; ++i) {
+				const real_t *acc_row = acc_ptr + 2 * (i * S) * fft_size.x;
+				real_t *output_row = output_slice_ptr + i * output_size.x;
+
+				for (int j = 0; j < output_size.x; ++j) {
+					output_row[j] = acc_row[2 * j * S];
+				}
+			}
+		}
+	}
+}
+
+bool MLPPConvolutions::_fft_filter_spectra_shared(const ConvolutionData *p_data, const int p_fft_n) {
+	return p_data->batch_size > 1 && int64_t(2) * p_fft_n * p_data->filter_count * p_data->input_size.z <= FFT_FILTER_SPECTRA_MAX_SIZE;
+}
+
+void MLPPConvolutions::_fft_filter_spectrum(const real_t *p_filter_slice, const Size2i &p_filter_size, const Size2i &p_fft_size, real_t *r_spectrum) {
+	memset(r_spectrum, 0, sizeof(real_t) * 2 * p_fft_size.x * p_fft_size.y);
+
+	for (int y = 0; y < p_filter_size.y; ++y) {
+		real_t *row = r_spectrum + 2 * y * p_fft_size.x;
+		const real_t *filter_row = p_filter_slice + y * p_filter_size.x;
+
+		for (int x = 0; x < p_filter_size.x; ++x) {
+			row[2 * x] = filter_row[x];
+		}
+	}
+
+	_transforms.fft_2d_complex(r_spectrum, p_fft_size, false);
+}
+
+bool MLPPConvolutions::_separable_filter_decompose(const real_t *p_filter, const Size2i &p_filter_size, real_t *r_vertical, real_t *r_horizontal, const real_t p_tolerance) {
+	int filter_data_size = p_filter_size.x * p_filter_size.y;
+
+	// A rank 1 matrix is the outer product of any of its nonzero columns and rows,
+	// so the ones through the largest element are used, then the reconstruction is checked.
+	int pivot = 0;
+	real_t pivot_abs = 0;
+
+	for (int i = 0; i < filter_data_size; ++i) {
+		real_t a = ABS(p_filter[i]);
+
+		if (a > pivot_abs) {
+			pivot_abs = a;
+			pivot = i;
+		}
+	}
+
+	if (pivot_abs == 0) {
+		return false;
+	}
+
+	int pivot_y = pivot / p_filter_size.x;
+	int pivot_x = pivot % p_filter_size.x;
+	real_t pivot_inv = 1 / p_filter[pivot];
+
+	for (int i = 0; i < p_filter_size.y; ++i) {
+		r_vertical[i] = p_filter[i * p_filter_size.x + pivot_x];
+	}
+
+	for (int j = 0; j < p_filter_size.x; ++j) {
+		r_horizontal[j] = p_filter[pivot_y * p_filter_size.x + j] * pivot_inv;
+	}
+
+	real_t max_error = p_tolerance * pivot_abs;
+
+	for (int i = 0; i < p_filter_size.y; ++i) {
+		for (int j = 0; j < p_filter_size.x; ++j) {
+			if (ABS(p_filter[i * p_filter_size.x + j] - r_vertical[i] * r_horizontal[j]) > max_error) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool MLPPConvolutions::_separable_filter_decompose_cached(const real_t *p_filter, const Size2i &p_filter_size, Vector<real_t> &r_vertical, Vector<real_t> &r_horizontal) {
+	MutexLock lock(_separable_cache_mutex);
+
+	SeparableCache &cache = _separable_cache;
+	int filter_data_size = p_filter_size.x * p_filter_size.y;
+
+	bool hit = cache.filter_size == p_filter_size;
+
+	if (hit) {
+		const real_t *cached_filter = cache.filter.ptr();
+
+		for (int i = 0; i < filter_data_size; ++i) {
+			if (cached_filter[i] != p_filter[i]) {
+				hit = false;
+				break;
+			}
+		}
+	}
+
+	if (!hit) {
+		cache.filter_size = p_filter_size;
+		cache.filter.resize(filter_data_size);
+		memcpy(cache.filter.ptrw(), p_filter, sizeof(real_t) * filter_data_size);
+
+		cache.vertical.resize(p_filter_size.y);
+		cache.horizontal.resize(p_filter_size.x);
+
+		cache.separable = _separable_filter_decompose(p_filter, p_filter_size, cache.vertical.ptrw(), cache.horizontal.ptrw(), CMP_EPSILON);
+	}
+
+	// Copy on write, the caller keeps its factors even if another thread replaces the cached filter.
+	r_vertical = cache.vertical;
+	r_horizontal = cache.horizontal;
+
+	return cache.separable;
+}
+
+void MLPPConvolutions::_convolve_separable(ConvolutionData *p_data) {
+	const int row_count = p_data->batch_size * p_data->input_size.y;
+
+	// Row pass result: input_size.y x output_size.x per input.
+	Vector<real_t> tmp;
+	tmp.resize(row_count * p_data->output_size.x);
+	p_data->separable_tmp = tmp.ptrw();
+
+	int row_work = p_data->output_size.x * p_data->filter_size.x;
+	MLPPParallel::do_work(row_count, this, &MLPPConvolutions::_convolve_separable_rows_range, p_data, 1 + 65536 / MAX(row_work, 1));
+
+	int column_work = p_data->output_size.x * p_data->filter_size.y;
+	MLPPParallel::do_work(p_data->batch_size * p_data->output_size.y, this, &MLPPConvolutions::_convolve_separable_columns_range, p_data, 1 + 65536 / MAX(column_work, 1));
+
+	p_data->separable_tmp = NULL;
+}
+
+void MLPPConvolutions::_convolve_separable_rows_range(int p_from, int p_to, ConvolutionData *p_data) {
+	const Size3i input_size = p_data->input_size;
+	const int output_width = p_data->output_size.x;
+	const int fw = p_data->filter_size.x;
+	const int S = p_data->stride;
+	const int P = p_data->padding;
+	const real_t *h = p_data->separable_horizontal;
+
+	// Output columns whose whole window is inside the row. Only the ones outside need bounds checks.
+	int interior_start = MIN((P + S - 1) / S, output_width);
+	int interior_end = input_size.x - fw + P >= 0 ? MIN((input_size.x - fw + P) / S + 1, output_width) : interior_start;
+	interior_end = MAX(interior_end, interior_start);
+
+	for (int r = p_from; r < p_to; ++r) {
+		int batch_index = r / input_size.y;
+		int y = r % input_size.y;
+
+		const real_t *input_row = p_data->inputs[batch_index] + y * input_size.x;
+		real_t *tmp_row = p_data->separable_tmp + r * output_width;
+
+		for (int ox = 0; ox < output_width; ++ox) {
+			if (ox == interior_start) {
+				ox = interior_end;
+
+				if (ox >= output_width) {
+					break;
+				}
+			}
+
+			int x0 = ox * S - P;
+			real_t sum = 0;
+
+			for (int l = 0; l < fw; ++l) {
+				int x = _border_map(x0 + l, input_size.x, p_data->border_mode);
+
+				if (x >= 0) {
+					sum += input_row[x] * h[l];
+				}
+			}
+
+			tmp_row[ox] = sum;
+		}
+
+		if (interior_start == interior_end) {
+			continue;
+		}
+
+		real_t *tmp_interior = tmp_row + interior_start;
+		int interior_count = interior_end - interior_start;
+
+		for (int ox = 0; ox < interior_count; ++ox) {
+			tmp_interior[ox] = 0;
+		}
+
+		if (S == 1) {
+			// Contiguous axpy per tap, vectorizes well.
+			for (int l = 0; l < fw; ++l) {
+				const real_t *src = input_row + interior_start - P + l;
+				real_t hl = h[l];
+
+				for (int ox = 0; ox < interior_count; ++ox) {
+					tmp_interior[ox] += hl * src[ox];
+				}
+			}
+		} else {
+			for (int ox = 0; ox < interior_count; ++ox) {
+				const real_t *src = input_row + (interior_start + ox) * S - P;
+				real_t sum = 0;
+
+				for (int l = 0; l < fw; ++l) {
+					sum += h[l] * src[l];
+				}
+
+				tmp_interior[ox] = sum;
+			}
+		}
+	}
+}
+
+void MLPPConvolutions::_convolve_separable_columns_range(int p_from, int p_to, ConvolutionData *p_data) {
+	const Size3i input_size = p_data->input_size;
+	const Size2i output_size = p_data->output_size;
+	const int fh = p_data->filter_size.y;
+	const int S = p_data->stride;
+	const int P = p_data->padding;
+	const real_t *v = p_data->separable_vertical;
+
+	for (int r = p_from; r < p_to; ++r) {
+		int batch_index = r / output_size.y;
+		int oy = r % output_size.y;
+
+		const real_t *tmp = p_data->separable_tmp + batch_index * input_size.y * output_size.x;
+		real_t *output_row = p_data->outputs[batch_index] + oy * output_size.x;
+
+		for (int ox = 0; ox < output_size.x; ++ox) {
+			output_row[ox] = 0;
+		}
+
+		int y0 = oy * S - P;
+
+		// The row pass was done on input rows only, rows outside map back to one of them (or are skipped for zero padding).
+		for (int k = 0; k < fh; ++k) {
+			int y = _border_map(y0 + k, input_size.y, p_data->border_mode);
+
+			if (y < 0) {
+				continue;
+			}
+
+			const real_t *tmp_row = tmp + y * output_size.x;
+			real_t vk = v[k];
+
+			for (int ox = 0; ox < output_size.x; ++ox) {
+				output_row[ox] += vk * tmp_row[ox];
+			}
+		}
+	}
+}
+
+MLPPConvolutions::ConvolutionAlgorithm MLPPConvolutions::get_convolution_algorithm() const {
+	return _convolution_algorithm;
+}
+void MLPPConvolutions::set_convolution_algorithm(const ConvolutionAlgorithm p_algorithm) {
+	_convolution_algorithm = p_algorithm;
+}
+
+MLPPConvolutions::BorderMode MLPPConvolutions::get_border_mode() const {
+	return _border_mode;
+}
+void MLPPConvolutions::set_border_mode(const BorderMode p_mode) {
+	_border_mode = p_mode;
+}
+
+Ref<MLPPMatrix> MLPPConvolutions::get_prewitt_horizontal() const {
+	return _prewitt_horizontal;
+}
+Ref<MLPPMatrix> MLPPConvolutions::get_prewitt_vertical() const {
+	return _prewitt_vertical;
+}
+Ref<MLPPMatrix> MLPPConvolutions::get_sobel_horizontal() const {
+	return _sobel_horizontal;
+}
+Ref<MLPPMatrix> MLPPConvolutions::get_sobel_vertical() const {
+	return _sobel_vertical;
+}
+Ref<MLPPMatrix> MLPPConvolutions::get_scharr_horizontal() const {
+	return _scharr_horizontal;
+}
+Ref<MLPPMatrix> MLPPConvolutions::get_scharr_vertical() const {
+	return _scharr_vertical;
+}
+Ref<MLPPMatrix> MLPPConvolutions::get_roberts_horizontal() const {
+	return _roberts_horizontal;
+}
+Ref<MLPPMatrix> MLPPConvolutions::get_roberts_vertical() const {
+	return _roberts_vertical;
+}
+
+MLPPConvolutions::MLPPConvolutions() {
+	_convolution_algorithm = CONVOLUTION_ALGORITHM_AUTO;
+	_border_mode = BORDER_MODE_ZERO;
+
+	_separable_cache.separable = false;
+
 	const real_t prewitt_horizontal_arr[]{
 		1, 1, 1, //
 		0, 0, 0, //
@@ -40,11 +40,13 @@
 #include "core/math/math_defs.h"
 
 #include "core/object/reference.h"
+#include "core/os/mutex.h"
 #endif
 
 #include "../core/mlpp_matrix.h"
 #include "../core/mlpp_tensor3.h"
 #include "../core/mlpp_vector.h"
+#include "../core/transforms.h"
 
 
 
@@ -58,28 +60,104 @@ public:
 		POOL_TYPE_MAX,
 	};
 
+	enum ConvolutionAlgorithm {
+		// Separable if the filter is separable (single channel, single filter only), then Winograd for 3x3 filters with stride 1,
+		// otherwise FFT if its estimated cost is lower, im2col if not.
+		// The separability check of the last filter is cached. Callers that already have the 1D factors can use convolve_2d_separable().
+		CONVOLUTION_ALGORITHM_AUTO = 0,
+		CONVOLUTION_ALGORITHM_IM2COL,
+		// Winograd F(2x2, 3x3). Falls back to im2col if the filter is not 3x3, or the stride is not 1.
+		CONVOLUTION_ALGORITHM_WINOGRAD,
+		// Pointwise products of 2D FFTs. Worth it for large filters.
+		CONVOLUTION_ALGORITHM_FFT,
+		// A row pass and a column pass with the 1D factors of a rank 1 filter. Only for single channel, single filter
+		// convolutions, falls back to im2col if the filter is not separable.
+		CONVOLUTION_ALGORITHM_SEPARABLE,
+	};
+
+	ConvolutionAlgorithm get_convolution_algorithm() const;
+	void set_convolution_algorithm(const ConvolutionAlgorithm p_algorithm);
+
+	// What the P pixels of padding around the input contain, for both convolution and pooling.
+	// The padding is never materialized, the kernels map the out of bounds coordinates back into the input.
+	enum BorderMode {
+		BORDER_MODE_ZERO = 0,
+		// aaa|abcd|ddd
+		BORDER_MODE_REPLICATE,
+		// dcb|abcd|cba
+		BORDER_MODE_REFLECT,
+		// bcd|abcd|abc
+		BORDER_MODE_WRAP,
+	};
+
+	BorderMode get_border_mode() const;
+	void set_border_mode(const BorderMode p_mode);
+
+	// These are cross-correlations (the filter is not flipped), with stride S, and P pixels of padding on every side (see BorderMode).
+	// Neither the input nor the filter has to be square.
+	// They are lowered to a blocked GEMM (im2col), and computed in parallel over tiles of output pixels.
 	Ref<MLPPMatrix> convolve_2d(const Ref<MLPPMatrix> &input, const Ref<MLPPMatrix> &filter, const int S, const int P = 0);
+	// filter contains (filter z size / input z size) filters stacked along z, each with as many z slices as the input.
+	// The result has one z slice per filter.
 	Ref<MLPPTensor3> convolve_3d(const Ref<MLPPTensor3> &input, const Ref<MLPPTensor3> &filter, const int S, const int P = 0);
+	// Same as convolve_3d() for every input, but in one parallel pass. Every input has to have the same size.
+	Vector<Ref<MLPPTensor3>> convolve_3d_batch(const Vector<Ref<MLPPTensor3>> &inputs, const Ref<MLPPTensor3> &filter, const int S, const int P = 0);
+	// A batch without a tensor per image: inputs contains (inputs z size / channels) images stacked along z, each with channels z slices,
+	// the same way filter stacks the filters. The result stacks the feature maps of every image the same way, in one buffer.
+	// pool_3d() works on these as is, as it pools every z slice on its own.
+	Ref<MLPPTensor3> convolve_3d_stacked(const Ref<MLPPTensor3> &inputs, const int channels, const Ref<MLPPTensor3> &filter, const int S, const int P = 0);
+	// convolve_3d_stacked() on caller owned buffers. inputs holds batch_size images of input_size, filters holds filter_count
+	// filters of filter_size with input_size.z slices each, r_outputs has room for batch_size * filter_count output maps.
+	void convolve_3d_stacked_ptr(const real_t *inputs, const Size3i &input_size, const int batch_size, const real_t *filters, const Size2i &filter_size, const int filter_count, const int S, const int P, real_t *r_outputs);
+
+	// Same as convolve_2d() with the filter vertical * horizontalT, but in O(F) per pixel.
+	Ref<MLPPMatrix> convolve_2d_separable(const Ref<MLPPMatrix> &input, const Ref<MLPPVector> &vertical, const Ref<MLPPVector> &horizontal, const int S, const int P = 0);
 
-	Ref<MLPPMatrix> pool_2d(const Ref<MLPPMatrix> &input, const int F, const int S, const PoolType type);
-	Ref<MLPPTensor3> pool_3d(const Ref<MLPPTensor3> &input, const int F, const int S, const PoolType type);
+	// Checks whether filter is rank 1, and if so, sets r_vertical and r_horizontal so filter = r_vertical * r_horizontalT.
+	// tolerance is relative to the largest element of filter.
+	bool separable_filter_decompose(const Ref<MLPPMatrix> &filter, Ref<MLPPVector> r_vertical, Ref<MLPPVector> r_horizontal, const real_t tolerance = CMP_EPSILON);
+
+	// F x F windows, with stride S, and P pixels of padding on every side (see BorderMode).
+	Ref<MLPPMatrix> pool_2d(const Ref<MLPPMatrix> &input, const int F, const int S, const PoolType type, const int P = 0);
+	Ref<MLPPTensor3> pool_3d(const Ref<MLPPTensor3> &input, const int F, const int S, const PoolType type, const int P = 0);
 
 	real_t global_pool_2d(const Ref<MLPPMatrix> &input, const PoolType type);
 	Ref<MLPPVector> global_pool_3d(const Ref<MLPPTensor3> &input, const PoolType type);
 
 	real_t gaussian_2d(const real_t x, const real_t y, const real_t std);
+	// Centered on (size - 1) / 2, so even sizes are symmetric as well.
 	Ref<MLPPMatrix> gaussian_filter_2d(const int size, const real_t std);
+	// gaussian_filter_2d(size, std) == gaussian_filter_1d(size, std) * gaussian_filter_1d(size, std)T
+	Ref<MLPPVector> gaussian_filter_1d(const int size, const real_t std);
 
 	Ref<MLPPMatrix> dx(const Ref<MLPPMatrix> &input);
 	Ref<MLPPMatrix> dy(const Ref<MLPPMatrix> &input);
 
+	struct GradientResult {
+		Ref<MLPPMatrix> magnitude;
+		Ref<MLPPMatrix> orientation;
+	};
+
+	// These compute the dx() and dy() gradients on the fly, in one parallel pass.
 	Ref<MLPPMatrix> grad_magnitude(const Ref<MLPPMatrix> &input);
 	Ref<MLPPMatrix> grad_orientation(const Ref<MLPPMatrix> &input);
+	GradientResult grad_magnitude_orientation(const Ref<MLPPMatrix> &input);
 
+	// The structure tensor (xx, yy, xy), smoothed with a 3x3 gaussian.
 	Ref<MLPPTensor3> compute_m(const Ref<MLPPMatrix> &input);
 	Vector<Ref<MLPPMatrix>> compute_mv(const Ref<MLPPMatrix> &input);
 
-	//TODO better data srtucture for this. Maybe IntMatrix?
+	struct HarrisResult {
+		// det(M) - k * trace(M)^2 for every pixel
+		Ref<MLPPMatrix> response;
+		// x: column, y: row. Local maxima of response above the threshold.
+		Vector<Vector2i> keypoints;
+	};
+
+	// Gradients, structure tensor and response are computed in one fused pass, in parallel over rows.
+	HarrisResult harris_corners(const Ref<MLPPMatrix> &input, const real_t k = 0.05, const real_t threshold = 0);
+
+	// The sign of the harris_corners() response, C: corner (> 0), E: edge (< 0), N: flat.
 	Vector<Vector<CharType>> harris_corner_detection(const Ref<MLPPMatrix> &input);
 
 	Ref<MLPPMatrix> get_prewitt_horizontal() const;
@@ -94,8 +172,118 @@ public:
 	MLPPConvolutions();
 
 protected:
+	struct ConvolutionData {
+		// batch_size inputs of input_size (x: width, y: height, z: channels)
+		const real_t *const *inputs;
+		Size3i input_size;
+		// filter_count * input_size.z * filter_size.y * filter_size.x
+		const real_t *filter;
+		Size2i filter_size;
+		int filter_count;
+		int stride;
+		int padding;
+		BorderMode border_mode;
+		// batch_size outputs of filter_count * output_size.y * output_size.x
+		real_t *const *outputs;
+		Size2i output_size;
+		int batch_size;
+		int tiles_per_output;
+		// Winograd only: 2x2 output tiles per row and column, and the transformed filters (16 x filter_count x input_size.z).
+		Size2i winograd_tiles;
+		const real_t *winograd_filter;
+		// Separable only: the 1D factors (filter_size.y, filter_size.x long), and the row pass result per input.
+		const real_t *separable_vertical;
+		const real_t *separable_horizontal;
+		real_t *separable_tmp;
+	};
+
+	struct PoolData {
+		// slice_count slices of input_size, and of output_size
+		const real_t *input;
+		Size2i input_size;
+		real_t *output;
+		Size2i output_size;
+		int slice_count;
+		int size;
+		int stride;
+		int padding;
+		PoolType type;
+		BorderMode border_mode;
+	};
+
+	void _pool(PoolData *p_data);
+	void _pool_range(int p_from, int p_to, PoolData *p_data);
+	static real_t _global_pool_slice(const real_t *input, const int size, const PoolType type);
+	void _global_pool_range(int p_from, int p_to, PoolData *p_data);
+
+	struct GradientData {
+		const real_t *input;
+		Size2i size;
+		// Either can be NULL
+		real_t *magnitude;
+		real_t *orientation;
+	};
+
+	GradientResult _gradient(const Ref<MLPPMatrix> &input, const bool p_magnitude, const bool p_orientation);
+	void _gradient_range(int p_from, int p_to, GradientData *p_data);
+
+	enum {
+		HARRIS_GAUSSIAN_SIZE = 3,
+	};
+
+	struct HarrisData {
+		const real_t *input;
+		Size2i size;
+		real_t weights[HARRIS_GAUSSIAN_SIZE];
+		real_t k;
+		// The structure tensor (all 3 or none), and the response, any of them can be NULL.
+		real_t *xx;
+		real_t *yy;
+		real_t *xy;
+		real_t *response;
+	};
+
+	void _harris(const Ref<MLPPMatrix> &input, real_t *r_xx, real_t *r_yy, real_t *r_xy, real_t *r_response, const real_t k);
+	void _harris_range(int p_from, int p_to, HarrisData *p_data);
+
+	Size2i _convolution_output_size(const Size2i &p_input_size, const Size2i &p_filter_size, const int S, const int P) const;
+	void _convolve(ConvolutionData *p_data);
+	void _convolve_im2col(ConvolutionData *p_data);
+	void _convolve_im2col_range(int p_from, int p_to, ConvolutionData *p_data);
+	void _convolve_winograd(ConvolutionData *p_data);
+	void _convolve_winograd_range(int p_from, int p_to, ConvolutionData *p_data);
+	void _convolve_fft(ConvolutionData *p_data);
+	// Whether _convolve_fft() keeps the spectra of every filter for the whole batch, or recomputes them per input.
+	static bool _fft_filter_spectra_shared(const ConvolutionData *p_data, const int p_fft_n);
+	void _fft_filter_spectrum(const real_t *p_filter_slice, const Size2i &p_filter_size, const Size2i &p_fft_size, real_t *r_spectrum);
+	void _convolve_separable(ConvolutionData *p_data);
+	static bool _separable_filter_decompose(const real_t *p_filter, const Size2i &p_filter_size, real_t *r_vertical, real_t *r_horizontal, const real_t p_tolerance);
+	// separable_filter_decompose() through _separable_cache.
+	bool _separable_filter_decompose_cached(const real_t *p_filter, const Size2i &p_filter_size, Vector<real_t> &r_vertical, Vector<real_t> &r_horizontal);
+	void _convolve_separable_rows_range(int p_from, int p_to, ConvolutionData *p_data);
+	void _convolve_separable_columns_range(int p_from, int p_to, ConvolutionData *p_data);
+
 	static void _bind_methods();
 
+	ConvolutionAlgorithm _convolution_algorithm;
+	BorderMode _border_mode;
+
+	// Caches the FFT plans between calls. The cache is locked, so the FFT path stays reentrant.
+	MLPPTransforms _transforms;
+
+	// The last filter the AUTO / SEPARABLE paths checked, and its 1D factors, if it is separable.
+	// Convolving many inputs with the same filter only decomposes it once.
+	struct SeparableCache {
+		Vector<real_t> filter;
+		Size2i filter_size;
+		bool separable;
+		Vector<real_t> vertical;
+		Vector<real_t> horizontal;
+	};
+
+	SeparableCache _separable_cache;
+	Mutex _separable_cache_mutex;
+
 	Ref<MLPPMatrix> _prewitt_horizontal;
 	Ref<MLPPMatrix> _prewitt_vertical;
 	Ref<MLPPMatrix> _sobel_horizontal;
@@ -106,4 +294,6 @@ protected:
 	Ref<MLPPMatrix> _roberts_vertical;
 };
 
+VARIANT_ENUM_CAST(MLPPConvolutions::PoolType);
+
 #endif // Convolutions_hpp
\ No newline at end of file
@@ -890,11 +890,18 @@ MLPPData::WordsToVecResult MLPPData::word_to_vec(Vector<String> sentences, WordT
 	return res;
 }
 
-Ref<MLPPMatrix> MLPPData::lsa(Vector<String> sentences, int dim) {
+Ref<MLPPMatrix> MLPPData::lsa(Vector<String> sentences, int dim, bool randomized) {
 	MLPPLinAlg alg;
 
 	Ref<MLPPMatrix> doc_word_data = bag_of_words(sentences, BAG_OF_WORDS_TYPE_BINARY);
 
+	if (randomized) {
+		MLPPLinAlg::SVDResult svr_res = alg.randomized_svd(doc_word_data, dim);
+		ERR_FAIL_COND_V(!svr_res.Vt.is_valid(), Ref<MLPPMatrix>());
+
+		return svr_res.S->multn(svr_res.Vt);
+	}
+
 	MLPPLinAlg::SVDResult svr_res = alg.svd(doc_word_data);
 
 	Ref<MLPPMatrix> S_trunc = alg.zeromatnm(dim, dim);
@@ -172,7 +172,8 @@ public:
 
 	WordsToVecResult word_to_vec(Vector<String> sentences, WordToVecType type, int windowSize, int dimension, real_t learning_rate, int max_epoch);
 
-	Ref<MLPPMatrix> lsa(Vector<String> sentences, int dim);
+	// When randomized is true, only the top dim singular triplets are computed using MLPPLinAlg::randomized_svd.
+	Ref<MLPPMatrix> lsa(Vector<String> sentences, int dim, bool randomized = false);
 
 	Vector<String> create_word_list(Vector<String> sentences);
 
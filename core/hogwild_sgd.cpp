@@ -0,0 +1,167 @@
+/*************************************************************************/
+/*  hogwild_sgd.cpp                                                      */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "hogwild_sgd.h"
+
+#include "../core/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+struct MLPPHogwildSGDJob {
+	const real_t *input;
+	const real_t *output;
+	real_t *weights;
+	real_t *bias;
+	const int *order;
+	// Rows of the current epoch, the first ones of order.
+	int epoch_row_count;
+	int feature_count;
+	int worker_count;
+	MLPPHogwildSGD::Settings settings;
+
+	// d(cost) / dz for one sample.
+	_FORCE_INLINE_ real_t gradient_scale(const real_t z, const real_t y) const {
+		switch (settings.model_type) {
+			case MLPPHogwildSGD::MODEL_TYPE_LINEAR:
+				return z - y;
+			case MLPPHogwildSGD::MODEL_TYPE_LOGISTIC:
+				return 1 / (1 + Math::exp(-z)) - y;
+			case MLPPHogwildSGD::MODEL_TYPE_PROBIT:
+				return (0.5 * (1 + std::erf(z / Math::sqrt(2.0))) - y) * ((1 / Math::sqrt(2 * Math_PI)) * Math::exp(-z * z / 2));
+			case MLPPHogwildSGD::MODEL_TYPE_TANH: {
+				real_t y_hat = Math::tanh(z);
+				return (y_hat - y) * (1 - y_hat * y_hat);
+			}
+			case MLPPHogwildSGD::MODEL_TYPE_HINGE:
+				return (1 - y * z > 0) ? -y * settings.c : 0;
+		}
+
+		return 0;
+	}
+
+	void run_workers(int p_from, int p_to, void *p_userdata) {
+		for (int i = p_from; i < p_to; ++i) {
+			run_worker(i);
+		}
+	}
+
+	void run_worker(const int p_index) {
+		// Disjoint ranges of the shuffled order, no two workers visit the same row in an epoch.
+		int row_from;
+		int row_to;
+		MLPPParallel::range_get(epoch_row_count, worker_count, p_index, row_from, row_to);
+
+		const bool clip = settings.reg == MLPPReg::REGULARIZATION_TYPE_WEIGHT_CLIPPING;
+		const bool regularize = settings.reg != MLPPReg::REGULARIZATION_TYPE_NONE;
+
+		for (int i = row_from; i < row_to; ++i) {
+			int row = order[i];
+
+			const real_t *x = input + row * feature_count;
+
+			// Reads and writes of the shared weights are intentionally unsynchronized.
+			real_t z = *bias;
+			for (int j = 0; j < feature_count; ++j) {
+				z += weights[j] * x[j];
+			}
+
+			real_t step = settings.learning_rate * gradient_scale(z, output[row]);
+
+			for (int j = 0; j < feature_count; ++j) {
+				real_t xj = x[j];
+
+				if (xj == 0) {
+					continue;
+				}
+
+				real_t wj = weights[j] - step * xj;
+
+				if (clip) {
+					wj = MLPPReg::reg_deriv_termr(wj, settings.lambda, settings.alpha, settings.reg);
+				} else if (regularize) {
+					wj -= MLPPReg::reg_deriv_termr(wj, settings.lambda, settings.alpha, settings.reg);
+				}
+
+				weights[j] = wj;
+			}
+
+			*bias -= step;
+		}
+	}
+};
+
+void MLPPHogwildSGD::train(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_set, Ref<MLPPVector> r_weights, real_t *r_bias, const Settings &p_settings) {
+	ERR_FAIL_COND(!p_input_set.is_valid() || !p_output_set.is_valid() || !r_weights.is_valid());
+	ERR_FAIL_COND(!r_bias);
+
+	Size2i size = p_input_set->size();
+
+	ERR_FAIL_COND(p_output_set->size() != size.y);
+	ERR_FAIL_COND(r_weights->size() != size.x);
+	ERR_FAIL_COND(p_settings.worker_count < 1);
+
+	if (size.y == 0 || p_settings.iteration_count <= 0) {
+		return;
+	}
+
+	std::vector<int> order;
+	order.resize(size.y);
+
+	for (int i = 0; i < size.y; ++i) {
+		order[i] = i;
+	}
+
+	std::random_device rd;
+	std::default_random_engine generator(rd());
+
+	MLPPHogwildSGDJob job;
+	job.input = p_input_set->ptr();
+	job.output = p_output_set->ptr();
+	job.weights = r_weights->ptrw();
+	job.bias = r_bias;
+	job.order = order.data();
+	job.feature_count = size.x;
+	job.settings = p_settings;
+
+	// One epoch is one pass over the rows (the last one can be partial). The shared order is reshuffled
+	// on the calling thread between epochs, while no worker is running.
+	for (int remaining = p_settings.iteration_count; remaining > 0; remaining -= job.epoch_row_count) {
+		std::shuffle(order.begin(), order.end(), generator);
+
+		job.epoch_row_count = MIN(remaining, size.y);
+		// Every worker needs at least one row of its own.
+		job.worker_count = MIN(p_settings.worker_count, job.epoch_row_count);
+
+		MLPPParallel::do_work(job.worker_count, &job, &MLPPHogwildSGDJob::run_workers, (void *)NULL);
+	}
+}
@@ -0,0 +1,95 @@
+#ifndef MLPP_HOGWILD_SGD_H
+#define MLPP_HOGWILD_SGD_H
+
+/*************************************************************************/
+/*  hogwild_sgd.h                                                        */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifdef USING_SFW
+#include "sfw.h"
+#else
+#include "core/math/math_defs.h"
+#include "core/typedefs.h"
+#endif
+
+#include "../core/mlpp_matrix.h"
+#include "../core/mlpp_vector.h"
+
+#include "../core/reg.h"
+
+// Lock-free parallel SGD ("Hogwild!") for the single output models: y_hat = f(w * x + b).
+// Every epoch the row order is shuffled once, and split into disjoint ranges, one per worker. The workers update the
+// shared weights without locking.
+// Features that are 0 in a row are skipped, so on sparse data the workers rarely touch the same weights,
+// and the few racing updates that get lost do not hurt convergence.
+// With more than one worker the result depends on thread timing, so runs are not reproducible.
+// MLPPLinReg, MLPPLogReg, MLPPProbitReg, MLPPTanhReg and MLPPSVC train with it when their hogwild thread count is above 1.
+class MLPPHogwildSGD {
+public:
+	enum ModelType {
+		MODEL_TYPE_LINEAR = 0, // y_hat = z, MSE
+		MODEL_TYPE_LOGISTIC, // y_hat = sigmoid(z), log loss
+		MODEL_TYPE_PROBIT, // y_hat = gaussian_cdf(z), MSE
+		MODEL_TYPE_TANH, // y_hat = tanh(z), MSE
+		MODEL_TYPE_HINGE, // y_hat = sign(z), hinge loss scaled by c
+	};
+
+	struct Settings {
+		ModelType model_type;
+		real_t learning_rate;
+		// Number of single sample updates in total. Every epoch of up to one pass over the rows is split evenly between
+		// the workers.
+		int iteration_count;
+		int worker_count;
+
+		// Applied to the weights a row touched, after its update.
+		MLPPReg::RegularizationType reg;
+		real_t lambda;
+		real_t alpha;
+
+		// MODEL_TYPE_HINGE only.
+		real_t c;
+
+		Settings() {
+			model_type = MODEL_TYPE_LINEAR;
+			learning_rate = 0.001;
+			iteration_count = 0;
+			worker_count = 1;
+			reg = MLPPReg::REGULARIZATION_TYPE_NONE;
+			lambda = 0.5;
+			alpha = 0.5;
+			c = 1;
+		}
+	};
+
+	// Trains r_weights and r_bias in place. Workers run on MLPPParallel threads.
+	static void train(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_set, Ref<MLPPVector> r_weights, real_t *r_bias, const Settings &p_settings);
+};
+
+#endif
@@ -0,0 +1,350 @@
+/*************************************************************************/
+/*  inference_batcher.cpp                                                */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "inference_batcher.h"
+
+bool MLPPInferenceRequest::is_done() const {
+	MutexLock lock(_mutex);
+
+	return _done;
+}
+
+void MLPPInferenceRequest::wait() {
+	MutexLock lock(_mutex);
+
+	while (!_done) {
+		_condition.wait(_mutex);
+	}
+}
+
+Ref<MLPPVector> MLPPInferenceRequest::get_output() const {
+	return _output;
+}
+
+MLPPInferenceRequest::MLPPInferenceRequest() {
+	_done = false;
+}
+MLPPInferenceRequest::~MLPPInferenceRequest() {
+}
+
+void MLPPInferenceRequest::_complete(const real_t *p_output) {
+	{
+		MutexLock lock(_mutex);
+
+		real_t *output = _output->ptrw();
+		int size = _output->size();
+
+		for (int i = 0; i < size; ++i) {
+			output[i] = p_output[i];
+		}
+
+		_done = true;
+	}
+
+	_condition.notify_all();
+}
+
+void MLPPInferenceRequest::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("is_done"), &MLPPInferenceRequest::is_done);
+	ClassDB::bind_method(D_METHOD("wait"), &MLPPInferenceRequest::wait);
+	ClassDB::bind_method(D_METHOD("get_output"), &MLPPInferenceRequest::get_output);
+}
+
+void MLPPInferenceBatcher::start(const Ref<MLPPInferenceModel> &p_model, const int p_max_batch_size, const int p_max_wait_usec) {
+	ERR_FAIL_COND(!p_model.is_valid() || p_model->get_layer_count() == 0);
+	ERR_FAIL_COND(p_max_batch_size < 1 || p_max_wait_usec < 0);
+	ERR_FAIL_COND_MSG(is_running(), "The batcher is already running, stop() it first.");
+
+	_model = p_model;
+	_max_batch_size = p_max_batch_size;
+	_max_wait_usec = p_max_wait_usec;
+
+	_context = _model->create_context(_max_batch_size);
+	_output.resize(_max_batch_size * _model->get_output_size());
+
+	_batch_count = 0;
+	_sample_count = 0;
+	_stopping = false;
+	_running = true;
+
+#ifndef NO_THREADS
+	_thread.start(&MLPPInferenceBatcher::_thread_func, this);
+#endif
+}
+
+void MLPPInferenceBatcher::stop() {
+	{
+		MutexLock lock(_mutex);
+
+		if (!_running) {
+			return;
+		}
+
+		_stopping = true;
+	}
+
+	_condition.notify_all();
+
+#ifndef NO_THREADS
+	_thread.wait_to_finish();
+#endif
+
+	MutexLock lock(_mutex);
+
+	_running = false;
+	_stopping = false;
+	_context.unref();
+	_output.clear();
+}
+
+bool MLPPInferenceBatcher::is_running() const {
+	MutexLock lock(_mutex);
+
+	return _running;
+}
+
+Ref<MLPPInferenceModel> MLPPInferenceBatcher::get_model() const {
+	return _model;
+}
+int MLPPInferenceBatcher::get_max_batch_size() const {
+	return _max_batch_size;
+}
+int MLPPInferenceBatcher::get_max_wait_usec() const {
+	return _max_wait_usec;
+}
+
+Ref<MLPPInferenceRequest> MLPPInferenceBatcher::submit(const Ref<MLPPVector> &p_input) {
+	ERR_FAIL_COND_V(!p_input.is_valid() || !_model.is_valid(), Ref<MLPPInferenceRequest>());
+	ERR_FAIL_COND_V(p_input->size() != _model->get_input_size(), Ref<MLPPInferenceRequest>());
+
+	Pending pending;
+	pending.request.instance();
+	pending.request->_output.instance();
+	pending.request->_output->resize(_model->get_output_size());
+
+	if (!_submit(p_input->ptr(), pending)) {
+		return Ref<MLPPInferenceRequest>();
+	}
+
+	return pending.request;
+}
+
+void MLPPInferenceBatcher::submit_callback(const real_t *p_input, Callback p_callback, void *p_userdata) {
+	ERR_FAIL_COND(!p_input || !p_callback);
+
+	Pending pending;
+	pending.callback = p_callback;
+	pending.userdata = p_userdata;
+
+	_submit(p_input, pending);
+}
+
+Ref<MLPPVector> MLPPInferenceBatcher::predict(const Ref<MLPPVector> &p_input) {
+	Ref<MLPPInferenceRequest> request = submit(p_input);
+
+	ERR_FAIL_COND_V(!request.is_valid(), Ref<MLPPVector>());
+
+	request->wait();
+
+	return request->get_output();
+}
+
+int MLPPInferenceBatcher::get_batch_count() const {
+	MutexLock lock(_mutex);
+
+	return _batch_count;
+}
+int MLPPInferenceBatcher::get_sample_count() const {
+	MutexLock lock(_mutex);
+
+	return _sample_count;
+}
+
+MLPPInferenceBatcher::MLPPInferenceBatcher() {
+	_max_batch_size = 0;
+	_max_wait_usec = 0;
+	_pending_index = 0;
+	_first_pending_usec = 0;
+	_running = false;
+	_stopping = false;
+	_batch_count = 0;
+	_sample_count = 0;
+}
+MLPPInferenceBatcher::~MLPPInferenceBatcher() {
+	stop();
+}
+
+bool MLPPInferenceBatcher::_submit(const real_t *p_input, const Pending &p_pending) {
+	bool notify = false;
+
+	{
+		MutexLock lock(_mutex);
+
+		ERR_FAIL_COND_V_MSG(!_running || _stopping, false, "The batcher is not running.");
+
+		LocalVector<real_t> &pending_input = _pending_input[_pending_index];
+		LocalVector<Pending> &pending = _pending[_pending_index];
+
+		if (pending.empty()) {
+			_first_pending_usec = MLPPConditionVariable::get_ticks_usec();
+		}
+
+		int input_size = _model->get_input_size();
+		int offset = pending_input.size();
+
+		pending_input.resize(offset + input_size);
+		real_t *input = pending_input.ptr() + offset;
+
+		for (int i = 0; i < input_size; ++i) {
+			input[i] = p_input[i];
+		}
+
+		pending.push_back(p_pending);
+
+		// Wakes the thread for the first sample, to start the timer, and when the batch is full.
+		notify = pending.size() == 1 || static_cast<int>(pending.size()) >= _max_batch_size;
+	}
+
+#ifdef NO_THREADS
+	// Nothing to wait for, every sample is its own batch.
+	int index;
+
+	{
+		MutexLock lock(_mutex);
+
+		index = _pending_index;
+		_pending_index = 1 - index;
+	}
+
+	_run(index);
+#else
+	if (notify) {
+		_condition.notify_one();
+	}
+#endif
+
+	return true;
+}
+
+void MLPPInferenceBatcher::_run(const int p_index) {
+	LocalVector<real_t> &pending_input = _pending_input[p_index];
+	LocalVector<Pending> &pending = _pending[p_index];
+
+	int input_size = _model->get_input_size();
+	int output_size = _model->get_output_size();
+	int count = pending.size();
+
+	const real_t *input = pending_input.ptr();
+	real_t *output = _output.ptrw();
+
+	int batch_count = 0;
+
+	for (int from = 0; from < count; from += _max_batch_size) {
+		int row_count = MIN(_max_batch_size, count - from);
+
+		_model->predict_batch_ptr(input + from * input_size, row_count, output, _context.ptr());
+
+		for (int i = 0; i < row_count; ++i) {
+			const Pending &p = pending[from + i];
+			const real_t *output_row = output + i * output_size;
+
+			if (p.request.is_valid()) {
+				Ref<MLPPInferenceRequest> request = p.request;
+
+				request->_complete(output_row);
+			} else {
+				p.callback(output_row, p.userdata);
+			}
+		}
+
+		++batch_count;
+	}
+
+	// Lets go of the requests, but keeps the memory for the next batch.
+	pending_input.clear();
+	pending.clear();
+
+	MutexLock lock(_mutex);
+
+	_batch_count += batch_count;
+	_sample_count += count;
+}
+
+void MLPPInferenceBatcher::_thread_func(void *p_userdata) {
+	MLPPInferenceBatcher *self = static_cast<MLPPInferenceBatcher *>(p_userdata);
+
+	self->_mutex.lock();
+
+	while (true) {
+		while (self->_pending[self->_pending_index].empty() && !self->_stopping) {
+			self->_condition.wait(self->_mutex);
+		}
+
+		int index = self->_pending_index;
+
+		// Stopping, and everything ran.
+		if (self->_pending[index].empty()) {
+			break;
+		}
+
+		uint64_t deadline = self->_first_pending_usec + self->_max_wait_usec;
+
+		while (!self->_stopping && static_cast<int>(self->_pending[index].size()) < self->_max_batch_size && MLPPConditionVariable::get_ticks_usec() < deadline) {
+			self->_condition.wait_until(self->_mutex, deadline);
+		}
+
+		// New samples go into the other buffers while this batch runs.
+		self->_pending_index = 1 - index;
+
+		self->_mutex.unlock();
+
+		self->_run(index);
+
+		self->_mutex.lock();
+	}
+
+	self->_mutex.unlock();
+}
+
+void MLPPInferenceBatcher::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("start", "model", "max_batch_size", "max_wait_usec"), &MLPPInferenceBatcher::start);
+	ClassDB::bind_method(D_METHOD("stop"), &MLPPInferenceBatcher::stop);
+	ClassDB::bind_method(D_METHOD("is_running"), &MLPPInferenceBatcher::is_running);
+
+	ClassDB::bind_method(D_METHOD("get_model"), &MLPPInferenceBatcher::get_model);
+	ClassDB::bind_method(D_METHOD("get_max_batch_size"), &MLPPInferenceBatcher::get_max_batch_size);
+	ClassDB::bind_method(D_METHOD("get_max_wait_usec"), &MLPPInferenceBatcher::get_max_wait_usec);
+
+	ClassDB::bind_method(D_METHOD("submit", "input"), &MLPPInferenceBatcher::submit);
+	ClassDB::bind_method(D_METHOD("predict", "input"), &MLPPInferenceBatcher::predict);
+
+	ClassDB::bind_method(D_METHOD("get_batch_count"), &MLPPInferenceBatcher::get_batch_count);
+	ClassDB::bind_method(D_METHOD("get_sample_count"), &MLPPInferenceBatcher::get_sample_count);
+}
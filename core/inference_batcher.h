@@ -0,0 +1,164 @@
+#ifndef MLPP_INFERENCE_BATCHER_H
+#define MLPP_INFERENCE_BATCHER_H
+
+/*************************************************************************/
+/*  inference_batcher.h                                                  */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifdef USING_SFW
+#include "sfw.h"
+#else
+#include "core/containers/local_vector.h"
+#include "core/containers/vector.h"
+#include "core/math/math_defs.h"
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
+
+#include "core/object/reference.h"
+#endif
+
+#include "../core/condition_variable.h"
+#include "../core/inference_model.h"
+
+#include "../core/mlpp_vector.h"
+
+// The result of one sample submitted to an MLPPInferenceBatcher.
+class MLPPInferenceRequest : public Reference {
+	GDCLASS(MLPPInferenceRequest, Reference);
+
+public:
+	bool is_done() const;
+	// Blocks until the batch of the request ran.
+	void wait();
+	// Valid once the request is done.
+	Ref<MLPPVector> get_output() const;
+
+	MLPPInferenceRequest();
+	~MLPPInferenceRequest();
+
+protected:
+	friend class MLPPInferenceBatcher;
+
+	void _complete(const real_t *p_output);
+
+	static void _bind_methods();
+
+	Ref<MLPPVector> _output;
+	bool _done;
+
+	BinaryMutex _mutex;
+	MLPPConditionVariable _condition;
+};
+
+// Collects single sample requests from any number of threads, and runs them together as one batch on a background
+// thread, with MLPPInferenceModel::predict_batch_ptr(). A batch runs once max_batch_size samples are waiting, or
+// max_wait_usec after the first one arrived, whichever is first. Every weight is then loaded once per batch instead of
+// once per sample.
+//
+// batcher->start(ann->create_inference_model(), 64, 500);
+// Ref<MLPPInferenceRequest> request = batcher->submit(x); // any thread
+// ...
+// request->wait();
+// Ref<MLPPVector> y_hat = request->get_output();
+//
+// Callbacks run on the batcher's thread. stop() runs everything that is still waiting, then returns.
+class MLPPInferenceBatcher : public Reference {
+	GDCLASS(MLPPInferenceBatcher, Reference);
+
+public:
+	typedef void (*Callback)(const real_t *p_output, void *p_userdata);
+
+	void start(const Ref<MLPPInferenceModel> &p_model, const int p_max_batch_size, const int p_max_wait_usec);
+	void stop();
+	bool is_running() const;
+
+	Ref<MLPPInferenceModel> get_model() const;
+	int get_max_batch_size() const;
+	int get_max_wait_usec() const;
+
+	// Thread safe. The input is copied, it can be reused right away.
+	Ref<MLPPInferenceRequest> submit(const Ref<MLPPVector> &p_input);
+	// p_input has get_model()->get_input_size() elements, p_callback gets get_model()->get_output_size().
+	void submit_callback(const real_t *p_input, Callback p_callback, void *p_userdata);
+	// Submits, and waits for the result.
+	Ref<MLPPVector> predict(const Ref<MLPPVector> &p_input);
+
+	// Batches run, and the samples in them, since start().
+	int get_batch_count() const;
+	int get_sample_count() const;
+
+	MLPPInferenceBatcher();
+	~MLPPInferenceBatcher();
+
+protected:
+	struct Pending {
+		Ref<MLPPInferenceRequest> request;
+		Callback callback;
+		void *userdata;
+
+		Pending() {
+			callback = NULL;
+			userdata = NULL;
+		}
+	};
+
+	bool _submit(const real_t *p_input, const Pending &p_pending);
+	// Runs the buffers at p_index in chunks of _max_batch_size, completes them, then clears the buffers.
+	// The caller flipped _pending_index away from p_index, and doesn't hold the lock.
+	void _run(const int p_index);
+	static void _thread_func(void *p_userdata);
+
+	static void _bind_methods();
+
+	Ref<MLPPInferenceModel> _model;
+	int _max_batch_size;
+	int _max_wait_usec;
+
+	// Only used by the batcher's thread.
+	Ref<MLPPInferenceContext> _context;
+	Vector<real_t> _output;
+
+	// Guarded by _mutex. Submitted samples go into the buffers at _pending_index. The batcher's thread flips the
+	// index, and runs the other buffers without holding the lock. Both pairs keep their capacity between batches.
+	LocalVector<real_t> _pending_input[2];
+	LocalVector<Pending> _pending[2];
+	int _pending_index;
+	uint64_t _first_pending_usec;
+	bool _running;
+	bool _stopping;
+	int _batch_count;
+	int _sample_count;
+
+	BinaryMutex _mutex;
+	MLPPConditionVariable _condition;
+
+	Thread _thread;
+};
+
+#endif
@@ -0,0 +1,313 @@
+/*************************************************************************/
+/*  inference_model.cpp                                                  */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "inference_model.h"
+
+int MLPPInferenceContext::get_size() const {
+	return _size;
+}
+int MLPPInferenceContext::get_batch_size() const {
+	return _batch_size;
+}
+
+MLPPInferenceContext::MLPPInferenceContext() {
+	_size = 0;
+	_batch_size = 0;
+}
+MLPPInferenceContext::~MLPPInferenceContext() {
+}
+
+void MLPPInferenceContext::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_size"), &MLPPInferenceContext::get_size);
+	ClassDB::bind_method(D_METHOD("get_batch_size"), &MLPPInferenceContext::get_batch_size);
+}
+
+void MLPPInferenceModel::add_layer(const Ref<MLPPMatrix> &p_weights, const Ref<MLPPVector> &p_bias, const MLPPActivation::ActivationFunction p_activation) {
+	ERR_FAIL_COND(!p_weights.is_valid() || !p_bias.is_valid());
+
+	Size2i weights_size = p_weights->size();
+
+	ERR_FAIL_COND(p_bias->size() != weights_size.x);
+
+	_add_layer(p_weights->ptr(), p_bias->ptr(), weights_size.y, weights_size.x, p_activation);
+}
+
+void MLPPInferenceModel::add_layer_single(const Ref<MLPPVector> &p_weights, const real_t p_bias, const MLPPActivation::ActivationFunction p_activation) {
+	ERR_FAIL_COND(!p_weights.is_valid());
+
+	_add_layer(p_weights->ptr(), &p_bias, p_weights->size(), 1, p_activation);
+}
+
+void MLPPInferenceModel::clear() {
+	_parameters.clear();
+	_layers.clear();
+	_max_size = 0;
+}
+
+int MLPPInferenceModel::get_layer_count() const {
+	return _layers.size();
+}
+int MLPPInferenceModel::get_input_size() const {
+	if (_layers.empty()) {
+		return 0;
+	}
+
+	return _layers[0].input_size;
+}
+int MLPPInferenceModel::get_output_size() const {
+	if (_layers.empty()) {
+		return 0;
+	}
+
+	return _layers[_layers.size() - 1].size;
+}
+
+Ref<MLPPInferenceContext> MLPPInferenceModel::create_context(const int p_max_batch_size) const {
+	ERR_FAIL_COND_V(p_max_batch_size < 1, Ref<MLPPInferenceContext>());
+
+	Ref<MLPPInferenceContext> context;
+	context.instance();
+
+	context->_size = _max_size;
+	context->_batch_size = p_max_batch_size;
+	context->_buffer.resize(2 * _max_size * p_max_batch_size);
+
+	return context;
+}
+
+void MLPPInferenceModel::predict_ptr(const real_t *p_input, real_t *r_output, MLPPInferenceContext *p_context) const {
+	predict_batch_ptr(p_input, 1, r_output, p_context);
+}
+
+void MLPPInferenceModel::predict_batch_ptr(const real_t *p_input, const int p_row_count, real_t *r_output, MLPPInferenceContext *p_context) const {
+	ERR_FAIL_COND(!p_context);
+	ERR_FAIL_COND(_layers.empty());
+	ERR_FAIL_COND_MSG(p_context->_size < _max_size, "The context was created for a smaller model.");
+	ERR_FAIL_COND(p_row_count < 1 || p_row_count > p_context->_batch_size);
+
+	const real_t *parameters = _parameters.ptr();
+	real_t *buffer = p_context->_buffer.ptrw();
+	MLPPActivation &avn = p_context->_activation;
+
+	const real_t *in = p_input;
+	int layer_count = _layers.size();
+	int buffer_size = _max_size * p_context->_batch_size;
+
+	for (int l = 0; l < layer_count; ++l) {
+		const Layer &layer = _layers[l];
+
+		// The last layer writes straight into the output.
+		real_t *out = l == layer_count - 1 ? r_output : buffer + (l % 2) * buffer_size;
+
+		const real_t *w = parameters + layer.weights_offset;
+		const real_t *b = parameters + layer.bias_offset;
+		int input_size = layer.input_size;
+		int size = layer.size;
+
+		for (int r = 0; r < p_row_count; ++r) {
+			real_t *out_row = out + r * size;
+
+			for (int j = 0; j < size; ++j) {
+				out_row[j] = b[j];
+			}
+		}
+
+		// Weight row outer, so it stays in cache for the whole batch.
+		for (int k = 0; k < input_size; ++k) {
+			const real_t *w_row = w + k * size;
+
+			for (int r = 0; r < p_row_count; ++r) {
+				real_t x = in[r * input_size + k];
+
+				if (x == 0) {
+					continue;
+				}
+
+				real_t *out_row = out + r * size;
+
+				for (int j = 0; j < size; ++j) {
+					out_row[j] += x * w_row[j];
+				}
+			}
+		}
+
+		if (layer.function) {
+			for (int i = 0; i < p_row_count * size; ++i) {
+				out[i] = (avn.*layer.function)(out[i]);
+			}
+		} else {
+			// Softmax per row, shifted by the max, which leaves the result unchanged.
+			for (int r = 0; r < p_row_count; ++r) {
+				real_t *out_row = out + r * size;
+				real_t max = out_row[0];
+
+				for (int j = 1; j < size; ++j) {
+					if (out_row[j] > max) {
+						max = out_row[j];
+					}
+				}
+
+				real_t sum = 0;
+
+				for (int j = 0; j < size; ++j) {
+					out_row[j] = Math::exp(out_row[j] - max);
+					sum += out_row[j];
+				}
+
+				for (int j = 0; j < size; ++j) {
+					out_row[j] /= sum;
+				}
+			}
+		}
+
+		in = out;
+	}
+}
+
+void MLPPInferenceModel::predict_into(const Ref<MLPPVector> &p_input, Ref<MLPPVector> r_output, Ref<MLPPInferenceContext> p_context) const {
+	ERR_FAIL_COND(!p_input.is_valid() || !r_output.is_valid() || !p_context.is_valid());
+	ERR_FAIL_COND(p_input->size() != get_input_size());
+
+	if (r_output->size() != get_output_size()) {
+		r_output->resize(get_output_size());
+	}
+
+	predict_ptr(p_input->ptr(), r_output->ptrw(), p_context.ptr());
+}
+
+Ref<MLPPVector> MLPPInferenceModel::predict(const Ref<MLPPVector> &p_input, Ref<MLPPInferenceContext> p_context) const {
+	Ref<MLPPVector> output;
+	output.instance();
+
+	predict_into(p_input, output, p_context);
+
+	return output;
+}
+
+real_t MLPPInferenceModel::predict_real(const Ref<MLPPVector> &p_input, Ref<MLPPInferenceContext> p_context) const {
+	ERR_FAIL_COND_V(!p_input.is_valid() || !p_context.is_valid(), 0);
+	ERR_FAIL_COND_V(p_input->size() != get_input_size(), 0);
+	ERR_FAIL_COND_V_MSG(get_output_size() != 1, 0, "Use predict_into() for models with more than one output.");
+
+	real_t output = 0;
+
+	predict_ptr(p_input->ptr(), &output, p_context.ptr());
+
+	return output;
+}
+
+Ref<MLPPMatrix> MLPPInferenceModel::predict_batch(const Ref<MLPPMatrix> &p_input, Ref<MLPPInferenceContext> p_context) const {
+	ERR_FAIL_COND_V(!p_input.is_valid() || !p_context.is_valid(), Ref<MLPPMatrix>());
+	ERR_FAIL_COND_V(p_input->size().x != get_input_size(), Ref<MLPPMatrix>());
+
+	int row_count = p_input->size().y;
+	int input_size = get_input_size();
+	int output_size = get_output_size();
+
+	Ref<MLPPMatrix> output;
+	output.instance();
+	output->resize(Size2i(output_size, row_count));
+
+	const real_t *input_ptr = p_input->ptr();
+	real_t *output_ptr = output->ptrw();
+
+	for (int from = 0; from < row_count; from += p_context->_batch_size) {
+		int count = MIN(p_context->_batch_size, row_count - from);
+
+		predict_batch_ptr(input_ptr + from * input_size, count, output_ptr + from * output_size, p_context.ptr());
+	}
+
+	return output;
+}
+
+MLPPInferenceModel::MLPPInferenceModel() {
+	_max_size = 0;
+}
+MLPPInferenceModel::~MLPPInferenceModel() {
+}
+
+void MLPPInferenceModel::_add_layer(const real_t *p_weights, const real_t *p_bias, const int p_input_size, const int p_size, const MLPPActivation::ActivationFunction p_activation) {
+	ERR_FAIL_COND(p_input_size <= 0 || p_size <= 0);
+	ERR_FAIL_COND_MSG(!_layers.empty() && _layers[_layers.size() - 1].size != p_input_size, "The layer's input size does not match the previous layer's size.");
+
+	Layer layer;
+	layer.input_size = p_input_size;
+	layer.size = p_size;
+	layer.activation = p_activation;
+	layer.function = NULL;
+
+	if (p_activation != MLPPActivation::ACTIVATION_FUNCTION_SOFTMAX && p_activation != MLPPActivation::ACTIVATION_FUNCTION_ADJ_SOFTMAX) {
+		MLPPActivation avn;
+
+		layer.function = avn.get_activation_function_ptr_normal_real(p_activation);
+
+		ERR_FAIL_COND_MSG(!layer.function, "Unsupported activation function.");
+	}
+
+	int weights_size = p_input_size * p_size;
+
+	layer.weights_offset = _parameters.size();
+	layer.bias_offset = layer.weights_offset + weights_size;
+
+	_parameters.resize(layer.bias_offset + p_size);
+
+	real_t *parameters = _parameters.ptrw();
+
+	for (int i = 0; i < weights_size; ++i) {
+		parameters[layer.weights_offset + i] = p_weights[i];
+	}
+
+	for (int i = 0; i < p_size; ++i) {
+		parameters[layer.bias_offset + i] = p_bias[i];
+	}
+
+	_layers.push_back(layer);
+
+	if (p_size > _max_size) {
+		_max_size = p_size;
+	}
+}
+
+void MLPPInferenceModel::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("add_layer", "weights", "bias", "activation"), &MLPPInferenceModel::add_layer);
+	ClassDB::bind_method(D_METHOD("add_layer_single", "weights", "bias", "activation"), &MLPPInferenceModel::add_layer_single);
+	ClassDB::bind_method(D_METHOD("clear"), &MLPPInferenceModel::clear);
+
+	ClassDB::bind_method(D_METHOD("get_layer_count"), &MLPPInferenceModel::get_layer_count);
+	ClassDB::bind_method(D_METHOD("get_input_size"), &MLPPInferenceModel::get_input_size);
+	ClassDB::bind_method(D_METHOD("get_output_size"), &MLPPInferenceModel::get_output_size);
+
+	ClassDB::bind_method(D_METHOD("create_context", "max_batch_size"), &MLPPInferenceModel::create_context, 1);
+
+	ClassDB::bind_method(D_METHOD("predict_into", "input", "output", "context"), &MLPPInferenceModel::predict_into);
+	ClassDB::bind_method(D_METHOD("predict", "input", "context"), &MLPPInferenceModel::predict);
+	ClassDB::bind_method(D_METHOD("predict_real", "input", "context"), &MLPPInferenceModel::predict_real);
+	ClassDB::bind_method(D_METHOD("predict_batch", "input", "context"), &MLPPInferenceModel::predict_batch);
+}
@@ -0,0 +1,137 @@
+#ifndef MLPP_INFERENCE_MODEL_H
+#define MLPP_INFERENCE_MODEL_H
+
+/*************************************************************************/
+/*  inference_model.h                                                    */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifdef USING_SFW
+#include "sfw.h"
+#else
+#include "core/containers/vector.h"
+#include "core/math/math_defs.h"
+
+#include "core/object/reference.h"
+#endif
+
+#include "../core/activation.h"
+
+#include "../core/mlpp_matrix.h"
+#include "../core/mlpp_vector.h"
+
+// Scratch space of one caller of MLPPInferenceModel. Create one per thread with MLPPInferenceModel::create_context().
+class MLPPInferenceContext : public Reference {
+	GDCLASS(MLPPInferenceContext, Reference);
+
+public:
+	int get_size() const;
+	int get_batch_size() const;
+
+	MLPPInferenceContext();
+	~MLPPInferenceContext();
+
+protected:
+	friend class MLPPInferenceModel;
+
+	static void _bind_methods();
+
+	// Two buffers of _batch_size rows of _size, the layers ping pong between them.
+	Vector<real_t> _buffer;
+	int _size;
+	int _batch_size;
+
+	MLPPActivation _activation;
+};
+
+// A read only snapshot of a fully connected network, for single sample inference.
+// The weights are copied into one buffer when the layers are added, training the source model afterwards does not
+// change it. predict() only reads the model, and writes nothing but the caller's context and output, so any number of
+// threads can predict on the same model at the same time, each with its own context. predict_ptr() does no allocations.
+//
+// Ref<MLPPInferenceModel> model = ann->create_inference_model();
+// Ref<MLPPInferenceContext> context = model->create_context(); // per thread
+// real_t y_hat = model->predict_real(x, context);
+//
+// Add every layer before sharing the model between threads.
+class MLPPInferenceModel : public Reference {
+	GDCLASS(MLPPInferenceModel, Reference);
+
+public:
+	// weights is input size x layer size, like in MLPPHiddenLayer. Softmax and adjusted softmax are row wise, every
+	// other activation is element wise.
+	void add_layer(const Ref<MLPPMatrix> &p_weights, const Ref<MLPPVector> &p_bias, const MLPPActivation::ActivationFunction p_activation);
+	// A layer with one output, like MLPPOutputLayer.
+	void add_layer_single(const Ref<MLPPVector> &p_weights, const real_t p_bias, const MLPPActivation::ActivationFunction p_activation);
+	void clear();
+
+	int get_layer_count() const;
+	int get_input_size() const;
+	int get_output_size() const;
+
+	// p_max_batch_size is the most rows the context can take in one predict_batch_ptr() call.
+	Ref<MLPPInferenceContext> create_context(const int p_max_batch_size = 1) const;
+
+	// p_input has get_input_size() elements, r_output get_output_size().
+	void predict_ptr(const real_t *p_input, real_t *r_output, MLPPInferenceContext *p_context) const;
+	// p_row_count samples at once, row major. Every weight row is loaded once per batch instead of once per sample.
+	// p_row_count can't be more than the context's batch size.
+	void predict_batch_ptr(const real_t *p_input, const int p_row_count, real_t *r_output, MLPPInferenceContext *p_context) const;
+
+	void predict_into(const Ref<MLPPVector> &p_input, Ref<MLPPVector> r_output, Ref<MLPPInferenceContext> p_context) const;
+	Ref<MLPPVector> predict(const Ref<MLPPVector> &p_input, Ref<MLPPInferenceContext> p_context) const;
+	// The first output.
+	real_t predict_real(const Ref<MLPPVector> &p_input, Ref<MLPPInferenceContext> p_context) const;
+	// Any number of rows, in chunks of the context's batch size.
+	Ref<MLPPMatrix> predict_batch(const Ref<MLPPMatrix> &p_input, Ref<MLPPInferenceContext> p_context) const;
+
+	MLPPInferenceModel();
+	~MLPPInferenceModel();
+
+protected:
+	struct Layer {
+		int input_size;
+		int size;
+		// Into _parameters.
+		int weights_offset;
+		int bias_offset;
+		MLPPActivation::ActivationFunction activation;
+		// Null for the row wise activations.
+		MLPPActivation::RealActivationFunctionPointer function;
+	};
+
+	void _add_layer(const real_t *p_weights, const real_t *p_bias, const int p_input_size, const int p_size, const MLPPActivation::ActivationFunction p_activation);
+
+	static void _bind_methods();
+
+	Vector<real_t> _parameters;
+	Vector<Layer> _layers;
+	int _max_size;
+};
+
+#endif
@@ -36,22 +36,178 @@
 #include "core/math/math_funcs.h"
 #endif
 
+#include "../core/parallel.h"
 #include "../core/stat.h"
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <random>
 
 Ref<MLPPMatrix> MLPPLinAlg::gram_matrix(const Ref<MLPPMatrix> &A) {
-	return A->transposen()->multn(A); // AtA
+	return A->gram_matrixn(); // AtA
 }
 
 bool MLPPLinAlg::linear_independence_checker(const Ref<MLPPMatrix> &A) {
-	if (gram_matrix(A)->det(A->size().y) == 0) {
+	ERR_FAIL_COND_V(!A.is_valid(), false);
+
+	Size2i a_size = A->size();
+
+	if (a_size.y > a_size.x) {
 		return false;
 	}
 
-	return true;
+	return rank(A) == a_size.y;
+}
+
+int MLPPLinAlg::rank(const Ref<MLPPMatrix> &A, real_t tolerance) {
+	ERR_FAIL_COND_V(!A.is_valid(), 0);
+
+	Size2i a_size = A->size();
+	int m = a_size.y;
+	int n = a_size.x;
+	int k_max = MIN(m, n);
+
+	if (k_max == 0) {
+		return 0;
+	}
+
+	Ref<MLPPMatrix> W = A->duplicate_fast();
+	real_t *w_ptr = W->ptrw();
+
+	// Squared norms of the remaining part of each column, plus the last exactly computed values,
+	// so cancellation in the downdate can be detected.
+	Vector<real_t> norms;
+	norms.resize(n);
+	real_t *norms_ptr = norms.ptrw();
+	Vector<real_t> norms_exact;
+	norms_exact.resize(n);
+	real_t *norms_exact_ptr = norms_exact.ptrw();
+	Vector<real_t> s;
+	s.resize(n);
+	real_t *s_ptr = s.ptrw();
+
+	for (int j = 0; j < n; ++j) {
+		norms_ptr[j] = 0;
+	}
+
+	for (int i = 0; i < m; ++i) {
+		const real_t *w_row = w_ptr + i * n;
+
+		for (int j = 0; j < n; ++j) {
+			norms_ptr[j] += w_row[j] * w_row[j];
+		}
+	}
+
+	for (int j = 0; j < n; ++j) {
+		norms_exact_ptr[j] = norms_ptr[j];
+	}
+
+	const real_t eps = std::numeric_limits<real_t>::epsilon();
+	real_t tol = tolerance;
+
+	for (int k = 0; k < k_max; ++k) {
+		int p = k;
+
+		for (int j = k + 1; j < n; ++j) {
+			if (norms_ptr[j] > norms_ptr[p]) {
+				p = j;
+			}
+		}
+
+		real_t pivot_norm = Math::sqrt(MAX(norms_ptr[p], (real_t)0));
+
+		if (k == 0 && tol < 0) {
+			tol = MAX(m, n) * eps * pivot_norm;
+		}
+
+		if (pivot_norm <= tol || pivot_norm == 0) {
+			return k;
+		}
+
+		if (p != k) {
+			for (int i = 0; i < m; ++i) {
+				real_t *w_row = w_ptr + i * n;
+				SWAP(w_row[p], w_row[k]);
+			}
+
+			SWAP(norms_ptr[p], norms_ptr[k]);
+			SWAP(norms_exact_ptr[p], norms_exact_ptr[k]);
+		}
+
+		// Householder reflector for column k, rows k..m-1. v is stored in place of the column.
+		real_t xnorm = 0;
+		for (int i = k; i < m; ++i) {
+			real_t v = w_ptr[i * n + k];
+			xnorm += v * v;
+		}
+		xnorm = Math::sqrt(xnorm);
+
+		if (xnorm == 0) {
+			return k;
+		}
+
+		real_t x0 = w_ptr[k * n + k];
+		real_t alpha = x0 >= 0 ? -xnorm : xnorm;
+		w_ptr[k * n + k] = x0 - alpha;
+
+		// v^T v = 2 * xnorm * (xnorm + |x0|)
+		real_t vtv = 2 * xnorm * (xnorm + ABS(x0));
+
+		// s = v^T * W[k:, k+1:], walks the rows so the access stays contiguous.
+		for (int j = k + 1; j < n; ++j) {
+			s_ptr[j] = 0;
+		}
+
+		for (int i = k; i < m; ++i) {
+			const real_t *w_row = w_ptr + i * n;
+			real_t vi = w_row[k];
+
+			if (vi == 0) {
+				continue;
+			}
+
+			for (int j = k + 1; j < n; ++j) {
+				s_ptr[j] += vi * w_row[j];
+			}
+		}
+
+		real_t f = 2 / vtv;
+
+		for (int i = k; i < m; ++i) {
+			real_t *w_row = w_ptr + i * n;
+			real_t vi = w_row[k] * f;
+
+			if (vi == 0) {
+				continue;
+			}
+
+			for (int j = k + 1; j < n; ++j) {
+				w_row[j] -= vi * s_ptr[j];
+			}
+		}
+
+		// Downdate the column norms, recompute them when too much cancellation happened.
+		const real_t *w_row_k = w_ptr + k * n;
+
+		for (int j = k + 1; j < n; ++j) {
+			norms_ptr[j] -= w_row_k[j] * w_row_k[j];
+
+			if (norms_ptr[j] <= norms_exact_ptr[j] * Math::sqrt(eps)) {
+				real_t sum = 0;
+
+				for (int i = k + 1; i < m; ++i) {
+					real_t v = w_ptr[i * n + j];
+					sum += v * v;
+				}
+
+				norms_ptr[j] = sum;
+				norms_exact_ptr[j] = sum;
+			}
+		}
+	}
+
+	return k_max;
 }
 
 Ref<MLPPMatrix> MLPPLinAlg::gaussian_noise(int n, int m) {
@@ -696,34 +852,9 @@ Ref<MLPPMatrix> MLPPLinAlg::identitym(int d) {
 }
 
 Ref<MLPPMatrix> MLPPLinAlg::covnm(const Ref<MLPPMatrix> &A) {
-	MLPPStat stat;
-
-	Ref<MLPPMatrix> cov_mat;
-	cov_mat.instance();
-
-	Size2i a_size = A->size();
+	ERR_FAIL_COND_V(!A.is_valid(), Ref<MLPPMatrix>());
 
-	cov_mat->resize(a_size);
-
-	Ref<MLPPVector> a_i_row_tmp;
-	a_i_row_tmp.instance();
-	a_i_row_tmp->resize(a_size.x);
-
-	Ref<MLPPVector> a_j_row_tmp;
-	a_j_row_tmp.instance();
-	a_j_row_tmp->resize(a_size.x);
-
-	for (int i = 0; i < a_size.y; ++i) {
-		A->row_get_into_mlpp_vector(i, a_i_row_tmp);
-
-		for (int j = 0; j < a_size.x; ++j) {
-			A->row_get_into_mlpp_vector(j, a_j_row_tmp);
-
-			cov_mat->element_set(i, j, stat.covariancev(a_i_row_tmp, a_j_row_tmp));
-		}
-	}
-
-	return cov_mat;
+	return A->cov();
 }
 
 MLPPLinAlg::EigenResult MLPPLinAlg::eigen(Ref<MLPPMatrix> A) {
@@ -873,8 +1004,8 @@ MLPPLinAlg::SVDResult MLPPLinAlg::svd(const Ref<MLPPMatrix> &A) {
 
 	Size2i a_size = A->size();
 
-	EigenResult left_eigen = eigen(matmultnm(A, transposenm(A)));
-	EigenResult right_eigen = eigen(matmultnm(transposenm(A), A));
+	EigenResult left_eigen = eigen(A->row_gram_matrixn());
+	EigenResult right_eigen = eigen(A->gram_matrixn());
 
 	Ref<MLPPMatrix> singularvals = sqrtnm(left_eigen.eigen_values);
 	Ref<MLPPMatrix> sigma = zeromatnm(a_size.y, a_size.x);
@@ -894,6 +1025,123 @@ MLPPLinAlg::SVDResult MLPPLinAlg::svd(const Ref<MLPPMatrix> &A) {
 	return res;
 }
 
+MLPPLinAlg::SVDResult MLPPLinAlg::randomized_svd(const Ref<MLPPMatrix> &A, int rank, int oversampling, int power_iterations) {
+	SVDResult res;
+
+	ERR_FAIL_COND_V(!A.is_valid(), res);
+
+	Size2i a_size = A->size();
+	int min_dim = MIN(a_size.x, a_size.y);
+
+	ERR_FAIL_COND_V(rank <= 0 || rank > min_dim, res);
+	ERR_FAIL_COND_V(oversampling < 0 || power_iterations < 0, res);
+
+	int l = MIN(rank + oversampling, min_dim);
+
+	// The bases are kept transposed (l x m and l x n), so that every product with A walks its rows contiguously.
+	Ref<MLPPMatrix> omega_t = MLPPMatrix::create_gaussian_noise(l, a_size.x);
+
+	Ref<MLPPMatrix> qt;
+	qt.instance();
+
+	_mult_abt_transposed(A, omega_t, qt); // Y^T = (A * Omega)^T
+	_orthonormalize_rows(qt);
+
+	Ref<MLPPMatrix> zt;
+	zt.instance();
+
+	// Power iterations sharpen the spectrum decay: Q <- orth(A * orth(A^T * Q)).
+	for (int i = 0; i < power_iterations; ++i) {
+		zt->multb(qt, A); // Z^T = (A^T * Q)^T = Q^T * A
+		_orthonormalize_rows(zt);
+
+		_mult_abt_transposed(A, zt, qt);
+		_orthonormalize_rows(qt);
+	}
+
+	// B = Q^T * A is only (l x n), its SVD is cheap.
+	Ref<MLPPMatrix> b = qt->multn(A);
+	Ref<MLPPMatrix> j_mat = identitym(l);
+
+	// J * B = S * Vt, so B = J^T * S * Vt and U = Q * J^T.
+	_one_sided_jacobi_rows(b, j_mat);
+
+	Ref<MLPPMatrix> ut = j_mat->multn(qt);
+
+	const real_t *b_ptr = b->ptr();
+	const real_t *ut_ptr = ut->ptr();
+
+	Vector<real_t> singular_values;
+	Vector<int> order;
+	singular_values.resize(l);
+	order.resize(l);
+
+	for (int i = 0; i < l; ++i) {
+		const real_t *b_row_ptr = b_ptr + b->calculate_index(i, 0);
+
+		real_t sum = 0;
+		for (int j = 0; j < a_size.x; ++j) {
+			sum += b_row_ptr[j] * b_row_ptr[j];
+		}
+
+		singular_values.write[i] = Math::sqrt(sum);
+		order.write[i] = i;
+	}
+
+	// Selection sort, l is small.
+	for (int i = 0; i < rank; ++i) {
+		int max_index = i;
+
+		for (int j = i + 1; j < l; ++j) {
+			if (singular_values[order[j]] > singular_values[order[max_index]]) {
+				max_index = j;
+			}
+		}
+
+		SWAP(order.write[i], order.write[max_index]);
+	}
+
+	Ref<MLPPMatrix> U;
+	U.instance();
+	U->resize(Size2i(rank, a_size.y));
+
+	Ref<MLPPMatrix> S = zeromatnm(rank, rank);
+
+	Ref<MLPPMatrix> Vt;
+	Vt.instance();
+	Vt->resize(Size2i(a_size.x, rank));
+
+	real_t *u_ptr = U->ptrw();
+	real_t *vt_ptr = Vt->ptrw();
+
+	for (int i = 0; i < rank; ++i) {
+		int r = order[i];
+		real_t s = singular_values[r];
+
+		S->element_set(i, i, s);
+
+		const real_t *b_row_ptr = b_ptr + b->calculate_index(r, 0);
+		real_t *vt_row_ptr = vt_ptr + Vt->calculate_index(i, 0);
+		real_t s_inv = s > CMP_EPSILON ? 1 / s : 0;
+
+		for (int j = 0; j < a_size.x; ++j) {
+			vt_row_ptr[j] = b_row_ptr[j] * s_inv;
+		}
+
+		const real_t *ut_row_ptr = ut_ptr + ut->calculate_index(r, 0);
+
+		for (int j = 0; j < a_size.y; ++j) {
+			u_ptr[U->calculate_index(j, i)] = ut_row_ptr[j];
+		}
+	}
+
+	res.U = U;
+	res.S = S;
+	res.Vt = Vt;
+
+	return res;
+}
+
 Ref<MLPPVector> MLPPLinAlg::vector_projection(const Ref<MLPPVector> &a, const Ref<MLPPVector> &b) {
 	real_t product = a->dot(b) / a->dot(a);
 
@@ -1025,53 +1273,437 @@ Ref<MLPPVector> MLPPLinAlg::flattenvvnv(const Ref<MLPPMatrix> &A) {
 	return res;
 }
 
-Ref<MLPPVector> MLPPLinAlg::solve(const Ref<MLPPMatrix> &A, const Ref<MLPPVector> &b) {
-	return A->inverse()->mult_vec(b);
+Ref<MLPPVector> MLPPLinAlg::solve(const Ref<MLPPMatrix> &A, const Ref<MLPPVector> &b, SolverType solver) {
+	switch (solver) {
+		case SOLVER_CONJUGATE_GRADIENT:
+			return conjugate_gradientm(A, b, Ref<MLPPVector>(), PRECONDITIONER_JACOBI).x;
+		case SOLVER_LSQR:
+			return lsqrm(A, b).x;
+		case SOLVER_INVERSE:
+		default:
+			return A->inverse()->mult_vec(b);
+	}
 }
 
-bool MLPPLinAlg::positive_definite_checker(const Ref<MLPPMatrix> &A) {
-	EigenResult eig_result = eigen(A);
+void MLPPLinAlg::LinearOperator::mult_vec_transposed(const Ref<MLPPVector> &x, Ref<MLPPVector> out) const {
+	ERR_FAIL_MSG("This LinearOperator does not implement mult_vec_transposed().");
+}
+bool MLPPLinAlg::LinearOperator::diagonal_get(Ref<MLPPVector> out) const {
+	return false;
+}
+Ref<MLPPMatrix> MLPPLinAlg::LinearOperator::matrix_get() const {
+	return Ref<MLPPMatrix>();
+}
+
+Size2i MLPPLinAlg::MatrixLinearOperator::size() const {
+	return _A->size();
+}
+void MLPPLinAlg::MatrixLinearOperator::mult_vec(const Ref<MLPPVector> &x, Ref<MLPPVector> out) const {
+	Size2i a_size = _A->size();
 
-	Ref<MLPPMatrix> eigenvals = eig_result.eigen_values;
-	Size2i eigenvals_size = eigenvals->size();
+	ERR_FAIL_COND(x->size() != a_size.x);
 
-	for (int i = 0; i < eigenvals_size.y; ++i) {
-		if (eigenvals->element_get(i, i) <= 0) { // Simply check to ensure all eigenvalues are positive.
-			return false;
+	if (unlikely(out->size() != a_size.y)) {
+		out->resize(a_size.y);
+	}
+
+	const real_t *a_ptr = _A->ptr();
+	const real_t *x_ptr = x->ptr();
+	real_t *out_ptr = out->ptrw();
+
+	for (int i = 0; i < a_size.y; ++i) {
+		const real_t *a_row_ptr = a_ptr + _A->calculate_index(i, 0);
+
+		real_t sum = 0;
+		for (int j = 0; j < a_size.x; ++j) {
+			sum += a_row_ptr[j] * x_ptr[j];
 		}
+
+		out_ptr[i] = sum;
+	}
+}
+void MLPPLinAlg::MatrixLinearOperator::mult_vec_transposed(const Ref<MLPPVector> &x, Ref<MLPPVector> out) const {
+	Size2i a_size = _A->size();
+
+	ERR_FAIL_COND(x->size() != a_size.y);
+
+	if (unlikely(out->size() != a_size.x)) {
+		out->resize(a_size.x);
+	}
+
+	out->fill(0);
+
+	const real_t *a_ptr = _A->ptr();
+	const real_t *x_ptr = x->ptr();
+	real_t *out_ptr = out->ptrw();
+
+	// Row-wise axpy, so A is still read contiguously.
+	for (int i = 0; i < a_size.y; ++i) {
+		const real_t *a_row_ptr = a_ptr + _A->calculate_index(i, 0);
+		real_t xi = x_ptr[i];
+
+		for (int j = 0; j < a_size.x; ++j) {
+			out_ptr[j] += a_row_ptr[j] * xi;
+		}
+	}
+}
+bool MLPPLinAlg::MatrixLinearOperator::diagonal_get(Ref<MLPPVector> out) const {
+	Size2i a_size = _A->size();
+	int d = MIN(a_size.x, a_size.y);
+
+	if (unlikely(out->size() != d)) {
+		out->resize(d);
+	}
+
+	for (int i = 0; i < d; ++i) {
+		out->element_set(i, _A->element_get(i, i));
 	}
 
 	return true;
 }
+Ref<MLPPMatrix> MLPPLinAlg::MatrixLinearOperator::matrix_get() const {
+	return _A;
+}
+MLPPLinAlg::MatrixLinearOperator::MatrixLinearOperator(const Ref<MLPPMatrix> &p_A) {
+	_A = p_A;
+}
 
-bool MLPPLinAlg::negative_definite_checker(const Ref<MLPPMatrix> &A) {
-	EigenResult eig_result = eigen(A);
+MLPPLinAlg::IterativeSolverResult MLPPLinAlg::conjugate_gradient(const LinearOperator &A, const Ref<MLPPVector> &b, const Ref<MLPPVector> &x0, PreconditionerType preconditioner, real_t tolerance, int max_iterations) {
+	IterativeSolverResult res;
 
-	Ref<MLPPMatrix> eigenvals = eig_result.eigen_values;
-	Size2i eigenvals_size = eigenvals->size();
+	ERR_FAIL_COND_V(!b.is_valid(), res);
 
-	for (int i = 0; i < eigenvals_size.y; ++i) {
-		if (eigenvals->element_get(i, i) >= 0) { // Simply check to ensure all eigenvalues are negative.
-			return false;
+	Size2i a_size = A.size();
+	int n = a_size.x;
+
+	ERR_FAIL_COND_V(a_size.x != a_size.y, res);
+	ERR_FAIL_COND_V(b->size() != n, res);
+	ERR_FAIL_COND_V(x0.is_valid() && x0->size() != n, res);
+
+	if (max_iterations <= 0) {
+		max_iterations = n;
+	}
+
+	Ref<MLPPVector> x;
+	if (x0.is_valid()) {
+		x = x0->duplicate_fast();
+	} else {
+		x.instance();
+		x->resize(n);
+		x->fill(0);
+	}
+
+	Ref<MLPPVector> r;
+	r.instance();
+	r->resize(n);
+
+	Ref<MLPPVector> z;
+	z.instance();
+	z->resize(n);
+
+	Ref<MLPPVector> p;
+	p.instance();
+	p->resize(n);
+
+	Ref<MLPPVector> ap;
+	ap.instance();
+	ap->resize(n);
+
+	// Preconditioner setup
+	Ref<MLPPVector> inv_diag;
+	Ref<MLPPMatrix> ic_l;
+
+	if (preconditioner == PRECONDITIONER_INCOMPLETE_CHOLESKY) {
+		Ref<MLPPMatrix> a_mat = A.matrix_get();
+
+		if (a_mat.is_valid()) {
+			ic_l.instance();
+
+			if (!_incomplete_cholesky(a_mat, ic_l)) {
+				ERR_PRINT("Incomplete Cholesky factorization broke down, falling back to the Jacobi preconditioner.");
+				ic_l.unref();
+				preconditioner = PRECONDITIONER_JACOBI;
+			}
+		} else {
+			ERR_PRINT("Incomplete Cholesky preconditioning needs an operator backed by a matrix, falling back to the Jacobi preconditioner.");
+			preconditioner = PRECONDITIONER_JACOBI;
 		}
 	}
 
-	return true;
+	if (preconditioner == PRECONDITIONER_JACOBI) {
+		inv_diag.instance();
+
+		if (A.diagonal_get(inv_diag)) {
+			real_t *d_ptr = inv_diag->ptrw();
+
+			for (int i = 0; i < n; ++i) {
+				d_ptr[i] = d_ptr[i] != 0 ? 1 / d_ptr[i] : 1;
+			}
+		} else {
+			ERR_PRINT("The operator does not provide its diagonal, Jacobi preconditioning is disabled.");
+			inv_diag.unref();
+			preconditioner = PRECONDITIONER_NONE;
+		}
+	}
+
+	// r = b - A * x
+	A.mult_vec(x, ap);
+
+	const real_t *b_ptr = b->ptr();
+	real_t *x_ptr = x->ptrw();
+	real_t *r_ptr = r->ptrw();
+	real_t *z_ptr = z->ptrw();
+	real_t *p_ptr = p->ptrw();
+	const real_t *ap_ptr = ap->ptr();
+
+	for (int i = 0; i < n; ++i) {
+		r_ptr[i] = b_ptr[i] - ap_ptr[i];
+	}
+
+	real_t b_norm = b->norm_2();
+	real_t threshold = tolerance * (b_norm > 0 ? b_norm : 1);
+
+	res.residual_norm = r->norm_2();
+
+	if (res.residual_norm <= threshold) {
+		res.x = x;
+		res.converged = true;
+		return res;
+	}
+
+	if (preconditioner == PRECONDITIONER_JACOBI) {
+		const real_t *d_ptr = inv_diag->ptr();
+
+		for (int i = 0; i < n; ++i) {
+			z_ptr[i] = d_ptr[i] * r_ptr[i];
+		}
+	} else if (preconditioner == PRECONDITIONER_INCOMPLETE_CHOLESKY) {
+		_cholesky_solve(ic_l, r, z);
+	} else {
+		z->set_from_mlpp_vector(r);
+	}
+
+	p->set_from_mlpp_vector(z);
+
+	real_t rz = r->dot(z);
+
+	for (int iter = 0; iter < max_iterations; ++iter) {
+		A.mult_vec(p, ap);
+
+		real_t pap = p->dot(ap);
+
+		if (pap <= 0) {
+			// Not positive definite (or converged to rounding error)
+			break;
+		}
+
+		real_t alpha = rz / pap;
+
+		real_t r_norm_sq = 0;
+		for (int i = 0; i < n; ++i) {
+			x_ptr[i] += alpha * p_ptr[i];
+			r_ptr[i] -= alpha * ap_ptr[i];
+			r_norm_sq += r_ptr[i] * r_ptr[i];
+		}
+
+		res.iterations = iter + 1;
+		res.residual_norm = Math::sqrt(r_norm_sq);
+
+		if (res.residual_norm <= threshold) {
+			res.converged = true;
+			break;
+		}
+
+		if (preconditioner == PRECONDITIONER_JACOBI) {
+			const real_t *d_ptr = inv_diag->ptr();
+
+			for (int i = 0; i < n; ++i) {
+				z_ptr[i] = d_ptr[i] * r_ptr[i];
+			}
+		} else if (preconditioner == PRECONDITIONER_INCOMPLETE_CHOLESKY) {
+			_cholesky_solve(ic_l, r, z);
+		} else {
+			z->set_from_mlpp_vector(r);
+		}
+
+		real_t rz_new = r->dot(z);
+		real_t beta = rz_new / rz;
+		rz = rz_new;
+
+		for (int i = 0; i < n; ++i) {
+			p_ptr[i] = z_ptr[i] + beta * p_ptr[i];
+		}
+	}
+
+	res.x = x;
+
+	return res;
 }
+MLPPLinAlg::IterativeSolverResult MLPPLinAlg::conjugate_gradientm(const Ref<MLPPMatrix> &A, const Ref<MLPPVector> &b, const Ref<MLPPVector> &x0, PreconditionerType preconditioner, real_t tolerance, int max_iterations) {
+	ERR_FAIL_COND_V(!A.is_valid(), IterativeSolverResult());
 
-bool MLPPLinAlg::zero_eigenvalue(const Ref<MLPPMatrix> &A) {
-	EigenResult eig_result = eigen(A);
+	return conjugate_gradient(MatrixLinearOperator(A), b, x0, preconditioner, tolerance, max_iterations);
+}
 
-	Ref<MLPPMatrix> eigenvals = eig_result.eigen_values;
-	Size2i eigenvals_size = eigenvals->size();
+MLPPLinAlg::IterativeSolverResult MLPPLinAlg::lsqr(const LinearOperator &A, const Ref<MLPPVector> &b, real_t damp, real_t tolerance, int max_iterations) {
+	IterativeSolverResult res;
 
-	for (int i = 0; i < eigenvals_size.y; ++i) {
-		if (eigenvals->element_get(i, i) == 0) { // TODO should it use is_equal_approx?
-			return false;
+	ERR_FAIL_COND_V(!b.is_valid(), res);
+
+	Size2i a_size = A.size();
+	int m = a_size.y;
+	int n = a_size.x;
+
+	ERR_FAIL_COND_V(b->size() != m, res);
+
+	if (max_iterations <= 0) {
+		max_iterations = 2 * n;
+	}
+
+	Ref<MLPPVector> x;
+	x.instance();
+	x->resize(n);
+	x->fill(0);
+
+	res.x = x;
+
+	Ref<MLPPVector> u = b->duplicate_fast();
+
+	Ref<MLPPVector> v;
+	v.instance();
+	v->resize(n);
+
+	Ref<MLPPVector> w;
+	w.instance();
+	w->resize(n);
+
+	Ref<MLPPVector> tmp_m;
+	tmp_m.instance();
+	tmp_m->resize(m);
+
+	Ref<MLPPVector> tmp_n;
+	tmp_n.instance();
+	tmp_n->resize(n);
+
+	// Golub-Kahan bidiagonalization start: beta * u = b, alpha * v = A^T * u
+	real_t beta = u->norm_2();
+	real_t b_norm = beta;
+
+	if (beta == 0) {
+		res.converged = true;
+		return res;
+	}
+
+	u->scalar_multiply(1 / beta);
+
+	A.mult_vec_transposed(u, v);
+	real_t alpha = v->norm_2();
+
+	if (alpha == 0) {
+		// b is orthogonal to the range of A, x = 0 is the solution.
+		res.residual_norm = b_norm;
+		res.converged = true;
+		return res;
+	}
+
+	v->scalar_multiply(1 / alpha);
+	w->set_from_mlpp_vector(v);
+
+	real_t phibar = beta;
+	real_t rhobar = alpha;
+	real_t a_norm_sq = 0;
+
+	real_t *x_ptr = x->ptrw();
+	real_t *u_ptr = u->ptrw();
+	real_t *v_ptr = v->ptrw();
+	real_t *w_ptr = w->ptrw();
+	const real_t *tmp_m_ptr = tmp_m->ptr();
+	const real_t *tmp_n_ptr = tmp_n->ptr();
+
+	for (int iter = 0; iter < max_iterations; ++iter) {
+		// beta * u = A * v - alpha * u
+		A.mult_vec(v, tmp_m);
+
+		for (int i = 0; i < m; ++i) {
+			u_ptr[i] = tmp_m_ptr[i] - alpha * u_ptr[i];
+		}
+
+		beta = u->norm_2();
+
+		if (beta > 0) {
+			u->scalar_multiply(1 / beta);
+		}
+
+		a_norm_sq += alpha * alpha + beta * beta + damp * damp;
+
+		// alpha * v = A^T * u - beta * v
+		A.mult_vec_transposed(u, tmp_n);
+
+		for (int i = 0; i < n; ++i) {
+			v_ptr[i] = tmp_n_ptr[i] - beta * v_ptr[i];
+		}
+
+		alpha = v->norm_2();
+
+		if (alpha > 0) {
+			v->scalar_multiply(1 / alpha);
+		}
+
+		// Eliminate the damping term
+		real_t rhobar1 = Math::sqrt(rhobar * rhobar + damp * damp);
+		real_t cs1 = rhobar / rhobar1;
+		phibar = cs1 * phibar;
+
+		// Next plane rotation
+		real_t rho = Math::sqrt(rhobar1 * rhobar1 + beta * beta);
+		real_t cs = rhobar1 / rho;
+		real_t sn = beta / rho;
+		real_t theta = sn * alpha;
+		rhobar = -cs * alpha;
+		real_t phi = cs * phibar;
+		phibar = sn * phibar;
+
+		real_t t1 = phi / rho;
+		real_t t2 = -theta / rho;
+
+		for (int i = 0; i < n; ++i) {
+			x_ptr[i] += t1 * w_ptr[i];
+			w_ptr[i] = v_ptr[i] + t2 * w_ptr[i];
+		}
+
+		res.iterations = iter + 1;
+		res.residual_norm = ABS(phibar);
+
+		// Either the system is compatible, or the normal equations are satisfied (||A^T * r|| is small).
+		real_t normal_residual = res.residual_norm * alpha * ABS(cs);
+
+		if (res.residual_norm <= tolerance * b_norm || normal_residual <= tolerance * Math::sqrt(a_norm_sq) * res.residual_norm) {
+			res.converged = true;
+			break;
 		}
 	}
 
-	return true;
+	return res;
+}
+MLPPLinAlg::IterativeSolverResult MLPPLinAlg::lsqrm(const Ref<MLPPMatrix> &A, const Ref<MLPPVector> &b, real_t damp, real_t tolerance, int max_iterations) {
+	ERR_FAIL_COND_V(!A.is_valid(), IterativeSolverResult());
+
+	return lsqr(MatrixLinearOperator(A), b, damp, tolerance, max_iterations);
+}
+
+bool MLPPLinAlg::positive_definite_checker(const Ref<MLPPMatrix> &A) {
+	return _cholesky_attempt(A, 1);
+}
+
+bool MLPPLinAlg::negative_definite_checker(const Ref<MLPPMatrix> &A) {
+	return _cholesky_attempt(A, -1);
+}
+
+bool MLPPLinAlg::zero_eigenvalue(const Ref<MLPPMatrix> &A) {
+	ERR_FAIL_COND_V(!A.is_valid(), false);
+	ERR_FAIL_COND_V(A->size().x != A->size().y, false);
+
+	return rank(A) < A->size().y;
 }
 
 Ref<MLPPVector> MLPPLinAlg::flattenmnv(const Vector<Ref<MLPPVector>> &A) {
@@ -1987,5 +2619,371 @@ std::vector<std::vector<std::vector<real_t>>> MLPPLinAlg::vector_wise_tensor_pro
 }
 */
 
+void MLPPLinAlg::_mult_abt_transposed(const Ref<MLPPMatrix> &A, const Ref<MLPPMatrix> &Bt, Ref<MLPPMatrix> out) {
+	ERR_FAIL_COND(!A.is_valid() || !Bt.is_valid() || !out.is_valid());
+
+	Size2i a_size = A->size();
+	Size2i bt_size = Bt->size();
+
+	ERR_FAIL_COND(a_size.x != bt_size.x);
+
+	Size2i rs = Size2i(a_size.y, bt_size.y);
+
+	if (unlikely(out->size() != rs)) {
+		out->resize(rs);
+	}
+
+	MultABtData data;
+	data.a = A.ptr();
+	data.bt = Bt.ptr();
+	data.out = out.ptr();
+
+	// Every row of A writes its own column of out.
+	MLPPParallel::do_work(a_size.y, this, &MLPPLinAlg::_mult_abt_transposed_range, &data, 1 + 65536 / MAX(a_size.x * bt_size.y, 1));
+}
+
+void MLPPLinAlg::_mult_abt_transposed_range(int p_from, int p_to, MultABtData *p_data) {
+	const MLPPMatrix *A = p_data->a;
+	const MLPPMatrix *Bt = p_data->bt;
+	MLPPMatrix *out = p_data->out;
+
+	Size2i a_size = A->size();
+	Size2i bt_size = Bt->size();
+
+	const real_t *a_ptr = A->ptr();
+	const real_t *bt_ptr = Bt->ptr();
+	real_t *out_ptr = out->ptrw();
+
+	for (int i = p_from; i < p_to; ++i) {
+		const real_t *a_row_ptr = a_ptr + A->calculate_index(i, 0);
+
+		for (int c = 0; c < bt_size.y; ++c) {
+			const real_t *bt_row_ptr = bt_ptr + Bt->calculate_index(c, 0);
+
+			real_t sum = 0;
+			for (int k = 0; k < a_size.x; ++k) {
+				sum += a_row_ptr[k] * bt_row_ptr[k];
+			}
+
+			out_ptr[out->calculate_index(c, i)] = sum;
+		}
+	}
+}
+
+void MLPPLinAlg::_orthonormalize_rows(Ref<MLPPMatrix> A) {
+	ERR_FAIL_COND(!A.is_valid());
+
+	Size2i a_size = A->size();
+	real_t *a_ptr = A->ptrw();
+
+	Vector<real_t> projections;
+	projections.resize(a_size.y);
+
+	OrthonormalizeRowsData data;
+	data.a = A.ptr();
+	data.projections = projections.ptrw();
+
+	for (int i = 0; i < a_size.y; ++i) {
+		real_t *row_i = a_ptr + A->calculate_index(i, 0);
+
+		real_t original_norm_sq = 0;
+		for (int k = 0; k < a_size.x; ++k) {
+			original_norm_sq += row_i[k] * row_i[k];
+		}
+
+		data.row_index = i;
+
+		// Classical Gram-Schmidt, so that both the projections and the update run in parallel.
+		// Two passes, otherwise orthogonality is lost quickly with nearly dependent rows.
+		for (int pass = 0; pass < 2 && i > 0; ++pass) {
+			MLPPParallel::do_work(i, this, &MLPPLinAlg::_orthonormalize_projections_range, &data, 1 + 65536 / MAX(a_size.x, 1));
+			MLPPParallel::do_work(a_size.x, this, &MLPPLinAlg::_orthonormalize_subtract_range, &data, 1 + 65536 / i);
+		}
+
+		real_t norm_sq = 0;
+		for (int k = 0; k < a_size.x; ++k) {
+			norm_sq += row_i[k] * row_i[k];
+		}
+
+		// The row was (numerically) in the span of the previous ones.
+		if (norm_sq <= CMP_EPSILON2 * original_norm_sq || norm_sq == 0) {
+			for (int k = 0; k < a_size.x; ++k) {
+				row_i[k] = 0;
+			}
+
+			continue;
+		}
+
+		real_t norm_inv = 1 / Math::sqrt(norm_sq);
+
+		for (int k = 0; k < a_size.x; ++k) {
+			row_i[k] *= norm_inv;
+		}
+	}
+}
+
+void MLPPLinAlg::_orthonormalize_projections_range(int p_from, int p_to, OrthonormalizeRowsData *p_data) {
+	MLPPMatrix *A = p_data->a;
+
+	int row_length = A->size().x;
+	real_t *a_ptr = A->ptrw();
+	const real_t *row_i = a_ptr + A->calculate_index(p_data->row_index, 0);
+
+	for (int j = p_from; j < p_to; ++j) {
+		const real_t *row_j = a_ptr + A->calculate_index(j, 0);
+
+		real_t proj = 0;
+		for (int k = 0; k < row_length; ++k) {
+			proj += row_i[k] * row_j[k];
+		}
+
+		p_data->projections[j] = proj;
+	}
+}
+
+void MLPPLinAlg::_orthonormalize_subtract_range(int p_from, int p_to, OrthonormalizeRowsData *p_data) {
+	MLPPMatrix *A = p_data->a;
+
+	int row_index = p_data->row_index;
+	real_t *a_ptr = A->ptrw();
+	real_t *row_i = a_ptr + A->calculate_index(row_index, 0);
+	const real_t *projections = p_data->projections;
+
+	for (int j = 0; j < row_index; ++j) {
+		const real_t *row_j = a_ptr + A->calculate_index(j, 0);
+		real_t proj = projections[j];
+
+		for (int k = p_from; k < p_to; ++k) {
+			row_i[k] -= proj * row_j[k];
+		}
+	}
+}
+
+void MLPPLinAlg::_one_sided_jacobi_rows(Ref<MLPPMatrix> A, Ref<MLPPMatrix> J) {
+	ERR_FAIL_COND(!A.is_valid() || !J.is_valid());
+
+	Size2i a_size = A->size();
+	Size2i j_size = J->size();
+
+	ERR_FAIL_COND(a_size.y != j_size.y);
+
+	real_t *a_ptr = A->ptrw();
+	real_t *j_ptr = J->ptrw();
+
+	const int max_sweeps = 60;
+
+	for (int sweep = 0; sweep < max_sweeps; ++sweep) {
+		bool rotated = false;
+
+		for (int p = 0; p < a_size.y - 1; ++p) {
+			real_t *a_p = a_ptr + A->calculate_index(p, 0);
+
+			for (int q = p + 1; q < a_size.y; ++q) {
+				real_t *a_q = a_ptr + A->calculate_index(q, 0);
+
+				real_t alpha = 0;
+				real_t beta = 0;
+				real_t gamma = 0;
+
+				for (int k = 0; k < a_size.x; ++k) {
+					alpha += a_p[k] * a_p[k];
+					beta += a_q[k] * a_q[k];
+					gamma += a_p[k] * a_q[k];
+				}
+
+				if (ABS(gamma) <= CMP_EPSILON * Math::sqrt(alpha * beta) || gamma == 0) {
+					continue;
+				}
+
+				rotated = true;
+
+				real_t zeta = (beta - alpha) / (2 * gamma);
+				real_t t = (zeta >= 0 ? 1 : -1) / (ABS(zeta) + Math::sqrt(1 + zeta * zeta));
+				real_t c = 1 / Math::sqrt(1 + t * t);
+				real_t s = c * t;
+
+				for (int k = 0; k < a_size.x; ++k) {
+					real_t ap = a_p[k];
+					real_t aq = a_q[k];
+
+					a_p[k] = c * ap - s * aq;
+					a_q[k] = s * ap + c * aq;
+				}
+
+				real_t *j_p = j_ptr + J->calculate_index(p, 0);
+				real_t *j_q = j_ptr + J->calculate_index(q, 0);
+
+				for (int k = 0; k < j_size.x; ++k) {
+					real_t jp = j_p[k];
+					real_t jq = j_q[k];
+
+					j_p[k] = c * jp - s * jq;
+					j_q[k] = s * jp + c * jq;
+				}
+			}
+		}
+
+		if (!rotated) {
+			break;
+		}
+	}
+}
+
+bool MLPPLinAlg::_cholesky_attempt(const Ref<MLPPMatrix> &A, real_t sign) {
+	ERR_FAIL_COND_V(!A.is_valid(), false);
+
+	Size2i a_size = A->size();
+	int n = a_size.y;
+
+	ERR_FAIL_COND_V(a_size.x != a_size.y, false);
+
+	if (n == 0) {
+		return false;
+	}
+
+	const real_t *a_ptr = A->ptr();
+
+	real_t max_diag = 0;
+	for (int i = 0; i < n; ++i) {
+		max_diag = MAX(max_diag, ABS(a_ptr[i * n + i]));
+	}
+
+	// Pivots below this are treated as zero, so (numerically) semidefinite matrices are rejected.
+	real_t tol = n * std::numeric_limits<real_t>::epsilon() * max_diag;
+
+	// Only the lower triangle of L is used. Row i only depends on the rows above it,
+	// so an indefinite matrix gets rejected at the first bad pivot.
+	Ref<MLPPMatrix> L;
+	L.instance();
+	L->resize(a_size);
+	real_t *l_ptr = L->ptrw();
+
+	for (int i = 0; i < n; ++i) {
+		const real_t *a_row_i = a_ptr + i * n;
+		real_t *l_row_i = l_ptr + i * n;
+
+		for (int j = 0; j < i; ++j) {
+			const real_t *l_row_j = l_ptr + j * n;
+
+			real_t sum = sign * a_row_i[j];
+			for (int k = 0; k < j; ++k) {
+				sum -= l_row_i[k] * l_row_j[k];
+			}
+
+			l_row_i[j] = sum / l_row_j[j];
+		}
+
+		real_t d = sign * a_row_i[i];
+		for (int k = 0; k < i; ++k) {
+			d -= l_row_i[k] * l_row_i[k];
+		}
+
+		if (d <= tol) {
+			return false;
+		}
+
+		l_row_i[i] = Math::sqrt(d);
+	}
+
+	return true;
+}
+
+bool MLPPLinAlg::_incomplete_cholesky(const Ref<MLPPMatrix> &A, Ref<MLPPMatrix> L) {
+	ERR_FAIL_COND_V(!A.is_valid() || !L.is_valid(), false);
+
+	Size2i a_size = A->size();
+	int n = a_size.y;
+
+	ERR_FAIL_COND_V(a_size.x != a_size.y, false);
+
+	if (unlikely(L->size() != a_size)) {
+		L->resize(a_size);
+	}
+
+	const real_t *a_ptr = A->ptr();
+	real_t *l_ptr = L->ptrw();
+
+	// Lower triangle of A
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			int ind = L->calculate_index(i, j);
+			l_ptr[ind] = j <= i ? a_ptr[ind] : 0;
+		}
+	}
+
+	for (int k = 0; k < n; ++k) {
+		real_t *l_row_k = l_ptr + L->calculate_index(k, 0);
+
+		if (l_row_k[k] <= 0) {
+			return false;
+		}
+
+		l_row_k[k] = Math::sqrt(l_row_k[k]);
+		real_t l_kk_inv = 1 / l_row_k[k];
+
+		for (int i = k + 1; i < n; ++i) {
+			real_t &l_ik = l_ptr[L->calculate_index(i, k)];
+
+			if (l_ik != 0) {
+				l_ik *= l_kk_inv;
+			}
+		}
+
+		// Only update entries that are already in the sparsity pattern.
+		for (int i = k + 1; i < n; ++i) {
+			real_t *l_row_i = l_ptr + L->calculate_index(i, 0);
+			real_t l_ik = l_row_i[k];
+
+			if (l_ik == 0) {
+				continue;
+			}
+
+			for (int j = k + 1; j <= i; ++j) {
+				if (l_row_i[j] != 0) {
+					l_row_i[j] -= l_ik * l_ptr[L->calculate_index(j, k)];
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+void MLPPLinAlg::_cholesky_solve(const Ref<MLPPMatrix> &L, const Ref<MLPPVector> &r, Ref<MLPPVector> out) {
+	int n = L->size().y;
+
+	if (unlikely(out->size() != n)) {
+		out->resize(n);
+	}
+
+	const real_t *l_ptr = L->ptr();
+	const real_t *r_ptr = r->ptr();
+	real_t *out_ptr = out->ptrw();
+
+	// Forward substitution: L * y = r
+	for (int i = 0; i < n; ++i) {
+		const real_t *l_row_i = l_ptr + L->calculate_index(i, 0);
+
+		real_t sum = r_ptr[i];
+		for (int j = 0; j < i; ++j) {
+			sum -= l_row_i[j] * out_ptr[j];
+		}
+
+		out_ptr[i] = sum / l_row_i[i];
+	}
+
+	// Back substitution: L^T * x = y
+	for (int i = n - 1; i >= 0; --i) {
+		out_ptr[i] /= l_ptr[L->calculate_index(i, i)];
+
+		real_t xi = out_ptr[i];
+		const real_t *l_row_i = l_ptr + L->calculate_index(i, 0);
+
+		for (int j = 0; j < i; ++j) {
+			out_ptr[j] -= l_row_i[j] * xi;
+		}
+	}
+}
+
 void MLPPLinAlg::_bind_methods() {
 }
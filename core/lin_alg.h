@@ -54,8 +54,13 @@ public:
 	// MATRIX FUNCTIONS
 
 	Ref<MLPPMatrix> gram_matrix(const Ref<MLPPMatrix> &A);
+	// True if the rows of A are linearly independent.
 	bool linear_independence_checker(const Ref<MLPPMatrix> &A);
 
+	// Numerical rank, using Householder QR with column pivoting. Stops as soon as the remaining columns are negligible.
+	// tolerance < 0 means max(m, n) * epsilon * |R_00| (same as numpy's matrix_rank).
+	int rank(const Ref<MLPPMatrix> &A, real_t tolerance = -1);
+
 	Ref<MLPPMatrix> gaussian_noise(int n, int m);
 
 	Ref<MLPPMatrix> additionnm(const Ref<MLPPMatrix> &A, const Ref<MLPPMatrix> &B);
@@ -126,6 +131,10 @@ public:
 
 	SVDResult svd(const Ref<MLPPMatrix> &A);
 
+	// Truncated SVD using a randomized range finder (Halko, Martinsson, Tropp).
+	// Only the top rank singular triplets are computed: U is (m x rank), S is (rank x rank), Vt is (rank x n).
+	SVDResult randomized_svd(const Ref<MLPPMatrix> &A, int rank, int oversampling = 10, int power_iterations = 2);
+
 	Ref<MLPPVector> vector_projection(const Ref<MLPPVector> &a, const Ref<MLPPVector> &b);
 
 	Ref<MLPPMatrix> gram_schmidt_process(const Ref<MLPPMatrix> &A);
@@ -147,11 +156,88 @@ public:
 	//real_t sum_elements(std::vector<std::vector<real_t>> A);
 
 	Ref<MLPPVector> flattenvvnv(const Ref<MLPPMatrix> &A);
-	Ref<MLPPVector> solve(const Ref<MLPPMatrix> &A, const Ref<MLPPVector> &b);
 
+	// Matrix-free operator interface for the iterative solvers.
+	// Only mult_vec() is mandatory, the rest is needed by lsqr() and the preconditioners.
+	class LinearOperator {
+	public:
+		virtual Size2i size() const = 0;
+
+		// out = A * x
+		virtual void mult_vec(const Ref<MLPPVector> &x, Ref<MLPPVector> out) const = 0;
+		// out = A^T * x
+		virtual void mult_vec_transposed(const Ref<MLPPVector> &x, Ref<MLPPVector> out) const;
+
+		// Returns false if the diagonal is not available.
+		virtual bool diagonal_get(Ref<MLPPVector> out) const;
+		// Returns an invalid reference if the operator is not backed by a matrix.
+		virtual Ref<MLPPMatrix> matrix_get() const;
+
+		virtual ~LinearOperator() {}
+	};
+
+	class MatrixLinearOperator : public LinearOperator {
+	public:
+		Size2i size() const;
+
+		void mult_vec(const Ref<MLPPVector> &x, Ref<MLPPVector> out) const;
+		void mult_vec_transposed(const Ref<MLPPVector> &x, Ref<MLPPVector> out) const;
+
+		bool diagonal_get(Ref<MLPPVector> out) const;
+		Ref<MLPPMatrix> matrix_get() const;
+
+		MatrixLinearOperator(const Ref<MLPPMatrix> &p_A);
+
+	protected:
+		Ref<MLPPMatrix> _A;
+	};
+
+	enum PreconditionerType {
+		PRECONDITIONER_NONE = 0,
+		PRECONDITIONER_JACOBI,
+		// IC(0), needs an operator that is backed by a matrix.
+		PRECONDITIONER_INCOMPLETE_CHOLESKY,
+	};
+
+	struct IterativeSolverResult {
+		Ref<MLPPVector> x;
+		int iterations;
+		real_t residual_norm;
+		bool converged;
+
+		IterativeSolverResult() {
+			iterations = 0;
+			residual_norm = 0;
+			converged = false;
+		}
+	};
+
+	// Preconditioned conjugate gradient, A has to be symmetric positive definite.
+	// x0 is used as the initial guess if valid (warm start). max_iterations <= 0 means the size of the system.
+	IterativeSolverResult conjugate_gradient(const LinearOperator &A, const Ref<MLPPVector> &b, const Ref<MLPPVector> &x0 = Ref<MLPPVector>(), PreconditionerType preconditioner = PRECONDITIONER_NONE, real_t tolerance = 1e-6, int max_iterations = 0);
+	IterativeSolverResult conjugate_gradientm(const Ref<MLPPMatrix> &A, const Ref<MLPPVector> &b, const Ref<MLPPVector> &x0 = Ref<MLPPVector>(), PreconditionerType preconditioner = PRECONDITIONER_NONE, real_t tolerance = 1e-6, int max_iterations = 0);
+
+	// LSQR (Paige, Saunders). Minimizes ||A * x - b||^2 + damp^2 * ||x||^2 without forming A^T * A,
+	// so damp = sqrt(lambda) gives ridge regression. max_iterations <= 0 means 2 * the number of columns.
+	IterativeSolverResult lsqr(const LinearOperator &A, const Ref<MLPPVector> &b, real_t damp = 0, real_t tolerance = 1e-6, int max_iterations = 0);
+	IterativeSolverResult lsqrm(const Ref<MLPPMatrix> &A, const Ref<MLPPVector> &b, real_t damp = 0, real_t tolerance = 1e-6, int max_iterations = 0);
+
+	enum SolverType {
+		// Explicit inverse, small dense systems only.
+		SOLVER_INVERSE = 0,
+		// conjugate_gradientm() with the Jacobi preconditioner, A has to be symmetric positive definite.
+		SOLVER_CONJUGATE_GRADIENT,
+		// lsqrm(), also works for non square (least squares) systems.
+		SOLVER_LSQR,
+	};
+
+	Ref<MLPPVector> solve(const Ref<MLPPMatrix> &A, const Ref<MLPPVector> &b, SolverType solver = SOLVER_INVERSE);
+
+	// A has to be symmetric. These attempt a Cholesky factorization, and return as soon as a pivot fails.
 	bool positive_definite_checker(const Ref<MLPPMatrix> &A);
 	bool negative_definite_checker(const Ref<MLPPMatrix> &A);
 
+	// True if A is singular (has a (numerically) zero eigenvalue).
 	bool zero_eigenvalue(const Ref<MLPPMatrix> &A);
 
 	// VECTOR FUNCTIONS
@@ -254,6 +340,38 @@ public:
 	//std::vector<std::vector<std::vector<real_t>>> vector_wise_tensor_product(std::vector<std::vector<std::vector<real_t>>> A, std::vector<std::vector<real_t>> B);
 
 protected:
+	struct MultABtData {
+		const MLPPMatrix *a;
+		const MLPPMatrix *bt;
+		MLPPMatrix *out;
+	};
+
+	struct OrthonormalizeRowsData {
+		MLPPMatrix *a;
+		// The row that is currently orthogonalized against all rows before it.
+		int row_index;
+		real_t *projections;
+	};
+
+	// out = (A * Bt^T)^T, streams over the rows of A only once, in parallel.
+	void _mult_abt_transposed(const Ref<MLPPMatrix> &A, const Ref<MLPPMatrix> &Bt, Ref<MLPPMatrix> out);
+	void _mult_abt_transposed_range(int p_from, int p_to, MultABtData *p_data);
+	// Gram-Schmidt (classical, run twice) over the rows of A.
+	void _orthonormalize_rows(Ref<MLPPMatrix> A);
+	// projections[j] = row_index . row_j
+	void _orthonormalize_projections_range(int p_from, int p_to, OrthonormalizeRowsData *p_data);
+	// row_index -= sum(projections[j] * row_j), over the columns [p_from, p_to).
+	void _orthonormalize_subtract_range(int p_from, int p_to, OrthonormalizeRowsData *p_data);
+	// One-sided Jacobi on the rows of A. Applies the same rotations to J.
+	void _one_sided_jacobi_rows(Ref<MLPPMatrix> A, Ref<MLPPMatrix> J);
+
+	// Computes the IC(0) factor L of A (same sparsity pattern as A). Returns false if it broke down.
+	bool _incomplete_cholesky(const Ref<MLPPMatrix> &A, Ref<MLPPMatrix> L);
+	// Solves L * L^T * out = r
+	void _cholesky_solve(const Ref<MLPPMatrix> &L, const Ref<MLPPVector> &r, Ref<MLPPVector> out);
+	// Tries to Cholesky factorize sign * A (row by row), returns false at the first pivot that is not clearly positive.
+	bool _cholesky_attempt(const Ref<MLPPMatrix> &A, real_t sign);
+
 	static void _bind_methods();
 };
 
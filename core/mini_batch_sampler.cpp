@@ -0,0 +1,387 @@
+/*************************************************************************/
+/*  mini_batch_sampler.cpp                                               */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "mini_batch_sampler.h"
+
+#include <algorithm>
+
+// Gathering smaller batches is cheaper than starting a thread.
+static const int PREFETCH_MIN_ELEMENTS = 16384;
+
+uint32_t MLPPMiniBatchSampler::_default_seed = 0;
+
+void MLPPMiniBatchSampler::setupm(const Ref<MLPPMatrix> &p_input_set, const int p_batch_size) {
+	_setup(p_input_set, Ref<MLPPVector>(), Ref<MLPPMatrix>(), p_batch_size);
+}
+void MLPPMiniBatchSampler::setupmv(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_set, const int p_batch_size) {
+	ERR_FAIL_COND(!p_output_set.is_valid());
+
+	_setup(p_input_set, p_output_set, Ref<MLPPMatrix>(), p_batch_size);
+}
+void MLPPMiniBatchSampler::setupmm(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPMatrix> &p_output_set, const int p_batch_size) {
+	ERR_FAIL_COND(!p_output_set.is_valid());
+
+	_setup(p_input_set, Ref<MLPPVector>(), p_output_set, p_batch_size);
+}
+
+void MLPPMiniBatchSampler::reset() {
+	_finish_prefetch();
+
+	_input_set.unref();
+	_output_vector.unref();
+	_output_matrix.unref();
+
+	_order.clear();
+
+	for (int i = 0; i < 2; ++i) {
+		_buffers[i].input->reset();
+		_buffers[i].output_vector->reset();
+		_buffers[i].output_matrix->reset();
+	}
+
+	_views.input->reset();
+	_views.output_vector->reset();
+	_views.output_matrix->reset();
+
+	_current_buffer = -1;
+	_batch_index = -1;
+}
+
+bool MLPPMiniBatchSampler::get_shuffle() const {
+	return _shuffle;
+}
+void MLPPMiniBatchSampler::set_shuffle(const bool val) {
+	_finish_prefetch();
+
+	_shuffle = val;
+	_batch_index = -1;
+}
+
+bool MLPPMiniBatchSampler::get_prefetch() const {
+	return _prefetch;
+}
+void MLPPMiniBatchSampler::set_prefetch(const bool val) {
+	_prefetch = val;
+}
+
+int MLPPMiniBatchSampler::get_batch_size() const {
+	return _batch_size;
+}
+int MLPPMiniBatchSampler::get_batch_count() const {
+	if (_batch_size <= 0) {
+		return 0;
+	}
+
+	return (_order.size() + _batch_size - 1) / _batch_size;
+}
+int MLPPMiniBatchSampler::get_batch_index() const {
+	return _batch_index;
+}
+
+void MLPPMiniBatchSampler::begin_epoch() {
+	ERR_FAIL_COND(!_input_set.is_valid());
+
+	_finish_prefetch();
+
+	if (_shuffle) {
+		int *order = _order.ptrw();
+		std::shuffle(order, order + _order.size(), _generator);
+	}
+
+	_batch_index = -1;
+
+	if (_shuffle && get_batch_count() > 0 && _should_prefetch()) {
+		_start_prefetch(0);
+	}
+}
+
+bool MLPPMiniBatchSampler::next() {
+	ERR_FAIL_COND_V(!_input_set.is_valid(), false);
+
+	int batch_count = get_batch_count();
+	int batch_index = _batch_index + 1;
+
+	if (batch_index >= batch_count) {
+		return false;
+	}
+
+	_batch_index = batch_index;
+
+	if (!_shuffle) {
+		_set_views(batch_index);
+		return true;
+	}
+
+	if (_prefetch_batch_index == batch_index) {
+		int buffer = _prefetch_buffer;
+		_finish_prefetch();
+		_current_buffer = buffer;
+	} else {
+		_finish_prefetch();
+		_current_buffer = _current_buffer == 0 ? 1 : 0;
+		_gather(batch_index, _buffers[_current_buffer]);
+	}
+
+	if (batch_index + 1 < batch_count && _should_prefetch()) {
+		_start_prefetch(batch_index + 1);
+	}
+
+	return true;
+}
+
+Ref<MLPPMatrix> MLPPMiniBatchSampler::get_input() const {
+	if (!_shuffle) {
+		return _views.input;
+	}
+
+	ERR_FAIL_COND_V(_current_buffer < 0, Ref<MLPPMatrix>());
+
+	return _buffers[_current_buffer].input;
+}
+Ref<MLPPVector> MLPPMiniBatchSampler::get_output_vector() const {
+	if (!_shuffle) {
+		return _views.output_vector;
+	}
+
+	ERR_FAIL_COND_V(_current_buffer < 0, Ref<MLPPVector>());
+
+	return _buffers[_current_buffer].output_vector;
+}
+Ref<MLPPMatrix> MLPPMiniBatchSampler::get_output_matrix() const {
+	if (!_shuffle) {
+		return _views.output_matrix;
+	}
+
+	ERR_FAIL_COND_V(_current_buffer < 0, Ref<MLPPMatrix>());
+
+	return _buffers[_current_buffer].output_matrix;
+}
+
+void MLPPMiniBatchSampler::set_default_seed(const uint32_t p_seed) {
+	_default_seed = p_seed;
+}
+uint32_t MLPPMiniBatchSampler::get_default_seed() {
+	return _default_seed;
+}
+
+MLPPMiniBatchSampler::MLPPMiniBatchSampler() {
+	_batch_size = 0;
+	_shuffle = true;
+	_prefetch = true;
+
+	for (int i = 0; i < 2; ++i) {
+		_buffers[i].input.instance();
+		_buffers[i].output_vector.instance();
+		_buffers[i].output_matrix.instance();
+	}
+
+	_views.input.instance();
+	_views.output_vector.instance();
+	_views.output_matrix.instance();
+
+	_current_buffer = -1;
+	_batch_index = -1;
+
+	_prefetch_buffer = -1;
+	_prefetch_batch_index = -1;
+}
+
+MLPPMiniBatchSampler::~MLPPMiniBatchSampler() {
+	_finish_prefetch();
+}
+
+void MLPPMiniBatchSampler::_setup(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_vector, const Ref<MLPPMatrix> &p_output_matrix, const int p_batch_size) {
+	ERR_FAIL_COND(!p_input_set.is_valid());
+	ERR_FAIL_COND(p_batch_size <= 0);
+
+	int row_count = p_input_set->size().y;
+
+	ERR_FAIL_COND(p_output_vector.is_valid() && p_output_vector->size() != row_count);
+	ERR_FAIL_COND(p_output_matrix.is_valid() && p_output_matrix->size().y != row_count);
+
+	reset();
+
+	_input_set = p_input_set;
+	_output_vector = p_output_vector;
+	_output_matrix = p_output_matrix;
+	_batch_size = p_batch_size;
+
+	_order.resize(row_count);
+	int *order = _order.ptrw();
+
+	for (int i = 0; i < row_count; ++i) {
+		order[i] = i;
+	}
+
+	if (_default_seed != 0) {
+		_generator.seed(_default_seed);
+	} else {
+		std::random_device rd;
+		_generator.seed(rd());
+	}
+}
+
+void MLPPMiniBatchSampler::_gather(const int p_batch_index, Buffer &r_buffer) const {
+	int from = p_batch_index * _batch_size;
+	int row_count = MIN(_batch_size, _order.size() - from);
+	const int *order = _order.ptr();
+
+	int input_columns = _input_set->size().x;
+	Size2i input_size = Size2i(input_columns, row_count);
+
+	if (r_buffer.input->size() != input_size) {
+		r_buffer.input->resize(input_size);
+	}
+
+	const real_t *input_ptr = _input_set->ptr();
+	real_t *batch_input_ptr = r_buffer.input->ptrw();
+
+	for (int i = 0; i < row_count; ++i) {
+		memcpy(batch_input_ptr + i * input_columns, input_ptr + order[from + i] * input_columns, sizeof(real_t) * input_columns);
+	}
+
+	if (_output_vector.is_valid()) {
+		if (r_buffer.output_vector->size() != row_count) {
+			r_buffer.output_vector->resize(row_count);
+		}
+
+		const real_t *output_ptr = _output_vector->ptr();
+		real_t *batch_output_ptr = r_buffer.output_vector->ptrw();
+
+		for (int i = 0; i < row_count; ++i) {
+			batch_output_ptr[i] = output_ptr[order[from + i]];
+		}
+	}
+
+	if (_output_matrix.is_valid()) {
+		int output_columns = _output_matrix->size().x;
+		Size2i output_size = Size2i(output_columns, row_count);
+
+		if (r_buffer.output_matrix->size() != output_size) {
+			r_buffer.output_matrix->resize(output_size);
+		}
+
+		const real_t *output_ptr = _output_matrix->ptr();
+		real_t *batch_output_ptr = r_buffer.output_matrix->ptrw();
+
+		for (int i = 0; i < row_count; ++i) {
+			memcpy(batch_output_ptr + i * output_columns, output_ptr + order[from + i] * output_columns, sizeof(real_t) * output_columns);
+		}
+	}
+}
+
+void MLPPMiniBatchSampler::_set_views(const int p_batch_index) {
+	int from = p_batch_index * _batch_size;
+	int row_count = MIN(_batch_size, _order.size() - from);
+
+	// The views never get written, the data set stays unchanged.
+	int input_columns = _input_set->size().x;
+	_views.input->set_view(const_cast<real_t *>(_input_set->ptr()) + from * input_columns, Size2i(input_columns, row_count));
+
+	if (_output_vector.is_valid()) {
+		_views.output_vector->set_view(const_cast<real_t *>(_output_vector->ptr()) + from, row_count);
+	}
+
+	if (_output_matrix.is_valid()) {
+		int output_columns = _output_matrix->size().x;
+		_views.output_matrix->set_view(const_cast<real_t *>(_output_matrix->ptr()) + from * output_columns, Size2i(output_columns, row_count));
+	}
+}
+
+bool MLPPMiniBatchSampler::_should_prefetch() const {
+#ifdef NO_THREADS
+	return false;
+#else
+	if (!_prefetch) {
+		return false;
+	}
+
+	int columns = _input_set->size().x;
+
+	if (_output_matrix.is_valid()) {
+		columns += _output_matrix->size().x;
+	} else if (_output_vector.is_valid()) {
+		columns += 1;
+	}
+
+	return _batch_size * columns >= PREFETCH_MIN_ELEMENTS;
+#endif
+}
+
+void MLPPMiniBatchSampler::_start_prefetch(const int p_batch_index) {
+	// The buffer that the current batch does not use.
+	_prefetch_buffer = _current_buffer == 0 ? 1 : 0;
+	_prefetch_batch_index = p_batch_index;
+
+	_thread.start(&MLPPMiniBatchSampler::_prefetch_thread_func, this);
+}
+
+void MLPPMiniBatchSampler::_finish_prefetch() {
+	if (_prefetch_batch_index == -1) {
+		return;
+	}
+
+	_thread.wait_to_finish();
+
+	_prefetch_buffer = -1;
+	_prefetch_batch_index = -1;
+}
+
+void MLPPMiniBatchSampler::_prefetch_thread_func(void *p_userdata) {
+	MLPPMiniBatchSampler *self = static_cast<MLPPMiniBatchSampler *>(p_userdata);
+
+	self->_gather(self->_prefetch_batch_index, self->_buffers[self->_prefetch_buffer]);
+}
+
+void MLPPMiniBatchSampler::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("setupm", "input_set", "batch_size"), &MLPPMiniBatchSampler::setupm);
+	ClassDB::bind_method(D_METHOD("setupmv", "input_set", "output_set", "batch_size"), &MLPPMiniBatchSampler::setupmv);
+	ClassDB::bind_method(D_METHOD("setupmm", "input_set", "output_set", "batch_size"), &MLPPMiniBatchSampler::setupmm);
+	ClassDB::bind_method(D_METHOD("reset"), &MLPPMiniBatchSampler::reset);
+
+	ClassDB::bind_method(D_METHOD("get_shuffle"), &MLPPMiniBatchSampler::get_shuffle);
+	ClassDB::bind_method(D_METHOD("set_shuffle", "val"), &MLPPMiniBatchSampler::set_shuffle);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "shuffle"), "set_shuffle", "get_shuffle");
+
+	ClassDB::bind_method(D_METHOD("get_prefetch"), &MLPPMiniBatchSampler::get_prefetch);
+	ClassDB::bind_method(D_METHOD("set_prefetch", "val"), &MLPPMiniBatchSampler::set_prefetch);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "prefetch"), "set_prefetch", "get_prefetch");
+
+	ClassDB::bind_method(D_METHOD("get_batch_size"), &MLPPMiniBatchSampler::get_batch_size);
+	ClassDB::bind_method(D_METHOD("get_batch_count"), &MLPPMiniBatchSampler::get_batch_count);
+	ClassDB::bind_method(D_METHOD("get_batch_index"), &MLPPMiniBatchSampler::get_batch_index);
+
+	ClassDB::bind_method(D_METHOD("begin_epoch"), &MLPPMiniBatchSampler::begin_epoch);
+	ClassDB::bind_method(D_METHOD("next"), &MLPPMiniBatchSampler::next);
+
+	ClassDB::bind_method(D_METHOD("get_input"), &MLPPMiniBatchSampler::get_input);
+	ClassDB::bind_method(D_METHOD("get_output_vector"), &MLPPMiniBatchSampler::get_output_vector);
+	ClassDB::bind_method(D_METHOD("get_output_matrix"), &MLPPMiniBatchSampler::get_output_matrix);
+}
@@ -0,0 +1,147 @@
+#ifndef MLPP_MINI_BATCH_SAMPLER_H
+#define MLPP_MINI_BATCH_SAMPLER_H
+
+/*************************************************************************/
+/*  mini_batch_sampler.h                                                 */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifdef USING_SFW
+#include "sfw.h"
+#else
+#include "core/containers/vector.h"
+#include "core/math/math_defs.h"
+#include "core/os/thread.h"
+
+#include "core/object/reference.h"
+#endif
+
+#include "../core/mlpp_matrix.h"
+#include "../core/mlpp_vector.h"
+
+#include <random>
+
+// Iterates over a data set in mini-batches, in a new random row order every epoch.
+// Nothing is copied up front: every batch is gathered from the shuffled rows into one of two buffers,
+// and bigger batches are gathered on a background thread, while the previous one is in use.
+// The last batch of an epoch gets the remaining rows, so it can be smaller than the rest.
+//
+// sampler->begin_epoch();
+// while (sampler->next()) {
+//     Ref<MLPPMatrix> input = sampler->get_input();
+//     ...
+// }
+class MLPPMiniBatchSampler : public Reference {
+	GDCLASS(MLPPMiniBatchSampler, Reference);
+
+public:
+	// Input only, input with a vector of outputs, input with a matrix of outputs.
+	void setupm(const Ref<MLPPMatrix> &p_input_set, const int p_batch_size);
+	void setupmv(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_set, const int p_batch_size);
+	void setupmm(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPMatrix> &p_output_set, const int p_batch_size);
+
+	// Waits for the background thread, and lets go of the data set and the buffers.
+	void reset();
+
+	// Without shuffling, batches are views of consecutive rows of the data set, nothing is copied.
+	// Batches are read only either way.
+	bool get_shuffle() const;
+	void set_shuffle(const bool val);
+
+	// Whether big enough batches get gathered on a background thread.
+	bool get_prefetch() const;
+	void set_prefetch(const bool val);
+
+	int get_batch_size() const;
+	// Number of batches in an epoch.
+	int get_batch_count() const;
+	// Index of the current batch in the epoch, -1 before the first next().
+	int get_batch_index() const;
+
+	// Shuffles the rows, and starts gathering the first batch.
+	void begin_epoch();
+	// Moves to the next batch. Returns false once the epoch is over.
+	bool next();
+
+	// The current batch. The buffers are reused, so these are only valid until the next next() call.
+	Ref<MLPPMatrix> get_input() const;
+	Ref<MLPPVector> get_output_vector() const;
+	Ref<MLPPMatrix> get_output_matrix() const;
+
+	// Seed for the samplers that get set up afterwards. 0 (the default) seeds them from std::random_device.
+	// Lets tests get the same batch order in two runs.
+	static void set_default_seed(const uint32_t p_seed);
+	static uint32_t get_default_seed();
+
+	MLPPMiniBatchSampler();
+	~MLPPMiniBatchSampler();
+
+protected:
+	struct Buffer {
+		Ref<MLPPMatrix> input;
+		Ref<MLPPVector> output_vector;
+		Ref<MLPPMatrix> output_matrix;
+	};
+
+	void _setup(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_vector, const Ref<MLPPMatrix> &p_output_matrix, const int p_batch_size);
+	void _gather(const int p_batch_index, Buffer &r_buffer) const;
+	void _set_views(const int p_batch_index);
+
+	bool _should_prefetch() const;
+	void _start_prefetch(const int p_batch_index);
+	void _finish_prefetch();
+	static void _prefetch_thread_func(void *p_userdata);
+
+	static void _bind_methods();
+
+	Ref<MLPPMatrix> _input_set;
+	Ref<MLPPVector> _output_vector;
+	Ref<MLPPMatrix> _output_matrix;
+
+	int _batch_size;
+	bool _shuffle;
+	bool _prefetch;
+
+	Vector<int> _order;
+	std::default_random_engine _generator;
+
+	Buffer _buffers[2];
+	int _current_buffer;
+	int _batch_index;
+
+	// Used when not shuffling.
+	Buffer _views;
+
+	Thread _thread;
+	int _prefetch_buffer;
+	int _prefetch_batch_index;
+
+	static uint32_t _default_seed;
+};
+
+#endif
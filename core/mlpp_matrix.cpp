@@ -36,6 +36,7 @@
 #include "core/io/image.h"
 #endif
 
+#include "../core/parallel.h"
 #include "../core/stat.h"
 #include <random>
 
@@ -95,6 +96,10 @@ void MLPPMatrix::row_add(const Vector<real_t> &p_row) {
 
 	ERR_FAIL_COND(_size.x != p_row.size());
 
+	if (_is_view) {
+		detach_view();
+	}
+
 	int ci = data_size();
 
 	++_size.y;
@@ -120,6 +125,10 @@ void MLPPMatrix::row_add_pool_vector(const PoolRealArray &p_row) {
 
 	ERR_FAIL_COND(_size.x != p_row.size());
 
+	if (_is_view) {
+		detach_view();
+	}
+
 	int ci = data_size();
 
 	++_size.y;
@@ -150,6 +159,10 @@ void MLPPMatrix::row_add_mlpp_vector(const Ref<MLPPVector> &p_row) {
 
 	ERR_FAIL_COND(_size.x != p_row_size);
 
+	if (_is_view) {
+		detach_view();
+	}
+
 	int ci = data_size();
 
 	++_size.y;
@@ -181,6 +194,10 @@ void MLPPMatrix::rows_add_mlpp_matrix(const Ref<MLPPMatrix> &p_other) {
 
 	ERR_FAIL_COND(other_size.x != _size.x);
 
+	if (_is_view) {
+		detach_view();
+	}
+
 	int start_offset = data_size();
 
 	_size.y += other_size.y;
@@ -198,6 +215,10 @@ void MLPPMatrix::rows_add_mlpp_matrix(const Ref<MLPPMatrix> &p_other) {
 void MLPPMatrix::row_remove(int p_index) {
 	ERR_FAIL_INDEX(p_index, _size.y);
 
+	if (_is_view) {
+		detach_view();
+	}
+
 	--_size.y;
 
 	int ds = data_size();
@@ -221,6 +242,10 @@ void MLPPMatrix::row_remove(int p_index) {
 void MLPPMatrix::row_remove_unordered(int p_index) {
 	ERR_FAIL_INDEX(p_index, _size.y);
 
+	if (_is_view) {
+		detach_view();
+	}
+
 	--_size.y;
 
 	int ds = data_size();
@@ -257,6 +282,14 @@ void MLPPMatrix::row_swap(int p_index_1, int p_index_2) {
 }
 
 void MLPPMatrix::resize(const Size2i &p_size) {
+	if (_is_view) {
+		if (p_size == _size) {
+			return;
+		}
+
+		detach_view();
+	}
+
 	_size = p_size;
 
 	int ds = data_size();
@@ -274,6 +307,43 @@ void MLPPMatrix::resize(const Size2i &p_size) {
 	CRASH_COND_MSG(!_data, "Out of memory");
 }
 
+void MLPPMatrix::set_view(real_t *p_data, const Size2i &p_size) {
+	ERR_FAIL_COND(p_size.x < 0 || p_size.y < 0);
+	ERR_FAIL_COND(p_size.x * p_size.y > 0 && !p_data);
+
+	reset();
+
+	if (p_size.x * p_size.y == 0) {
+		return;
+	}
+
+	_data = p_data;
+	_size = p_size;
+	_is_view = true;
+}
+
+void MLPPMatrix::detach_view() {
+	if (!_is_view) {
+		return;
+	}
+
+	_is_view = false;
+
+	int ds = data_size();
+
+	if (ds == 0) {
+		_data = NULL;
+		return;
+	}
+
+	real_t *data = (real_t *)memalloc(ds * sizeof(real_t));
+	CRASH_COND_MSG(!data, "Out of memory");
+
+	memcpy(data, _data, ds * sizeof(real_t));
+
+	_data = data;
+}
+
 Vector<real_t> MLPPMatrix::row_get_vector(int p_index_y) const {
 	ERR_FAIL_INDEX_V(p_index_y, _size.y, Vector<real_t>());
 
@@ -592,8 +662,6 @@ void MLPPMatrix::set_from_arrays(const Array &p_from) {
 }
 
 void MLPPMatrix::set_from_ptr(const real_t *p_from, const int p_size_y, const int p_size_x) {
-	_data = NULL;
-
 	ERR_FAIL_COND(!p_from);
 
 	resize(Size2i(p_size_x, p_size_y));
@@ -877,6 +945,69 @@ void MLPPMatrix::multb(const Ref<MLPPMatrix> &A, const Ref<MLPPMatrix> &B) {
 	}
 }
 
+void MLPPMatrix::mult_transposed_a_add(const Ref<MLPPMatrix> &A, const Ref<MLPPMatrix> &B) {
+	ERR_FAIL_COND(!A.is_valid() || !B.is_valid());
+
+	Size2i a_size = A->size();
+	Size2i b_size = B->size();
+
+	ERR_FAIL_COND(a_size.y != b_size.y);
+	ERR_FAIL_COND(_size != Size2i(b_size.x, a_size.x));
+
+	const real_t *a_ptr = A->ptr();
+	const real_t *b_ptr = B->ptr();
+	real_t *r_ptr = ptrw();
+
+	for (int n = 0; n < a_size.y; ++n) {
+		const real_t *a_row = a_ptr + n * a_size.x;
+		const real_t *b_row = b_ptr + n * b_size.x;
+
+		for (int i = 0; i < a_size.x; ++i) {
+			real_t av = a_row[i];
+
+			if (av == 0) {
+				continue;
+			}
+
+			real_t *r_row = r_ptr + i * b_size.x;
+
+			for (int j = 0; j < b_size.x; ++j) {
+				r_row[j] += av * b_row[j];
+			}
+		}
+	}
+}
+
+void MLPPMatrix::mult_transposed_b_add(const Ref<MLPPMatrix> &A, const Ref<MLPPMatrix> &B) {
+	ERR_FAIL_COND(!A.is_valid() || !B.is_valid());
+
+	Size2i a_size = A->size();
+	Size2i b_size = B->size();
+
+	ERR_FAIL_COND(a_size.x != b_size.x);
+	ERR_FAIL_COND(_size != Size2i(b_size.y, a_size.y));
+
+	const real_t *a_ptr = A->ptr();
+	const real_t *b_ptr = B->ptr();
+	real_t *r_ptr = ptrw();
+
+	for (int i = 0; i < a_size.y; ++i) {
+		const real_t *a_row = a_ptr + i * a_size.x;
+		real_t *r_row = r_ptr + i * b_size.y;
+
+		for (int j = 0; j < b_size.y; ++j) {
+			const real_t *b_row = b_ptr + j * b_size.x;
+
+			real_t s = 0;
+			for (int k = 0; k < a_size.x; ++k) {
+				s += a_row[k] * b_row[k];
+			}
+
+			r_row[j] += s;
+		}
+	}
+}
+
 void MLPPMatrix::hadamard_product(const Ref<MLPPMatrix> &B) {
 	ERR_FAIL_COND(!B.is_valid());
 	ERR_FAIL_COND(_size != B->size());
@@ -1509,24 +1640,51 @@ void MLPPMatrix::cbrtb(const Ref<MLPPMatrix> &A) {
 }
 
 Ref<MLPPMatrix> MLPPMatrix::matrix_powern(const int n) const {
+	ERR_FAIL_COND_V(_size.x != _size.y, Ref<MLPPMatrix>());
+
 	if (n == 0) {
 		return identity_mat(_size.y);
 	}
 
-	Ref<MLPPMatrix> A = Ref<MLPPMatrix>(this);
-	Ref<MLPPMatrix> B = identity_mat(_size.y);
+	// Exponentiation by squaring. The products are written into tmp, and then
+	// the buffers are swapped, so only 3 matrices get allocated regardless of n.
+	Ref<MLPPMatrix> base;
 
 	if (n < 0) {
-		A = inverse();
+		base = inverse();
+	} else {
+		base = duplicate_fast();
 	}
 
-	int absn = ABS(n);
+	Ref<MLPPMatrix> result;
+	Ref<MLPPMatrix> tmp;
+	tmp.instance();
+	tmp->resize(_size);
+
+	// Avoid overflow on -INT_MIN
+	unsigned int e = n < 0 ? -static_cast<unsigned int>(n) : static_cast<unsigned int>(n);
+
+	while (true) {
+		if (e & 1) {
+			if (!result.is_valid()) {
+				result = base->duplicate_fast();
+			} else {
+				tmp->multb(result, base);
+				SWAP(result, tmp);
+			}
+		}
 
-	for (int i = 0; i < absn; i++) {
-		B->mult(A);
+		e >>= 1;
+
+		if (e == 0) {
+			break;
+		}
+
+		tmp->multb(base, base);
+		SWAP(base, tmp);
 	}
 
-	return B;
+	return result;
 }
 
 /*
@@ -2172,57 +2330,179 @@ Ref<MLPPMatrix> MLPPMatrix::create_identity_mat(int d) {
 }
 
 Ref<MLPPMatrix> MLPPMatrix::cov() const {
-	MLPPStat stat;
-
 	Ref<MLPPMatrix> cov_mat;
 	cov_mat.instance();
 
-	cov_mat->resize(_size);
+	covo(cov_mat);
 
-	Ref<MLPPVector> a_i_row_tmp;
-	a_i_row_tmp.instance();
-	a_i_row_tmp->resize(_size.x);
+	return cov_mat;
+}
+void MLPPMatrix::covo(Ref<MLPPMatrix> out) const {
+	ERR_FAIL_COND(!out.is_valid());
+
+	Size2i rs = Size2i(_size.y, _size.y);
+
+	if (unlikely(out->size() != rs)) {
+		out->resize(rs);
+	}
+
+	if (_size.y == 0) {
+		return;
+	}
 
-	Ref<MLPPVector> a_j_row_tmp;
-	a_j_row_tmp.instance();
-	a_j_row_tmp->resize(_size.x);
+	Vector<real_t> row_means;
+	row_means.resize(_size.y);
+	real_t *row_means_ptr = row_means.ptrw();
 
 	for (int i = 0; i < _size.y; ++i) {
-		row_get_into_mlpp_vector(i, a_i_row_tmp);
+		const real_t *row_ptr = _data + calculate_index(i, 0);
 
+		real_t sum = 0;
 		for (int j = 0; j < _size.x; ++j) {
-			row_get_into_mlpp_vector(j, a_j_row_tmp);
-
-			cov_mat->element_set(i, j, stat.covariancev(a_i_row_tmp, a_j_row_tmp));
+			sum += row_ptr[j];
 		}
+
+		row_means_ptr[i] = _size.x > 0 ? sum / _size.x : 0;
 	}
 
-	return cov_mat;
+	// Centering happens inside the kernel, the centered matrix is never materialized.
+	SYRKData data;
+	data.out = out.ptr();
+	data.row_means = row_means.ptr();
+	data.scale = _size.x > 1 ? static_cast<real_t>(1) / (_size.x - 1) : 0;
+
+	MLPPParallel::do_work((_size.y + 1) / 2, this, &MLPPMatrix::_row_gram_matrix_range, &data, 1 + 65536 / MAX(_size.x * _size.y, 1));
 }
-void MLPPMatrix::covo(Ref<MLPPMatrix> out) const {
+
+Ref<MLPPMatrix> MLPPMatrix::gram_matrixn() const {
+	Ref<MLPPMatrix> out;
+	out.instance();
+
+	gram_matrixo(out);
+
+	return out;
+}
+void MLPPMatrix::gram_matrixo(Ref<MLPPMatrix> out) const {
 	ERR_FAIL_COND(!out.is_valid());
 
-	MLPPStat stat;
+	Size2i rs = Size2i(_size.x, _size.x);
 
-	if (unlikely(out->size() != _size)) {
-		out->resize(_size);
+	if (unlikely(out->size() != rs)) {
+		out->resize(rs);
 	}
 
-	Ref<MLPPVector> a_i_row_tmp;
-	a_i_row_tmp.instance();
-	a_i_row_tmp->resize(_size.x);
+	SYRKData data;
+	data.out = out.ptr();
+	data.row_means = NULL;
+	data.scale = 1;
 
-	Ref<MLPPVector> a_j_row_tmp;
-	a_j_row_tmp.instance();
-	a_j_row_tmp->resize(_size.x);
+	MLPPParallel::do_work((_size.x + 1) / 2, this, &MLPPMatrix::_gram_matrix_range, &data, 1 + 65536 / MAX(_size.x * _size.y, 1));
+}
 
-	for (int i = 0; i < _size.y; ++i) {
-		row_get_into_mlpp_vector(i, a_i_row_tmp);
+Ref<MLPPMatrix> MLPPMatrix::row_gram_matrixn() const {
+	Ref<MLPPMatrix> out;
+	out.instance();
 
-		for (int j = 0; j < _size.x; ++j) {
-			row_get_into_mlpp_vector(j, a_j_row_tmp);
+	row_gram_matrixo(out);
+
+	return out;
+}
+void MLPPMatrix::row_gram_matrixo(Ref<MLPPMatrix> out) const {
+	ERR_FAIL_COND(!out.is_valid());
+
+	Size2i rs = Size2i(_size.y, _size.y);
+
+	if (unlikely(out->size() != rs)) {
+		out->resize(rs);
+	}
+
+	SYRKData data;
+	data.out = out.ptr();
+	data.row_means = NULL;
+	data.scale = 1;
+
+	MLPPParallel::do_work((_size.y + 1) / 2, this, &MLPPMatrix::_row_gram_matrix_range, &data, 1 + 65536 / MAX(_size.x * _size.y, 1));
+}
+
+void MLPPMatrix::_gram_matrix_range(int p_from, int p_to, SYRKData *p_data) const {
+	int n = _size.x;
+	real_t *out_ptr = p_data->out->ptrw();
+
+	for (int p = p_from; p < p_to; ++p) {
+		for (int pi = 0; pi < 2; ++pi) {
+			int i = pi == 0 ? p : n - 1 - p;
+
+			if (pi == 1 && i == p) {
+				break;
+			}
+
+			real_t *out_row_i = out_ptr + i * n;
+
+			for (int j = i; j < n; ++j) {
+				out_row_i[j] = 0;
+			}
 
-			out->element_set(i, j, stat.covariancev(a_i_row_tmp, a_j_row_tmp));
+			// out[i][j] = sum_k A[k][i] * A[k][j], A is walked row by row.
+			for (int k = 0; k < _size.y; ++k) {
+				const real_t *a_row_k = _data + calculate_index(k, 0);
+				real_t a_ki = a_row_k[i];
+
+				if (a_ki == 0) {
+					continue;
+				}
+
+				for (int j = i; j < n; ++j) {
+					out_row_i[j] += a_ki * a_row_k[j];
+				}
+			}
+
+			// Mirror. Every (j, i) cell belongs to the owner of row i, so this is race free.
+			for (int j = i + 1; j < n; ++j) {
+				out_ptr[j * n + i] = out_row_i[j];
+			}
+		}
+	}
+}
+
+void MLPPMatrix::_row_gram_matrix_range(int p_from, int p_to, SYRKData *p_data) const {
+	int n = _size.y;
+	real_t *out_ptr = p_data->out->ptrw();
+	const real_t *row_means = p_data->row_means;
+	real_t scale = p_data->scale;
+
+	for (int p = p_from; p < p_to; ++p) {
+		for (int pi = 0; pi < 2; ++pi) {
+			int i = pi == 0 ? p : n - 1 - p;
+
+			if (pi == 1 && i == p) {
+				break;
+			}
+
+			const real_t *a_row_i = _data + calculate_index(i, 0);
+
+			for (int j = i; j < n; ++j) {
+				const real_t *a_row_j = _data + calculate_index(j, 0);
+
+				real_t sum = 0;
+
+				if (row_means) {
+					real_t mean_i = row_means[i];
+					real_t mean_j = row_means[j];
+
+					for (int k = 0; k < _size.x; ++k) {
+						sum += (a_row_i[k] - mean_i) * (a_row_j[k] - mean_j);
+					}
+				} else {
+					for (int k = 0; k < _size.x; ++k) {
+						sum += a_row_i[k] * a_row_j[k];
+					}
+				}
+
+				sum *= scale;
+
+				out_ptr[i * n + j] = sum;
+				out_ptr[j * n + i] = sum;
+			}
 		}
 	}
 }
@@ -2531,8 +2811,8 @@ Array MLPPMatrix::eigenb_bind(const Ref<MLPPMatrix> &A) {
 MLPPMatrix::SVDResult MLPPMatrix::svd() const {
 	SVDResult res;
 
-	EigenResult left_eigen = multn(transposen())->eigen();
-	EigenResult right_eigen = transposen()->multn(Ref<MLPPMatrix>(this))->eigen();
+	EigenResult left_eigen = row_gram_matrixn()->eigen();
+	EigenResult right_eigen = gram_matrixn()->eigen();
 
 	Ref<MLPPMatrix> singularvals = left_eigen.eigen_values->sqrtn();
 	Ref<MLPPMatrix> sigma = matn_zero(_size.y, _size.x);
@@ -2559,8 +2839,8 @@ MLPPMatrix::SVDResult MLPPMatrix::svdb(const Ref<MLPPMatrix> &A) const {
 
 	Size2i a_size = A->size();
 
-	EigenResult left_eigen = A->multn(A->transposen())->eigen();
-	EigenResult right_eigen = A->transposen()->multn(A)->eigen();
+	EigenResult left_eigen = A->row_gram_matrixn()->eigen();
+	EigenResult right_eigen = A->gram_matrixn()->eigen();
 
 	Ref<MLPPMatrix> singularvals = left_eigen.eigen_values->sqrtn();
 	Ref<MLPPMatrix> sigma = matn_zero(a_size.y, a_size.x);
@@ -2899,12 +3179,14 @@ void MLPPMatrix::outer_product(const Ref<MLPPVector> &a, const Ref<MLPPVector> &
 
 	const real_t *a_ptr = a->ptr();
 	const real_t *b_ptr = b->ptr();
+	real_t *c_ptr = ptrw();
 
 	for (int i = 0; i < s.y; ++i) {
 		real_t curr_a = a_ptr[i];
+		real_t *c_row_ptr = c_ptr + i * s.x;
 
 		for (int j = 0; j < s.x; ++j) {
-			element_set(i, j, curr_a * b_ptr[j]);
+			c_row_ptr[j] = curr_a * b_ptr[j];
 		}
 	}
 }
@@ -2919,17 +3201,41 @@ Ref<MLPPMatrix> MLPPMatrix::outer_productn(const Ref<MLPPVector> &a, const Ref<M
 
 	const real_t *a_ptr = a->ptr();
 	const real_t *b_ptr = b->ptr();
+	real_t *c_ptr = C->ptrw();
 
 	for (int i = 0; i < s.y; ++i) {
 		real_t curr_a = a_ptr[i];
+		real_t *c_row_ptr = c_ptr + i * s.x;
 
 		for (int j = 0; j < s.x; ++j) {
-			C->element_set(i, j, curr_a * b_ptr[j]);
+			c_row_ptr[j] = curr_a * b_ptr[j];
 		}
 	}
 
 	return C;
 }
+void MLPPMatrix::outer_product_add(const Ref<MLPPVector> &a, const Ref<MLPPVector> &b, const real_t alpha) {
+	ERR_FAIL_COND(!a.is_valid() || !b.is_valid());
+	ERR_FAIL_COND(_size != Size2i(b->size(), a->size()));
+
+	const real_t *a_ptr = a->ptr();
+	const real_t *b_ptr = b->ptr();
+	real_t *c_ptr = ptrw();
+
+	for (int i = 0; i < _size.y; ++i) {
+		real_t curr_a = alpha * a_ptr[i];
+
+		if (curr_a == 0) {
+			continue;
+		}
+
+		real_t *c_row_ptr = c_ptr + i * _size.x;
+
+		for (int j = 0; j < _size.x; ++j) {
+			c_row_ptr[j] += curr_a * b_ptr[j];
+		}
+	}
+}
 
 void MLPPMatrix::diagonal_set(const Ref<MLPPVector> &a) {
 	ERR_FAIL_COND(!a.is_valid());
@@ -3120,10 +3426,12 @@ String MLPPMatrix::to_string() {
 
 MLPPMatrix::MLPPMatrix() {
 	_data = NULL;
+	_is_view = false;
 }
 
 MLPPMatrix::MLPPMatrix(const MLPPMatrix &p_from) {
 	_data = NULL;
+	_is_view = false;
 
 	resize(p_from.size());
 	for (int i = 0; i < p_from.data_size(); ++i) {
@@ -3133,18 +3441,21 @@ MLPPMatrix::MLPPMatrix(const MLPPMatrix &p_from) {
 
 MLPPMatrix::MLPPMatrix(const Vector<Vector<real_t>> &p_from) {
 	_data = NULL;
+	_is_view = false;
 
 	set_from_vectors(p_from);
 }
 
 MLPPMatrix::MLPPMatrix(const Array &p_from) {
 	_data = NULL;
+	_is_view = false;
 
 	set_from_arrays(p_from);
 }
 
 MLPPMatrix::MLPPMatrix(const real_t *p_from, const int p_size_y, const int p_size_x) {
 	_data = NULL;
+	_is_view = false;
 
 	ERR_FAIL_COND(!p_from);
 
@@ -3229,6 +3540,7 @@ void MLPPMatrix::set_row_std_vector(int p_index_y, const std::vector<real_t> &p_
 
 MLPPMatrix::MLPPMatrix(const std::vector<std::vector<real_t>> &p_from) {
 	_data = NULL;
+	_is_view = false;
 
 	set_from_std_vectors(p_from);
 }
@@ -3248,6 +3560,8 @@ void MLPPMatrix::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("clear"), &MLPPMatrix::clear);
 	ClassDB::bind_method(D_METHOD("reset"), &MLPPMatrix::reset);
+	ClassDB::bind_method(D_METHOD("is_view"), &MLPPMatrix::is_view);
+	ClassDB::bind_method(D_METHOD("detach_view"), &MLPPMatrix::detach_view);
 	ClassDB::bind_method(D_METHOD("empty"), &MLPPMatrix::empty);
 
 	ClassDB::bind_method(D_METHOD("data_size"), &MLPPMatrix::data_size);
@@ -3299,6 +3613,8 @@ void MLPPMatrix::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("mult", "B"), &MLPPMatrix::mult);
 	ClassDB::bind_method(D_METHOD("multn", "B"), &MLPPMatrix::multn);
 	ClassDB::bind_method(D_METHOD("multb", "A", "B"), &MLPPMatrix::multb);
+	ClassDB::bind_method(D_METHOD("mult_transposed_a_add", "A", "B"), &MLPPMatrix::mult_transposed_a_add);
+	ClassDB::bind_method(D_METHOD("mult_transposed_b_add", "A", "B"), &MLPPMatrix::mult_transposed_b_add);
 
 	ClassDB::bind_method(D_METHOD("hadamard_product", "B"), &MLPPMatrix::hadamard_product);
 	ClassDB::bind_method(D_METHOD("hadamard_productn", "B"), &MLPPMatrix::hadamard_productn);
@@ -3404,6 +3720,12 @@ void MLPPMatrix::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("cov"), &MLPPMatrix::cov);
 	ClassDB::bind_method(D_METHOD("covo", "out"), &MLPPMatrix::covo);
 
+	ClassDB::bind_method(D_METHOD("gram_matrixn"), &MLPPMatrix::gram_matrixn);
+	ClassDB::bind_method(D_METHOD("gram_matrixo", "out"), &MLPPMatrix::gram_matrixo);
+
+	ClassDB::bind_method(D_METHOD("row_gram_matrixn"), &MLPPMatrix::row_gram_matrixn);
+	ClassDB::bind_method(D_METHOD("row_gram_matrixo", "out"), &MLPPMatrix::row_gram_matrixo);
+
 	ClassDB::bind_method(D_METHOD("eigen"), &MLPPMatrix::eigen_bind);
 	ClassDB::bind_method(D_METHOD("eigenb", "A"), &MLPPMatrix::eigenb_bind);
 
@@ -3422,6 +3744,7 @@ void MLPPMatrix::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("outer_product", "a", "b"), &MLPPMatrix::outer_product);
 	ClassDB::bind_method(D_METHOD("outer_productn", "a", "b"), &MLPPMatrix::outer_productn);
+	ClassDB::bind_method(D_METHOD("outer_product_add", "a", "b", "alpha"), &MLPPMatrix::outer_product_add);
 
 	ClassDB::bind_method(D_METHOD("diagonal_set", "a"), &MLPPMatrix::diagonal_set);
 	ClassDB::bind_method(D_METHOD("diagonal_setn", "a"), &MLPPMatrix::diagonal_setn);
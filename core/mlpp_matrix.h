@@ -78,12 +78,24 @@ public:
   _FORCE_INLINE_ void clear() { resize(Size2i()); }
   _FORCE_INLINE_ void reset() {
     if (_data) {
-      memfree(_data);
+      if (!_is_view) {
+        memfree(_data);
+      }
+
       _data = NULL;
       _size = Vector2i();
     }
+
+    _is_view = false;
   }
 
+  // Uses p_data as storage without copying it or taking ownership, p_data has
+  // to outlive the view. Writes go to p_data. Changing the size copies the
+  // data into an owned buffer first, and ends the view.
+  void set_view(real_t *p_data, const Size2i &p_size);
+  void detach_view();
+  _FORCE_INLINE_ bool is_view() const { return _is_view; }
+
   _FORCE_INLINE_ bool empty() const { return data_size() == 0; }
   _FORCE_INLINE_ int data_size() const { return _size.x * _size.y; }
   _FORCE_INLINE_ Size2i size() const { return _size; }
@@ -175,6 +187,9 @@ public:
   void mult(const Ref<MLPPMatrix> &B);
   Ref<MLPPMatrix> multn(const Ref<MLPPMatrix> &B) const;
   void multb(const Ref<MLPPMatrix> &A, const Ref<MLPPMatrix> &B);
+  // this += A^T * B and this += A * B^T, without materializing the transpose
+  void mult_transposed_a_add(const Ref<MLPPMatrix> &A, const Ref<MLPPMatrix> &B);
+  void mult_transposed_b_add(const Ref<MLPPMatrix> &A, const Ref<MLPPMatrix> &B);
 
   void hadamard_product(const Ref<MLPPMatrix> &B);
   Ref<MLPPMatrix> hadamard_productn(const Ref<MLPPMatrix> &B) const;
@@ -291,9 +306,22 @@ public:
 
   static Ref<MLPPMatrix> create_identity_mat(int d);
 
+  // Covariance of the rows (every row is a variable, every column is an
+  // observation). The result is (size.y x size.y).
   Ref<MLPPMatrix> cov() const;
   void covo(Ref<MLPPMatrix> out) const;
 
+  // Symmetric rank-k products (syrk). Only the upper triangle gets computed,
+  // then it's mirrored. Large inputs are split between threads.
+
+  // A^T * A
+  Ref<MLPPMatrix> gram_matrixn() const;
+  void gram_matrixo(Ref<MLPPMatrix> out) const;
+
+  // A * A^T
+  Ref<MLPPMatrix> row_gram_matrixn() const;
+  void row_gram_matrixo(Ref<MLPPMatrix> out) const;
+
   struct EigenResult {
     Ref<MLPPMatrix> eigen_vectors;
     Ref<MLPPMatrix> eigen_values;
@@ -365,6 +393,9 @@ public:
   void outer_product(const Ref<MLPPVector> &a, const Ref<MLPPVector> &b);
   Ref<MLPPMatrix> outer_productn(const Ref<MLPPVector> &a,
                                  const Ref<MLPPVector> &b) const;
+  // this += alpha * a * bT (BLAS ger), without materializing the outer product
+  void outer_product_add(const Ref<MLPPVector> &a, const Ref<MLPPVector> &b,
+                         const real_t alpha = 1);
 
   // Just sets the diagonal
   void diagonal_set(const Ref<MLPPVector> &a);
@@ -402,9 +433,22 @@ public:
 protected:
   static void _bind_methods();
 
+  struct SYRKData {
+    MLPPMatrix *out;
+    // If set, rows are centered on the fly.
+    const real_t *row_means;
+    real_t scale;
+  };
+
+  // Both process row pairs (i, n - 1 - i) so every index has the same amount
+  // of work in the triangle.
+  void _gram_matrix_range(int p_from, int p_to, SYRKData *p_data) const;
+  void _row_gram_matrix_range(int p_from, int p_to, SYRKData *p_data) const;
+
 protected:
   Size2i _size;
   real_t *_data;
+  bool _is_view;
 };
 
 #endif
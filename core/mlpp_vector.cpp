@@ -57,6 +57,10 @@ void MLPPVector::set_data(const PoolRealArray &p_from) {
 }
 
 void MLPPVector::push_back(real_t p_elem) {
+	if (_is_view) {
+		detach_view();
+	}
+
 	++_size;
 
 	_data = (real_t *)memrealloc(_data, _size * sizeof(real_t));
@@ -74,6 +78,10 @@ void MLPPVector::append_mlpp_vector(const Ref<MLPPVector> &p_other) {
 		return;
 	}
 
+	if (_is_view) {
+		detach_view();
+	}
+
 	int start_offset = _size;
 
 	_size += other_size;
@@ -91,11 +99,18 @@ void MLPPVector::append_mlpp_vector(const Ref<MLPPVector> &p_other) {
 void MLPPVector::remove(int p_index) {
 	ERR_FAIL_INDEX(p_index, _size);
 
+	if (_is_view) {
+		detach_view();
+	}
+
 	--_size;
 
 	if (_size == 0) {
-		memfree(_data);
-		_data = NULL;
+		if (_data) {
+			memfree(_data);
+			_data = NULL;
+		}
+
 		return;
 	}
 
@@ -111,11 +126,18 @@ void MLPPVector::remove(int p_index) {
 // remove. It's generally faster than `remove`.
 void MLPPVector::remove_unordered(int p_index) {
 	ERR_FAIL_INDEX(p_index, _size);
+
+	if (_is_view) {
+		detach_view();
+	}
 	_size--;
 
 	if (_size == 0) {
-		memfree(_data);
-		_data = NULL;
+		if (_data) {
+			memfree(_data);
+			_data = NULL;
+		}
+
 		return;
 	}
 
@@ -157,11 +179,22 @@ void MLPPVector::invert() {
 }
 
 void MLPPVector::resize(int p_size) {
+	if (_is_view) {
+		if (p_size == _size) {
+			return;
+		}
+
+		detach_view();
+	}
+
 	_size = p_size;
 
 	if (_size == 0) {
-		memfree(_data);
-		_data = NULL;
+		if (_data) {
+			memfree(_data);
+			_data = NULL;
+		}
+
 		return;
 	}
 
@@ -169,6 +202,41 @@ void MLPPVector::resize(int p_size) {
 	CRASH_COND_MSG(!_data, "Out of memory");
 }
 
+void MLPPVector::set_view(real_t *p_data, const int p_size) {
+	ERR_FAIL_COND(p_size < 0);
+	ERR_FAIL_COND(p_size > 0 && !p_data);
+
+	reset();
+
+	if (p_size == 0) {
+		return;
+	}
+
+	_data = p_data;
+	_size = p_size;
+	_is_view = true;
+}
+
+void MLPPVector::detach_view() {
+	if (!_is_view) {
+		return;
+	}
+
+	_is_view = false;
+
+	if (_size == 0) {
+		_data = NULL;
+		return;
+	}
+
+	real_t *data = (real_t *)memalloc(_size * sizeof(real_t));
+	CRASH_COND_MSG(!data, "Out of memory");
+
+	memcpy(data, _data, _size * sizeof(real_t));
+
+	_data = data;
+}
+
 void MLPPVector::fill(real_t p_val) {
 	for (int i = 0; i < _size; i++) {
 		_data[i] = p_val;
@@ -1459,10 +1527,12 @@ String MLPPVector::to_string() {
 MLPPVector::MLPPVector() {
 	_size = 0;
 	_data = NULL;
+	_is_view = false;
 }
 MLPPVector::MLPPVector(const MLPPVector &p_from) {
 	_size = 0;
 	_data = NULL;
+	_is_view = false;
 
 	resize(p_from.size());
 	for (int i = 0; i < p_from._size; i++) {
@@ -1473,6 +1543,7 @@ MLPPVector::MLPPVector(const MLPPVector &p_from) {
 MLPPVector::MLPPVector(const Vector<real_t> &p_from) {
 	_size = 0;
 	_data = NULL;
+	_is_view = false;
 
 	resize(p_from.size());
 	for (int i = 0; i < _size; i++) {
@@ -1483,6 +1554,7 @@ MLPPVector::MLPPVector(const Vector<real_t> &p_from) {
 MLPPVector::MLPPVector(const PoolRealArray &p_from) {
 	_size = 0;
 	_data = NULL;
+	_is_view = false;
 
 	resize(p_from.size());
 	PoolRealArray::Read r = p_from.read();
@@ -1494,6 +1566,7 @@ MLPPVector::MLPPVector(const PoolRealArray &p_from) {
 MLPPVector::MLPPVector(const real_t *p_from, const int p_size) {
 	_size = 0;
 	_data = NULL;
+	_is_view = false;
 
 	resize(p_size);
 	for (int i = 0; i < _size; i++) {
@@ -1525,6 +1598,7 @@ void MLPPVector::set_from_std_vector(const std::vector<real_t> &p_from) {
 MLPPVector::MLPPVector(const std::vector<real_t> &p_from) {
 	_size = 0;
 	_data = NULL;
+	_is_view = false;
 
 	resize(p_from.size());
 	for (int i = 0; i < _size; i++) {
@@ -1546,6 +1620,8 @@ void MLPPVector::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("invert"), &MLPPVector::invert);
 	ClassDB::bind_method(D_METHOD("clear"), &MLPPVector::clear);
 	ClassDB::bind_method(D_METHOD("reset"), &MLPPVector::reset);
+	ClassDB::bind_method(D_METHOD("is_view"), &MLPPVector::is_view);
+	ClassDB::bind_method(D_METHOD("detach_view"), &MLPPVector::detach_view);
 	ClassDB::bind_method(D_METHOD("empty"), &MLPPVector::empty);
 
 	ClassDB::bind_method(D_METHOD("size"), &MLPPVector::size);
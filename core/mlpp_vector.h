@@ -84,12 +84,23 @@ public:
 	_FORCE_INLINE_ void clear() { resize(0); }
 	_FORCE_INLINE_ void reset() {
 		if (_data) {
-			memfree(_data);
+			if (!_is_view) {
+				memfree(_data);
+			}
+
 			_data = NULL;
 			_size = 0;
 		}
+
+		_is_view = false;
 	}
 
+	// Uses p_data as storage without copying it or taking ownership, p_data has to outlive the view.
+	// Writes go to p_data. Changing the size copies the data into an owned buffer first, and ends the view.
+	void set_view(real_t *p_data, const int p_size);
+	void detach_view();
+	_FORCE_INLINE_ bool is_view() const { return _is_view; }
+
 	_FORCE_INLINE_ bool empty() const { return _size == 0; }
 	_FORCE_INLINE_ int size() const { return _size; }
 
@@ -295,6 +306,7 @@ protected:
 protected:
 	int _size;
 	real_t *_data;
+	bool _is_view;
 };
 
 #endif
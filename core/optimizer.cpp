@@ -0,0 +1,474 @@
+/*************************************************************************/
+/*  optimizer.cpp                                                        */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "optimizer.h"
+
+#include "parallel.h"
+
+int MLPPOptimizer::get_step() const {
+	return _step;
+}
+
+void MLPPOptimizer::begin_step() {
+	++_step;
+}
+
+void MLPPOptimizer::update(const int p_slot, real_t *r_params, const real_t *p_grads, const int p_size, const real_t p_learning_rate) {
+	ERR_FAIL_COND(p_slot < 0);
+	ERR_FAIL_COND(p_size < 0);
+	ERR_FAIL_COND(p_size > 0 && (!r_params || !p_grads));
+
+	if (_step == 0) {
+		// Not started with begin_step()
+		begin_step();
+	}
+
+	if (p_slot >= _states.size()) {
+		_states.resize(p_slot + 1);
+	}
+
+	int state_count = _get_state_count();
+	Vector<real_t> &state = _states.write[p_slot];
+
+	if (state.size() != state_count * p_size) {
+		state.resize(state_count * p_size);
+		state.fill(0);
+	}
+
+	UpdateData data;
+	data.params = r_params;
+	data.grads = p_grads;
+	data.state = state.ptrw();
+	data.size = p_size;
+	data.learning_rate = p_learning_rate;
+
+	MLPPParallel::do_work(p_size, this, &MLPPOptimizer::_update_range, &data, UPDATE_MIN_PER_THREAD);
+}
+
+void MLPPOptimizer::update_vector(const int p_slot, Ref<MLPPVector> r_params, const Ref<MLPPVector> &p_grads, const real_t p_learning_rate) {
+	ERR_FAIL_COND(!r_params.is_valid() || !p_grads.is_valid());
+	ERR_FAIL_COND(r_params->size() != p_grads->size());
+
+	update(p_slot, r_params->ptrw(), p_grads->ptr(), r_params->size(), p_learning_rate);
+}
+
+void MLPPOptimizer::update_matrix(const int p_slot, Ref<MLPPMatrix> r_params, const Ref<MLPPMatrix> &p_grads, const real_t p_learning_rate) {
+	ERR_FAIL_COND(!r_params.is_valid() || !p_grads.is_valid());
+	ERR_FAIL_COND(r_params->size() != p_grads->size());
+
+	update(p_slot, r_params->ptrw(), p_grads->ptr(), r_params->data_size(), p_learning_rate);
+}
+
+void MLPPOptimizer::reset() {
+	_states.clear();
+	_step = 0;
+}
+
+MLPPOptimizer::MLPPOptimizer() {
+	_step = 0;
+}
+MLPPOptimizer::~MLPPOptimizer() {
+}
+
+int MLPPOptimizer::_get_state_count() const {
+	return 0;
+}
+
+void MLPPOptimizer::_update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate) {
+	ERR_FAIL_MSG("Use one of the MLPPOptimizer subclasses!");
+}
+
+void MLPPOptimizer::_update_range(int p_from, int p_to, UpdateData *p_data) {
+	_update(p_data->params + p_from, p_data->grads + p_from, p_data->state + p_from, p_data->size, p_to - p_from, p_data->learning_rate);
+}
+
+void MLPPOptimizer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_step"), &MLPPOptimizer::get_step);
+	ClassDB::bind_method(D_METHOD("begin_step"), &MLPPOptimizer::begin_step);
+
+	ClassDB::bind_method(D_METHOD("update_vector", "slot", "params", "grads", "learning_rate"), &MLPPOptimizer::update_vector);
+	ClassDB::bind_method(D_METHOD("update_matrix", "slot", "params", "grads", "learning_rate"), &MLPPOptimizer::update_matrix);
+
+	ClassDB::bind_method(D_METHOD("reset"), &MLPPOptimizer::reset);
+}
+
+// SGD
+
+MLPPOptimizerSGD::MLPPOptimizerSGD() {
+}
+MLPPOptimizerSGD::~MLPPOptimizerSGD() {
+}
+
+int MLPPOptimizerSGD::_get_state_count() const {
+	return 0;
+}
+
+void MLPPOptimizerSGD::_update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate) {
+	for (int i = 0; i < p_size; ++i) {
+		r_params[i] -= p_learning_rate * p_grads[i];
+	}
+}
+
+void MLPPOptimizerSGD::_bind_methods() {
+}
+
+// Momentum
+
+real_t MLPPOptimizerMomentum::get_gamma() const {
+	return _gamma;
+}
+void MLPPOptimizerMomentum::set_gamma(const real_t val) {
+	_gamma = val;
+}
+
+bool MLPPOptimizerMomentum::get_nesterov() const {
+	return _nesterov;
+}
+void MLPPOptimizerMomentum::set_nesterov(const bool val) {
+	_nesterov = val;
+}
+
+MLPPOptimizerMomentum::MLPPOptimizerMomentum(const real_t p_gamma, const bool p_nesterov) {
+	_gamma = p_gamma;
+	_nesterov = p_nesterov;
+}
+
+MLPPOptimizerMomentum::MLPPOptimizerMomentum() {
+	_gamma = 0.9;
+	_nesterov = false;
+}
+MLPPOptimizerMomentum::~MLPPOptimizerMomentum() {
+}
+
+int MLPPOptimizerMomentum::_get_state_count() const {
+	return 1;
+}
+
+void MLPPOptimizerMomentum::_update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate) {
+	real_t *v = r_state;
+
+	if (_nesterov) {
+		for (int i = 0; i < p_size; ++i) {
+			real_t g = p_learning_rate * p_grads[i];
+
+			v[i] = _gamma * v[i] + g;
+			r_params[i] -= _gamma * v[i] + g;
+		}
+	} else {
+		for (int i = 0; i < p_size; ++i) {
+			v[i] = _gamma * v[i] + p_learning_rate * p_grads[i];
+			r_params[i] -= v[i];
+		}
+	}
+}
+
+void MLPPOptimizerMomentum::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_gamma"), &MLPPOptimizerMomentum::get_gamma);
+	ClassDB::bind_method(D_METHOD("set_gamma", "val"), &MLPPOptimizerMomentum::set_gamma);
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "gamma"), "set_gamma", "get_gamma");
+
+	ClassDB::bind_method(D_METHOD("get_nesterov"), &MLPPOptimizerMomentum::get_nesterov);
+	ClassDB::bind_method(D_METHOD("set_nesterov", "val"), &MLPPOptimizerMomentum::set_nesterov);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "nesterov"), "set_nesterov", "get_nesterov");
+}
+
+// Adagrad
+
+real_t MLPPOptimizerAdagrad::get_epsilon() const {
+	return _epsilon;
+}
+void MLPPOptimizerAdagrad::set_epsilon(const real_t val) {
+	_epsilon = val;
+}
+
+MLPPOptimizerAdagrad::MLPPOptimizerAdagrad(const real_t p_epsilon) {
+	_epsilon = p_epsilon;
+}
+
+MLPPOptimizerAdagrad::MLPPOptimizerAdagrad() {
+	_epsilon = 1e-8;
+}
+MLPPOptimizerAdagrad::~MLPPOptimizerAdagrad() {
+}
+
+int MLPPOptimizerAdagrad::_get_state_count() const {
+	return 1;
+}
+
+void MLPPOptimizerAdagrad::_update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate) {
+	real_t *v = r_state;
+
+	for (int i = 0; i < p_size; ++i) {
+		real_t g = p_grads[i];
+
+		v[i] += g * g;
+		r_params[i] -= p_learning_rate * g / (Math::sqrt(v[i]) + _epsilon);
+	}
+}
+
+void MLPPOptimizerAdagrad::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_epsilon"), &MLPPOptimizerAdagrad::get_epsilon);
+	ClassDB::bind_method(D_METHOD("set_epsilon", "val"), &MLPPOptimizerAdagrad::set_epsilon);
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "epsilon"), "set_epsilon", "get_epsilon");
+}
+
+// Adadelta
+
+real_t MLPPOptimizerAdadelta::get_b1() const {
+	return _b1;
+}
+void MLPPOptimizerAdadelta::set_b1(const real_t val) {
+	_b1 = val;
+}
+
+real_t MLPPOptimizerAdadelta::get_epsilon() const {
+	return _epsilon;
+}
+void MLPPOptimizerAdadelta::set_epsilon(const real_t val) {
+	_epsilon = val;
+}
+
+MLPPOptimizerAdadelta::MLPPOptimizerAdadelta(const real_t p_b1, const real_t p_epsilon) {
+	_b1 = p_b1;
+	_epsilon = p_epsilon;
+}
+
+MLPPOptimizerAdadelta::MLPPOptimizerAdadelta() {
+	_b1 = 0.9;
+	_epsilon = 1e-8;
+}
+MLPPOptimizerAdadelta::~MLPPOptimizerAdadelta() {
+}
+
+int MLPPOptimizerAdadelta::_get_state_count() const {
+	return 1;
+}
+
+void MLPPOptimizerAdadelta::_update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate) {
+	real_t *v = r_state;
+
+	for (int i = 0; i < p_size; ++i) {
+		real_t g = p_grads[i];
+
+		v[i] = _b1 * v[i] + (1 - _b1) * g * g;
+		r_params[i] -= p_learning_rate * g / (Math::sqrt(v[i]) + _epsilon);
+	}
+}
+
+void MLPPOptimizerAdadelta::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_b1"), &MLPPOptimizerAdadelta::get_b1);
+	ClassDB::bind_method(D_METHOD("set_b1", "val"), &MLPPOptimizerAdadelta::set_b1);
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "b1"), "set_b1", "get_b1");
+
+	ClassDB::bind_method(D_METHOD("get_epsilon"), &MLPPOptimizerAdadelta::get_epsilon);
+	ClassDB::bind_method(D_METHOD("set_epsilon", "val"), &MLPPOptimizerAdadelta::set_epsilon);
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "epsilon"), "set_epsilon", "get_epsilon");
+}
+
+// Adam family
+
+real_t MLPPOptimizerAdamBase::get_b1() const {
+	return _b1;
+}
+void MLPPOptimizerAdamBase::set_b1(const real_t val) {
+	_b1 = val;
+}
+
+real_t MLPPOptimizerAdamBase::get_b2() const {
+	return _b2;
+}
+void MLPPOptimizerAdamBase::set_b2(const real_t val) {
+	_b2 = val;
+}
+
+real_t MLPPOptimizerAdamBase::get_epsilon() const {
+	return _epsilon;
+}
+void MLPPOptimizerAdamBase::set_epsilon(const real_t val) {
+	_epsilon = val;
+}
+
+MLPPOptimizerAdamBase::MLPPOptimizerAdamBase() {
+	_b1 = 0.9;
+	_b2 = 0.999;
+	_epsilon = 1e-8;
+}
+MLPPOptimizerAdamBase::~MLPPOptimizerAdamBase() {
+}
+
+void MLPPOptimizerAdamBase::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_b1"), &MLPPOptimizerAdamBase::get_b1);
+	ClassDB::bind_method(D_METHOD("set_b1", "val"), &MLPPOptimizerAdamBase::set_b1);
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "b1"), "set_b1", "get_b1");
+
+	ClassDB::bind_method(D_METHOD("get_b2"), &MLPPOptimizerAdamBase::get_b2);
+	ClassDB::bind_method(D_METHOD("set_b2", "val"), &MLPPOptimizerAdamBase::set_b2);
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "b2"), "set_b2", "get_b2");
+
+	ClassDB::bind_method(D_METHOD("get_epsilon"), &MLPPOptimizerAdamBase::get_epsilon);
+	ClassDB::bind_method(D_METHOD("set_epsilon", "val"), &MLPPOptimizerAdamBase::set_epsilon);
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "epsilon"), "set_epsilon", "get_epsilon");
+}
+
+// Adam
+
+MLPPOptimizerAdam::MLPPOptimizerAdam(const real_t p_b1, const real_t p_b2, const real_t p_epsilon) {
+	_b1 = p_b1;
+	_b2 = p_b2;
+	_epsilon = p_epsilon;
+}
+
+MLPPOptimizerAdam::MLPPOptimizerAdam() {
+}
+MLPPOptimizerAdam::~MLPPOptimizerAdam() {
+}
+
+int MLPPOptimizerAdam::_get_state_count() const {
+	return 2;
+}
+
+void MLPPOptimizerAdam::_update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate) {
+	real_t *m = r_state;
+	real_t *v = r_state + p_state_stride;
+
+	const real_t m_correction = 1 / (1 - Math::pow(_b1, static_cast<real_t>(_step)));
+	const real_t v_correction = 1 / (1 - Math::pow(_b2, static_cast<real_t>(_step)));
+
+	for (int i = 0; i < p_size; ++i) {
+		real_t g = p_grads[i];
+
+		m[i] = _b1 * m[i] + (1 - _b1) * g;
+		v[i] = _b2 * v[i] + (1 - _b2) * g * g;
+
+		r_params[i] -= p_learning_rate * (m[i] * m_correction) / (Math::sqrt(v[i] * v_correction) + _epsilon);
+	}
+}
+
+// Adamax
+
+MLPPOptimizerAdamax::MLPPOptimizerAdamax(const real_t p_b1, const real_t p_b2, const real_t p_epsilon) {
+	_b1 = p_b1;
+	_b2 = p_b2;
+	_epsilon = p_epsilon;
+}
+
+MLPPOptimizerAdamax::MLPPOptimizerAdamax() {
+}
+MLPPOptimizerAdamax::~MLPPOptimizerAdamax() {
+}
+
+int MLPPOptimizerAdamax::_get_state_count() const {
+	return 2;
+}
+
+void MLPPOptimizerAdamax::_update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate) {
+	real_t *m = r_state;
+	real_t *u = r_state + p_state_stride;
+
+	const real_t m_correction = 1 / (1 - Math::pow(_b1, static_cast<real_t>(_step)));
+
+	for (int i = 0; i < p_size; ++i) {
+		real_t g = p_grads[i];
+
+		m[i] = _b1 * m[i] + (1 - _b1) * g;
+		u[i] = MAX(_b2 * u[i], Math::abs(g));
+
+		r_params[i] -= p_learning_rate * (m[i] * m_correction) / (u[i] + _epsilon);
+	}
+}
+
+// Nadam
+
+MLPPOptimizerNadam::MLPPOptimizerNadam(const real_t p_b1, const real_t p_b2, const real_t p_epsilon) {
+	_b1 = p_b1;
+	_b2 = p_b2;
+	_epsilon = p_epsilon;
+}
+
+MLPPOptimizerNadam::MLPPOptimizerNadam() {
+}
+MLPPOptimizerNadam::~MLPPOptimizerNadam() {
+}
+
+int MLPPOptimizerNadam::_get_state_count() const {
+	return 2;
+}
+
+void MLPPOptimizerNadam::_update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate) {
+	real_t *m = r_state;
+	real_t *v = r_state + p_state_stride;
+
+	const real_t m_correction = 1 / (1 - Math::pow(_b1, static_cast<real_t>(_step)));
+	const real_t v_correction = 1 / (1 - Math::pow(_b2, static_cast<real_t>(_step)));
+
+	for (int i = 0; i < p_size; ++i) {
+		real_t g = p_grads[i];
+
+		m[i] = _b1 * m[i] + (1 - _b1) * g;
+		v[i] = _b2 * v[i] + (1 - _b2) * g * g;
+
+		real_t m_final = (_b1 * m[i] + (1 - _b1) * g) * m_correction;
+
+		r_params[i] -= p_learning_rate * m_final / (Math::sqrt(v[i] * v_correction) + _epsilon);
+	}
+}
+
+// AMSGrad
+
+MLPPOptimizerAMSGrad::MLPPOptimizerAMSGrad(const real_t p_b1, const real_t p_b2, const real_t p_epsilon) {
+	_b1 = p_b1;
+	_b2 = p_b2;
+	_epsilon = p_epsilon;
+}
+
+MLPPOptimizerAMSGrad::MLPPOptimizerAMSGrad() {
+}
+MLPPOptimizerAMSGrad::~MLPPOptimizerAMSGrad() {
+}
+
+int MLPPOptimizerAMSGrad::_get_state_count() const {
+	return 3;
+}
+
+void MLPPOptimizerAMSGrad::_update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate) {
+	real_t *m = r_state;
+	real_t *v = r_state + p_state_stride;
+	real_t *v_max = r_state + 2 * p_state_stride;
+
+	for (int i = 0; i < p_size; ++i) {
+		real_t g = p_grads[i];
+
+		m[i] = _b1 * m[i] + (1 - _b1) * g;
+		v[i] = _b2 * v[i] + (1 - _b2) * g * g;
+		v_max[i] = MAX(v_max[i], v[i]);
+
+		r_params[i] -= p_learning_rate * m[i] / (Math::sqrt(v_max[i]) + _epsilon);
+	}
+}
@@ -0,0 +1,275 @@
+#ifndef MLPP_OPTIMIZER_H
+#define MLPP_OPTIMIZER_H
+
+/*************************************************************************/
+/*  optimizer.h                                                          */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifdef USING_SFW
+#include "sfw.h"
+#else
+#include "core/containers/vector.h"
+#include "core/math/math_defs.h"
+
+#include "core/object/reference.h"
+#endif
+
+#include "../core/mlpp_matrix.h"
+#include "../core/mlpp_vector.h"
+
+// Gradient descent update rules, shared by the models.
+// An optimizer keeps the state (moments) of every parameter buffer it updates, per slot, so one optimizer
+// can update every layer of a network. A step is begin_step(), then one update() per parameter buffer.
+// The updates are done in place, in one pass over the buffer, without temporaries.
+class MLPPOptimizer : public Reference {
+	GDCLASS(MLPPOptimizer, Reference);
+
+public:
+	// The time step used for bias correction. Incremented by begin_step(), so it's 1 during the first step.
+	int get_step() const;
+
+	void begin_step();
+
+	// r_params -= the step computed from p_grads. p_slot identifies the parameter buffer, its state is kept between steps.
+	void update(const int p_slot, real_t *r_params, const real_t *p_grads, const int p_size, const real_t p_learning_rate);
+	void update_vector(const int p_slot, Ref<MLPPVector> r_params, const Ref<MLPPVector> &p_grads, const real_t p_learning_rate);
+	void update_matrix(const int p_slot, Ref<MLPPMatrix> r_params, const Ref<MLPPMatrix> &p_grads, const real_t p_learning_rate);
+
+	// Clears the state of every slot, and the time step.
+	void reset();
+
+	MLPPOptimizer();
+	~MLPPOptimizer();
+
+protected:
+	enum {
+		// Smaller buffers are updated on the calling thread.
+		UPDATE_MIN_PER_THREAD = 16384,
+	};
+
+	// How many real_ts of state every parameter needs.
+	virtual int _get_state_count() const;
+	// State k of element i is r_state[k * p_state_stride + i], it starts out as 0.
+	virtual void _update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate);
+
+	struct UpdateData {
+		real_t *params;
+		const real_t *grads;
+		real_t *state;
+		int size;
+		real_t learning_rate;
+	};
+
+	void _update_range(int p_from, int p_to, UpdateData *p_data);
+
+	static void _bind_methods();
+
+	Vector<Vector<real_t>> _states;
+	int _step;
+};
+
+// params -= learning_rate * grads
+class MLPPOptimizerSGD : public MLPPOptimizer {
+	GDCLASS(MLPPOptimizerSGD, MLPPOptimizer);
+
+public:
+	MLPPOptimizerSGD();
+	~MLPPOptimizerSGD();
+
+protected:
+	int _get_state_count() const;
+	void _update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate);
+
+	static void _bind_methods();
+};
+
+// v = gamma * v + learning_rate * grads, params -= v
+// With nesterov, params -= gamma * v + learning_rate * grads, which is Nesterov's lookahead without evaluating the gradients
+// at the moved parameters.
+class MLPPOptimizerMomentum : public MLPPOptimizer {
+	GDCLASS(MLPPOptimizerMomentum, MLPPOptimizer);
+
+public:
+	real_t get_gamma() const;
+	void set_gamma(const real_t val);
+
+	bool get_nesterov() const;
+	void set_nesterov(const bool val);
+
+	MLPPOptimizerMomentum(const real_t p_gamma, const bool p_nesterov = false);
+
+	MLPPOptimizerMomentum();
+	~MLPPOptimizerMomentum();
+
+protected:
+	int _get_state_count() const;
+	void _update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate);
+
+	static void _bind_methods();
+
+	real_t _gamma;
+	bool _nesterov;
+};
+
+// v += grads^2, params -= learning_rate * grads / (sqrt(v) + epsilon)
+class MLPPOptimizerAdagrad : public MLPPOptimizer {
+	GDCLASS(MLPPOptimizerAdagrad, MLPPOptimizer);
+
+public:
+	real_t get_epsilon() const;
+	void set_epsilon(const real_t val);
+
+	MLPPOptimizerAdagrad(const real_t p_epsilon);
+
+	MLPPOptimizerAdagrad();
+	~MLPPOptimizerAdagrad();
+
+protected:
+	int _get_state_count() const;
+	void _update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate);
+
+	static void _bind_methods();
+
+	real_t _epsilon;
+};
+
+// The Adagrad upgrade the models call adadelta, with a decaying average instead of a sum (RMSProp):
+// v = b1 * v + (1 - b1) * grads^2, params -= learning_rate * grads / (sqrt(v) + epsilon)
+class MLPPOptimizerAdadelta : public MLPPOptimizer {
+	GDCLASS(MLPPOptimizerAdadelta, MLPPOptimizer);
+
+public:
+	real_t get_b1() const;
+	void set_b1(const real_t val);
+
+	real_t get_epsilon() const;
+	void set_epsilon(const real_t val);
+
+	MLPPOptimizerAdadelta(const real_t p_b1, const real_t p_epsilon);
+
+	MLPPOptimizerAdadelta();
+	~MLPPOptimizerAdadelta();
+
+protected:
+	int _get_state_count() const;
+	void _update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate);
+
+	static void _bind_methods();
+
+	real_t _b1;
+	real_t _epsilon;
+};
+
+// The common base of the Adam family, with the two decay rates and epsilon.
+class MLPPOptimizerAdamBase : public MLPPOptimizer {
+	GDCLASS(MLPPOptimizerAdamBase, MLPPOptimizer);
+
+public:
+	real_t get_b1() const;
+	void set_b1(const real_t val);
+
+	real_t get_b2() const;
+	void set_b2(const real_t val);
+
+	real_t get_epsilon() const;
+	void set_epsilon(const real_t val);
+
+	MLPPOptimizerAdamBase();
+	~MLPPOptimizerAdamBase();
+
+protected:
+	static void _bind_methods();
+
+	real_t _b1;
+	real_t _b2;
+	real_t _epsilon;
+};
+
+// m = b1 * m + (1 - b1) * grads, v = b2 * v + (1 - b2) * grads^2
+// params -= learning_rate * m_hat / (sqrt(v_hat) + epsilon), where _hat is the bias corrected moment.
+class MLPPOptimizerAdam : public MLPPOptimizerAdamBase {
+	GDCLASS(MLPPOptimizerAdam, MLPPOptimizerAdamBase);
+
+public:
+	MLPPOptimizerAdam(const real_t p_b1, const real_t p_b2, const real_t p_epsilon);
+
+	MLPPOptimizerAdam();
+	~MLPPOptimizerAdam();
+
+protected:
+	int _get_state_count() const;
+	void _update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate);
+};
+
+// Adam with the infinity norm: u = max(b2 * u, |grads|), params -= learning_rate * m_hat / (u + epsilon)
+class MLPPOptimizerAdamax : public MLPPOptimizerAdamBase {
+	GDCLASS(MLPPOptimizerAdamax, MLPPOptimizerAdamBase);
+
+public:
+	MLPPOptimizerAdamax(const real_t p_b1, const real_t p_b2, const real_t p_epsilon);
+
+	MLPPOptimizerAdamax();
+	~MLPPOptimizerAdamax();
+
+protected:
+	int _get_state_count() const;
+	void _update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate);
+};
+
+// Adam with Nesterov momentum: params -= learning_rate * (b1 * m_hat + (1 - b1) * grads / (1 - b1^t)) / (sqrt(v_hat) + epsilon)
+class MLPPOptimizerNadam : public MLPPOptimizerAdamBase {
+	GDCLASS(MLPPOptimizerNadam, MLPPOptimizerAdamBase);
+
+public:
+	MLPPOptimizerNadam(const real_t p_b1, const real_t p_b2, const real_t p_epsilon);
+
+	MLPPOptimizerNadam();
+	~MLPPOptimizerNadam();
+
+protected:
+	int _get_state_count() const;
+	void _update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate);
+};
+
+// Adam with the running maximum of v, and without bias correction: params -= learning_rate * m / (sqrt(max(v)) + epsilon)
+class MLPPOptimizerAMSGrad : public MLPPOptimizerAdamBase {
+	GDCLASS(MLPPOptimizerAMSGrad, MLPPOptimizerAdamBase);
+
+public:
+	MLPPOptimizerAMSGrad(const real_t p_b1, const real_t p_b2, const real_t p_epsilon);
+
+	MLPPOptimizerAMSGrad();
+	~MLPPOptimizerAMSGrad();
+
+protected:
+	int _get_state_count() const;
+	void _update(real_t *r_params, const real_t *p_grads, real_t *r_state, const int p_state_stride, const int p_size, const real_t p_learning_rate);
+};
+
+#endif
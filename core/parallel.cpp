@@ -0,0 +1,105 @@
+/*************************************************************************/
+/*  parallel.cpp                                                         */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "parallel.h"
+
+#ifndef USING_SFW
+#include "core/os/os.h"
+#endif
+
+int MLPPParallel::_thread_count = 0;
+
+void MLPPParallel::set_thread_count(const int p_count) {
+	ERR_FAIL_COND(p_count < 0);
+
+	_thread_count = p_count;
+}
+
+int MLPPParallel::get_thread_count() {
+#ifdef NO_THREADS
+	return 1;
+#else
+	if (_thread_count > 0) {
+		return _thread_count;
+	}
+
+#ifdef USING_SFW
+	int count = std::thread::hardware_concurrency();
+#else
+	int count = OS::get_singleton()->get_processor_count();
+#endif
+
+	return MAX(count, 1);
+#endif
+}
+
+int MLPPParallel::calculate_range_count(const int p_count, const int p_min_per_thread) {
+	int min_per_thread = MAX(p_min_per_thread, 1);
+
+	return CLAMP(p_count / min_per_thread, 1, get_thread_count());
+}
+
+struct MLPPParallelTreeSumLevel {
+	real_t *const *buffers;
+	int buffer_count;
+	int stride;
+
+	void add_range(int p_from, int p_to, void *p_userdata) {
+		for (int i = 0; i + stride < buffer_count; i += 2 * stride) {
+			real_t *dst = buffers[i];
+			const real_t *src = buffers[i + stride];
+
+			for (int j = p_from; j < p_to; ++j) {
+				dst[j] += src[j];
+			}
+		}
+	}
+};
+
+void MLPPParallel::tree_sum(real_t *const *p_buffers, const int p_buffer_count, const int p_size) {
+	ERR_FAIL_COND(p_buffer_count > 0 && !p_buffers);
+
+	MLPPParallelTreeSumLevel level;
+	level.buffers = p_buffers;
+	level.buffer_count = p_buffer_count;
+
+	for (level.stride = 1; level.stride < p_buffer_count; level.stride *= 2) {
+		do_work(p_size, &level, &MLPPParallelTreeSumLevel::add_range, (void *)NULL, 16384);
+	}
+}
+
+void MLPPParallel::range_get(const int p_count, const int p_range_count, const int p_index, int &r_from, int &r_to) {
+	int base = p_count / p_range_count;
+	int rem = p_count % p_range_count;
+
+	// The first rem ranges get one extra element.
+	r_from = p_index * base + MIN(p_index, rem);
+	r_to = r_from + base + (p_index < rem ? 1 : 0);
+}
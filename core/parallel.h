@@ -0,0 +1,129 @@
+#ifndef MLPP_PARALLEL_H
+#define MLPP_PARALLEL_H
+
+/*************************************************************************/
+/*  parallel.h                                                           */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifdef USING_SFW
+#include "sfw.h"
+#else
+#include "core/math/math_defs.h"
+#include "core/os/memory.h"
+#include "core/os/thread.h"
+#include "core/typedefs.h"
+#endif
+
+// Minimal fork-join helper for the heavier kernels.
+// The work is split into contiguous, deterministic ranges (depending only on the thread count),
+// so results do not depend on scheduling.
+class MLPPParallel {
+public:
+	// 0 means use every available core.
+	static void set_thread_count(const int p_count);
+	static int get_thread_count();
+
+	// Splits [0, p_count) into contiguous ranges, and calls (p_instance->*p_method)(from, to, p_userdata) for each of them
+	// on a separate thread. The calling thread processes the first range. Returns once every range is done.
+	// p_min_per_thread is the smallest range that is worth a thread, smaller work gets run directly.
+	template <class C, class M, class U>
+	static void do_work(const int p_count, C *p_instance, M p_method, U p_userdata, const int p_min_per_thread = 1) {
+		if (p_count <= 0) {
+			return;
+		}
+
+		int thread_count = calculate_range_count(p_count, p_min_per_thread);
+
+		if (thread_count <= 1) {
+			(p_instance->*p_method)(0, p_count, p_userdata);
+			return;
+		}
+
+#ifdef NO_THREADS
+		(p_instance->*p_method)(0, p_count, p_userdata);
+#else
+		typedef Work<C, M, U> WorkType;
+
+		WorkType *works = memnew_arr(WorkType, thread_count);
+		Thread *threads = memnew_arr(Thread, thread_count - 1);
+
+		for (int i = 0; i < thread_count; ++i) {
+			WorkType &w = works[i];
+
+			w.instance = p_instance;
+			w.method = p_method;
+			w.userdata = p_userdata;
+			range_get(p_count, thread_count, i, w.from, w.to);
+		}
+
+		for (int i = 1; i < thread_count; ++i) {
+			threads[i - 1].start(&WorkType::run, &works[i]);
+		}
+
+		WorkType::run(&works[0]);
+
+		for (int i = 0; i < thread_count - 1; ++i) {
+			threads[i].wait_to_finish();
+		}
+
+		memdelete_arr(threads);
+		memdelete_arr(works);
+#endif
+	}
+
+	// Sums p_buffer_count buffers of p_size elements into p_buffers[0], pairwise, as a tree: 1 into 0, 3 into 2, ...
+	// then 2 into 0, 6 into 4, ... Every level runs in parallel over the elements.
+	// The order of the additions only depends on p_buffer_count, so results are reproducible.
+	static void tree_sum(real_t *const *p_buffers, const int p_buffer_count, const int p_size);
+
+	// How many ranges do_work() will use.
+	static int calculate_range_count(const int p_count, const int p_min_per_thread = 1);
+	// The p_index-th of p_range_count ranges of [0, p_count).
+	static void range_get(const int p_count, const int p_range_count, const int p_index, int &r_from, int &r_to);
+
+protected:
+	template <class C, class M, class U>
+	struct Work {
+		C *instance;
+		M method;
+		U userdata;
+		int from;
+		int to;
+
+		static void run(void *p_userdata) {
+			Work *w = static_cast<Work *>(p_userdata);
+
+			(w->instance->*w->method)(w->from, w->to, w->userdata);
+		}
+	};
+
+	static int _thread_count;
+};
+
+#endif
@@ -0,0 +1,337 @@
+/*************************************************************************/
+/*  parameter_arena.cpp                                                  */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "parameter_arena.h"
+
+int MLPPParameterArena::add_matrix(const Ref<MLPPMatrix> &p_params) {
+	ERR_FAIL_COND_V(!p_params.is_valid(), -1);
+
+	Entry e;
+	e.matrix = p_params;
+	e.size = p_params->data_size();
+
+	_entries.push_back(e);
+
+	return _entries.size() - 1;
+}
+
+int MLPPParameterArena::add_vector(const Ref<MLPPVector> &p_params) {
+	ERR_FAIL_COND_V(!p_params.is_valid(), -1);
+
+	Entry e;
+	e.vector = p_params;
+	e.size = p_params->size();
+
+	_entries.push_back(e);
+
+	return _entries.size() - 1;
+}
+
+void MLPPParameterArena::build() {
+	int size = 0;
+
+	for (int i = 0; i < _entries.size(); ++i) {
+		Entry &e = _entries.write[i];
+
+		e.offset = size;
+		e.size = e.matrix.is_valid() ? e.matrix->data_size() : e.vector->size();
+
+		size += e.size;
+	}
+
+	real_t *parameters = NULL;
+	real_t *gradients = NULL;
+
+	if (size > 0) {
+		parameters = (real_t *)memalloc(size * sizeof(real_t));
+		CRASH_COND_MSG(!parameters, "Out of memory");
+
+		gradients = (real_t *)memalloc(size * sizeof(real_t));
+		CRASH_COND_MSG(!gradients, "Out of memory");
+
+		memset(gradients, 0, size * sizeof(real_t));
+	}
+
+	// The entries might still view the previous buffer, so that is only freed after everything got moved.
+	for (int i = 0; i < _entries.size(); ++i) {
+		const Entry &e = _entries[i];
+
+		if (e.size == 0) {
+			continue;
+		}
+
+		if (e.matrix.is_valid()) {
+			Ref<MLPPMatrix> matrix = e.matrix;
+
+			memcpy(parameters + e.offset, matrix->ptr(), e.size * sizeof(real_t));
+			matrix->set_view(parameters + e.offset, matrix->size());
+		} else {
+			Ref<MLPPVector> vector = e.vector;
+
+			memcpy(parameters + e.offset, vector->ptr(), e.size * sizeof(real_t));
+			vector->set_view(parameters + e.offset, e.size);
+		}
+	}
+
+	_parameters_view->detach_view();
+	_gradients_view->detach_view();
+
+	if (_parameters) {
+		memfree(_parameters);
+		memfree(_gradients);
+	}
+
+	_parameters = parameters;
+	_gradients = gradients;
+	_size = size;
+
+	_parameters_view.instance();
+	_parameters_view->set_view(_parameters, _size);
+
+	_gradients_view.instance();
+	_gradients_view->set_view(_gradients, _size);
+}
+
+void MLPPParameterArena::clear() {
+	for (int i = 0; i < _entries.size(); ++i) {
+		Entry &e = _entries.write[i];
+
+		if (e.matrix.is_valid()) {
+			e.matrix->detach_view();
+		} else {
+			e.vector->detach_view();
+		}
+	}
+
+	_entries.clear();
+
+	_parameters_view->detach_view();
+	_gradients_view->detach_view();
+
+	if (_parameters) {
+		memfree(_parameters);
+		memfree(_gradients);
+
+		_parameters = NULL;
+		_gradients = NULL;
+	}
+
+	_size = 0;
+}
+
+bool MLPPParameterArena::has_matrix(const int p_index, const Ref<MLPPMatrix> &p_params) const {
+	ERR_FAIL_INDEX_V(p_index, _entries.size(), false);
+
+	const Entry &e = _entries[p_index];
+
+	if (e.matrix != p_params || p_params->data_size() != e.size) {
+		return false;
+	}
+
+	return e.size == 0 || (p_params->is_view() && p_params->ptr() == _parameters + e.offset);
+}
+
+bool MLPPParameterArena::has_vector(const int p_index, const Ref<MLPPVector> &p_params) const {
+	ERR_FAIL_INDEX_V(p_index, _entries.size(), false);
+
+	const Entry &e = _entries[p_index];
+
+	if (e.vector != p_params || p_params->size() != e.size) {
+		return false;
+	}
+
+	return e.size == 0 || (p_params->is_view() && p_params->ptr() == _parameters + e.offset);
+}
+
+int MLPPParameterArena::get_entry_count() const {
+	return _entries.size();
+}
+
+int MLPPParameterArena::get_entry_offset(const int p_index) const {
+	ERR_FAIL_INDEX_V(p_index, _entries.size(), 0);
+
+	return _entries[p_index].offset;
+}
+
+int MLPPParameterArena::get_entry_size(const int p_index) const {
+	ERR_FAIL_INDEX_V(p_index, _entries.size(), 0);
+
+	return _entries[p_index].size;
+}
+
+int MLPPParameterArena::get_size() const {
+	return _size;
+}
+
+Ref<MLPPVector> MLPPParameterArena::get_parameters() {
+	return _parameters_view;
+}
+
+Ref<MLPPVector> MLPPParameterArena::get_gradients() {
+	return _gradients_view;
+}
+
+void MLPPParameterArena::gradient_set_matrix(const int p_index, const Ref<MLPPMatrix> &p_grad) {
+	ERR_FAIL_INDEX(p_index, _entries.size());
+	ERR_FAIL_COND(!p_grad.is_valid());
+
+	const Entry &e = _entries[p_index];
+
+	ERR_FAIL_COND(p_grad->data_size() != e.size);
+
+	if (e.size > 0) {
+		memcpy(_gradients + e.offset, p_grad->ptr(), e.size * sizeof(real_t));
+	}
+}
+
+void MLPPParameterArena::gradient_set_vector(const int p_index, const Ref<MLPPVector> &p_grad) {
+	ERR_FAIL_INDEX(p_index, _entries.size());
+	ERR_FAIL_COND(!p_grad.is_valid());
+
+	const Entry &e = _entries[p_index];
+
+	ERR_FAIL_COND(p_grad->size() != e.size);
+
+	if (e.size > 0) {
+		memcpy(_gradients + e.offset, p_grad->ptr(), e.size * sizeof(real_t));
+	}
+}
+
+void MLPPParameterArena::gradients_fill(const real_t p_val) {
+	for (int i = 0; i < _size; ++i) {
+		_gradients[i] = p_val;
+	}
+}
+
+void MLPPParameterArena::apply_gradients(const int p_from, const int p_to, const real_t p_learning_rate) {
+	ERR_FAIL_COND(p_from < 0 || p_to > _size);
+
+	for (int i = p_from; i < p_to; ++i) {
+		_parameters[i] -= p_learning_rate * _gradients[i];
+	}
+}
+
+void MLPPParameterArena::clip_parameters(const int p_from, const int p_to, const real_t p_limit) {
+	ERR_FAIL_COND(p_from < 0 || p_to > _size);
+
+	for (int i = p_from; i < p_to; ++i) {
+		_parameters[i] = CLAMP(_parameters[i], -p_limit, p_limit);
+	}
+}
+
+real_t MLPPParameterArena::gradient_norm() const {
+	real_t sum = 0;
+
+	for (int i = 0; i < _size; ++i) {
+		sum += _gradients[i] * _gradients[i];
+	}
+
+	return Math::sqrt(sum);
+}
+
+real_t MLPPParameterArena::clip_gradient_norm(const real_t p_max_norm) {
+	real_t norm = gradient_norm();
+
+	if (norm > p_max_norm && norm > 0) {
+		real_t scale = p_max_norm / norm;
+
+		for (int i = 0; i < _size; ++i) {
+			_gradients[i] *= scale;
+		}
+	}
+
+	return norm;
+}
+
+Ref<MLPPVector> MLPPParameterArena::checkpoint() const {
+	Ref<MLPPVector> ret;
+	ret.instance();
+	ret->resize(_size);
+
+	if (_size > 0) {
+		memcpy(ret->ptrw(), _parameters, _size * sizeof(real_t));
+	}
+
+	return ret;
+}
+
+void MLPPParameterArena::restore(const Ref<MLPPVector> &p_checkpoint) {
+	ERR_FAIL_COND(!p_checkpoint.is_valid());
+	ERR_FAIL_COND(p_checkpoint->size() != _size);
+
+	if (_size > 0) {
+		memcpy(_parameters, p_checkpoint->ptr(), _size * sizeof(real_t));
+	}
+}
+
+MLPPParameterArena::MLPPParameterArena() {
+	_parameters = NULL;
+	_gradients = NULL;
+	_size = 0;
+
+	_parameters_view.instance();
+	_gradients_view.instance();
+}
+
+MLPPParameterArena::~MLPPParameterArena() {
+	clear();
+}
+
+void MLPPParameterArena::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("add_matrix", "params"), &MLPPParameterArena::add_matrix);
+	ClassDB::bind_method(D_METHOD("add_vector", "params"), &MLPPParameterArena::add_vector);
+
+	ClassDB::bind_method(D_METHOD("build"), &MLPPParameterArena::build);
+	ClassDB::bind_method(D_METHOD("clear"), &MLPPParameterArena::clear);
+
+	ClassDB::bind_method(D_METHOD("has_matrix", "index", "params"), &MLPPParameterArena::has_matrix);
+	ClassDB::bind_method(D_METHOD("has_vector", "index", "params"), &MLPPParameterArena::has_vector);
+
+	ClassDB::bind_method(D_METHOD("get_entry_count"), &MLPPParameterArena::get_entry_count);
+	ClassDB::bind_method(D_METHOD("get_entry_offset", "index"), &MLPPParameterArena::get_entry_offset);
+	ClassDB::bind_method(D_METHOD("get_entry_size", "index"), &MLPPParameterArena::get_entry_size);
+	ClassDB::bind_method(D_METHOD("get_size"), &MLPPParameterArena::get_size);
+
+	ClassDB::bind_method(D_METHOD("get_parameters"), &MLPPParameterArena::get_parameters);
+	ClassDB::bind_method(D_METHOD("get_gradients"), &MLPPParameterArena::get_gradients);
+
+	ClassDB::bind_method(D_METHOD("gradient_set_matrix", "index", "grad"), &MLPPParameterArena::gradient_set_matrix);
+	ClassDB::bind_method(D_METHOD("gradient_set_vector", "index", "grad"), &MLPPParameterArena::gradient_set_vector);
+	ClassDB::bind_method(D_METHOD("gradients_fill", "val"), &MLPPParameterArena::gradients_fill);
+
+	ClassDB::bind_method(D_METHOD("apply_gradients", "from", "to", "learning_rate"), &MLPPParameterArena::apply_gradients);
+	ClassDB::bind_method(D_METHOD("clip_parameters", "from", "to", "limit"), &MLPPParameterArena::clip_parameters);
+
+	ClassDB::bind_method(D_METHOD("gradient_norm"), &MLPPParameterArena::gradient_norm);
+	ClassDB::bind_method(D_METHOD("clip_gradient_norm", "max_norm"), &MLPPParameterArena::clip_gradient_norm);
+
+	ClassDB::bind_method(D_METHOD("checkpoint"), &MLPPParameterArena::checkpoint);
+	ClassDB::bind_method(D_METHOD("restore", "checkpoint"), &MLPPParameterArena::restore);
+}
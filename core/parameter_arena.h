@@ -0,0 +1,128 @@
+#ifndef MLPP_PARAMETER_ARENA_H
+#define MLPP_PARAMETER_ARENA_H
+
+/*************************************************************************/
+/*  parameter_arena.h                                                    */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifdef USING_SFW
+#include "sfw.h"
+#else
+#include "core/containers/vector.h"
+#include "core/math/math_defs.h"
+
+#include "core/object/reference.h"
+#endif
+
+#include "../core/mlpp_matrix.h"
+#include "../core/mlpp_vector.h"
+
+// Keeps every parameter of a network in one contiguous buffer, with a matching gradient buffer.
+// The registered matrices and vectors become views into the arena, so the layers keep working on them as before,
+// while optimizer steps, clipping, norms and checkpoints can run as single linear passes over the whole network.
+class MLPPParameterArena : public Reference {
+	GDCLASS(MLPPParameterArena, Reference);
+
+public:
+	// Registers a parameter buffer, returns its entry index. Call build() after adding all of them.
+	int add_matrix(const Ref<MLPPMatrix> &p_params);
+	int add_vector(const Ref<MLPPVector> &p_params);
+
+	// Copies the values of every entry into the arena, and turns the entries into views of it. Gradients start out as 0.
+	void build();
+	// Turns the entries back into normal matrices and vectors, and frees the arena.
+	void clear();
+
+	// Whether entry p_index is p_params, and it still views its place in the arena.
+	// The networks use these to notice layers that got new weights since the last build().
+	bool has_matrix(const int p_index, const Ref<MLPPMatrix> &p_params) const;
+	bool has_vector(const int p_index, const Ref<MLPPVector> &p_params) const;
+
+	int get_entry_count() const;
+	int get_entry_offset(const int p_index) const;
+	int get_entry_size(const int p_index) const;
+
+	// Number of parameters in the arena.
+	int get_size() const;
+
+	_FORCE_INLINE_ real_t *parameters_ptrw() { return _parameters; }
+	_FORCE_INLINE_ const real_t *parameters_ptr() const { return _parameters; }
+	_FORCE_INLINE_ real_t *gradients_ptrw() { return _gradients; }
+	_FORCE_INLINE_ const real_t *gradients_ptr() const { return _gradients; }
+
+	// Views of the whole parameter and gradient buffers.
+	Ref<MLPPVector> get_parameters();
+	Ref<MLPPVector> get_gradients();
+
+	void gradient_set_matrix(const int p_index, const Ref<MLPPMatrix> &p_grad);
+	void gradient_set_vector(const int p_index, const Ref<MLPPVector> &p_grad);
+	void gradients_fill(const real_t p_val);
+
+	// parameters[p_from, p_to) -= p_learning_rate * gradients[p_from, p_to)
+	void apply_gradients(const int p_from, const int p_to, const real_t p_learning_rate);
+	// Clamps parameters[p_from, p_to) into [-p_limit, p_limit], like the weight clipping of WGANs.
+	void clip_parameters(const int p_from, const int p_to, const real_t p_limit);
+
+	real_t gradient_norm() const;
+	// Scales the gradients so their norm is at most p_max_norm. Returns the norm before the scaling.
+	real_t clip_gradient_norm(const real_t p_max_norm);
+
+	// A copy of every parameter, and loading one back.
+	Ref<MLPPVector> checkpoint() const;
+	void restore(const Ref<MLPPVector> &p_checkpoint);
+
+	MLPPParameterArena();
+	~MLPPParameterArena();
+
+protected:
+	struct Entry {
+		Ref<MLPPMatrix> matrix;
+		Ref<MLPPVector> vector;
+		int offset;
+		int size;
+
+		Entry() {
+			offset = 0;
+			size = 0;
+		}
+	};
+
+	static void _bind_methods();
+
+	Vector<Entry> _entries;
+
+	real_t *_parameters;
+	real_t *_gradients;
+	int _size;
+
+	Ref<MLPPVector> _parameters_view;
+	Ref<MLPPVector> _gradients_view;
+};
+
+#endif
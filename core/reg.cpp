@@ -189,17 +189,16 @@ void MLPPReg::_bind_methods() {
 	BIND_ENUM_CONSTANT(REGULARIZATION_TYPE_WEIGHT_CLIPPING);
 }
 
-real_t MLPPReg::reg_deriv_termvr(const Ref<MLPPVector> &weights, real_t lambda, real_t alpha, MLPPReg::RegularizationType reg, int j) {
-	MLPPActivation act;
-
-	real_t wj = weights->element_get(j);
+real_t MLPPReg::reg_deriv_termr(real_t wj, real_t lambda, real_t alpha, MLPPReg::RegularizationType reg) {
+	// sign_normr(), without needing an MLPPActivation instance per weight.
+	real_t sign = static_cast<real_t>((wj > 0) - (wj < 0));
 
 	if (reg == REGULARIZATION_TYPE_RIDGE) {
 		return lambda * wj;
 	} else if (reg == REGULARIZATION_TYPE_LASSO) {
-		return lambda * act.sign_normr(wj);
+		return lambda * sign;
 	} else if (reg == REGULARIZATION_TYPE_ELASTIC_NET) {
-		return alpha * lambda * act.sign_normr(wj) + (1 - alpha) * lambda * wj;
+		return alpha * lambda * sign + (1 - alpha) * lambda * wj;
 	} else if (reg == REGULARIZATION_TYPE_WEIGHT_CLIPPING) { // Preparation for Wasserstein GANs.
 		// We assume lambda is the lower clipping threshold, while alpha is the higher clipping threshold.
 		// alpha > lambda.
@@ -214,28 +213,10 @@ real_t MLPPReg::reg_deriv_termvr(const Ref<MLPPVector> &weights, real_t lambda,
 		return 0;
 	}
 }
-real_t MLPPReg::reg_deriv_termmr(const Ref<MLPPMatrix> &weights, real_t lambda, real_t alpha, MLPPReg::RegularizationType reg, int i, int j) {
-	MLPPActivation act;
 
-	real_t wj = weights->element_get(i, j);
-
-	if (reg == REGULARIZATION_TYPE_RIDGE) {
-		return lambda * wj;
-	} else if (reg == REGULARIZATION_TYPE_LASSO) {
-		return lambda * act.sign_normr(wj);
-	} else if (reg == REGULARIZATION_TYPE_ELASTIC_NET) {
-		return alpha * lambda * act.sign_normr(wj) + (1 - alpha) * lambda * wj;
-	} else if (reg == REGULARIZATION_TYPE_WEIGHT_CLIPPING) { // Preparation for Wasserstein GANs.
-		// We assume lambda is the lower clipping threshold, while alpha is the higher clipping threshold.
-		// alpha > lambda.
-		if (wj > alpha) {
-			return alpha;
-		} else if (wj < lambda) {
-			return lambda;
-		} else {
-			return wj;
-		}
-	} else {
-		return 0;
-	}
+real_t MLPPReg::reg_deriv_termvr(const Ref<MLPPVector> &weights, real_t lambda, real_t alpha, MLPPReg::RegularizationType reg, int j) {
+	return reg_deriv_termr(weights->element_get(j), lambda, alpha, reg);
+}
+real_t MLPPReg::reg_deriv_termmr(const Ref<MLPPMatrix> &weights, real_t lambda, real_t alpha, MLPPReg::RegularizationType reg, int i, int j) {
+	return reg_deriv_termr(weights->element_get(i, j), lambda, alpha, reg);
 }
@@ -66,6 +66,9 @@ public:
 	Ref<MLPPVector> reg_deriv_termv(const Ref<MLPPVector> &weights, real_t lambda, real_t alpha, RegularizationType reg);
 	Ref<MLPPMatrix> reg_deriv_termm(const Ref<MLPPMatrix> &weights, real_t lambda, real_t alpha, RegularizationType reg);
 
+	// The derivative term for a single weight.
+	static real_t reg_deriv_termr(real_t wj, real_t lambda, real_t alpha, RegularizationType reg);
+
 	MLPPReg();
 	~MLPPReg();
 
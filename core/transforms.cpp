@@ -31,6 +31,7 @@
 #include "transforms.h"
 
 #include "../core/lin_alg.h"
+#include "../core/parallel.h"
 
 #ifdef USING_SFW
 #include "sfw.h"
@@ -41,46 +42,871 @@
 // DCT ii.
 // https://www.mathworks.com/help/images/discrete-cosine-transform.html
 Ref<MLPPMatrix> MLPPTransforms::discrete_cosine_transform(const Ref<MLPPMatrix> &p_A) {
+	ERR_FAIL_COND_V(!p_A.is_valid(), Ref<MLPPMatrix>());
+
 	Ref<MLPPMatrix> A = p_A->scalar_addn(-128); // Center around 0.
 
-	Size2i size = A->size();
+	_dct_2d(A->ptrw(), A->size(), false);
+
+	return A;
+}
+
+Ref<MLPPVector> MLPPTransforms::dct(const Ref<MLPPVector> &p_x) {
+	ERR_FAIL_COND_V(!p_x.is_valid(), Ref<MLPPVector>());
+
+	Ref<MLPPVector> x = p_x->duplicate_fast();
+
+	_dct_2d(x->ptrw(), Size2i(x->size(), 1), false);
+
+	return x;
+}
+
+Ref<MLPPVector> MLPPTransforms::idct(const Ref<MLPPVector> &p_x) {
+	ERR_FAIL_COND_V(!p_x.is_valid(), Ref<MLPPVector>());
+
+	Ref<MLPPVector> x = p_x->duplicate_fast();
+
+	_dct_2d(x->ptrw(), Size2i(x->size(), 1), true);
+
+	return x;
+}
+
+Ref<MLPPMatrix> MLPPTransforms::dct_2d(const Ref<MLPPMatrix> &p_A) {
+	ERR_FAIL_COND_V(!p_A.is_valid(), Ref<MLPPMatrix>());
+
+	Ref<MLPPMatrix> A = p_A->duplicate_fast();
+
+	_dct_2d(A->ptrw(), A->size(), false);
+
+	return A;
+}
+
+Ref<MLPPMatrix> MLPPTransforms::idct_2d(const Ref<MLPPMatrix> &p_A) {
+	ERR_FAIL_COND_V(!p_A.is_valid(), Ref<MLPPMatrix>());
+
+	Ref<MLPPMatrix> A = p_A->duplicate_fast();
+
+	_dct_2d(A->ptrw(), A->size(), true);
+
+	return A;
+}
+
+Ref<MLPPMatrix> MLPPTransforms::dct_blocks_2d(const Ref<MLPPMatrix> &p_A) {
+	ERR_FAIL_COND_V(!p_A.is_valid(), Ref<MLPPMatrix>());
+
+	Size2i size = p_A->size();
+
+	ERR_FAIL_COND_V(size.x % DCT_BLOCK_SIZE != 0 || size.y % DCT_BLOCK_SIZE != 0, Ref<MLPPMatrix>());
+
+	Ref<MLPPMatrix> res;
+	res.instance();
+	res->resize(size);
+
+	DCTBlockData data;
+	data.input = p_A->ptr();
+	data.output = res->ptrw();
+	data.size = size;
+	data.slice_count = 1;
+	data.inverse = false;
+
+	_dct_blocks(&data);
+
+	return res;
+}
+
+Ref<MLPPMatrix> MLPPTransforms::idct_blocks_2d(const Ref<MLPPMatrix> &p_A) {
+	ERR_FAIL_COND_V(!p_A.is_valid(), Ref<MLPPMatrix>());
+
+	Size2i size = p_A->size();
+
+	ERR_FAIL_COND_V(size.x % DCT_BLOCK_SIZE != 0 || size.y % DCT_BLOCK_SIZE != 0, Ref<MLPPMatrix>());
+
+	Ref<MLPPMatrix> res;
+	res.instance();
+	res->resize(size);
+
+	DCTBlockData data;
+	data.input = p_A->ptr();
+	data.output = res->ptrw();
+	data.size = size;
+	data.slice_count = 1;
+	data.inverse = true;
+
+	_dct_blocks(&data);
+
+	return res;
+}
+
+Ref<MLPPTensor3> MLPPTransforms::dct_blocks_3d(const Ref<MLPPTensor3> &p_A) {
+	ERR_FAIL_COND_V(!p_A.is_valid(), Ref<MLPPTensor3>());
 
-	Ref<MLPPMatrix> B;
-	B.instance();
-	B->resize(size);
+	Size3i size = p_A->size();
 
-	real_t M = size.y;
-	real_t inv_sqrt_M = 1 / Math::sqrt(M);
-	real_t s2M = Math::sqrt(real_t(2) / real_t(M));
+	ERR_FAIL_COND_V(size.x % DCT_BLOCK_SIZE != 0 || size.y % DCT_BLOCK_SIZE != 0, Ref<MLPPTensor3>());
 
-	for (int i = 0; i < size.y; i++) {
-		for (int j = 0; j < size.x; j++) {
-			real_t sum = 0;
+	Ref<MLPPTensor3> res;
+	res.instance();
+	res->resize(size);
 
-			real_t alphaI;
-			if (i == 0) {
-				alphaI = inv_sqrt_M;
-			} else {
-				alphaI = s2M;
+	DCTBlockData data;
+	data.input = p_A->ptr();
+	data.output = res->ptrw();
+	data.size = Size2i(size.x, size.y);
+	data.slice_count = size.z;
+	data.inverse = false;
+
+	_dct_blocks(&data);
+
+	return res;
+}
+
+Ref<MLPPTensor3> MLPPTransforms::idct_blocks_3d(const Ref<MLPPTensor3> &p_A) {
+	ERR_FAIL_COND_V(!p_A.is_valid(), Ref<MLPPTensor3>());
+
+	Size3i size = p_A->size();
+
+	ERR_FAIL_COND_V(size.x % DCT_BLOCK_SIZE != 0 || size.y % DCT_BLOCK_SIZE != 0, Ref<MLPPTensor3>());
+
+	Ref<MLPPTensor3> res;
+	res.instance();
+	res->resize(size);
+
+	DCTBlockData data;
+	data.input = p_A->ptr();
+	data.output = res->ptrw();
+	data.size = Size2i(size.x, size.y);
+	data.slice_count = size.z;
+	data.inverse = true;
+
+	_dct_blocks(&data);
+
+	return res;
+}
+
+MLPPTransforms::FFTResult MLPPTransforms::fft(const Ref<MLPPVector> &real, const Ref<MLPPVector> &imag) {
+	FFTResult res;
+
+	ERR_FAIL_COND_V(!real.is_valid(), res);
+	ERR_FAIL_COND_V(imag.is_valid() && imag->size() != real->size(), res);
+
+	int n = real->size();
+
+	Vector<real_t> data;
+	data.resize(2 * n);
+	real_t *data_ptr = data.ptrw();
+
+	const real_t *real_ptr = real->ptr();
+	const real_t *imag_ptr = imag.is_valid() ? imag->ptr() : NULL;
+
+	for (int i = 0; i < n; ++i) {
+		data_ptr[2 * i] = real_ptr[i];
+		data_ptr[2 * i + 1] = imag_ptr ? imag_ptr[i] : 0;
+	}
+
+	fft_complex(data_ptr, n, false);
+
+	res.real.instance();
+	res.real->resize(n);
+	res.imag.instance();
+	res.imag->resize(n);
+
+	real_t *res_real_ptr = res.real->ptrw();
+	real_t *res_imag_ptr = res.imag->ptrw();
+
+	for (int i = 0; i < n; ++i) {
+		res_real_ptr[i] = data_ptr[2 * i];
+		res_imag_ptr[i] = data_ptr[2 * i + 1];
+	}
+
+	return res;
+}
+
+MLPPTransforms::FFTResult MLPPTransforms::ifft(const Ref<MLPPVector> &real, const Ref<MLPPVector> &imag) {
+	FFTResult res;
+
+	ERR_FAIL_COND_V(!real.is_valid() || !imag.is_valid(), res);
+	ERR_FAIL_COND_V(imag->size() != real->size(), res);
+
+	int n = real->size();
+
+	Vector<real_t> data;
+	data.resize(2 * n);
+	real_t *data_ptr = data.ptrw();
+
+	const real_t *real_ptr = real->ptr();
+	const real_t *imag_ptr = imag->ptr();
+
+	for (int i = 0; i < n; ++i) {
+		data_ptr[2 * i] = real_ptr[i];
+		data_ptr[2 * i + 1] = imag_ptr[i];
+	}
+
+	fft_complex(data_ptr, n, true);
+
+	res.real.instance();
+	res.real->resize(n);
+	res.imag.instance();
+	res.imag->resize(n);
+
+	real_t *res_real_ptr = res.real->ptrw();
+	real_t *res_imag_ptr = res.imag->ptrw();
+
+	for (int i = 0; i < n; ++i) {
+		res_real_ptr[i] = data_ptr[2 * i];
+		res_imag_ptr[i] = data_ptr[2 * i + 1];
+	}
+
+	return res;
+}
+
+MLPPTransforms::FFT2DResult MLPPTransforms::fft_2d(const Ref<MLPPMatrix> &real, const Ref<MLPPMatrix> &imag) {
+	FFT2DResult res;
+
+	ERR_FAIL_COND_V(!real.is_valid(), res);
+	ERR_FAIL_COND_V(imag.is_valid() && imag->size() != real->size(), res);
+
+	Size2i size = real->size();
+	int n = size.x * size.y;
+
+	Vector<real_t> data;
+	data.resize(2 * n);
+	real_t *data_ptr = data.ptrw();
+
+	const real_t *real_ptr = real->ptr();
+	const real_t *imag_ptr = imag.is_valid() ? imag->ptr() : NULL;
+
+	for (int i = 0; i < n; ++i) {
+		data_ptr[2 * i] = real_ptr[i];
+		data_ptr[2 * i + 1] = imag_ptr ? imag_ptr[i] : 0;
+	}
+
+	fft_2d_complex(data_ptr, size, false);
+
+	res.real.instance();
+	res.real->resize(size);
+	res.imag.instance();
+	res.imag->resize(size);
+
+	real_t *res_real_ptr = res.real->ptrw();
+	real_t *res_imag_ptr = res.imag->ptrw();
+
+	for (int i = 0; i < n; ++i) {
+		res_real_ptr[i] = data_ptr[2 * i];
+		res_imag_ptr[i] = data_ptr[2 * i + 1];
+	}
+
+	return res;
+}
+
+MLPPTransforms::FFT2DResult MLPPTransforms::ifft_2d(const Ref<MLPPMatrix> &real, const Ref<MLPPMatrix> &imag) {
+	FFT2DResult res;
+
+	ERR_FAIL_COND_V(!real.is_valid() || !imag.is_valid(), res);
+	ERR_FAIL_COND_V(imag->size() != real->size(), res);
+
+	Size2i size = real->size();
+	int n = size.x * size.y;
+
+	Vector<real_t> data;
+	data.resize(2 * n);
+	real_t *data_ptr = data.ptrw();
+
+	const real_t *real_ptr = real->ptr();
+	const real_t *imag_ptr = imag->ptr();
+
+	for (int i = 0; i < n; ++i) {
+		data_ptr[2 * i] = real_ptr[i];
+		data_ptr[2 * i + 1] = imag_ptr[i];
+	}
+
+	fft_2d_complex(data_ptr, size, true);
+
+	res.real.instance();
+	res.real->resize(size);
+	res.imag.instance();
+	res.imag->resize(size);
+
+	real_t *res_real_ptr = res.real->ptrw();
+	real_t *res_imag_ptr = res.imag->ptrw();
+
+	for (int i = 0; i < n; ++i) {
+		res_real_ptr[i] = data_ptr[2 * i];
+		res_imag_ptr[i] = data_ptr[2 * i + 1];
+	}
+
+	return res;
+}
+
+void MLPPTransforms::fft_complex(real_t *p_data, const int p_size, const bool p_inverse) {
+	ERR_FAIL_COND(!p_data && p_size > 0);
+
+	if (p_size <= 1) {
+		return;
+	}
+
+	const FFTPlan *plan = _fft_plan_get(p_size);
+
+	Vector<real_t> scratch;
+	scratch.resize(2 * p_size);
+
+	_fft_execute(plan, p_data, scratch.ptrw(), p_inverse);
+
+	_fft_plan_release(plan);
+}
+
+void MLPPTransforms::fft_2d_complex(real_t *p_data, const Size2i &p_size, const bool p_inverse) {
+	ERR_FAIL_COND(!p_data && p_size.x * p_size.y > 0);
+
+	if (p_size.x <= 0 || p_size.y <= 0) {
+		return;
+	}
+
+	// The plans are looked up here, so the workers only read them.
+	FFT2DData data;
+	data.data = p_data;
+	data.size = p_size;
+	data.row_plan = p_size.x > 1 ? _fft_plan_get(p_size.x) : NULL;
+	data.column_plan = p_size.y > 1 ? _fft_plan_get(p_size.y) : NULL;
+	data.inverse = p_inverse;
+
+	if (data.row_plan) {
+		MLPPParallel::do_work(p_size.y, this, &MLPPTransforms::_fft_rows_range, &data, 1 + 16384 / p_size.x);
+	}
+
+	if (data.column_plan) {
+		MLPPParallel::do_work(p_size.x, this, &MLPPTransforms::_fft_columns_range, &data, 1 + 16384 / p_size.y);
+	}
+
+	_fft_plan_release(data.row_plan);
+	_fft_plan_release(data.column_plan);
+}
+
+int MLPPTransforms::fft_good_size(const int n) {
+	if (n <= 1) {
+		return 1;
+	}
+
+	for (int size = n;; ++size) {
+		int m = size;
+
+		while (m % 2 == 0) {
+			m /= 2;
+		}
+		while (m % 3 == 0) {
+			m /= 3;
+		}
+		while (m % 5 == 0) {
+			m /= 5;
+		}
+
+		if (m == 1) {
+			return size;
+		}
+	}
+}
+
+void MLPPTransforms::fft_plan_cache_clear() {
+	MutexLock lock(_fft_plans_mutex);
+
+	for (int i = _fft_plans.size() - 1; i >= 0; --i) {
+		if (_fft_plans[i]->users == 0) {
+			memdelete(_fft_plans[i]);
+			_fft_plans.remove(i);
+		}
+	}
+}
+
+MLPPTransforms::MLPPTransforms() {
+}
+
+MLPPTransforms::~MLPPTransforms() {
+	fft_plan_cache_clear();
+}
+
+// Sizes used with different image dimensions can add up, the oldest plan is dropped above this.
+static const int FFT_PLAN_CACHE_SIZE = 32;
+
+const MLPPTransforms::FFTPlan *MLPPTransforms::_fft_plan_get(const int p_size) {
+	MutexLock lock(_fft_plans_mutex);
+
+	for (int i = 0; i < _fft_plans.size(); ++i) {
+		if (_fft_plans[i]->size == p_size) {
+			++_fft_plans[i]->users;
+			return _fft_plans[i];
+		}
+	}
+
+	if (_fft_plans.size() >= FFT_PLAN_CACHE_SIZE) {
+		// The oldest plan that no other thread is using.
+		for (int i = 0; i < _fft_plans.size(); ++i) {
+			if (_fft_plans[i]->users == 0) {
+				memdelete(_fft_plans[i]);
+				_fft_plans.remove(i);
+				break;
 			}
+		}
+	}
 
-			real_t alphaJ;
-			if (j == 0) {
-				alphaJ = inv_sqrt_M;
-			} else {
-				alphaJ = s2M;
+	FFTPlan *plan = memnew(FFTPlan);
+	plan->size = p_size;
+	plan->users = 1;
+
+	// Radix 4 first, as it has the cheapest butterflies per element.
+	int n = p_size;
+	int p = 4;
+
+	while (n > 1) {
+		while (n % p != 0) {
+			switch (p) {
+				case 4:
+					p = 2;
+					break;
+				case 2:
+					p = 3;
+					break;
+				default:
+					p += 2;
+					break;
 			}
 
-			for (int k = 0; k < size.y; k++) {
-				for (int f = 0; f < size.x; f++) {
-					sum += A->element_get(k, f) * Math::cos((Math_PI * i * (2 * k + 1)) / (2 * M)) * Math::cos((Math_PI * j * (2 * f + 1)) / (2 * M));
+			if (p * p > n) {
+				p = n;
+			}
+		}
+
+		n /= p;
+		plan->factors.push_back(p);
+	}
+
+	plan->twiddles.resize(2 * p_size);
+	real_t *tw = plan->twiddles.ptrw();
+
+	for (int k = 0; k < p_size; ++k) {
+		double phase = -2.0 * Math_PI * k / p_size;
+
+		tw[2 * k] = Math::cos(phase);
+		tw[2 * k + 1] = Math::sin(phase);
+	}
+
+	_fft_plans.push_back(plan);
+
+	return plan;
+}
+
+void MLPPTransforms::_fft_plan_release(const FFTPlan *p_plan) {
+	if (!p_plan) {
+		return;
+	}
+
+	MutexLock lock(_fft_plans_mutex);
+
+	for (int i = 0; i < _fft_plans.size(); ++i) {
+		if (_fft_plans[i] == p_plan) {
+			--_fft_plans[i]->users;
+			return;
+		}
+	}
+}
+
+void MLPPTransforms::_fft_execute(const FFTPlan *p_plan, real_t *p_data, real_t *p_scratch, const bool p_inverse) const {
+	int n = p_plan->size;
+
+	_fft_recursive(p_plan, p_data, p_scratch, n, 1, 0, 1, p_inverse);
+
+	if (p_inverse) {
+		real_t scale = real_t(1) / n;
+
+		for (int i = 0; i < 2 * n; ++i) {
+			p_data[i] = p_scratch[i] * scale;
+		}
+	} else {
+		for (int i = 0; i < 2 * n; ++i) {
+			p_data[i] = p_scratch[i];
+		}
+	}
+}
+
+// Decimation in time, the same structure as KISS FFT: the p sub-transforms of size n / p are written
+// next to each other in p_out, and then combined with radix p butterflies. The output is in natural order.
+void MLPPTransforms::_fft_recursive(const FFTPlan *p_plan, const real_t *p_in, real_t *p_out, const int p_size, const int p_in_stride, const int p_factor_index, const int p_twiddle_stride, const bool p_inverse) const {
+	const int p = p_plan->factors[p_factor_index];
+	const int m = p_size / p;
+
+	if (m == 1) {
+		for (int q = 0; q < p; ++q) {
+			p_out[2 * q] = p_in[2 * q * p_in_stride];
+			p_out[2 * q + 1] = p_in[2 * q * p_in_stride + 1];
+		}
+	} else {
+		for (int q = 0; q < p; ++q) {
+			_fft_recursive(p_plan, p_in + 2 * q * p_in_stride, p_out + 2 * q * m, m, p_in_stride * p, p_factor_index + 1, p_twiddle_stride * p, p_inverse);
+		}
+	}
+
+	const real_t *tw = p_plan->twiddles.ptr();
+	// The inverse uses the conjugate twiddles.
+	const real_t tw_sign = p_inverse ? -1 : 1;
+
+	if (p == 2) {
+		for (int k = 0; k < m; ++k) {
+			real_t *a = p_out + 2 * k;
+			real_t *b = p_out + 2 * (k + m);
+
+			real_t wr = tw[2 * k * p_twiddle_stride];
+			real_t wi = tw_sign * tw[2 * k * p_twiddle_stride + 1];
+
+			real_t tr = b[0] * wr - b[1] * wi;
+			real_t ti = b[0] * wi + b[1] * wr;
+
+			b[0] = a[0] - tr;
+			b[1] = a[1] - ti;
+			a[0] += tr;
+			a[1] += ti;
+		}
+	} else if (p == 4) {
+		for (int k = 0; k < m; ++k) {
+			real_t t[8];
+
+			t[0] = p_out[2 * k];
+			t[1] = p_out[2 * k + 1];
+
+			for (int q = 1; q < 4; ++q) {
+				const real_t *x = p_out + 2 * (k + q * m);
+				int twi = 2 * q * k * p_twiddle_stride;
+
+				real_t wr = tw[twi];
+				real_t wi = tw_sign * tw[twi + 1];
+
+				t[2 * q] = x[0] * wr - x[1] * wi;
+				t[2 * q + 1] = x[0] * wi + x[1] * wr;
+			}
+
+			real_t a0r = t[0] + t[4];
+			real_t a0i = t[1] + t[5];
+			real_t a1r = t[0] - t[4];
+			real_t a1i = t[1] - t[5];
+			real_t a2r = t[2] + t[6];
+			real_t a2i = t[3] + t[7];
+			// (t1 - t3) * -i for the forward transform, * i for the inverse.
+			real_t a3r = tw_sign * (t[3] - t[7]);
+			real_t a3i = -tw_sign * (t[2] - t[6]);
+
+			p_out[2 * k] = a0r + a2r;
+			p_out[2 * k + 1] = a0i + a2i;
+			p_out[2 * (k + 2 * m)] = a0r - a2r;
+			p_out[2 * (k + 2 * m) + 1] = a0i - a2i;
+			p_out[2 * (k + m)] = a1r + a3r;
+			p_out[2 * (k + m) + 1] = a1i + a3i;
+			p_out[2 * (k + 3 * m)] = a1r - a3r;
+			p_out[2 * (k + 3 * m) + 1] = a1i - a3i;
+		}
+	} else {
+		// Generic radix p DFT.
+		Vector<real_t> t;
+		t.resize(2 * p);
+		real_t *t_ptr = t.ptrw();
+
+		// W_p^j = W_size^(j * m)
+		const int wp_stride = m * p_twiddle_stride;
+
+		for (int k = 0; k < m; ++k) {
+			for (int q = 0; q < p; ++q) {
+				const real_t *x = p_out + 2 * (k + q * m);
+				int twi = 2 * q * k * p_twiddle_stride;
+
+				real_t wr = tw[twi];
+				real_t wi = tw_sign * tw[twi + 1];
+
+				t_ptr[2 * q] = x[0] * wr - x[1] * wi;
+				t_ptr[2 * q + 1] = x[0] * wi + x[1] * wr;
+			}
+
+			for (int r = 0; r < p; ++r) {
+				real_t sr = 0;
+				real_t si = 0;
+
+				for (int q = 0; q < p; ++q) {
+					int twi = 2 * ((q * r) % p) * wp_stride;
+
+					real_t wr = tw[twi];
+					real_t wi = tw_sign * tw[twi + 1];
+
+					sr += t_ptr[2 * q] * wr - t_ptr[2 * q + 1] * wi;
+					si += t_ptr[2 * q] * wi + t_ptr[2 * q + 1] * wr;
 				}
+
+				p_out[2 * (k + r * m)] = sr;
+				p_out[2 * (k + r * m) + 1] = si;
+			}
+		}
+	}
+}
+
+void MLPPTransforms::_fft_rows_range(int p_from, int p_to, FFT2DData *p_data) {
+	const int nx = p_data->size.x;
+
+	Vector<real_t> scratch;
+	scratch.resize(2 * nx);
+	real_t *scratch_ptr = scratch.ptrw();
+
+	for (int i = p_from; i < p_to; ++i) {
+		_fft_execute(p_data->row_plan, p_data->data + 2 * i * nx, scratch_ptr, p_data->inverse);
+	}
+}
+
+void MLPPTransforms::_fft_columns_range(int p_from, int p_to, FFT2DData *p_data) {
+	const int nx = p_data->size.x;
+	const int ny = p_data->size.y;
+
+	Vector<real_t> column;
+	column.resize(2 * ny);
+	real_t *column_ptr = column.ptrw();
+
+	Vector<real_t> scratch;
+	scratch.resize(2 * ny);
+	real_t *scratch_ptr = scratch.ptrw();
+
+	for (int j = p_from; j < p_to; ++j) {
+		for (int i = 0; i < ny; ++i) {
+			column_ptr[2 * i] = p_data->data[2 * (i * nx + j)];
+			column_ptr[2 * i + 1] = p_data->data[2 * (i * nx + j) + 1];
+		}
+
+		_fft_execute(p_data->column_plan, column_ptr, scratch_ptr, p_data->inverse);
+
+		for (int i = 0; i < ny; ++i) {
+			p_data->data[2 * (i * nx + j)] = column_ptr[2 * i];
+			p_data->data[2 * (i * nx + j) + 1] = column_ptr[2 * i + 1];
+		}
+	}
+}
+
+static void _dct_twiddles_make(const int p_size, Vector<real_t> &r_twiddles) {
+	r_twiddles.resize(2 * p_size);
+	real_t *twiddles = r_twiddles.ptrw();
+
+	for (int k = 0; k < p_size; ++k) {
+		double phase = Math_PI * k / (2.0 * p_size);
+
+		twiddles[2 * k] = Math::cos(phase);
+		twiddles[2 * k + 1] = Math::sin(phase);
+	}
+}
+
+void MLPPTransforms::_dct_2d(real_t *p_data, const Size2i &p_size, const bool p_inverse) {
+	if (p_size.x <= 0 || p_size.y <= 0) {
+		return;
+	}
+
+	// Size 1 transforms are the identity, so they have no plans.
+	Vector<real_t> row_twiddles;
+	Vector<real_t> column_twiddles;
+
+	DCTData data;
+	data.data = p_data;
+	data.size = p_size;
+	data.row_plan = p_size.x > 1 ? _fft_plan_get(p_size.x) : NULL;
+	data.column_plan = p_size.y > 1 ? _fft_plan_get(p_size.y) : NULL;
+	data.inverse = p_inverse;
+
+	if (data.row_plan) {
+		_dct_twiddles_make(p_size.x, row_twiddles);
+		data.row_twiddles = row_twiddles.ptr();
+
+		MLPPParallel::do_work(p_size.y, this, &MLPPTransforms::_dct_rows_range, &data, 1 + 16384 / p_size.x);
+	}
+
+	if (data.column_plan) {
+		_dct_twiddles_make(p_size.y, column_twiddles);
+		data.column_twiddles = column_twiddles.ptr();
+
+		MLPPParallel::do_work(p_size.x, this, &MLPPTransforms::_dct_columns_range, &data, 1 + 16384 / p_size.y);
+	}
+
+	_fft_plan_release(data.row_plan);
+	_fft_plan_release(data.column_plan);
+}
+
+// Makhoul: the DCT-II of x is the real part of exp(-i * pi * k / (2 * n)) * FFT(v), where v is x reordered as
+// x[0], x[2], x[4], ... x[5], x[3], x[1]. The DCT-III runs the same steps backwards.
+// p_scratch is 4 * n long.
+void MLPPTransforms::_dct_line(const FFTPlan *p_plan, const real_t *p_twiddles, real_t *p_line, const int p_stride, real_t *p_scratch, const bool p_inverse) const {
+	const int n = p_plan->size;
+
+	real_t *v = p_scratch;
+	real_t *fft_scratch = p_scratch + 2 * n;
+
+	const real_t scale_0 = Math::sqrt(real_t(1) / n);
+	const real_t scale_k = Math::sqrt(real_t(2) / n);
+
+	if (!p_inverse) {
+		for (int k = 0; 2 * k < n; ++k) {
+			v[2 * k] = p_line[2 * k * p_stride];
+			v[2 * k + 1] = 0;
+		}
+
+		for (int k = 0; 2 * k + 1 < n; ++k) {
+			v[2 * (n - 1 - k)] = p_line[(2 * k + 1) * p_stride];
+			v[2 * (n - 1 - k) + 1] = 0;
+		}
+
+		_fft_execute(p_plan, v, fft_scratch, false);
+
+		for (int k = 0; k < n; ++k) {
+			real_t val = v[2 * k] * p_twiddles[2 * k] + v[2 * k + 1] * p_twiddles[2 * k + 1];
+
+			p_line[k * p_stride] = val * (k == 0 ? scale_0 : scale_k);
+		}
+	} else {
+		const real_t inv_scale_0 = 1 / scale_0;
+		const real_t inv_scale_k = 1 / scale_k;
+
+		for (int k = 0; k < n; ++k) {
+			real_t y = p_line[k * p_stride] * (k == 0 ? inv_scale_0 : inv_scale_k);
+			real_t y_mirror = k == 0 ? 0 : p_line[(n - k) * p_stride] * inv_scale_k;
+
+			real_t c = p_twiddles[2 * k];
+			real_t s = p_twiddles[2 * k + 1];
+
+			v[2 * k] = c * y + s * y_mirror;
+			v[2 * k + 1] = s * y - c * y_mirror;
+		}
+
+		_fft_execute(p_plan, v, fft_scratch, true);
+
+		for (int k = 0; 2 * k < n; ++k) {
+			p_line[2 * k * p_stride] = v[2 * k];
+		}
+
+		for (int k = 0; 2 * k + 1 < n; ++k) {
+			p_line[(2 * k + 1) * p_stride] = v[2 * (n - 1 - k)];
+		}
+	}
+}
+
+void MLPPTransforms::_dct_rows_range(int p_from, int p_to, DCTData *p_data) {
+	const int nx = p_data->size.x;
+
+	Vector<real_t> scratch;
+	scratch.resize(4 * nx);
+	real_t *scratch_ptr = scratch.ptrw();
+
+	for (int i = p_from; i < p_to; ++i) {
+		_dct_line(p_data->row_plan, p_data->row_twiddles, p_data->data + i * nx, 1, scratch_ptr, p_data->inverse);
+	}
+}
+
+void MLPPTransforms::_dct_columns_range(int p_from, int p_to, DCTData *p_data) {
+	const int nx = p_data->size.x;
+	const int ny = p_data->size.y;
+
+	Vector<real_t> column;
+	column.resize(ny);
+	real_t *column_ptr = column.ptrw();
+
+	Vector<real_t> scratch;
+	scratch.resize(4 * ny);
+	real_t *scratch_ptr = scratch.ptrw();
+
+	for (int j = p_from; j < p_to; ++j) {
+		for (int i = 0; i < ny; ++i) {
+			column_ptr[i] = p_data->data[i * nx + j];
+		}
+
+		_dct_line(p_data->column_plan, p_data->column_twiddles, column_ptr, 1, scratch_ptr, p_data->inverse);
+
+		for (int i = 0; i < ny; ++i) {
+			p_data->data[i * nx + j] = column_ptr[i];
+		}
+	}
+}
+
+// The basis is symmetric in n for even k, and antisymmetric for odd k, so both directions
+// are split into a 4 point even and a 4 point odd half. That is 32 multiplications instead of 64.
+static _FORCE_INLINE_ void _dct_8(const real_t (*p_basis)[8], const real_t *p_in, const int p_in_stride, real_t *p_out, const int p_out_stride) {
+	real_t sum[4];
+	real_t diff[4];
+
+	for (int n = 0; n < 4; ++n) {
+		real_t a = p_in[n * p_in_stride];
+		real_t b = p_in[(7 - n) * p_in_stride];
+
+		sum[n] = a + b;
+		diff[n] = a - b;
+	}
+
+	for (int k = 0; k < 8; k += 2) {
+		const real_t *even = p_basis[k];
+		const real_t *odd = p_basis[k + 1];
+
+		p_out[k * p_out_stride] = sum[0] * even[0] + sum[1] * even[1] + sum[2] * even[2] + sum[3] * even[3];
+		p_out[(k + 1) * p_out_stride] = diff[0] * odd[0] + diff[1] * odd[1] + diff[2] * odd[2] + diff[3] * odd[3];
+	}
+}
+
+static _FORCE_INLINE_ void _idct_8(const real_t (*p_basis)[8], const real_t *p_in, const int p_in_stride, real_t *p_out, const int p_out_stride) {
+	for (int n = 0; n < 4; ++n) {
+		real_t even = 0;
+		real_t odd = 0;
+
+		for (int k = 0; k < 8; k += 2) {
+			even += p_in[k * p_in_stride] * p_basis[k][n];
+			odd += p_in[(k + 1) * p_in_stride] * p_basis[k + 1][n];
+		}
+
+		p_out[n * p_out_stride] = even + odd;
+		p_out[(7 - n) * p_out_stride] = even - odd;
+	}
+}
+
+void MLPPTransforms::_dct_blocks(DCTBlockData *p_data) {
+	for (int k = 0; k < DCT_BLOCK_SIZE; ++k) {
+		double scale = k == 0 ? Math::sqrt(1.0 / DCT_BLOCK_SIZE) : Math::sqrt(2.0 / DCT_BLOCK_SIZE);
+
+		for (int n = 0; n < DCT_BLOCK_SIZE; ++n) {
+			p_data->basis[k][n] = scale * Math::cos(Math_PI * (2 * n + 1) * k / (2.0 * DCT_BLOCK_SIZE));
+		}
+	}
+
+	int block_count = p_data->slice_count * (p_data->size.x / DCT_BLOCK_SIZE) * (p_data->size.y / DCT_BLOCK_SIZE);
+
+	MLPPParallel::do_work(block_count, this, &MLPPTransforms::_dct_blocks_range, p_data, 256);
+}
+
+void MLPPTransforms::_dct_blocks_range(int p_from, int p_to, DCTBlockData *p_data) {
+	const Size2i size = p_data->size;
+	const int blocks_x = size.x / DCT_BLOCK_SIZE;
+	const int blocks_per_slice = blocks_x * (size.y / DCT_BLOCK_SIZE);
+
+	real_t tmp[DCT_BLOCK_SIZE * DCT_BLOCK_SIZE];
+
+	for (int b = p_from; b < p_to; ++b) {
+		int slice = b / blocks_per_slice;
+		int block = b % blocks_per_slice;
+		int offset = slice * size.x * size.y + (block / blocks_x) * DCT_BLOCK_SIZE * size.x + (block % blocks_x) * DCT_BLOCK_SIZE;
+
+		const real_t *in = p_data->input + offset;
+		real_t *out = p_data->output + offset;
+
+		// Rows into tmp, then the columns of tmp into the output.
+		if (!p_data->inverse) {
+			for (int i = 0; i < DCT_BLOCK_SIZE; ++i) {
+				_dct_8(p_data->basis, in + i * size.x, 1, tmp + i * DCT_BLOCK_SIZE, 1);
 			}
 
-			B->element_set(i, j, sum * alphaI * alphaJ);
+			for (int j = 0; j < DCT_BLOCK_SIZE; ++j) {
+				_dct_8(p_data->basis, tmp + j, DCT_BLOCK_SIZE, out + j, size.x);
+			}
+		} else {
+			for (int i = 0; i < DCT_BLOCK_SIZE; ++i) {
+				_idct_8(p_data->basis, in + i * size.x, 1, tmp + i * DCT_BLOCK_SIZE, 1);
+			}
+
+			for (int j = 0; j < DCT_BLOCK_SIZE; ++j) {
+				_idct_8(p_data->basis, tmp + j, DCT_BLOCK_SIZE, out + j, size.x);
+			}
 		}
 	}
-	return B;
 }
 
 void MLPPTransforms::_bind_methods() {
@@ -42,17 +42,137 @@
 #include "core/math/math_defs.h"
 
 #include "core/object/reference.h"
+#include "core/os/mutex.h"
 #endif
 
 #include "../core/mlpp_matrix.h"
+#include "../core/mlpp_tensor3.h"
+#include "../core/mlpp_vector.h"
 
 class MLPPTransforms : public Reference {
 	GDCLASS(MLPPTransforms, Reference);
 
 public:
+	// dct_2d() of p_A - 128.
 	Ref<MLPPMatrix> discrete_cosine_transform(const Ref<MLPPMatrix> &p_A);
 
+	// DCT
+
+	// Orthonormal DCT-II, and its inverse, the DCT-III, of any size, in O(n log n).
+	// They are computed with one n point complex FFT (Makhoul's reordering), so the same size rules apply as for fft().
+	Ref<MLPPVector> dct(const Ref<MLPPVector> &p_x);
+	Ref<MLPPVector> idct(const Ref<MLPPVector> &p_x);
+
+	// Separable 2D transforms, row DCTs, then column DCTs, both in parallel.
+	Ref<MLPPMatrix> dct_2d(const Ref<MLPPMatrix> &p_A);
+	Ref<MLPPMatrix> idct_2d(const Ref<MLPPMatrix> &p_A);
+
+	// JPEG style 8x8 block transforms, every block is transformed on its own.
+	// Both sides of the input have to be multiples of DCT_BLOCK_SIZE.
+	// The 3d versions transform every z slice, with all blocks of all slices done in one parallel pass.
+	Ref<MLPPMatrix> dct_blocks_2d(const Ref<MLPPMatrix> &p_A);
+	Ref<MLPPMatrix> idct_blocks_2d(const Ref<MLPPMatrix> &p_A);
+	Ref<MLPPTensor3> dct_blocks_3d(const Ref<MLPPTensor3> &p_A);
+	Ref<MLPPTensor3> idct_blocks_3d(const Ref<MLPPTensor3> &p_A);
+
+	enum {
+		DCT_BLOCK_SIZE = 8,
+	};
+
+	// FFT
+
+	struct FFTResult {
+		Ref<MLPPVector> real;
+		Ref<MLPPVector> imag;
+	};
+
+	struct FFT2DResult {
+		Ref<MLPPMatrix> real;
+		Ref<MLPPMatrix> imag;
+	};
+
+	// Complex FFT of any size (mixed radix: 4, 2, 3, 5, and a generic butterfly for other prime factors,
+	// which is O(n * p), so sizes with large prime factors should be avoided, see fft_good_size()).
+	// If imag is not valid, the input is treated as real. The inverse transforms are scaled by 1 / n.
+	FFTResult fft(const Ref<MLPPVector> &real, const Ref<MLPPVector> &imag = Ref<MLPPVector>());
+	FFTResult ifft(const Ref<MLPPVector> &real, const Ref<MLPPVector> &imag);
+
+	// Row FFTs, then column FFTs, both in parallel.
+	FFT2DResult fft_2d(const Ref<MLPPMatrix> &real, const Ref<MLPPMatrix> &imag = Ref<MLPPMatrix>());
+	FFT2DResult ifft_2d(const Ref<MLPPMatrix> &real, const Ref<MLPPMatrix> &imag);
+
+	// In place transforms of interleaved complex data (re, im, re, im, ...).
+	// p_size is in complex elements, the 2D data is row major.
+	void fft_complex(real_t *p_data, const int p_size, const bool p_inverse);
+	void fft_2d_complex(real_t *p_data, const Size2i &p_size, const bool p_inverse);
+
+	// The smallest size >= n that only has the prime factors 2, 3 and 5.
+	static int fft_good_size(const int n);
+
+	// Plans (factorization and twiddles) are cached per size in this object. The cache is guarded by a lock, so one
+	// object can run transforms from several threads at once. Plans that are in use are kept until they are released.
+	void fft_plan_cache_clear();
+
+	MLPPTransforms();
+	~MLPPTransforms();
+
 protected:
+	struct FFTPlan {
+		int size;
+		// Transforms running with this plan. Guarded by _fft_plans_mutex.
+		int users;
+		Vector<int> factors;
+		// exp(-2 * pi * i * k / size), interleaved
+		Vector<real_t> twiddles;
+	};
+
+	struct FFT2DData {
+		real_t *data;
+		Size2i size;
+		const FFTPlan *row_plan;
+		const FFTPlan *column_plan;
+		bool inverse;
+	};
+
+	struct DCTData {
+		real_t *data;
+		Size2i size;
+		const FFTPlan *row_plan;
+		const FFTPlan *column_plan;
+		// cos and sin of pi * k / (2 * n), interleaved
+		const real_t *row_twiddles;
+		const real_t *column_twiddles;
+		bool inverse;
+	};
+
+	struct DCTBlockData {
+		const real_t *input;
+		real_t *output;
+		Size2i size;
+		int slice_count;
+		bool inverse;
+		// basis[k][n] = c(k) * cos(pi * (2 * n + 1) * k / 16)
+		real_t basis[DCT_BLOCK_SIZE][DCT_BLOCK_SIZE];
+	};
+
+	// Every plan returned by _fft_plan_get() has to be handed back with _fft_plan_release().
+	const FFTPlan *_fft_plan_get(const int p_size);
+	void _fft_plan_release(const FFTPlan *p_plan);
+	void _fft_execute(const FFTPlan *p_plan, real_t *p_data, real_t *p_scratch, const bool p_inverse) const;
+	void _fft_recursive(const FFTPlan *p_plan, const real_t *p_in, real_t *p_out, const int p_size, const int p_in_stride, const int p_factor_index, const int p_twiddle_stride, const bool p_inverse) const;
+	void _fft_rows_range(int p_from, int p_to, FFT2DData *p_data);
+	void _fft_columns_range(int p_from, int p_to, FFT2DData *p_data);
+
+	void _dct_2d(real_t *p_data, const Size2i &p_size, const bool p_inverse);
+	void _dct_line(const FFTPlan *p_plan, const real_t *p_twiddles, real_t *p_line, const int p_stride, real_t *p_scratch, const bool p_inverse) const;
+	void _dct_rows_range(int p_from, int p_to, DCTData *p_data);
+	void _dct_columns_range(int p_from, int p_to, DCTData *p_data);
+	void _dct_blocks(DCTBlockData *p_data);
+	void _dct_blocks_range(int p_from, int p_to, DCTBlockData *p_data);
+
+	Vector<FFTPlan *> _fft_plans;
+	Mutex _fft_plans_mutex;
+
 	static void _bind_methods();
 };
 
@@ -33,6 +33,8 @@
 #include "../core/activation.h"
 #include "../core/cost.h"
 #include "../core/lin_alg.h"
+#include "../core/mini_batch_sampler.h"
+#include "../core/parallel.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -45,6 +47,16 @@
 #include <random>
 
 Ref<MLPPVector> MLPPANN::model_set_test(const Ref<MLPPMatrix> &X) {
+	if (_plan_is_usable()) {
+		Ref<MLPPVector> y_hat;
+		y_hat.instance();
+		y_hat->resize(X->size().y);
+
+		_plan_model_set_test(X, y_hat->ptrw());
+
+		return y_hat;
+	}
+
 	if (!_network.empty()) {
 		Ref<MLPPHiddenLayer> layer = _network[0];
 
@@ -57,6 +69,8 @@ Ref<MLPPVector> MLPPANN::model_set_test(const Ref<MLPPMatrix> &X) {
 
 			layer->set_input(prev_layer->get_a());
 			layer->forward_pass();
+
+			_checkpoint_release(i - 1, false);
 		}
 
 		_output_layer->set_input(_network.write[_network.size() - 1]->get_a());
@@ -90,12 +104,31 @@ real_t MLPPANN::model_test(const Ref<MLPPVector> &x) {
 	return _output_layer->get_a_test();
 }
 
+Ref<MLPPInferenceModel> MLPPANN::create_inference_model() {
+	ERR_FAIL_COND_V(!_output_layer.is_valid(), Ref<MLPPInferenceModel>());
+
+	Ref<MLPPInferenceModel> model;
+	model.instance();
+
+	for (int i = 0; i < _network.size(); ++i) {
+		Ref<MLPPHiddenLayer> layer = _network[i];
+
+		ERR_FAIL_COND_V_MSG(Ref<MLPPConvLayer>(layer).is_valid() || Ref<MLPPPoolLayer>(layer).is_valid(), Ref<MLPPInferenceModel>(), "Conv and pool layers are not supported.");
+
+		model->add_layer(layer->get_weights(), layer->get_bias(), layer->get_activation());
+	}
+
+	model->add_layer_single(_output_layer->get_weights(), _output_layer->get_bias(), _output_layer->get_activation());
+
+	return model;
+}
+
 void MLPPANN::gradient_descent(real_t learning_rate, int max_epoch, bool ui) {
-	MLPPCost mlpp_cost;
-	MLPPLinAlg alg;
 	real_t cost_prev = 0;
 	int epoch = 1;
 
+	Ref<MLPPOptimizer> optimizer = Ref<MLPPOptimizer>(memnew(MLPPOptimizerSGD()));
+
 	forward_pass();
 
 	real_t initial_learning_rate = learning_rate;
@@ -105,12 +138,15 @@ void MLPPANN::gradient_descent(real_t learning_rate, int max_epoch, bool ui) {
 
 		cost_prev = cost(_y_hat, _output_set);
 
-		ComputeGradientsResult grads = compute_gradients(_y_hat, _output_set);
-		grads.cumulative_hidden_layer_w_grad = alg.scalar_multiplynvt(learning_rate / _n, grads.cumulative_hidden_layer_w_grad);
+		if (_plan_is_usable()) {
+			real_t output_bias_gradient = _plan_compute_gradients(_input_set, _output_set);
 
-		grads.output_w_grad->scalar_multiply(learning_rate / _n);
+			_arena_step(optimizer, output_bias_gradient, learning_rate);
+		} else {
+			ComputeGradientsResult grads = compute_gradients(_y_hat, _output_set);
 
-		update_parameters(grads.cumulative_hidden_layer_w_grad, grads.output_w_grad, learning_rate); // subject to change. may want bias to have this matrix too.
+			optimizer_step(optimizer, grads, learning_rate);
+		}
 
 		forward_pass();
 
@@ -127,13 +163,12 @@ void MLPPANN::gradient_descent(real_t learning_rate, int max_epoch, bool ui) {
 }
 
 void MLPPANN::sgd(real_t learning_rate, int max_epoch, bool ui) {
-	MLPPCost mlpp_cost;
-	MLPPLinAlg alg;
-
 	real_t cost_prev = 0;
 	int epoch = 1;
 	real_t initial_learning_rate = learning_rate;
 
+	Ref<MLPPOptimizer> optimizer = Ref<MLPPOptimizer>(memnew(MLPPOptimizerSGD()));
+
 	std::random_device rd;
 	std::default_random_engine generator(rd());
 	std::uniform_int_distribution<int> distribution(0, int(_n - 1));
@@ -166,10 +201,7 @@ void MLPPANN::sgd(real_t learning_rate, int max_epoch, bool ui) {
 
 		ComputeGradientsResult grads = compute_gradients(y_hat_row_tmp, output_set_row_tmp);
 
-		grads.cumulative_hidden_layer_w_grad = alg.scalar_multiplynvt(learning_rate / _n, grads.cumulative_hidden_layer_w_grad);
-		grads.output_w_grad->scalar_multiply(learning_rate / _n);
-
-		update_parameters(grads.cumulative_hidden_layer_w_grad, grads.output_w_grad, learning_rate); // subject to change. may want bias to have this matrix too.
+		optimizer_step(optimizer, grads, learning_rate);
 		y_hat = model_test(input_set_row_tmp);
 
 		if (ui) {
@@ -187,105 +219,95 @@ void MLPPANN::sgd(real_t learning_rate, int max_epoch, bool ui) {
 }
 
 void MLPPANN::mbgd(real_t learning_rate, int max_epoch, int mini_batch_size, bool ui) {
-	MLPPCost mlpp_cost;
-	MLPPLinAlg alg;
-
-	real_t cost_prev = 0;
-	int epoch = 1;
-	real_t initial_learning_rate = learning_rate;
-
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	// always evaluate the result
-	// always do forward pass only ONCE at end.
-
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	while (true) {
-		learning_rate = apply_learning_rate_scheduler(initial_learning_rate, _decay_constant, epoch, _drop_rate);
-
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch = batches.output_sets[i];
-
-			Ref<MLPPVector> y_hat = model_set_test(current_input_batch);
-			cost_prev = cost(y_hat, current_output_batch);
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerSGD())), learning_rate, max_epoch, mini_batch_size, ui);
+}
 
-			ComputeGradientsResult grads = compute_gradients(y_hat, current_output_batch);
+void MLPPANN::momentum(real_t learning_rate, int max_epoch, int mini_batch_size, real_t gamma, bool nag, bool ui) {
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerMomentum(gamma, nag))), learning_rate, max_epoch, mini_batch_size, ui);
+}
 
-			grads.cumulative_hidden_layer_w_grad = alg.scalar_multiplynvt(learning_rate / _n, grads.cumulative_hidden_layer_w_grad);
-			grads.output_w_grad->scalar_multiply(learning_rate / _n);
+void MLPPANN::adagrad(real_t learning_rate, int max_epoch, int mini_batch_size, real_t e, bool ui) {
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdagrad(e))), learning_rate, max_epoch, mini_batch_size, ui);
+}
 
-			update_parameters(grads.cumulative_hidden_layer_w_grad, grads.output_w_grad, learning_rate); // subject to change. may want bias to have this matrix too.
-			y_hat = model_set_test(current_input_batch);
+void MLPPANN::adadelta(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t e, bool ui) {
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdadelta(b1, e))), learning_rate, max_epoch, mini_batch_size, ui);
+}
 
-			if (ui) {
-				print_ui(epoch, cost_prev, y_hat, current_output_batch);
-			}
-		}
+void MLPPANN::adam(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui) {
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdam(b1, b2, e))), learning_rate, max_epoch, mini_batch_size, ui);
+}
 
-		epoch++;
+void MLPPANN::adamax(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui) {
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdamax(b1, b2, e))), learning_rate, max_epoch, mini_batch_size, ui);
+}
 
-		if (epoch > max_epoch) {
-			break;
-		}
-	}
+void MLPPANN::nadam(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui) {
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerNadam(b1, b2, e))), learning_rate, max_epoch, mini_batch_size, ui);
+}
 
-	forward_pass();
+void MLPPANN::amsgrad(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui) {
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAMSGrad(b1, b2, e))), learning_rate, max_epoch, mini_batch_size, ui);
 }
 
-void MLPPANN::momentum(real_t learning_rate, int max_epoch, int mini_batch_size, real_t gamma, bool nag, bool ui) {
-	class MLPPCost mlpp_cost;
-	MLPPLinAlg alg;
+void MLPPANN::train_optimizer(Ref<MLPPOptimizer> optimizer, real_t learning_rate, int max_epoch, int mini_batch_size, bool ui) {
+	ERR_FAIL_COND(!optimizer.is_valid());
+	ERR_FAIL_COND(mini_batch_size <= 0);
 
 	real_t cost_prev = 0;
 	int epoch = 1;
 	real_t initial_learning_rate = learning_rate;
 
 	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
 	// always evaluate the result
 	// always do forward pass only ONCE at end.
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmv(_input_set, _output_set, mini_batch_size);
 
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	// Initializing necessary components for Adam.
-	Vector<Ref<MLPPMatrix>> v_hidden;
+	Vector<DataParallelShard> shards;
 
-	Ref<MLPPVector> v_output;
-	v_output.instance();
+	if (_data_parallel_thread_count > 1) {
+		shards = _create_data_parallel_shards(_data_parallel_thread_count);
+	}
 
 	while (true) {
 		learning_rate = apply_learning_rate_scheduler(initial_learning_rate, _decay_constant, epoch, _drop_rate);
 
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch = batches.output_sets[i];
+		sampler.begin_epoch();
 
-			Ref<MLPPVector> y_hat = model_set_test(current_input_batch);
-			cost_prev = cost(y_hat, current_output_batch);
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_input_batch = sampler.get_input();
+			Ref<MLPPVector> current_output_batch = sampler.get_output_vector();
 
-			ComputeGradientsResult grads = compute_gradients(y_hat, current_output_batch);
+			Ref<MLPPVector> y_hat;
 
-			if (!_network.empty() && v_hidden.empty()) { // Initing our tensor
-				alg.resizevt(v_hidden, grads.cumulative_hidden_layer_w_grad);
-			}
+			if (!shards.empty()) {
+				if (ui) {
+					y_hat = model_set_test(current_input_batch);
+					cost_prev = cost(y_hat, current_output_batch);
+				}
 
-			if (v_output->size() == 0) {
-				v_output->resize(grads.output_w_grad->size());
-			}
+				_data_parallel_step(optimizer, shards, current_input_batch, current_output_batch, learning_rate);
+			} else if (_plan_is_usable()) {
+				if (ui) {
+					y_hat = model_set_test(current_input_batch);
+					cost_prev = cost(y_hat, current_output_batch);
+				}
 
-			if (nag) { // "Aposterori" calculation
-				update_parameters(v_hidden, v_output, 0); // DON'T update bias.
-			}
+				real_t output_bias_gradient = _plan_compute_gradients(current_input_batch, current_output_batch);
 
-			v_hidden = alg.additionnvt(alg.scalar_multiplynvt(gamma, v_hidden), alg.scalar_multiplynvt(learning_rate / _n, grads.cumulative_hidden_layer_w_grad));
-			v_output = v_output->scalar_multiplyn(gamma)->addn(grads.output_w_grad->scalar_multiplyn(learning_rate / _n));
+				_arena_step(optimizer, output_bias_gradient, learning_rate);
+			} else {
+				y_hat = model_set_test(current_input_batch);
+				cost_prev = cost(y_hat, current_output_batch);
 
-			update_parameters(v_hidden, v_output, learning_rate); // subject to change. may want bias to have this matrix too.
-			y_hat = model_set_test(current_input_batch);
+				ComputeGradientsResult grads = compute_gradients(y_hat, current_output_batch);
+
+				optimizer_step(optimizer, grads, learning_rate);
+			}
 
 			if (ui) {
+				y_hat = model_set_test(current_input_batch);
 				print_ui(epoch, cost_prev, y_hat, current_output_batch);
 			}
 		}
@@ -300,606 +322,919 @@ void MLPPANN::momentum(real_t learning_rate, int max_epoch, int mini_batch_size,
 	forward_pass();
 }
 
-void MLPPANN::adagrad(real_t learning_rate, int max_epoch, int mini_batch_size, real_t e, bool ui) {
-	MLPPCost mlpp_cost;
-	MLPPLinAlg alg;
-
-	real_t cost_prev = 0;
-	int epoch = 1;
-	real_t initial_learning_rate = learning_rate;
-
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	// always evaluate the result
-	// always do forward pass only ONCE at end.
-
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
+int MLPPANN::get_data_parallel_thread_count() const {
+	return _data_parallel_thread_count;
+}
+void MLPPANN::set_data_parallel_thread_count(const int val) {
+	ERR_FAIL_COND(val < 1);
 
-	// Initializing necessary components for Adam.
-	Vector<Ref<MLPPMatrix>> v_hidden;
+	_data_parallel_thread_count = val;
+}
 
-	Ref<MLPPVector> v_output;
-	v_output.instance();
+int MLPPANN::get_checkpoint_interval() const {
+	return _checkpoint_interval;
+}
+void MLPPANN::set_checkpoint_interval(const int val) {
+	ERR_FAIL_COND(val < 1);
 
-	while (true) {
-		learning_rate = apply_learning_rate_scheduler(initial_learning_rate, _decay_constant, epoch, _drop_rate);
+	_checkpoint_interval = val;
+}
 
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch = batches.output_sets[i];
+Ref<MLPPParameterArena> MLPPANN::get_parameter_arena() {
+	ERR_FAIL_COND_V(!_output_layer.is_valid(), Ref<MLPPParameterArena>());
 
-			Ref<MLPPVector> y_hat = model_set_test(current_input_batch);
-			cost_prev = cost(y_hat, current_output_batch);
+	_update_arena();
 
-			ComputeGradientsResult grads = compute_gradients(y_hat, current_output_batch);
+	return _arena;
+}
 
-			if (!_network.empty() && v_hidden.empty()) { // Initing our tensor
-				alg.resizevt(v_hidden, grads.cumulative_hidden_layer_w_grad);
-			}
+bool MLPPANN::compile(int max_batch_size) {
+	ERR_FAIL_COND_V(max_batch_size <= 0, false);
+	ERR_FAIL_COND_V(!_output_layer.is_valid(), false);
 
-			if (v_output->size() == 0) {
-				v_output->resize(grads.output_w_grad->size());
-			}
+	clear_compiled_plan();
 
-			v_hidden = alg.additionnvt(v_hidden, alg.exponentiatenvt(grads.cumulative_hidden_layer_w_grad, 2));
-			v_output->add(grads.output_w_grad->exponentiaten(2));
+	int layer_count = _network.size();
 
-			Vector<Ref<MLPPMatrix>> hidden_layer_updations = alg.scalar_multiplynvt(learning_rate / _n, alg.division_element_wisenvnvt(grads.cumulative_hidden_layer_w_grad, alg.scalar_addnvt(e, alg.sqrtnvt(v_hidden))));
+	// Shape inference.
+	Vector<int> widths;
+	widths.push_back(_k);
 
-			Ref<MLPPVector> output_layer_updation = grads.output_w_grad->division_element_wisen(v_output->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate / _n);
+	for (int i = 0; i < layer_count; ++i) {
+		Ref<MLPPHiddenLayer> layer = _network[i];
 
-			update_parameters(hidden_layer_updations, output_layer_updation, learning_rate); // subject to change. may want bias to have this matrix too.
-			y_hat = model_set_test(current_input_batch);
+		ERR_FAIL_COND_V_MSG(Ref<MLPPConvLayer>(layer).is_valid() || Ref<MLPPPoolLayer>(layer).is_valid(), false, "Only fully connected layers can be compiled.");
 
-			if (ui) {
-				print_ui(epoch, cost_prev, y_hat, current_output_batch);
-			}
-		}
+		MLPPActivation::ActivationFunction activation = layer->get_activation();
 
-		epoch++;
+		ERR_FAIL_COND_V_MSG(activation == MLPPActivation::ACTIVATION_FUNCTION_SOFTMAX || activation == MLPPActivation::ACTIVATION_FUNCTION_ADJ_SOFTMAX, false, "Only element wise activations can be compiled.");
+		ERR_FAIL_COND_V(layer->get_weights()->size() != Size2i(layer->get_n_hidden(), widths[i]), false);
+		ERR_FAIL_COND_V(layer->get_bias()->size() != layer->get_n_hidden(), false);
 
-		if (epoch > max_epoch) {
-			break;
-		}
+		widths.push_back(layer->get_n_hidden());
 	}
 
-	forward_pass();
-}
-
-void MLPPANN::adadelta(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t e, bool ui) {
-	MLPPCost mlpp_cost;
-	MLPPLinAlg alg;
-
-	real_t cost_prev = 0;
-	int epoch = 1;
-	real_t initial_learning_rate = learning_rate;
-
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	// always evaluate the result
-	// always do forward pass only ONCE at end.
-
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	// Initializing necessary components for Adam.
-	Vector<Ref<MLPPMatrix>> v_hidden;
-
-	Ref<MLPPVector> v_output;
-	v_output.instance();
+	MLPPCost::CostTypes cost_type = _output_layer->get_cost();
 
-	while (true) {
-		learning_rate = apply_learning_rate_scheduler(initial_learning_rate, _decay_constant, epoch, _drop_rate);
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch = batches.output_sets[i];
-
-			Ref<MLPPVector> y_hat = model_set_test(current_input_batch);
-			cost_prev = cost(y_hat, current_output_batch);
-
-			ComputeGradientsResult grads = compute_gradients(y_hat, current_output_batch);
+	ERR_FAIL_COND_V_MSG(cost_type != MLPPCost::COST_TYPE_MSE && cost_type != MLPPCost::COST_TYPE_MBE && cost_type != MLPPCost::COST_TYPE_LOGISTIC_LOSS && cost_type != MLPPCost::COST_TYPE_CROSS_ENTROPY && cost_type != MLPPCost::COST_TYPE_WASSERSTEIN_LOSS, false, "The output layer's cost has no element wise derivative.");
+	ERR_FAIL_COND_V(_output_layer->get_weights()->size() != widths[layer_count], false);
 
-			if (!_network.empty() && v_hidden.empty()) { // Initing our tensor
-				alg.resizevt(v_hidden, grads.cumulative_hidden_layer_w_grad);
-			}
-
-			if (v_output->size() == 0) {
-				v_output->resize(grads.output_w_grad->size());
-			}
+	// Inference: layer i is op i, the output layer is op layer_count. a is computed in place, over z.
+	Vector<PlanTensor> inference_tensors;
 
-			v_hidden = alg.additionnvt(alg.scalar_multiplynvt(1 - b1, v_hidden), alg.scalar_multiplynvt(b1, alg.exponentiatenvt(grads.cumulative_hidden_layer_w_grad, 2)));
-			v_output->add(grads.output_w_grad->exponentiaten(2));
+	for (int i = 0; i <= layer_count; ++i) {
+		PlanTensor t;
+		t.size = max_batch_size * (i < layer_count ? widths[i + 1] : 1);
+		t.first = i;
+		// The output is copied out after the last op.
+		t.last = i + 1;
+		t.offset = 0;
 
-			Vector<Ref<MLPPMatrix>> hidden_layer_updations = alg.scalar_multiplynvt(learning_rate / _n, alg.division_element_wisenvnvt(grads.cumulative_hidden_layer_w_grad, alg.scalar_addnvt(e, alg.sqrtnvt(v_hidden))));
-			Ref<MLPPVector> output_layer_updation = grads.output_w_grad->division_element_wisen(v_output->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate / _n);
+		inference_tensors.push_back(t);
+	}
 
-			update_parameters(hidden_layer_updations, output_layer_updation, learning_rate); // subject to change. may want bias to have this matrix too.
-			y_hat = model_set_test(current_input_batch);
+	// Training: the forward ops, then the output layer's backward op at layer_count + 1,
+	// then the hidden layers' backward ops from the last one to the first.
+	int output_backward = layer_count + 1;
+	Vector<int> backward;
+	for (int i = 0; i < layer_count; ++i) {
+		backward.push_back(output_backward + layer_count - i);
+	}
 
-			if (ui) {
-				print_ui(epoch, cost_prev, y_hat, current_output_batch);
-			}
+	// z, a and delta of every layer, the output layer last.
+	Vector<PlanTensor> training_tensors;
+
+	for (int i = 0; i <= layer_count; ++i) {
+		bool is_output = i == layer_count;
+		int size = max_batch_size * (is_output ? 1 : widths[i + 1]);
+		int own_backward = is_output ? output_backward : backward[i];
+
+		PlanTensor z;
+		z.size = size;
+		z.first = i;
+		z.last = own_backward;
+		z.offset = 0;
+
+		// a is the input of the next layer, its weight gradient needs it.
+		PlanTensor a = z;
+		if (is_output) {
+			a.last = output_backward;
+		} else {
+			a.last = i + 1 < layer_count ? backward[i + 1] : output_backward;
 		}
 
-		epoch++;
+		// delta is read by the previous layer's backward op.
+		PlanTensor delta = z;
+		delta.first = own_backward;
+		delta.last = i > 0 ? backward[i - 1] : own_backward;
 
-		if (epoch > max_epoch) {
-			break;
-		}
+		training_tensors.push_back(z);
+		training_tensors.push_back(a);
+		training_tensors.push_back(delta);
 	}
 
-	forward_pass();
-}
+	int inference_size = _plan_assign_offsets(inference_tensors);
+	int training_size = _plan_assign_offsets(training_tensors);
 
-void MLPPANN::adam(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui) {
-	MLPPCost mlpp_cost;
-	MLPPLinAlg alg;
+	for (int i = 0; i <= layer_count; ++i) {
+		bool is_output = i == layer_count;
 
-	real_t cost_prev = 0;
-	int epoch = 1;
-	real_t initial_learning_rate = learning_rate;
+		PlanOp op;
+		op.layer = is_output ? -1 : i;
+		op.input_width = widths[i];
+		op.width = is_output ? 1 : widths[i + 1];
+		op.activation = is_output ? _output_layer->get_activation() : _network[i]->get_activation();
 
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	// always evaluate the result
-	// always do forward pass only ONCE at end.
+		op.type = is_output ? PLAN_OP_TYPE_OUTPUT_FORWARD : PLAN_OP_TYPE_HIDDEN_FORWARD;
+		op.input = i > 0 ? inference_tensors[i - 1].offset : -1;
+		op.z = inference_tensors[i].offset;
+		op.a = op.z;
 
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
+		_plan.inference_ops.push_back(op);
 
-	// Initializing necessary components for Adam.
-	Vector<Ref<MLPPMatrix>> m_hidden;
-	Vector<Ref<MLPPMatrix>> v_hidden;
+		op.input = i > 0 ? training_tensors[(i - 1) * 3 + 1].offset : -1;
+		op.z = training_tensors[i * 3].offset;
+		op.a = training_tensors[i * 3 + 1].offset;
 
-	Ref<MLPPVector> m_output;
-	Ref<MLPPVector> v_output;
-	m_output.instance();
-	v_output.instance();
+		_plan.training_ops.push_back(op);
+	}
 
-	while (true) {
-		learning_rate = apply_learning_rate_scheduler(initial_learning_rate, _decay_constant, epoch, _drop_rate);
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch = batches.output_sets[i];
+	_plan.training_ops.resize(layer_count + 1 + 1 + layer_count);
 
-			Ref<MLPPVector> y_hat = model_set_test(current_input_batch);
-			cost_prev = cost(y_hat, current_output_batch);
+	for (int i = layer_count; i >= 0; --i) {
+		bool is_output = i == layer_count;
 
-			ComputeGradientsResult grads = compute_gradients(y_hat, current_output_batch);
+		PlanOp op = _plan.training_ops[i];
+		op.type = is_output ? PLAN_OP_TYPE_OUTPUT_BACKWARD : PLAN_OP_TYPE_HIDDEN_BACKWARD;
+		op.delta = training_tensors[i * 3 + 2].offset;
 
-			if (!_network.empty() && m_hidden.empty() && v_hidden.empty()) { // Initing our tensor
-				alg.resizevt(m_hidden, grads.cumulative_hidden_layer_w_grad);
-				alg.resizevt(v_hidden, grads.cumulative_hidden_layer_w_grad);
-			}
+		if (!is_output) {
+			op.next_layer = i + 1 < layer_count ? i + 1 : -1;
+			op.next_delta = training_tensors[(i + 1) * 3 + 2].offset;
+		}
 
-			if (m_output->size() == 0 && v_output->size()) {
-				m_output->resize(grads.output_w_grad->size());
-				v_output->resize(grads.output_w_grad->size());
-			}
+		_plan.training_ops.write[is_output ? output_backward : backward[i]] = op;
+	}
 
-			m_hidden = alg.additionnvt(alg.scalar_multiplynvt(b1, m_hidden), alg.scalar_multiplynvt(1 - b1, grads.cumulative_hidden_layer_w_grad));
-			v_hidden = alg.additionnvt(alg.scalar_multiplynvt(b2, v_hidden), alg.scalar_multiplynvt(1 - b2, alg.exponentiatenvt(grads.cumulative_hidden_layer_w_grad, 2)));
+	_plan.y_hat = inference_tensors[layer_count].offset;
+	_plan.buffer.resize(MAX(inference_size, training_size));
+	_plan.max_batch_size = max_batch_size;
 
-			m_output = m_output->scalar_multiplyn(b1)->addn(grads.output_w_grad->scalar_multiplyn(1 - b1));
-			v_output = v_output->scalar_multiplyn(b2)->addn(grads.output_w_grad->exponentiaten(2)->scalar_multiplyn(1 - b2));
+	return true;
+}
 
-			Vector<Ref<MLPPMatrix>> m_hidden_hat = alg.scalar_multiplynvt(1 / (1 - Math::pow(b1, epoch)), m_hidden);
-			Vector<Ref<MLPPMatrix>> v_hidden_hat = alg.scalar_multiplynvt(1 / (1 - Math::pow(b2, epoch)), v_hidden);
+void MLPPANN::clear_compiled_plan() {
+	_plan.max_batch_size = 0;
+	_plan.inference_ops.clear();
+	_plan.training_ops.clear();
+	_plan.y_hat = -1;
+	_plan.buffer.clear();
+}
 
-			Ref<MLPPVector> m_output_hat = m_output->scalar_multiplyn(1 / (1 - Math::pow(b1, epoch)));
-			Ref<MLPPVector> v_output_hat = v_output->scalar_multiplyn(1 / (1 - Math::pow(b2, epoch)));
+bool MLPPANN::is_compiled() const {
+	return _plan.max_batch_size > 0;
+}
 
-			Vector<Ref<MLPPMatrix>> hidden_layer_updations = alg.scalar_multiplynvt(learning_rate / _n, alg.division_element_wisenvnvt(m_hidden_hat, alg.scalar_addnvt(e, alg.sqrtnvt(v_hidden_hat))));
-			Ref<MLPPVector> output_layer_updation = m_output_hat->division_element_wisen(v_output_hat->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate / _n);
+real_t MLPPANN::score() {
+	MLPPUtilities util;
 
-			update_parameters(hidden_layer_updations, output_layer_updation, learning_rate); // subject to change. may want bias to have this matrix too.
-			y_hat = model_set_test(current_input_batch);
+	forward_pass();
 
-			if (ui) {
-				print_ui(epoch, cost_prev, y_hat, current_output_batch);
-			}
-		}
+	return util.performance_vec(_y_hat, _output_set);
+}
 
-		epoch++;
+void MLPPANN::save(const String &file_name) {
+	MLPPUtilities util;
 
-		if (epoch > max_epoch) {
-			break;
+	/*
+	if (!_network.empty()) {
+		util.saveParameters(file_name, _network[0].weights, _network[0].bias, false, 1);
+		for (uint32_t i = 1; i < _network.size(); i++) {
+			util.saveParameters(file_name, _network[i].weights, _network[i].bias, true, i + 1);
 		}
+		util.saveParameters(file_name, _output_layer->weights, _output_layer->bias, true, _network.size() + 1);
+	} else {
+		util.saveParameters(file_name, _output_layer->weights, _output_layer->bias, false, _network.size() + 1);
 	}
-	forward_pass();
+	*/
 }
 
-void MLPPANN::adamax(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui) {
-	MLPPCost mlpp_cost;
-	MLPPLinAlg alg;
-
-	real_t cost_prev = 0;
-	int epoch = 1;
-	real_t initial_learning_rate = learning_rate;
-
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	// always evaluate the result
-	// always do forward pass only ONCE at end.
-
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	// Initializing necessary components for Adam.
-	Vector<Ref<MLPPMatrix>> m_hidden;
-	Vector<Ref<MLPPMatrix>> u_hidden;
+void MLPPANN::set_learning_rate_scheduler(SchedulerType type, real_t decay_constant) {
+	_lr_scheduler = type;
+	_decay_constant = decay_constant;
+}
 
-	Ref<MLPPVector> m_output;
-	Ref<MLPPVector> u_output;
-	m_output.instance();
-	u_output.instance();
+void MLPPANN::set_learning_rate_scheduler_drop(SchedulerType type, real_t decay_constant, real_t drop_rate) {
+	_lr_scheduler = type;
+	_decay_constant = decay_constant;
+	_drop_rate = drop_rate;
+}
 
-	while (true) {
-		learning_rate = apply_learning_rate_scheduler(initial_learning_rate, _decay_constant, epoch, _drop_rate);
+void MLPPANN::add_layer(int n_hidden, MLPPActivation::ActivationFunction activation, MLPPUtilities::WeightDistributionType weight_init, MLPPReg::RegularizationType reg, real_t lambda, real_t alpha) {
+	clear_compiled_plan();
 
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch = batches.output_sets[i];
+	if (_network.empty()) {
+		_network.push_back(Ref<MLPPHiddenLayer>(memnew(MLPPHiddenLayer(n_hidden, activation, _input_set, weight_init, reg, lambda, alpha))));
+		_network.write[0]->forward_pass();
+	} else {
+		_network.push_back(Ref<MLPPHiddenLayer>(memnew(MLPPHiddenLayer(n_hidden, activation, _network.write[_network.size() - 1]->get_a(), weight_init, reg, lambda, alpha))));
+		_network.write[_network.size() - 1]->forward_pass();
+	}
+}
 
-			Ref<MLPPVector> y_hat = model_set_test(current_input_batch);
-			cost_prev = cost(y_hat, current_output_batch);
+void MLPPANN::add_conv_layer(const Size3i &input_size, int filter_count, int filter_size, int stride, int padding, MLPPActivation::ActivationFunction activation, MLPPUtilities::WeightDistributionType weight_init, MLPPReg::RegularizationType reg, real_t lambda, real_t alpha) {
+	clear_compiled_plan();
 
-			ComputeGradientsResult grads = compute_gradients(y_hat, current_output_batch);
+	Size3i size = input_size;
 
-			if (!_network.empty() && m_hidden.empty() && u_hidden.empty()) { // Initing our tensor
-				alg.resizevt(m_hidden, grads.cumulative_hidden_layer_w_grad);
-				alg.resizevt(u_hidden, grads.cumulative_hidden_layer_w_grad);
-			}
+	if (size == Size3i()) {
+		size = _get_image_layer_output_size();
+	}
 
-			if (m_output->size() == 0 && u_output->size() == 0) {
-				m_output->resize(grads.output_w_grad->size());
-				u_output->resize(grads.output_w_grad->size());
-			}
+	Ref<MLPPMatrix> input = _network.empty() ? _input_set : _network.write[_network.size() - 1]->get_a();
 
-			m_hidden = alg.additionnvt(alg.scalar_multiplynvt(b1, m_hidden), alg.scalar_multiplynvt(1 - b1, grads.cumulative_hidden_layer_w_grad));
-			u_hidden = alg.maxnvt(alg.scalar_multiplynvt(b2, u_hidden), alg.absnvt(grads.cumulative_hidden_layer_w_grad));
+	_network.push_back(Ref<MLPPHiddenLayer>(memnew(MLPPConvLayer(size, filter_count, filter_size, stride, padding, activation, input, weight_init, reg, lambda, alpha))));
+	_network.write[_network.size() - 1]->forward_pass();
+}
 
-			m_output->addb(m_output->scalar_multiplyn(b1), grads.output_w_grad->scalar_multiplyn(1 - b1));
-			u_output->maxb(u_output->scalar_multiplyn(b2), grads.output_w_grad->absn());
+void MLPPANN::add_pool_layer(const Size3i &input_size, int pool_size, int stride, MLPPConvolutions::PoolType pool_type) {
+	clear_compiled_plan();
 
-			Vector<Ref<MLPPMatrix>> m_hidden_hat = alg.scalar_multiplynvt(1 / (1 - Math::pow(b1, epoch)), m_hidden);
-			Ref<MLPPVector> m_output_hat = m_output->scalar_multiplyn(1 / (1 - Math::pow(b1, epoch)));
+	Size3i size = input_size;
 
-			Vector<Ref<MLPPMatrix>> hidden_layer_updations = alg.scalar_multiplynvt(learning_rate / _n, alg.division_element_wisenvnvt(m_hidden_hat, alg.scalar_addnvt(e, u_hidden)));
-			Ref<MLPPVector> output_layer_updation = m_output_hat->division_element_wisen(u_output->scalar_addn(e))->scalar_multiplyn(learning_rate / _n);
+	if (size == Size3i()) {
+		size = _get_image_layer_output_size();
+	}
 
-			update_parameters(hidden_layer_updations, output_layer_updation, learning_rate); // subject to change. may want bias to have this matrix too.
-			y_hat = model_set_test(current_input_batch);
+	Ref<MLPPMatrix> input = _network.empty() ? _input_set : _network.write[_network.size() - 1]->get_a();
 
-			if (ui) {
-				print_ui(epoch, cost_prev, y_hat, current_output_batch);
-			}
-		}
+	_network.push_back(Ref<MLPPHiddenLayer>(memnew(MLPPPoolLayer(size, pool_size, stride, pool_type, input))));
+	_network.write[_network.size() - 1]->forward_pass();
+}
 
-		epoch++;
+void MLPPANN::add_output_layer(MLPPActivation::ActivationFunction activation, MLPPCost::CostTypes loss, MLPPUtilities::WeightDistributionType weight_init, MLPPReg::RegularizationType reg, real_t lambda, real_t alpha) {
+	clear_compiled_plan();
 
-		if (epoch > max_epoch) {
-			break;
-		}
+	if (!_network.empty()) {
+		_output_layer = Ref<MLPPOutputLayer>(memnew(MLPPOutputLayer(_network.write[_network.size() - 1]->get_n_hidden(), activation, loss, _network.write[_network.size() - 1]->get_a(), weight_init, reg, lambda, alpha)));
+	} else {
+		_output_layer = Ref<MLPPOutputLayer>(memnew(MLPPOutputLayer(_k, activation, loss, _input_set, weight_init, reg, lambda, alpha)));
 	}
-	forward_pass();
 }
 
-void MLPPANN::nadam(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui) {
-	MLPPCost mlpp_cost;
-	MLPPLinAlg alg;
-
-	real_t cost_prev = 0;
-	int epoch = 1;
-	real_t initial_learning_rate = learning_rate;
+Ref<MLPPOutputLayer> MLPPANN::get_output_layer() {
+	return _output_layer;
+}
+Ref<MLPPHiddenLayer> MLPPANN::get_layer(const int index) {
+	ERR_FAIL_INDEX_V(index, _network.size(), Ref<MLPPHiddenLayer>());
 
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	// always evaluate the result
-	// always do forward pass only ONCE at end.
+	return _network[index];
+}
+int MLPPANN::get_layer_count() const {
+	return _network.size();
+}
 
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
+MLPPANN::MLPPANN(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_set) {
+	_input_set = p_input_set;
+	_output_set = p_output_set;
 
-	// Initializing necessary components for Adam.
-	Vector<Ref<MLPPMatrix>> m_hidden;
-	Vector<Ref<MLPPMatrix>> v_hidden;
+	_n = _input_set->size().y;
+	_k = _input_set->size().x;
+	_lr_scheduler = SCHEDULER_TYPE_NONE;
+	_decay_constant = 0;
+	_drop_rate = 0;
 
-	Ref<MLPPVector> m_output;
-	Ref<MLPPVector> v_output;
-	m_output.instance();
-	v_output.instance();
+	_data_parallel_thread_count = 1;
+	_checkpoint_interval = 1;
 
-	while (true) {
-		learning_rate = apply_learning_rate_scheduler(initial_learning_rate, _decay_constant, epoch, _drop_rate);
+	_arena.instance();
+}
 
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch = batches.output_sets[i];
+MLPPANN::MLPPANN() {
+	_n = 0;
+	_k = 0;
+	_lr_scheduler = SCHEDULER_TYPE_NONE;
+	_decay_constant = 0;
+	_drop_rate = 0;
 
-			Ref<MLPPVector> y_hat = model_set_test(current_input_batch);
-			cost_prev = cost(y_hat, current_output_batch);
+	_data_parallel_thread_count = 1;
+	_checkpoint_interval = 1;
 
-			ComputeGradientsResult grads = compute_gradients(y_hat, current_output_batch);
+	_arena.instance();
+}
 
-			if (!_network.empty() && m_hidden.empty() && v_hidden.empty()) { // Initing our tensor
-				alg.resizevt(m_hidden, grads.cumulative_hidden_layer_w_grad);
-				alg.resizevt(v_hidden, grads.cumulative_hidden_layer_w_grad);
-			}
+MLPPANN::~MLPPANN() {
+}
 
-			if (m_output->size() == 0 && v_output->size() == 0) {
-				m_output->resize(grads.output_w_grad->size());
-				v_output->resize(grads.output_w_grad->size());
-			}
+// https://en.wikipedia.org/wiki/Learning_rate
+// Learning Rate Decay (C2W2L09) - Andrew Ng - Deep Learning Specialization
+real_t MLPPANN::apply_learning_rate_scheduler(real_t learning_rate, real_t decay_constant, real_t epoch, real_t drop_rate) {
+	if (_lr_scheduler == SCHEDULER_TYPE_TIME) {
+		return learning_rate / (1 + decay_constant * epoch);
+	} else if (_lr_scheduler == SCHEDULER_TYPE_EPOCH) {
+		return learning_rate * (decay_constant / std::sqrt(epoch));
+	} else if (_lr_scheduler == SCHEDULER_TYPE_STEP) {
+		return learning_rate * Math::pow(decay_constant, int((1 + epoch) / drop_rate)); // Utilizing an explicit int conversion implicitly takes the floor.
+	} else if (_lr_scheduler == SCHEDULER_TYPE_EXPONENTIAL) {
+		return learning_rate * Math::exp(-decay_constant * epoch);
+	}
+
+	return learning_rate;
+}
+
+real_t MLPPANN::cost(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &y) {
+	MLPPReg regularization;
+	MLPPCost mlpp_cost;
 
-			m_hidden = alg.additionnvt(alg.scalar_multiplynvt(b1, m_hidden), alg.scalar_multiplynvt(1 - b1, grads.cumulative_hidden_layer_w_grad));
-			v_hidden = alg.additionnvt(alg.scalar_multiplynvt(b2, v_hidden), alg.scalar_multiplynvt(1 - b2, alg.exponentiatenvt(grads.cumulative_hidden_layer_w_grad, 2)));
+	real_t total_reg_term = 0;
 
-			m_output->addb(m_output->scalar_multiplyn(b1), grads.output_w_grad->scalar_multiplyn(1 - b1));
-			v_output->addb(v_output->scalar_multiplyn(b2), grads.output_w_grad->exponentiaten(2)->scalar_multiplyn(1 - b2));
+	if (!_network.empty()) {
+		for (int i = 0; i < _network.size() - 1; i++) {
+			Ref<MLPPHiddenLayer> layer = _network[i];
 
-			Vector<Ref<MLPPMatrix>> m_hidden_hat = alg.scalar_multiplynvt(1 / (1 - Math::pow(b1, epoch)), m_hidden);
-			Vector<Ref<MLPPMatrix>> v_hidden_hat = alg.scalar_multiplynvt(1 / (1 - Math::pow(b2, epoch)), v_hidden);
-			Vector<Ref<MLPPMatrix>> m_hidden_final = alg.additionnvt(alg.scalar_multiplynvt(b1, m_hidden_hat), alg.scalar_multiplynvt((1 - b1) / (1 - Math::pow(b1, epoch)), grads.cumulative_hidden_layer_w_grad));
+			total_reg_term += regularization.reg_termm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg());
+		}
+	}
 
-			Ref<MLPPVector> m_output_hat = m_output->scalar_multiplyn(1 / (1.0 - Math::pow(b1, epoch)));
-			Ref<MLPPVector> v_output_hat = v_output->scalar_multiplyn(1 / (1.0 - Math::pow(b2, epoch)));
-			Ref<MLPPVector> m_output_final = m_output_hat->scalar_multiplyn(b1)->addn(grads.output_w_grad->scalar_multiplyn((1 - b1) / (1.0 - Math::pow(b1, epoch))));
+	return mlpp_cost.run_cost_norm_vector(_output_layer->get_cost(), y_hat, y) + total_reg_term + regularization.reg_termv(_output_layer->get_weights(), _output_layer->get_lambda(), _output_layer->get_alpha(), _output_layer->get_reg());
+}
 
-			Vector<Ref<MLPPMatrix>> hidden_layer_updations = alg.scalar_multiplynvt(learning_rate / _n, alg.division_element_wisenvnvt(m_hidden_final, alg.scalar_addnvt(e, alg.sqrtnvt(v_hidden_hat))));
-			Ref<MLPPVector> output_layer_updation = m_output_final->division_element_wisen(v_output_hat->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate / _n);
+Size3i MLPPANN::_get_image_layer_output_size() {
+	ERR_FAIL_COND_V_MSG(_network.empty(), Size3i(), "input_size has to be set for the first layer!");
 
-			update_parameters(hidden_layer_updations, output_layer_updation, learning_rate); // subject to change. may want bias to have this matrix too.
+	Ref<MLPPConvLayer> conv_layer = _network[_network.size() - 1];
 
-			y_hat = model_set_test(current_input_batch);
+	if (conv_layer.is_valid()) {
+		return conv_layer->get_output_size();
+	}
 
-			if (ui) {
-				print_ui(epoch, cost_prev, y_hat, current_output_batch);
-			}
+	Ref<MLPPPoolLayer> pool_layer = _network[_network.size() - 1];
+
+	ERR_FAIL_COND_V_MSG(!pool_layer.is_valid(), Size3i(), "input_size has to be set after a fully connected layer!");
+
+	return pool_layer->get_output_size();
+}
+
+void MLPPANN::forward_pass() {
+	if (_plan_is_usable()) {
+		// _y_hat might still be the output layer's a from an earlier pass on the layers.
+		if (!_y_hat.is_valid() || _y_hat == _output_layer->get_a() || _y_hat->size() != _n) {
+			_y_hat.instance();
+			_y_hat->resize(_n);
 		}
 
-		epoch++;
+		_plan_model_set_test(_input_set, _y_hat->ptrw());
 
-		if (epoch > max_epoch) {
-			break;
+		return;
+	}
+
+	if (!_network.empty()) {
+		Ref<MLPPHiddenLayer> layer = _network[0];
+
+		layer->set_input(_input_set);
+		layer->forward_pass();
+
+		for (int i = 1; i < _network.size(); i++) {
+			layer = _network[i];
+			Ref<MLPPHiddenLayer> prev_layer = _network[i - 1];
+
+			layer->set_input(prev_layer->get_a());
+			layer->forward_pass();
+
+			_checkpoint_release(i - 1, false);
 		}
+
+		_output_layer->set_input(_network.write[_network.size() - 1]->get_a());
+	} else {
+		_output_layer->set_input(_input_set);
 	}
 
-	forward_pass();
+	_output_layer->forward_pass();
+
+	_y_hat = _output_layer->get_a();
 }
 
-void MLPPANN::amsgrad(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui) {
-	MLPPCost mlpp_cost;
-	MLPPLinAlg alg;
+// The weights are updated by the optimizer, in one pass over the weight part of the arena.
+// The biases get a plain gradient descent step.
+void MLPPANN::optimizer_step(Ref<MLPPOptimizer> optimizer, const ComputeGradientsResult &grads, real_t learning_rate) {
+	_update_arena();
+	_gather_gradients(grads);
 
-	real_t cost_prev = 0;
-	int epoch = 1;
-	real_t initial_learning_rate = learning_rate;
+	_arena_step(optimizer, _output_layer->get_delta()->sum_elements(), learning_rate);
+}
 
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	// always evaluate the result
-	// always do forward pass only ONCE at end.
+void MLPPANN::_arena_step(Ref<MLPPOptimizer> optimizer, real_t output_bias_gradient, real_t learning_rate) {
+	int weight_count = _network.empty() ? _arena->get_size() : _arena->get_entry_offset(_network.size() + 1);
 
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
+	optimizer->begin_step();
+	optimizer->update(0, _arena->parameters_ptrw(), _arena->gradients_ptr(), weight_count, learning_rate / _n);
 
-	// Initializing necessary components for Adam.
-	Vector<Ref<MLPPMatrix>> m_hidden;
-	Vector<Ref<MLPPMatrix>> v_hidden;
+	_arena->apply_gradients(weight_count, _arena->get_size(), learning_rate / _n);
+	_output_layer->set_bias(_output_layer->get_bias() - learning_rate * output_bias_gradient / _n);
+}
 
-	Vector<Ref<MLPPMatrix>> v_hidden_hat;
+// Entry 0 is the output layer's weights, then come the hidden layers' weights, then their biases, in network order.
+void MLPPANN::_update_arena() {
+	int layer_count = _network.size();
 
-	Ref<MLPPVector> m_output;
-	Ref<MLPPVector> v_output;
-	m_output.instance();
-	v_output.instance();
+	bool bound = _arena->get_entry_count() == 1 + 2 * layer_count && _arena->has_vector(0, _output_layer->get_weights());
 
-	Ref<MLPPVector> v_output_hat;
-	v_output_hat.instance();
+	for (int i = 0; i < layer_count && bound; ++i) {
+		Ref<MLPPHiddenLayer> layer = _network[i];
 
-	while (true) {
-		learning_rate = apply_learning_rate_scheduler(initial_learning_rate, _decay_constant, epoch, _drop_rate);
+		bound = _arena->has_matrix(1 + i, layer->get_weights()) && _arena->has_vector(1 + layer_count + i, layer->get_bias());
+	}
 
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch = batches.output_sets[i];
+	if (bound) {
+		return;
+	}
 
-			Ref<MLPPVector> y_hat = model_set_test(current_input_batch);
-			cost_prev = cost(y_hat, current_output_batch);
+	_arena->clear();
 
-			ComputeGradientsResult grads = compute_gradients(y_hat, current_output_batch);
+	_arena->add_vector(_output_layer->get_weights());
 
-			if (!_network.empty() && m_hidden.size() == 0 && v_hidden.size() == 0) { // Initing our tensor
-				alg.resizevt(m_hidden, grads.cumulative_hidden_layer_w_grad);
-				alg.resizevt(v_hidden, grads.cumulative_hidden_layer_w_grad);
-				alg.resizevt(v_hidden_hat, grads.cumulative_hidden_layer_w_grad);
-			}
+	for (int i = 0; i < layer_count; ++i) {
+		_arena->add_matrix(_network.write[i]->get_weights());
+	}
 
-			if (m_output->size() == 0 && v_output->size() == 0) {
-				m_output->resize(grads.output_w_grad->size());
-				v_output->resize(grads.output_w_grad->size());
-				v_output_hat->resize(grads.output_w_grad->size());
-			}
+	for (int i = 0; i < layer_count; ++i) {
+		_arena->add_vector(_network.write[i]->get_bias());
+	}
 
-			m_hidden = alg.additionnvt(alg.scalar_multiplynvt(b1, m_hidden), alg.scalar_multiplynvt(1 - b1, grads.cumulative_hidden_layer_w_grad));
-			v_hidden = alg.additionnvt(alg.scalar_multiplynvt(b2, v_hidden), alg.scalar_multiplynvt(1 - b2, alg.exponentiatenvt(grads.cumulative_hidden_layer_w_grad, 2)));
+	_arena->build();
+}
 
-			m_output->addb(m_output->scalar_multiplyn(b1), grads.output_w_grad->scalar_multiplyn(1 - b1));
-			v_output->addb(v_output->scalar_multiplyn(b2), grads.output_w_grad->exponentiaten(2)->scalar_multiplyn(1 - b2));
+void MLPPANN::_gather_gradients(const ComputeGradientsResult &grads) {
+	int layer_count = _network.size();
 
-			v_hidden_hat = alg.maxnvt(v_hidden_hat, v_hidden);
-			v_output_hat->max(v_output);
+	_arena->gradient_set_vector(0, grads.output_w_grad);
 
-			Vector<Ref<MLPPMatrix>> hidden_layer_updations = alg.scalar_multiplynvt(learning_rate / _n, alg.division_element_wisenvnvt(m_hidden, alg.scalar_addnvt(e, alg.sqrtnvt(v_hidden_hat))));
-			Ref<MLPPVector> output_layer_updation = m_output->division_element_wisen(v_output_hat->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate / _n);
+	// The hidden layer gradients are in reverse order.
+	for (int i = 0; i < grads.cumulative_hidden_layer_w_grad.size(); ++i) {
+		_arena->gradient_set_matrix(layer_count - i, grads.cumulative_hidden_layer_w_grad[i]);
+	}
 
-			update_parameters(hidden_layer_updations, output_layer_updation, learning_rate); // subject to change. may want bias to have this matrix too.
-			y_hat = model_set_test(current_input_batch);
+	for (int i = 0; i < grads.cumulative_hidden_layer_b_grad.size(); ++i) {
+		_arena->gradient_set_vector(layer_count + layer_count - i, grads.cumulative_hidden_layer_b_grad[i]);
+	}
+}
 
-			if (ui) {
-				print_ui(epoch, cost_prev, y_hat, current_output_batch);
-			}
-		}
+Vector<MLPPANN::DataParallelShard> MLPPANN::_create_data_parallel_shards(int p_count) {
+	Vector<DataParallelShard> shards;
+	shards.resize(p_count);
 
-		epoch++;
+	for (int i = 0; i < p_count; ++i) {
+		DataParallelShard &shard = shards.write[i];
 
-		if (epoch > max_epoch) {
-			break;
+		for (int j = 0; j < _network.size(); ++j) {
+			shard.network.push_back(_network.write[j]->create_replica());
 		}
+
+		shard.output_layer = _output_layer->create_replica();
+
+		shard.input.instance();
+		shard.output.instance();
 	}
 
-	forward_pass();
+	return shards;
 }
 
-real_t MLPPANN::score() {
-	MLPPUtilities util;
+void MLPPANN::_data_parallel_step(Ref<MLPPOptimizer> optimizer, Vector<DataParallelShard> &shards, const Ref<MLPPMatrix> &input, const Ref<MLPPVector> &output, real_t learning_rate) {
+	_update_arena();
 
-	forward_pass();
+	int size = _arena->get_size();
+	int shard_count = shards.size();
 
-	return util.performance_vec(_y_hat, _output_set);
-}
+	Vector<real_t *> buffers;
+	buffers.resize(shard_count);
 
-void MLPPANN::save(const String &file_name) {
-	MLPPUtilities util;
+	for (int i = 0; i < shard_count; ++i) {
+		DataParallelShard &shard = shards.write[i];
 
-	/*
-	if (!_network.empty()) {
-		util.saveParameters(file_name, _network[0].weights, _network[0].bias, false, 1);
-		for (uint32_t i = 1; i < _network.size(); i++) {
-			util.saveParameters(file_name, _network[i].weights, _network[i].bias, true, i + 1);
-		}
-		util.saveParameters(file_name, _output_layer->weights, _output_layer->bias, true, _network.size() + 1);
-	} else {
-		util.saveParameters(file_name, _output_layer->weights, _output_layer->bias, false, _network.size() + 1);
+		shard.output_layer->set_bias(_output_layer->get_bias());
+		shard.gradients.resize(size + 1);
+
+		buffers.write[i] = shard.gradients.ptrw();
 	}
-	*/
-}
 
-void MLPPANN::set_learning_rate_scheduler(SchedulerType type, real_t decay_constant) {
-	_lr_scheduler = type;
-	_decay_constant = decay_constant;
-}
+	DataParallelData data;
+	data.shards = shards.ptrw();
+	data.shard_count = shard_count;
+	data.input = input;
+	data.output = output;
 
-void MLPPANN::set_learning_rate_scheduler_drop(SchedulerType type, real_t decay_constant, real_t drop_rate) {
-	_lr_scheduler = type;
-	_decay_constant = decay_constant;
-	_drop_rate = drop_rate;
+	MLPPParallel::do_work(shard_count, this, &MLPPANN::_data_parallel_range, &data);
+
+	MLPPParallel::tree_sum(buffers.ptr(), shard_count, size + 1);
+
+	real_t *gradients = _arena->gradients_ptrw();
+	memcpy(gradients, buffers[0], sizeof(real_t) * size);
+
+	// The regularization terms only depend on the weights, they are added once, after the sum.
+	_add_regularization_gradients();
+
+	_arena_step(optimizer, buffers[0][size], learning_rate);
 }
 
-void MLPPANN::add_layer(int n_hidden, MLPPActivation::ActivationFunction activation, MLPPUtilities::WeightDistributionType weight_init, MLPPReg::RegularizationType reg, real_t lambda, real_t alpha) {
-	if (_network.empty()) {
-		_network.push_back(Ref<MLPPHiddenLayer>(memnew(MLPPHiddenLayer(n_hidden, activation, _input_set, weight_init, reg, lambda, alpha))));
-		_network.write[0]->forward_pass();
-	} else {
-		_network.push_back(Ref<MLPPHiddenLayer>(memnew(MLPPHiddenLayer(n_hidden, activation, _network.write[_network.size() - 1]->get_a(), weight_init, reg, lambda, alpha))));
-		_network.write[_network.size() - 1]->forward_pass();
+void MLPPANN::_data_parallel_range(int p_from, int p_to, DataParallelData *p_data) {
+	int row_count = p_data->input->size().y;
+
+	for (int i = p_from; i < p_to; ++i) {
+		int from;
+		int to;
+		MLPPParallel::range_get(row_count, p_data->shard_count, i, from, to);
+
+		_shard_compute_gradients(p_data->shards[i], p_data->input, p_data->output, from, to);
 	}
 }
 
-void MLPPANN::add_output_layer(MLPPActivation::ActivationFunction activation, MLPPCost::CostTypes loss, MLPPUtilities::WeightDistributionType weight_init, MLPPReg::RegularizationType reg, real_t lambda, real_t alpha) {
-	if (!_network.empty()) {
-		_output_layer = Ref<MLPPOutputLayer>(memnew(MLPPOutputLayer(_network.write[_network.size() - 1]->get_n_hidden(), activation, loss, _network.write[_network.size() - 1]->get_a(), weight_init, reg, lambda, alpha)));
-	} else {
-		_output_layer = Ref<MLPPOutputLayer>(memnew(MLPPOutputLayer(_k, activation, loss, _input_set, weight_init, reg, lambda, alpha)));
+// Same as compute_gradients() (without the regularization terms), for rows [p_from, p_to) of the batch,
+// on the shard's own layers, straight into the shard's gradient buffer.
+void MLPPANN::_shard_compute_gradients(DataParallelShard &shard, const Ref<MLPPMatrix> &input, const Ref<MLPPVector> &output, int p_from, int p_to) {
+	real_t *gradients = shard.gradients.ptrw();
+	int row_count = p_to - p_from;
+
+	if (row_count <= 0) {
+		for (int i = 0; i < shard.gradients.size(); ++i) {
+			gradients[i] = 0;
+		}
+
+		return;
 	}
+
+	int column_count = input->size().x;
+
+	shard.input->resize(Size2i(column_count, row_count));
+	memcpy(shard.input->ptrw(), input->ptr() + p_from * column_count, sizeof(real_t) * row_count * column_count);
+
+	shard.output->resize(row_count);
+	memcpy(shard.output->ptrw(), output->ptr() + p_from, sizeof(real_t) * row_count);
+
+	Ref<MLPPMatrix> layer_input = shard.input;
+
+	for (int i = 0; i < shard.network.size(); ++i) {
+		Ref<MLPPHiddenLayer> layer = shard.network[i];
+
+		layer->set_input(layer_input);
+		layer->forward_pass();
+
+		layer_input = layer->get_a();
+	}
+
+	Ref<MLPPOutputLayer> output_layer = shard.output_layer;
+
+	output_layer->set_input(layer_input);
+	output_layer->forward_pass();
+
+	MLPPCost mlpp_cost;
+	MLPPActivation avn;
+
+	output_layer->set_delta(mlpp_cost.run_cost_deriv_vector(output_layer->get_cost(), output_layer->get_a(), shard.output)->hadamard_productn(avn.run_activation_deriv_vector(output_layer->get_activation(), output_layer->get_z())));
+
+	Ref<MLPPVector> output_w_grad = output_layer->get_input()->transposen()->mult_vec(output_layer->get_delta());
+	memcpy(gradients + _arena->get_entry_offset(0), output_w_grad->ptr(), sizeof(real_t) * output_w_grad->size());
+
+	int layer_count = shard.network.size();
+
+	for (int i = layer_count - 1; i >= 0; i--) {
+		Ref<MLPPHiddenLayer> layer = shard.network[i];
+
+		Ref<MLPPMatrix> next_gradient;
+
+		if (i == layer_count - 1) {
+			next_gradient = output_layer->get_delta()->outer_product(output_layer->get_weights());
+		} else {
+			next_gradient = shard.network.write[i + 1]->input_gradient();
+		}
+
+		layer->set_delta(next_gradient->hadamard_productn(avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z())));
+
+		Ref<MLPPMatrix> w_grad = layer->weight_gradient();
+		Ref<MLPPVector> b_grad = layer->bias_gradient();
+
+		memcpy(gradients + _arena->get_entry_offset(1 + i), w_grad->ptr(), sizeof(real_t) * w_grad->data_size());
+		memcpy(gradients + _arena->get_entry_offset(1 + layer_count + i), b_grad->ptr(), sizeof(real_t) * b_grad->size());
+	}
+
+	gradients[_arena->get_size()] = output_layer->get_delta()->sum_elements();
 }
 
-MLPPANN::MLPPANN(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_set) {
-	_input_set = p_input_set;
-	_output_set = p_output_set;
+// Conv and pool layers keep more state than z and a, they are never released.
+bool MLPPANN::_checkpoint_is_image_layer(int p_index) {
+	Ref<MLPPHiddenLayer> layer = _network[p_index];
 
-	_n = _input_set->size().y;
-	_k = _input_set->size().x;
-	_lr_scheduler = SCHEDULER_TYPE_NONE;
-	_decay_constant = 0;
-	_drop_rate = 0;
+	return Ref<MLPPConvLayer>(layer).is_valid() || Ref<MLPPPoolLayer>(layer).is_valid();
 }
 
-MLPPANN::MLPPANN() {
+bool MLPPANN::_checkpoint_is_live(int p_index) {
+	return _checkpoint_is_image_layer(p_index) || _network.write[p_index]->has_activations();
 }
 
-MLPPANN::~MLPPANN() {
+void MLPPANN::_checkpoint_release(int p_index, bool p_backward_done) {
+	if (_checkpoint_interval <= 1 || _checkpoint_is_image_layer(p_index)) {
+		return;
+	}
+
+	bool checkpoint = p_index == _network.size() - 1 || (p_index + 1) % _checkpoint_interval == 0;
+
+	if (p_backward_done || !checkpoint) {
+		_network.write[p_index]->release_activations();
+	}
 }
 
-// https://en.wikipedia.org/wiki/Learning_rate
-// Learning Rate Decay (C2W2L09) - Andrew Ng - Deep Learning Specialization
-real_t MLPPANN::apply_learning_rate_scheduler(real_t learning_rate, real_t decay_constant, real_t epoch, real_t drop_rate) {
-	if (_lr_scheduler == SCHEDULER_TYPE_TIME) {
-		return learning_rate / (1 + decay_constant * epoch);
-	} else if (_lr_scheduler == SCHEDULER_TYPE_EPOCH) {
-		return learning_rate * (decay_constant / std::sqrt(epoch));
-	} else if (_lr_scheduler == SCHEDULER_TYPE_STEP) {
-		return learning_rate * Math::pow(decay_constant, int((1 + epoch) / drop_rate)); // Utilizing an explicit int conversion implicitly takes the floor.
-	} else if (_lr_scheduler == SCHEDULER_TYPE_EXPONENTIAL) {
-		return learning_rate * Math::exp(-decay_constant * epoch);
+// Layer p_index needs its own z and its input (the previous a) for the backward step.
+void MLPPANN::_checkpoint_restore(int p_index) {
+	if (_checkpoint_interval <= 1) {
+		return;
 	}
 
-	return learning_rate;
+	// The first layer's input is the batch itself, that never gets released.
+	if (_checkpoint_is_live(p_index) && (p_index == 0 || _checkpoint_is_live(p_index - 1))) {
+		return;
+	}
+
+	int from = p_index;
+	while (from > 0 && !_checkpoint_is_live(from - 1)) {
+		--from;
+	}
+
+	for (int i = from; i <= p_index; ++i) {
+		Ref<MLPPHiddenLayer> layer = _network[i];
+
+		if (i > 0) {
+			layer->set_input(_network.write[i - 1]->get_a());
+		}
+
+		layer->forward_pass();
+	}
 }
 
-real_t MLPPANN::cost(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &y) {
-	MLPPReg regularization;
-	MLPPCost mlpp_cost;
+void MLPPANN::_add_regularization_gradients() {
+	real_t *gradients = _arena->gradients_ptrw();
 
-	real_t total_reg_term = 0;
+	if (_output_layer->get_reg() != MLPPReg::REGULARIZATION_TYPE_NONE) {
+		Ref<MLPPVector> weights = _output_layer->get_weights();
 
-	if (!_network.empty()) {
-		for (int i = 0; i < _network.size() - 1; i++) {
-			Ref<MLPPHiddenLayer> layer = _network[i];
+		const real_t *w_ptr = weights->ptr();
+		real_t *grad_ptr = gradients + _arena->get_entry_offset(0);
 
-			total_reg_term += regularization.reg_termm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg());
+		for (int i = 0; i < weights->size(); ++i) {
+			grad_ptr[i] += MLPPReg::reg_deriv_termr(w_ptr[i], _output_layer->get_lambda(), _output_layer->get_alpha(), _output_layer->get_reg());
 		}
 	}
 
-	return mlpp_cost.run_cost_norm_vector(_output_layer->get_cost(), y_hat, y) + total_reg_term + regularization.reg_termv(_output_layer->get_weights(), _output_layer->get_lambda(), _output_layer->get_alpha(), _output_layer->get_reg());
+	for (int i = 0; i < _network.size(); ++i) {
+		Ref<MLPPHiddenLayer> layer = _network[i];
+
+		if (layer->get_reg() == MLPPReg::REGULARIZATION_TYPE_NONE) {
+			continue;
+		}
+
+		Ref<MLPPMatrix> weights = layer->get_weights();
+
+		const real_t *w_ptr = weights->ptr();
+		real_t *grad_ptr = gradients + _arena->get_entry_offset(1 + i);
+
+		for (int j = 0; j < weights->data_size(); ++j) {
+			grad_ptr[j] += MLPPReg::reg_deriv_termr(w_ptr[j], layer->get_lambda(), layer->get_alpha(), layer->get_reg());
+		}
+	}
 }
 
-void MLPPANN::forward_pass() {
-	if (!_network.empty()) {
-		Ref<MLPPHiddenLayer> layer = _network[0];
+// The layers might have been changed since compile().
+bool MLPPANN::_plan_is_usable() {
+	if (_plan.max_batch_size <= 0 || _plan.inference_ops.size() != _network.size() + 1) {
+		return false;
+	}
 
-		layer->set_input(_input_set);
-		layer->forward_pass();
+	for (int i = 0; i < _network.size(); ++i) {
+		const PlanOp &op = _plan.inference_ops[i];
+		Ref<MLPPHiddenLayer> layer = _network[i];
 
-		for (int i = 1; i < _network.size(); i++) {
-			layer = _network[i];
-			Ref<MLPPHiddenLayer> prev_layer = _network[i - 1];
+		if (layer->get_activation() != op.activation || layer->get_weights()->size() != Size2i(op.width, op.input_width)) {
+			return false;
+		}
+	}
 
-			layer->set_input(prev_layer->get_a());
-			layer->forward_pass();
+	const PlanOp &op = _plan.inference_ops[_network.size()];
+
+	return _output_layer->get_activation() == op.activation && _output_layer->get_weights()->size() == op.input_width;
+}
+
+// Greedy, in op order: a tensor reuses the slot of one that is already dead. Every slot gets as big as its
+// biggest tensor. Returns the size of all slots together.
+int MLPPANN::_plan_assign_offsets(Vector<PlanTensor> &r_tensors) {
+	Vector<int> slot_last;
+	Vector<int> slot_size;
+	Vector<int> tensor_slot;
+
+	for (int i = 0; i < r_tensors.size(); ++i) {
+		const PlanTensor &t = r_tensors[i];
+
+		int slot = -1;
+		for (int j = 0; j < slot_last.size(); ++j) {
+			if (slot_last[j] < t.first) {
+				slot = j;
+				break;
+			}
 		}
 
-		_output_layer->set_input(_network.write[_network.size() - 1]->get_a());
-	} else {
-		_output_layer->set_input(_input_set);
+		if (slot == -1) {
+			slot = slot_last.size();
+			slot_last.push_back(t.last);
+			slot_size.push_back(t.size);
+		} else {
+			slot_last.write[slot] = t.last;
+			slot_size.write[slot] = MAX(slot_size[slot], t.size);
+		}
+
+		tensor_slot.push_back(slot);
 	}
 
-	_output_layer->forward_pass();
+	Vector<int> slot_offset;
+	int total = 0;
 
-	_y_hat = _output_layer->get_a();
+	for (int i = 0; i < slot_size.size(); ++i) {
+		slot_offset.push_back(total);
+		total += slot_size[i];
+	}
+
+	for (int i = 0; i < r_tensors.size(); ++i) {
+		r_tensors.write[i].offset = slot_offset[tensor_slot[i]];
+	}
+
+	return total;
+}
+
+// d(cost) / d(y_hat) of one element, same as MLPPCost::run_cost_deriv_vector().
+static _FORCE_INLINE_ real_t plan_cost_deriv(MLPPCost::CostTypes p_cost, real_t y_hat, real_t y) {
+	switch (p_cost) {
+		case MLPPCost::COST_TYPE_MSE:
+			return y_hat - y;
+		case MLPPCost::COST_TYPE_MBE:
+			return 1;
+		case MLPPCost::COST_TYPE_LOGISTIC_LOSS:
+			return -y / y_hat + (1 - y) / (1 - y_hat);
+		case MLPPCost::COST_TYPE_CROSS_ENTROPY:
+			return -y / y_hat;
+		case MLPPCost::COST_TYPE_WASSERSTEIN_LOSS:
+			return -y;
+		default:
+			return 0;
+	}
 }
 
-void MLPPANN::update_parameters(const Vector<Ref<MLPPMatrix>> &hidden_layer_updations, const Ref<MLPPVector> &output_layer_updation, real_t learning_rate) {
-	_output_layer->set_weights(_output_layer->get_weights()->subn(output_layer_updation));
-	_output_layer->set_bias(_output_layer->get_bias() - learning_rate * _output_layer->get_delta()->sum_elements() / _n);
+void MLPPANN::_plan_run(const Vector<PlanOp> &ops, const real_t *input, const real_t *output, int row_count, real_t *r_output_bias_gradient) {
+	MLPPActivation avn;
 
-	Ref<MLPPMatrix> slice;
+	real_t *buffer = _plan.buffer.ptrw();
+	real_t *gradients = _arena->gradients_ptrw();
+	int layer_count = _network.size();
 
-	if (!_network.empty()) {
-		Ref<MLPPHiddenLayer> layer = _network[_network.size() - 1];
+	Ref<MLPPMatrix> in_view = _plan.input_view;
+	Ref<MLPPMatrix> z_view = _plan.z_view;
+	Ref<MLPPMatrix> delta_view = _plan.delta_view;
+	Ref<MLPPMatrix> next_delta_view = _plan.next_delta_view;
+	Ref<MLPPMatrix> weights_view = _plan.weights_view;
+	Ref<MLPPMatrix> gradient_view = _plan.gradient_view;
 
-		slice = hidden_layer_updations[0];
+	for (int op_index = 0; op_index < ops.size(); ++op_index) {
+		const PlanOp &op = ops[op_index];
 
-		layer->set_weights(layer->get_weights()->subn(slice));
-		layer->set_bias(layer->get_bias()->subtract_matrix_rowsn(layer->get_delta()->scalar_multiplyn(learning_rate / _n)));
+		// The kernels only read the input.
+		real_t *in = op.input < 0 ? const_cast<real_t *>(input) : buffer + op.input;
+		real_t *z = buffer + op.z;
+		real_t *a = buffer + op.a;
+		int in_width = op.input_width;
+		int width = op.width;
 
-		for (int i = _network.size() - 2; i >= 0; i--) {
-			layer = _network[i];
+		in_view->set_view(in, Size2i(in_width, row_count));
+		z_view->set_view(z, Size2i(width, row_count));
+
+		switch (op.type) {
+			case PLAN_OP_TYPE_HIDDEN_FORWARD: {
+				Ref<MLPPHiddenLayer> layer = _network[op.layer];
+
+				z_view->multb(in_view, layer->get_weights());
+				z_view->add_vec(layer->get_bias());
+
+				MLPPActivation::RealActivationFunctionPointer func = avn.get_activation_function_ptr_normal_real(op.activation);
+
+				for (int i = 0; i < row_count * width; ++i) {
+					a[i] = (avn.*func)(z[i]);
+				}
+			} break;
+			case PLAN_OP_TYPE_OUTPUT_FORWARD: {
+				real_t b = _output_layer->get_bias();
+
+				weights_view->set_view(_output_layer->get_weights()->ptrw(), Size2i(1, in_width));
+				z_view->multb(in_view, weights_view);
+
+				MLPPActivation::RealActivationFunctionPointer func = avn.get_activation_function_ptr_normal_real(op.activation);
+
+				for (int r = 0; r < row_count; ++r) {
+					z[r] += b;
+					a[r] = (avn.*func)(z[r]);
+				}
+			} break;
+			case PLAN_OP_TYPE_OUTPUT_BACKWARD: {
+				real_t *delta = buffer + op.delta;
+				MLPPCost::CostTypes cost_type = _output_layer->get_cost();
+
+				MLPPActivation::RealActivationFunctionPointer deriv = avn.get_activation_function_ptr_deriv_real(op.activation);
+
+				real_t bias_grad = 0;
+
+				for (int r = 0; r < row_count; ++r) {
+					real_t d = plan_cost_deriv(cost_type, a[r], output[r]) * (avn.*deriv)(z[r]);
+					delta[r] = d;
+					bias_grad += d;
+				}
 
-			slice = hidden_layer_updations[(_network.size() - 2) - i + 1];
+				delta_view->set_view(delta, Size2i(1, row_count));
+				gradient_view->set_view(gradients + _arena->get_entry_offset(0), Size2i(1, in_width));
+				gradient_view->mult_transposed_a_add(in_view, delta_view);
 
-			layer->set_weights(layer->get_weights()->subn(slice));
-			layer->set_bias(layer->get_bias()->subtract_matrix_rowsn(layer->get_delta()->scalar_multiplyn(learning_rate / _n)));
+				*r_output_bias_gradient += bias_grad;
+			} break;
+			case PLAN_OP_TYPE_HIDDEN_BACKWARD: {
+				real_t *delta = buffer + op.delta;
+				real_t *b_grad = gradients + _arena->get_entry_offset(1 + layer_count + op.layer);
+
+				MLPPActivation::RealActivationFunctionPointer deriv = avn.get_activation_function_ptr_deriv_real(op.activation);
+
+				delta_view->set_view(delta, Size2i(width, row_count));
+				delta_view->fill(0);
+
+				// delta = next delta * next weights^T, the output layer's weights are a width x 1 matrix.
+				if (op.next_layer < 0) {
+					next_delta_view->set_view(buffer + op.next_delta, Size2i(1, row_count));
+					weights_view->set_view(_output_layer->get_weights()->ptrw(), Size2i(1, width));
+
+					delta_view->mult_transposed_b_add(next_delta_view, weights_view);
+				} else {
+					Ref<MLPPMatrix> next_weights = _network.write[op.next_layer]->get_weights();
+
+					next_delta_view->set_view(buffer + op.next_delta, Size2i(next_weights->size().x, row_count));
+
+					delta_view->mult_transposed_b_add(next_delta_view, next_weights);
+				}
+
+				for (int i = 0; i < row_count * width; ++i) {
+					delta[i] *= (avn.*deriv)(z[i]);
+				}
+
+				gradient_view->set_view(gradients + _arena->get_entry_offset(1 + op.layer), Size2i(width, in_width));
+				gradient_view->mult_transposed_a_add(in_view, delta_view);
+
+				for (int r = 0; r < row_count; ++r) {
+					const real_t *delta_row = delta + r * width;
+
+					for (int j = 0; j < width; ++j) {
+						b_grad[j] += delta_row[j];
+					}
+				}
+			} break;
 		}
 	}
 }
 
+void MLPPANN::_plan_model_set_test(const Ref<MLPPMatrix> &input, real_t *r_y_hat) {
+	int row_count = input->size().y;
+	int column_count = input->size().x;
+
+	const real_t *y_hat = _plan.buffer.ptr() + _plan.y_hat;
+
+	for (int from = 0; from < row_count; from += _plan.max_batch_size) {
+		int count = MIN(_plan.max_batch_size, row_count - from);
+
+		_plan_run(_plan.inference_ops, input->ptr() + from * column_count, NULL, count, NULL);
+
+		memcpy(r_y_hat + from, y_hat, sizeof(real_t) * count);
+	}
+}
+
+real_t MLPPANN::_plan_compute_gradients(const Ref<MLPPMatrix> &input, const Ref<MLPPVector> &output) {
+	_update_arena();
+	_arena->gradients_fill(0);
+
+	int row_count = input->size().y;
+	int column_count = input->size().x;
+
+	real_t output_bias_gradient = 0;
+
+	// Every gradient is a sum over the rows, so the chunks just add up.
+	for (int from = 0; from < row_count; from += _plan.max_batch_size) {
+		int count = MIN(_plan.max_batch_size, row_count - from);
+
+		_plan_run(_plan.training_ops, input->ptr() + from * column_count, output->ptr() + from, count, &output_bias_gradient);
+	}
+
+	_add_regularization_gradients();
+
+	return output_bias_gradient;
+}
+
 MLPPANN::ComputeGradientsResult MLPPANN::compute_gradients(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &_output_set) {
 	// std::cout << "BEGIN" << std::endl;
 	MLPPCost mlpp_cost;
@@ -914,25 +1249,37 @@ MLPPANN::ComputeGradientsResult MLPPANN::compute_gradients(const Ref<MLPPVector>
 	res.output_w_grad = _output_layer->get_input()->transposen()->mult_vec(_output_layer->get_delta());
 	res.output_w_grad->add(regularization.reg_deriv_termv(_output_layer->get_weights(), _output_layer->get_lambda(), _output_layer->get_alpha(), _output_layer->get_reg()));
 
-	if (!_network.empty()) {
-		Ref<MLPPHiddenLayer> layer = _network[_network.size() - 1];
-		layer->set_delta(_output_layer->get_delta()->outer_product(_output_layer->get_weights())->hadamard_productn(avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z())));
+	for (int i = _network.size() - 1; i >= 0; i--) {
+		Ref<MLPPHiddenLayer> layer = _network[i];
+
+		_checkpoint_restore(i);
 
-		Ref<MLPPMatrix> hidden_layer_w_grad = layer->get_input()->transposen()->multn(layer->get_delta());
+		Ref<MLPPMatrix> next_gradient;
+
+		if (i == _network.size() - 1) {
+			next_gradient = _output_layer->get_delta()->outer_product(_output_layer->get_weights());
+		} else {
+			next_gradient = _network.write[i + 1]->input_gradient();
+		}
+
+		layer->set_delta(next_gradient->hadamard_productn(avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z())));
+
+		Ref<MLPPMatrix> hidden_layer_w_grad = layer->weight_gradient();
 
 		// Adding to our cumulative hidden layer grads. Maintain reg terms as well.
 		res.cumulative_hidden_layer_w_grad.push_back(hidden_layer_w_grad->addn(regularization.reg_deriv_termm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg())));
+		res.cumulative_hidden_layer_b_grad.push_back(layer->bias_gradient());
 
-		for (int i = _network.size() - 2; i >= 0; i--) {
-			layer = _network[i];
-			Ref<MLPPHiddenLayer> next_layer = _network[i + 1];
-
-			layer->set_delta(next_layer->get_delta()->multn(next_layer->get_weights()->transposen())->hadamard_productn(avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z())));
-			hidden_layer_w_grad = layer->get_input()->transposen()->multn(layer->get_delta());
-			res.cumulative_hidden_layer_w_grad.push_back(hidden_layer_w_grad->addn(regularization.reg_deriv_termm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg()))); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
+		// Everything above this layer is done.
+		if (i + 1 < _network.size()) {
+			_checkpoint_release(i + 1, true);
 		}
 	}
 
+	if (!_network.empty()) {
+		_checkpoint_release(0, true);
+	}
+
 	return res;
 }
 
@@ -45,11 +45,16 @@
 #include "../core/mlpp_tensor3.h"
 #include "../core/mlpp_vector.h"
 
+#include "../conv_layer/conv_layer.h"
 #include "../hidden_layer/hidden_layer.h"
+#include "../pool_layer/pool_layer.h"
 #include "../output_layer/output_layer.h"
 
 #include "../core/activation.h"
 #include "../core/cost.h"
+#include "../core/inference_model.h"
+#include "../core/optimizer.h"
+#include "../core/parameter_arena.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -69,6 +74,10 @@ public:
 	Ref<MLPPVector> model_set_test(const Ref<MLPPMatrix> &X);
 	real_t model_test(const Ref<MLPPVector> &x);
 
+	// An MLPPInferenceModel of the current weights.
+	// Needs fully connected layers.
+	Ref<MLPPInferenceModel> create_inference_model();
+
 	void gradient_descent(real_t learning_rate, int max_epoch, bool ui = false);
 	void sgd(real_t learning_rate, int max_epoch, bool ui = false);
 	void mbgd(real_t learning_rate, int max_epoch, int mini_batch_size, bool ui = false);
@@ -80,6 +89,39 @@ public:
 	void nadam(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui = false);
 	void amsgrad(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui = false);
 
+	// Mini-batch training with any optimizer, the methods above use this. The optimizer keeps its state between calls.
+	void train_optimizer(Ref<MLPPOptimizer> optimizer, real_t learning_rate, int max_epoch, int mini_batch_size, bool ui = false);
+
+	// Shards every mini-batch of train_optimizer() (and of the methods that use it) over this many threads.
+	// Every shard runs forward and backward on its own replicas of the layers, into its own gradient buffer.
+	// The buffers are summed as a tree, then the optimizer takes one step. Results only depend on this count.
+	// 1 (the default) trains on the calling thread.
+	int get_data_parallel_thread_count() const;
+	void set_data_parallel_thread_count(const int val);
+
+	// Plans the forward and backward passes for batches of up to max_batch_size rows. Infers the width of every layer,
+	// preallocates one buffer for all the z, a and delta matrices, sharing space between the ones that are never live
+	// at the same time, and flattens the network into a list of ops. model_set_test(), score(), gradient_descent() and
+	// train_optimizer() replay that list afterwards, bigger batches go through it in chunks, and training steps do no
+	// allocations. The layers' own z, a and delta are not updated by the compiled passes.
+	// Needs fully connected layers with element wise activations, and an output cost with an element wise derivative
+	// (MSE, MBE, logistic loss, cross entropy or Wasserstein loss). Returns false otherwise, and the network keeps
+	// running on the layers. Adding layers clears the plan.
+	bool compile(int max_batch_size);
+	void clear_compiled_plan();
+	bool is_compiled() const;
+
+	// Gradient checkpointing. With an interval of k only every k-th hidden layer (and the last one) keeps its z and a
+	// after a forward pass, the rest are recomputed segment by segment from the nearest kept layer during the backward
+	// pass. Trades about one extra forward pass for O(n / k) activation memory. 1 (the default) keeps everything.
+	// Conv and pool layers are always kept. The compiled plan and the data parallel shards are not affected.
+	int get_checkpoint_interval() const;
+	void set_checkpoint_interval(const int val);
+
+	// The weights and biases of every layer, except the output layer's bias, which is a scalar.
+	// The layers view the arena, so changing it changes the network.
+	Ref<MLPPParameterArena> get_parameter_arena();
+
 	real_t score();
 	void save(const String &file_name);
 
@@ -87,7 +129,13 @@ public:
 	void set_learning_rate_scheduler_drop(SchedulerType type, real_t decay_constant, real_t drop_rate);
 
 	void add_layer(int n_hidden, MLPPActivation::ActivationFunction activation, MLPPUtilities::WeightDistributionType weight_init = MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::RegularizationType reg = MLPPReg::REGULARIZATION_TYPE_NONE, real_t lambda = 0.5, real_t alpha = 0.5);
+	// input_size can be left as Size3i() after a conv or pool layer, it's taken from that layer's output size then.
+	void add_conv_layer(const Size3i &input_size, int filter_count, int filter_size, int stride, int padding, MLPPActivation::ActivationFunction activation, MLPPUtilities::WeightDistributionType weight_init = MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::RegularizationType reg = MLPPReg::REGULARIZATION_TYPE_NONE, real_t lambda = 0.5, real_t alpha = 0.5);
+	void add_pool_layer(const Size3i &input_size, int pool_size, int stride, MLPPConvolutions::PoolType pool_type);
 	void add_output_layer(MLPPActivation::ActivationFunction activation, MLPPCost::CostTypes loss, MLPPUtilities::WeightDistributionType weight_init = MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::RegularizationType reg = MLPPReg::REGULARIZATION_TYPE_NONE, real_t lambda = 0.5, real_t alpha = 0.5);
+	Ref<MLPPOutputLayer> get_output_layer();
+	Ref<MLPPHiddenLayer> get_layer(const int index);
+	int get_layer_count() const;
 
 	MLPPANN(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_set);
 
@@ -100,10 +148,12 @@ protected:
 	real_t cost(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &y);
 
 	void forward_pass();
-	void update_parameters(const Vector<Ref<MLPPMatrix>> &hidden_layer_updations, const Ref<MLPPVector> &output_layer_updation, real_t learning_rate);
+	Size3i _get_image_layer_output_size();
 
 	struct ComputeGradientsResult {
 		Vector<Ref<MLPPMatrix>> cumulative_hidden_layer_w_grad;
+		// Same order. Collected here, as checkpointing frees the deltas.
+		Vector<Ref<MLPPVector>> cumulative_hidden_layer_b_grad;
 		Ref<MLPPVector> output_w_grad;
 
 		ComputeGradientsResult() {
@@ -113,6 +163,134 @@ protected:
 
 	ComputeGradientsResult compute_gradients(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &_output_set);
 
+	void optimizer_step(Ref<MLPPOptimizer> optimizer, const ComputeGradientsResult &grads, real_t learning_rate);
+	void _update_arena();
+	void _gather_gradients(const ComputeGradientsResult &grads);
+	// Steps with the gradients already in the arena.
+	void _arena_step(Ref<MLPPOptimizer> optimizer, real_t output_bias_gradient, real_t learning_rate);
+
+	struct DataParallelShard {
+		Vector<Ref<MLPPHiddenLayer>> network;
+		Ref<MLPPOutputLayer> output_layer;
+
+		Ref<MLPPMatrix> input;
+		Ref<MLPPVector> output;
+
+		// In the arena's layout, followed by the gradient of the output layer's bias.
+		Vector<real_t> gradients;
+	};
+
+	struct DataParallelData {
+		DataParallelShard *shards;
+		int shard_count;
+
+		Ref<MLPPMatrix> input;
+		Ref<MLPPVector> output;
+	};
+
+	Vector<DataParallelShard> _create_data_parallel_shards(int p_count);
+	void _data_parallel_step(Ref<MLPPOptimizer> optimizer, Vector<DataParallelShard> &shards, const Ref<MLPPMatrix> &input, const Ref<MLPPVector> &output, real_t learning_rate);
+	void _data_parallel_range(int p_from, int p_to, DataParallelData *p_data);
+	void _shard_compute_gradients(DataParallelShard &shard, const Ref<MLPPMatrix> &input, const Ref<MLPPVector> &output, int p_from, int p_to);
+
+	bool _checkpoint_is_image_layer(int p_index);
+	bool _checkpoint_is_live(int p_index);
+	// Frees a layer's activations if they are not a checkpoint, or if its backward step is done.
+	void _checkpoint_release(int p_index, bool p_backward_done);
+	// Recomputes the segment below p_index, so it can run its backward step.
+	void _checkpoint_restore(int p_index);
+
+	// Adds the regularization terms of every layer's weights to the gradients in the arena.
+	void _add_regularization_gradients();
+
+	enum PlanOpType {
+		// z = input * weights + bias, a = f(z)
+		PLAN_OP_TYPE_HIDDEN_FORWARD = 0,
+		PLAN_OP_TYPE_OUTPUT_FORWARD,
+		// delta = cost'(a, y) * f'(z), then the weight and bias gradients.
+		PLAN_OP_TYPE_OUTPUT_BACKWARD,
+		// delta = (next delta * next weights^T) * f'(z), then the weight and bias gradients.
+		PLAN_OP_TYPE_HIDDEN_BACKWARD,
+	};
+
+	struct PlanOp {
+		PlanOpType type;
+		// Index in _network, -1 for the output layer.
+		int layer;
+		int next_layer;
+		int input_width;
+		int width;
+		MLPPActivation::ActivationFunction activation;
+
+		// Offsets into Plan::buffer, input is -1 for the batch itself.
+		int input;
+		int z;
+		int a;
+		int delta;
+		int next_delta;
+
+		PlanOp() {
+			type = PLAN_OP_TYPE_HIDDEN_FORWARD;
+			layer = -1;
+			next_layer = -1;
+			input_width = 0;
+			width = 0;
+			activation = MLPPActivation::ACTIVATION_FUNCTION_LINEAR;
+			input = -1;
+			z = -1;
+			a = -1;
+			delta = -1;
+			next_delta = -1;
+		}
+	};
+
+	// A z, a or delta matrix, alive from op first to op last.
+	struct PlanTensor {
+		int size;
+		int first;
+		int last;
+		int offset;
+	};
+
+	struct Plan {
+		int max_batch_size;
+		Vector<PlanOp> inference_ops;
+		Vector<PlanOp> training_ops;
+		// The output of the last inference op.
+		int y_hat;
+
+		Vector<real_t> buffer;
+
+		// Pointed at the operands of every op (the batch, buffer, the weights and the arena's gradients),
+		// so the ops run on the MLPPMatrix kernels without allocating.
+		Ref<MLPPMatrix> input_view;
+		Ref<MLPPMatrix> z_view;
+		Ref<MLPPMatrix> delta_view;
+		Ref<MLPPMatrix> next_delta_view;
+		Ref<MLPPMatrix> weights_view;
+		Ref<MLPPMatrix> gradient_view;
+
+		Plan() {
+			max_batch_size = 0;
+			y_hat = -1;
+
+			input_view.instance();
+			z_view.instance();
+			delta_view.instance();
+			next_delta_view.instance();
+			weights_view.instance();
+			gradient_view.instance();
+		}
+	};
+
+	bool _plan_is_usable();
+	static int _plan_assign_offsets(Vector<PlanTensor> &r_tensors);
+	void _plan_run(const Vector<PlanOp> &ops, const real_t *input, const real_t *output, int row_count, real_t *r_output_bias_gradient);
+	// Writes the network's output for every row of input into r_y_hat.
+	void _plan_model_set_test(const Ref<MLPPMatrix> &input, real_t *r_y_hat);
+	// Fills the arena's gradients, regularization included. Returns the gradient of the output layer's bias.
+	real_t _plan_compute_gradients(const Ref<MLPPMatrix> &input, const Ref<MLPPVector> &output);
+
 	void print_ui(int epoch, real_t cost_prev, const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &p_output_set);
 
 	static void _bind_methods();
@@ -124,12 +302,19 @@ protected:
 	Vector<Ref<MLPPHiddenLayer>> _network;
 	Ref<MLPPOutputLayer> _output_layer;
 
+	Ref<MLPPParameterArena> _arena;
+
 	int _n;
 	int _k;
 
 	SchedulerType _lr_scheduler;
 	real_t _decay_constant;
 	real_t _drop_rate;
+
+	int _data_parallel_thread_count;
+	int _checkpoint_interval;
+
+	Plan _plan;
 };
 
 VARIANT_ENUM_CAST(MLPPANN::SchedulerType);
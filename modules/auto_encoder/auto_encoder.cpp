@@ -32,6 +32,7 @@
 
 #include "../core/activation.h"
 #include "../core/cost.h"
+#include "../core/mini_batch_sampler.h"
 #include "../core/utilities.h"
 
 #ifdef USING_SFW
@@ -163,8 +164,7 @@ void MLPPAutoEncoder::sgd(real_t learning_rate, int max_epoch, bool ui) {
 		Ref<MLPPVector> error = y_hat->subn(input_set_row_tmp);
 
 		// Weight updation for layer 2
-		Ref<MLPPMatrix> D2_1 = error->outer_product(prop_res.a2);
-		_weights2->sub(D2_1->transposen()->scalar_multiplyn(learning_rate));
+		_weights2->outer_product_add(prop_res.a2, error, -learning_rate);
 
 		// Bias updation for layer 2
 		_bias2->sub(error->scalar_multiplyn(learning_rate));
@@ -172,9 +172,8 @@ void MLPPAutoEncoder::sgd(real_t learning_rate, int max_epoch, bool ui) {
 		// Weight updation for layer 1
 		Ref<MLPPVector> D1_1 = _weights2->mult_vec(error);
 		Ref<MLPPVector> D1_2 = D1_1->hadamard_productn(avn.sigmoid_derivv(prop_res.z2));
-		Ref<MLPPMatrix> D1_3 = input_set_row_tmp->outer_product(D1_2);
 
-		_weights1->sub(D1_3->scalar_multiplyn(learning_rate));
+		_weights1->outer_product_add(input_set_row_tmp, D1_2, -learning_rate);
 
 		// Bias updation for layer 1
 
@@ -209,12 +208,14 @@ void MLPPAutoEncoder::mbgd(real_t learning_rate, int max_epoch, int mini_batch_s
 	int epoch = 1;
 
 	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	Vector<Ref<MLPPMatrix>> batches = MLPPUtilities::create_mini_batchesm(_input_set, n_mini_batch);
+	MLPPMiniBatchSampler sampler;
+	sampler.setupm(_input_set, mini_batch_size);
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_batch = batches[i];
+		sampler.begin_epoch();
+
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_batch = sampler.get_input();
 
 			Ref<MLPPMatrix> y_hat = evaluatem(current_batch);
 
@@ -31,6 +31,7 @@
 #include "c_log_log_reg.h"
 #include "../core/activation.h"
 #include "../core/cost.h"
+#include "../core/mini_batch_sampler.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -188,13 +189,15 @@ void MLPPCLogLogReg::mbgd(real_t learning_rate, int max_epoch, int mini_batch_si
 	int epoch = 1;
 
 	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmv(_input_set, _output_set, mini_batch_size);
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch = batches.output_sets[i];
+		sampler.begin_epoch();
+
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_input_batch = sampler.get_input();
+			Ref<MLPPVector> current_output_batch = sampler.get_output_vector();
 
 			Ref<MLPPVector> y_hat = evaluatem(current_input_batch);
 			Ref<MLPPVector> z = propagatem(current_input_batch);
@@ -0,0 +1,559 @@
+/*************************************************************************/
+/*  conv_layer.cpp                                                       */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "conv_layer.h"
+
+#include "../core/activation.h"
+#include "../core/parallel.h"
+#include "../core/utilities.h"
+
+Size3i MLPPConvLayer::get_input_size() const {
+	return _input_size;
+}
+void MLPPConvLayer::set_input_size(const Size3i &val) {
+	_input_size = val;
+	_initialized = false;
+}
+
+int MLPPConvLayer::get_filter_count() const {
+	return _filter_count;
+}
+void MLPPConvLayer::set_filter_count(const int val) {
+	_filter_count = val;
+	_initialized = false;
+}
+
+int MLPPConvLayer::get_filter_size() const {
+	return _filter_size;
+}
+void MLPPConvLayer::set_filter_size(const int val) {
+	_filter_size = val;
+	_initialized = false;
+}
+
+int MLPPConvLayer::get_stride() const {
+	return _stride;
+}
+void MLPPConvLayer::set_stride(const int val) {
+	_stride = val;
+	_initialized = false;
+}
+
+int MLPPConvLayer::get_padding() const {
+	return _padding;
+}
+void MLPPConvLayer::set_padding(const int val) {
+	_padding = val;
+	_initialized = false;
+}
+
+Size3i MLPPConvLayer::get_output_size() const {
+	return _output_size;
+}
+
+void MLPPConvLayer::set_input_tensors(const Vector<Ref<MLPPTensor3>> &val) {
+	int input_data_size = _input_size.x * _input_size.y * _input_size.z;
+
+	Ref<MLPPMatrix> input;
+	input.instance();
+	input->resize(Size2i(input_data_size, val.size()));
+
+	real_t *input_ptr = input->ptrw();
+
+	for (int i = 0; i < val.size(); ++i) {
+		const Ref<MLPPTensor3> &t = val[i];
+
+		ERR_FAIL_COND(!t.is_valid());
+		ERR_FAIL_COND(t->size() != _input_size);
+
+		const real_t *t_ptr = t->ptr();
+
+		for (int j = 0; j < input_data_size; ++j) {
+			input_ptr[i * input_data_size + j] = t_ptr[j];
+		}
+	}
+
+	set_input(input);
+}
+
+Vector<Ref<MLPPTensor3>> MLPPConvLayer::get_a_tensors() {
+	Vector<Ref<MLPPTensor3>> res;
+
+	ERR_FAIL_COND_V(!_a.is_valid() || _a->size().x != _n_hidden, res);
+
+	const real_t *a_ptr = _a->ptr();
+
+	for (int i = 0; i < _a->size().y; ++i) {
+		Ref<MLPPTensor3> t;
+		t.instance();
+		t->resize(_output_size);
+
+		real_t *t_ptr = t->ptrw();
+
+		for (int j = 0; j < _n_hidden; ++j) {
+			t_ptr[j] = a_ptr[i * _n_hidden + j];
+		}
+
+		res.push_back(t);
+	}
+
+	return res;
+}
+
+void MLPPConvLayer::initialize() {
+	if (_initialized) {
+		return;
+	}
+
+	ERR_FAIL_COND(_input_size.x <= 0 || _input_size.y <= 0 || _input_size.z <= 0);
+	ERR_FAIL_COND(_filter_count <= 0 || _filter_size <= 0 || _stride <= 0 || _padding < 0);
+
+	_output_size = Size3i((_input_size.x - _filter_size + 2 * _padding) / _stride + 1, (_input_size.y - _filter_size + 2 * _padding) / _stride + 1, _filter_count);
+
+	ERR_FAIL_COND(_output_size.x <= 0 || _output_size.y <= 0);
+
+	_n_hidden = _output_size.x * _output_size.y * _output_size.z;
+
+	// Same as MLPPHiddenLayer, the setters only invalidate the layer.
+	Size2i weights_size = Size2i(_column_size(), _filter_count);
+
+	if (_weights->size() != weights_size || _bias->size() != _filter_count) {
+		_weights->resize(weights_size);
+		_bias->resize(_filter_count);
+
+		MLPPUtilities utils;
+
+		utils.weight_initializationm(_weights, _weight_init);
+		utils.bias_initializationv(_bias);
+	}
+
+	_initialized = true;
+}
+
+void MLPPConvLayer::forward_pass() {
+	if (!_initialized) {
+		initialize();
+	}
+
+	ERR_FAIL_COND(!_initialized);
+	ERR_FAIL_COND(_input->size().x != _input_size.x * _input_size.y * _input_size.z);
+
+	int batch_size = _input->size().y;
+
+	_z->resize(Size2i(_n_hidden, batch_size));
+
+	_forward(_input->ptr(), _z->ptrw(), batch_size);
+
+	MLPPActivation avn;
+
+	_a = avn.run_activation_norm_matrix(_activation, _z);
+}
+
+void MLPPConvLayer::test(const Ref<MLPPVector> &x) {
+	if (!_initialized) {
+		initialize();
+	}
+
+	ERR_FAIL_COND(!_initialized);
+	ERR_FAIL_COND(!x.is_valid() || x->size() != _input_size.x * _input_size.y * _input_size.z);
+
+	_z_test->resize(_n_hidden);
+
+	_forward(x->ptr(), _z_test->ptrw(), 1);
+
+	MLPPActivation avn;
+
+	_a_test = avn.run_activation_norm_vector(_activation, _z_test);
+}
+
+Ref<MLPPMatrix> MLPPConvLayer::input_gradient() {
+	if (!_initialized) {
+		initialize();
+	}
+
+	ERR_FAIL_COND_V(!_initialized, Ref<MLPPMatrix>());
+	ERR_FAIL_COND_V(_delta->size() != Size2i(_n_hidden, _input->size().y), Ref<MLPPMatrix>());
+
+	int batch_size = _input->size().y;
+
+	Ref<MLPPMatrix> grad;
+	grad.instance();
+	grad->resize(_input->size());
+
+	PassData data;
+	data.input = NULL;
+	data.delta = _delta->ptr();
+	data.output = grad->ptrw();
+	data.batch_size = batch_size;
+
+	MLPPParallel::do_work(batch_size, this, &MLPPConvLayer::_input_gradient_range, &data, 1 + 65536 / MAX(_n_hidden * _column_size(), 1));
+
+	return grad;
+}
+
+Ref<MLPPMatrix> MLPPConvLayer::weight_gradient() {
+	if (!_initialized) {
+		initialize();
+	}
+
+	ERR_FAIL_COND_V(!_initialized, Ref<MLPPMatrix>());
+	ERR_FAIL_COND_V(_delta->size() != Size2i(_n_hidden, _input->size().y), Ref<MLPPMatrix>());
+
+	int batch_size = _input->size().y;
+	int weights_data_size = _weights->data_size();
+	int chunk_count = (batch_size + WEIGHT_GRADIENT_CHUNK_SIZE - 1) / WEIGHT_GRADIENT_CHUNK_SIZE;
+
+	Vector<real_t> partial_sums;
+	partial_sums.resize(chunk_count * weights_data_size);
+
+	PassData data;
+	data.input = _input->ptr();
+	data.delta = _delta->ptr();
+	data.output = partial_sums.ptrw();
+	data.batch_size = batch_size;
+
+	MLPPParallel::do_work(chunk_count, this, &MLPPConvLayer::_weight_gradient_range, &data, 1 + 65536 / MAX(WEIGHT_GRADIENT_CHUNK_SIZE * _n_hidden * _column_size(), 1));
+
+	Ref<MLPPMatrix> grad;
+	grad.instance();
+	grad->resize(_weights->size());
+	grad->fill(0);
+
+	real_t *grad_ptr = grad->ptrw();
+	const real_t *partial_sums_ptr = partial_sums.ptr();
+
+	for (int c = 0; c < chunk_count; ++c) {
+		const real_t *partial = partial_sums_ptr + c * weights_data_size;
+
+		for (int i = 0; i < weights_data_size; ++i) {
+			grad_ptr[i] += partial[i];
+		}
+	}
+
+	return grad;
+}
+
+Ref<MLPPVector> MLPPConvLayer::bias_gradient() {
+	if (!_initialized) {
+		initialize();
+	}
+
+	ERR_FAIL_COND_V(!_initialized, Ref<MLPPVector>());
+	ERR_FAIL_COND_V(_delta->size().x != _n_hidden, Ref<MLPPVector>());
+
+	int batch_size = _delta->size().y;
+	int pixel_count = _pixel_count();
+
+	Ref<MLPPVector> grad;
+	grad.instance();
+	grad->resize(_filter_count);
+
+	const real_t *delta_ptr = _delta->ptr();
+	real_t *grad_ptr = grad->ptrw();
+
+	for (int f = 0; f < _filter_count; ++f) {
+		real_t sum = 0;
+
+		for (int b = 0; b < batch_size; ++b) {
+			const real_t *delta_row = delta_ptr + b * _n_hidden + f * pixel_count;
+
+			for (int p = 0; p < pixel_count; ++p) {
+				sum += delta_row[p];
+			}
+		}
+
+		grad_ptr[f] = sum;
+	}
+
+	return grad;
+}
+
+int MLPPConvLayer::record(Ref<MLPPAutodiffTape> p_tape, const int p_input) {
+	ERR_FAIL_V_MSG(-1, "MLPPConvLayer doesn't support MLPPAutodiffTape recording.");
+}
+
+Ref<MLPPHiddenLayer> MLPPConvLayer::create_replica() {
+	Ref<MLPPConvLayer> layer;
+	layer.instance();
+
+	_replica_setup(layer.ptr());
+
+	layer->_input_size = _input_size;
+	layer->_filter_count = _filter_count;
+	layer->_filter_size = _filter_size;
+	layer->_stride = _stride;
+	layer->_padding = _padding;
+
+	return layer;
+}
+
+MLPPConvLayer::MLPPConvLayer(const Size3i &p_input_size, int p_filter_count, int p_filter_size, int p_stride, int p_padding, MLPPActivation::ActivationFunction p_activation, Ref<MLPPMatrix> p_input, MLPPUtilities::WeightDistributionType p_weight_init, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha) {
+	_input_size = p_input_size;
+	_filter_count = p_filter_count;
+	_filter_size = p_filter_size;
+	_stride = p_stride;
+	_padding = p_padding;
+
+	_activation = p_activation;
+	_input = p_input;
+
+	_reg = p_reg;
+	_lambda = p_lambda;
+	_alpha = p_alpha;
+
+	_weight_init = p_weight_init;
+
+	initialize();
+}
+
+MLPPConvLayer::MLPPConvLayer() {
+	_filter_count = 0;
+	_filter_size = 0;
+	_stride = 1;
+	_padding = 0;
+}
+MLPPConvLayer::~MLPPConvLayer() {
+}
+
+// Row k = (c, fy, fx) of columns is input value k of the receptive field of every output pixel.
+void MLPPConvLayer::_im2col(const real_t *p_input, real_t *r_columns) const {
+	const int pixel_count = _pixel_count();
+
+	int k = 0;
+
+	for (int c = 0; c < _input_size.z; ++c) {
+		const real_t *input_slice = p_input + c * _input_size.x * _input_size.y;
+
+		for (int fy = 0; fy < _filter_size; ++fy) {
+			for (int fx = 0; fx < _filter_size; ++fx) {
+				real_t *column_row = r_columns + k * pixel_count;
+
+				for (int oy = 0; oy < _output_size.y; ++oy) {
+					int iy = oy * _stride - _padding + fy;
+					real_t *dst = column_row + oy * _output_size.x;
+
+					if (iy < 0 || iy >= _input_size.y) {
+						for (int ox = 0; ox < _output_size.x; ++ox) {
+							dst[ox] = 0;
+						}
+
+						continue;
+					}
+
+					const real_t *input_row = input_slice + iy * _input_size.x;
+
+					for (int ox = 0; ox < _output_size.x; ++ox) {
+						int ix = ox * _stride - _padding + fx;
+
+						dst[ox] = ix >= 0 && ix < _input_size.x ? input_row[ix] : 0;
+					}
+				}
+
+				++k;
+			}
+		}
+	}
+}
+
+// The transpose of _im2col(), adds every column value back to the input pixel it was read from.
+void MLPPConvLayer::_col2im(const real_t *p_columns, real_t *r_input) const {
+	const int pixel_count = _pixel_count();
+
+	int k = 0;
+
+	for (int c = 0; c < _input_size.z; ++c) {
+		real_t *input_slice = r_input + c * _input_size.x * _input_size.y;
+
+		for (int fy = 0; fy < _filter_size; ++fy) {
+			for (int fx = 0; fx < _filter_size; ++fx) {
+				const real_t *column_row = p_columns + k * pixel_count;
+
+				for (int oy = 0; oy < _output_size.y; ++oy) {
+					int iy = oy * _stride - _padding + fy;
+
+					if (iy < 0 || iy >= _input_size.y) {
+						continue;
+					}
+
+					const real_t *src = column_row + oy * _output_size.x;
+					real_t *input_row = input_slice + iy * _input_size.x;
+
+					for (int ox = 0; ox < _output_size.x; ++ox) {
+						int ix = ox * _stride - _padding + fx;
+
+						if (ix >= 0 && ix < _input_size.x) {
+							input_row[ix] += src[ox];
+						}
+					}
+				}
+
+				++k;
+			}
+		}
+	}
+}
+
+// The input rows are stacked images, the weight rows stacked filters, and the z rows stacked feature maps,
+// which is the layout of MLPPConvolutions::convolve_3d_stacked().
+void MLPPConvLayer::_forward(const real_t *p_input, real_t *r_z, const int p_batch_size) {
+	_convolutions.convolve_3d_stacked_ptr(p_input, _input_size, p_batch_size, _weights->ptr(), Size2i(_filter_size, _filter_size), _filter_count, _stride, _padding, r_z);
+
+	const int pixel_count = _pixel_count();
+	const real_t *bias_ptr = _bias->ptr();
+
+	for (int b = 0; b < p_batch_size; ++b) {
+		for (int f = 0; f < _filter_count; ++f) {
+			real_t *z_row = r_z + b * _n_hidden + f * pixel_count;
+			real_t bias = bias_ptr[f];
+
+			for (int p = 0; p < pixel_count; ++p) {
+				z_row[p] += bias;
+			}
+		}
+	}
+}
+
+// d columns (column_size x pixel_count) = weightsT * delta (filter_count x pixel_count), then col2im.
+void MLPPConvLayer::_input_gradient_range(int p_from, int p_to, PassData *p_data) {
+	const int input_data_size = _input_size.x * _input_size.y * _input_size.z;
+	const int column_size = _column_size();
+	const int pixel_count = _pixel_count();
+
+	const real_t *weights_ptr = _weights->ptr();
+
+	Vector<real_t> columns;
+	columns.resize(column_size * pixel_count);
+	real_t *columns_ptr = columns.ptrw();
+
+	for (int b = p_from; b < p_to; ++b) {
+		const real_t *delta = p_data->delta + b * _n_hidden;
+		real_t *grad = p_data->output + b * input_data_size;
+
+		for (int i = 0; i < column_size * pixel_count; ++i) {
+			columns_ptr[i] = 0;
+		}
+
+		for (int f = 0; f < _filter_count; ++f) {
+			const real_t *delta_row = delta + f * pixel_count;
+			const real_t *filter = weights_ptr + f * column_size;
+
+			for (int k = 0; k < column_size; ++k) {
+				real_t w = filter[k];
+				real_t *column_row = columns_ptr + k * pixel_count;
+
+				for (int p = 0; p < pixel_count; ++p) {
+					column_row[p] += w * delta_row[p];
+				}
+			}
+		}
+
+		for (int i = 0; i < input_data_size; ++i) {
+			grad[i] = 0;
+		}
+
+		_col2im(columns_ptr, grad);
+	}
+}
+
+// d weights (filter_count x column_size) += delta (filter_count x pixel_count) * columnsT, per chunk of samples.
+void MLPPConvLayer::_weight_gradient_range(int p_from, int p_to, PassData *p_data) {
+	const int input_data_size = _input_size.x * _input_size.y * _input_size.z;
+	const int column_size = _column_size();
+	const int pixel_count = _pixel_count();
+	const int weights_data_size = _filter_count * column_size;
+
+	Vector<real_t> columns;
+	columns.resize(column_size * pixel_count);
+	real_t *columns_ptr = columns.ptrw();
+
+	for (int c = p_from; c < p_to; ++c) {
+		real_t *partial = p_data->output + c * weights_data_size;
+
+		for (int i = 0; i < weights_data_size; ++i) {
+			partial[i] = 0;
+		}
+
+		int chunk_end = MIN((c + 1) * WEIGHT_GRADIENT_CHUNK_SIZE, p_data->batch_size);
+
+		for (int b = c * WEIGHT_GRADIENT_CHUNK_SIZE; b < chunk_end; ++b) {
+			const real_t *delta = p_data->delta + b * _n_hidden;
+
+			_im2col(p_data->input + b * input_data_size, columns_ptr);
+
+			for (int f = 0; f < _filter_count; ++f) {
+				const real_t *delta_row = delta + f * pixel_count;
+				real_t *partial_row = partial + f * column_size;
+
+				for (int k = 0; k < column_size; ++k) {
+					const real_t *column_row = columns_ptr + k * pixel_count;
+					real_t sum = 0;
+
+					for (int p = 0; p < pixel_count; ++p) {
+						sum += delta_row[p] * column_row[p];
+					}
+
+					partial_row[k] += sum;
+				}
+			}
+		}
+	}
+}
+
+int MLPPConvLayer::_column_size() const {
+	return _input_size.z * _filter_size * _filter_size;
+}
+
+int MLPPConvLayer::_pixel_count() const {
+	return _output_size.x * _output_size.y;
+}
+
+void MLPPConvLayer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_input_size"), &MLPPConvLayer::get_input_size);
+	ClassDB::bind_method(D_METHOD("set_input_size", "val"), &MLPPConvLayer::set_input_size);
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR3I, "input_size"), "set_input_size", "get_input_size");
+
+	ClassDB::bind_method(D_METHOD("get_filter_count"), &MLPPConvLayer::get_filter_count);
+	ClassDB::bind_method(D_METHOD("set_filter_count", "val"), &MLPPConvLayer::set_filter_count);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "filter_count"), "set_filter_count", "get_filter_count");
+
+	ClassDB::bind_method(D_METHOD("get_filter_size"), &MLPPConvLayer::get_filter_size);
+	ClassDB::bind_method(D_METHOD("set_filter_size", "val"), &MLPPConvLayer::set_filter_size);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "filter_size"), "set_filter_size", "get_filter_size");
+
+	ClassDB::bind_method(D_METHOD("get_stride"), &MLPPConvLayer::get_stride);
+	ClassDB::bind_method(D_METHOD("set_stride", "val"), &MLPPConvLayer::set_stride);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "stride"), "set_stride", "get_stride");
+
+	ClassDB::bind_method(D_METHOD("get_padding"), &MLPPConvLayer::get_padding);
+	ClassDB::bind_method(D_METHOD("set_padding", "val"), &MLPPConvLayer::set_padding);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "padding"), "set_padding", "get_padding");
+
+	ClassDB::bind_method(D_METHOD("get_output_size"), &MLPPConvLayer::get_output_size);
+}
@@ -0,0 +1,141 @@
+#ifndef MLPP_CONV_LAYER_H
+#define MLPP_CONV_LAYER_H
+
+/*************************************************************************/
+/*  conv_layer.h                                                         */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifdef USING_SFW
+#include "sfw.h"
+#else
+#include "core/math/math_defs.h"
+
+#include "core/object/reference.h"
+#endif
+
+#include "../hidden_layer/hidden_layer.h"
+
+#include "../core/convolutions.h"
+#include "../core/mlpp_matrix.h"
+#include "../core/mlpp_tensor3.h"
+#include "../core/mlpp_vector.h"
+
+// A trainable 2D convolutional layer, that fits into the MLPPHiddenLayer stacks of MLPPANN and MLPPMANN.
+// Every row of input is one image, flattened like MLPPTensor3 data (channel, row, column), and every row of z and a is
+// the filter_count output channels, flattened the same way. So n_hidden is filter_count * output height * output width.
+// The forward pass is one batched MLPPConvolutions call (so it uses the same algorithms, see ConvolutionAlgorithm).
+// The backward passes are im2col + GEMM, in parallel over the samples of the batch.
+class MLPPConvLayer : public MLPPHiddenLayer {
+	GDCLASS(MLPPConvLayer, MLPPHiddenLayer);
+
+public:
+	// x: width, y: height, z: channels
+	Size3i get_input_size() const;
+	void set_input_size(const Size3i &val);
+
+	int get_filter_count() const;
+	void set_filter_count(const int val);
+
+	int get_filter_size() const;
+	void set_filter_size(const int val);
+
+	int get_stride() const;
+	void set_stride(const int val);
+
+	// Zero padding
+	int get_padding() const;
+	void set_padding(const int val);
+
+	// x: width, y: height, z: filter_count
+	Size3i get_output_size() const;
+
+	// Helpers to use batches of MLPPTensor3s as input and output.
+	void set_input_tensors(const Vector<Ref<MLPPTensor3>> &val);
+	Vector<Ref<MLPPTensor3>> get_a_tensors();
+
+	// weights is filter_count x (channels * filter_size * filter_size), every row is a filter,
+	// laid out like the filters of MLPPConvolutions (channel, row, column). bias has one element per filter.
+	void initialize();
+
+	void forward_pass();
+	void test(const Ref<MLPPVector> &x);
+
+	Ref<MLPPMatrix> input_gradient();
+	Ref<MLPPMatrix> weight_gradient();
+	Ref<MLPPVector> bias_gradient();
+
+	// MLPPAutodiffTape has no convolution or pooling operations, so this layer can't be recorded.
+	int record(Ref<MLPPAutodiffTape> p_tape, const int p_input);
+
+	Ref<MLPPHiddenLayer> create_replica();
+
+	MLPPConvLayer(const Size3i &p_input_size, int p_filter_count, int p_filter_size, int p_stride, int p_padding, MLPPActivation::ActivationFunction p_activation, Ref<MLPPMatrix> p_input, MLPPUtilities::WeightDistributionType p_weight_init, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha);
+
+	MLPPConvLayer();
+	~MLPPConvLayer();
+
+protected:
+	enum {
+		// The weight gradient is summed per this many samples, then the partial sums are added in order,
+		// so the result does not depend on the thread count.
+		WEIGHT_GRADIENT_CHUNK_SIZE = 4,
+	};
+
+	struct PassData {
+		const real_t *input;
+		const real_t *delta;
+		real_t *output;
+		int batch_size;
+	};
+
+	void _im2col(const real_t *p_input, real_t *r_columns) const;
+	void _col2im(const real_t *p_columns, real_t *r_input) const;
+	// Convolves p_batch_size input rows into z rows, and adds the bias.
+	void _forward(const real_t *p_input, real_t *r_z, const int p_batch_size);
+
+	void _input_gradient_range(int p_from, int p_to, PassData *p_data);
+	void _weight_gradient_range(int p_from, int p_to, PassData *p_data);
+
+	int _column_size() const;
+	int _pixel_count() const;
+
+	static void _bind_methods();
+
+	Size3i _input_size;
+	int _filter_count;
+	int _filter_size;
+	int _stride;
+	int _padding;
+
+	Size3i _output_size;
+
+	MLPPConvolutions _convolutions;
+};
+
+#endif
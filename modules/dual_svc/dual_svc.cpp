@@ -312,7 +312,12 @@ real_t MLPPDualSVC::kernel_functionv(const Ref<MLPPVector> &v, const Ref<MLPPVec
 
 Ref<MLPPMatrix> MLPPDualSVC::kernel_functionm(const Ref<MLPPMatrix> &U, const Ref<MLPPMatrix> &V, KernelMethod kernel) {
 	if (kernel == KERNEL_METHOD_LINEAR) {
-		return _input_set->multn(_input_set->transposen());
+		if (U == V) {
+			// U * U^T is symmetric, only half of it needs to be computed.
+			return U->row_gram_matrixn();
+		}
+
+		return U->multn(V->transposen());
 	}
 
 	Ref<MLPPMatrix> m;
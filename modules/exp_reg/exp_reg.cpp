@@ -30,6 +30,7 @@
 
 #include "exp_reg.h"
 #include "../core/cost.h"
+#include "../core/mini_batch_sampler.h"
 #include "../core/reg.h"
 #include "../core/stat.h"
 #include "../core/utilities.h"
@@ -182,13 +183,15 @@ void MLPPExpReg::mbgd(real_t learning_rate, int max_epoch, int mini_batch_size,
 	int epoch = 1;
 
 	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmv(_input_set, _output_set, mini_batch_size);
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch = batches.output_sets[i];
+		sampler.begin_epoch();
+
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_input_batch = sampler.get_input();
+			Ref<MLPPVector> current_output_batch = sampler.get_output_vector();
 
 			Ref<MLPPVector> y_hat = evaluatem(current_input_batch);
 			cost_prev = cost(y_hat, current_output_batch);
@@ -211,8 +214,8 @@ void MLPPExpReg::mbgd(real_t learning_rate, int max_epoch, int mini_batch_size,
 				real_t i_gradient = sum2 / current_output_batch->size();
 
 				// Weight/initial updation
-				_weights->element_set(i, _weights->element_get(i) - learning_rate * w_gradient);
-				_initial->element_set(i, _initial->element_get(i) - learning_rate * i_gradient);
+				_weights->element_set(j, _weights->element_get(j) - learning_rate * w_gradient);
+				_initial->element_set(j, _initial->element_get(j) - learning_rate * i_gradient);
 			}
 
 			_weights = regularization.reg_weightsv(_weights, _lambda, _alpha, _reg);
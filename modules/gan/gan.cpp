@@ -77,13 +77,16 @@ void MLPPGAN::gradient_descent(real_t learning_rate, int max_epoch, bool ui) {
 
 	forward_pass();
 
+	Ref<MLPPMatrix> discriminator_input_set;
+	discriminator_input_set.instance();
+
 	while (true) {
 		cost_prev = cost(_y_hat, MLPPVector::create_vec_one(_n));
 
 		// Training of the discriminator.
 
 		Ref<MLPPMatrix> generator_input_set = MLPPMatrix::create_gaussian_noise(_n, _k);
-		Ref<MLPPMatrix> discriminator_input_set = model_set_test_generator(generator_input_set);
+		discriminator_input_set->set_from_mlpp_matrix(model_set_test_generator(generator_input_set));
 		discriminator_input_set->rows_add_mlpp_matrix(_output_set); // Fake + real inputs.
 
 		Ref<MLPPVector> y_hat = model_set_test_discriminator(discriminator_input_set);
@@ -91,22 +94,17 @@ void MLPPGAN::gradient_descent(real_t learning_rate, int max_epoch, bool ui) {
 		Ref<MLPPVector> output_set_real = MLPPVector::create_vec_one(_n);
 		output_set->append_mlpp_vector(output_set_real); // Fake + real output scores.
 
-		ComputeDiscriminatorGradientsResult dgrads = compute_discriminator_gradients(y_hat, _output_set);
-
-		dgrads.cumulative_hidden_layer_w_grad->scalar_multiply(learning_rate / _n);
-		dgrads.output_w_grad->scalar_multiply(learning_rate / _n);
+		ComputeDiscriminatorGradientsResult dgrads = compute_discriminator_gradients(y_hat, output_set);
 
 		update_discriminator_parameters(dgrads.cumulative_hidden_layer_w_grad, dgrads.output_w_grad, learning_rate);
 
 		// Training of the generator.
 		generator_input_set = MLPPMatrix::create_gaussian_noise(_n, _k);
-		discriminator_input_set = model_set_test_generator(generator_input_set);
+		discriminator_input_set->set_from_mlpp_matrix(model_set_test_generator(generator_input_set));
 		y_hat = model_set_test_discriminator(discriminator_input_set);
-		_output_set = MLPPVector::create_vec_one(_n);
-
-		Ref<MLPPTensor3> cumulative_generator_hidden_layer_w_grad = compute_generator_gradients(y_hat, _output_set);
+		output_set = MLPPVector::create_vec_one(_n);
 
-		cumulative_generator_hidden_layer_w_grad->scalar_multiply(learning_rate / _n);
+		Vector<Ref<MLPPMatrix>> cumulative_generator_hidden_layer_w_grad = compute_generator_gradients(y_hat, output_set);
 
 		update_generator_parameters(cumulative_generator_hidden_layer_w_grad, learning_rate);
 
@@ -124,6 +122,14 @@ void MLPPGAN::gradient_descent(real_t learning_rate, int max_epoch, bool ui) {
 	}
 }
 
+Ref<MLPPParameterArena> MLPPGAN::get_parameter_arena() {
+	ERR_FAIL_COND_V(!_output_layer.is_valid(), Ref<MLPPParameterArena>());
+
+	_update_arena();
+
+	return _arena;
+}
+
 real_t MLPPGAN::score() {
 	MLPPUtilities util;
 
@@ -175,9 +181,15 @@ MLPPGAN::MLPPGAN(real_t k, const Ref<MLPPMatrix> &output_set) {
 	_output_set = output_set;
 	_n = _output_set->size().y;
 	_k = k;
+
+	_arena.instance();
 }
 
 MLPPGAN::MLPPGAN() {
+	_n = 0;
+	_k = 0;
+
+	_arena.instance();
 }
 
 MLPPGAN::~MLPPGAN() {
@@ -249,50 +261,78 @@ void MLPPGAN::forward_pass() {
 	_y_hat = _output_layer->get_a();
 }
 
-void MLPPGAN::update_discriminator_parameters(const Ref<MLPPTensor3> &hidden_layer_updations, const Ref<MLPPVector> &output_layer_updation, real_t learning_rate) {
-	_output_layer->set_weights(_output_layer->get_weights()->subn(output_layer_updation));
-	real_t output_layer_bias = _output_layer->get_bias();
-	output_layer_bias -= learning_rate * _output_layer->get_delta()->sum_elements() / _n;
-	_output_layer->set_bias(output_layer_bias);
+// Every hidden layer's weights and bias in network order, then the output layer's weights.
+// The generator's layers come first, so both halves of the network are contiguous ranges.
+void MLPPGAN::_update_arena() {
+	int layer_count = _network.size();
 
-	Ref<MLPPMatrix> slice;
-	slice.instance();
+	bool bound = _arena->get_entry_count() == 2 * layer_count + 1 && _arena->has_vector(2 * layer_count, _output_layer->get_weights());
 
-	if (!_network.empty()) {
-		Ref<MLPPHiddenLayer> layer = _network[_network.size() - 1];
+	for (int i = 0; i < layer_count && bound; ++i) {
+		Ref<MLPPHiddenLayer> layer = _network[i];
 
-		hidden_layer_updations->z_slice_get_into_mlpp_matrix(0, slice);
+		bound = _arena->has_matrix(2 * i, layer->get_weights()) && _arena->has_vector(2 * i + 1, layer->get_bias());
+	}
 
-		layer->set_weights(layer->get_weights()->subn(slice));
-		layer->set_bias(layer->get_bias()->subtract_matrix_rowsn(layer->get_delta()->scalar_multiplyn(learning_rate / _n)));
+	if (bound) {
+		return;
+	}
 
-		for (int i = _network.size() - 2; i > _network.size() / 2; i--) {
-			layer = _network[i];
+	_arena->clear();
 
-			hidden_layer_updations->z_slice_get_into_mlpp_matrix((_network.size() - 2) - i + 1, slice);
+	for (int i = 0; i < layer_count; ++i) {
+		_arena->add_matrix(_network.write[i]->get_weights());
+		_arena->add_vector(_network.write[i]->get_bias());
+	}
 
-			layer->set_weights(layer->get_weights()->subn(slice));
-			layer->set_bias(layer->get_bias()->subtract_matrix_rowsn(layer->get_delta()->scalar_multiplyn(learning_rate / _n)));
-		}
+	_arena->add_vector(_output_layer->get_weights());
+
+	_arena->build();
+}
+
+int MLPPGAN::_get_discriminator_offset() const {
+	if (_network.empty()) {
+		return 0;
 	}
+
+	return _arena->get_entry_offset(2 * (_network.size() / 2 + 1));
 }
 
-void MLPPGAN::update_generator_parameters(const Ref<MLPPTensor3> &hidden_layer_updations, real_t learning_rate) {
-	if (!_network.empty()) {
-		Ref<MLPPMatrix> slice;
-		slice.instance();
+void MLPPGAN::update_discriminator_parameters(const Vector<Ref<MLPPMatrix>> &hidden_layer_gradients, const Ref<MLPPVector> &output_layer_gradient, real_t learning_rate) {
+	_update_arena();
 
-		for (int i = _network.size() / 2; i >= 0; i--) {
-			Ref<MLPPHiddenLayer> layer = _network[i];
+	int layer_count = _network.size();
 
-			hidden_layer_updations->z_slice_get_into_mlpp_matrix((_network.size() - 2) - i + 1, slice);
+	_arena->gradient_set_vector(2 * layer_count, output_layer_gradient);
 
-			//std::cout << network[i].weights.size() << "x" << network[i].weights[0].size() << std::endl;
-			//std::cout << hidden_layer_updations[(network.size() - 2) - i + 1].size() << "x" << hidden_layer_updations[(network.size() - 2) - i + 1][0].size() << std::endl;
-			layer->set_weights(layer->get_weights()->subn(slice));
-			layer->set_bias(layer->get_bias()->subtract_matrix_rowsn(layer->get_delta()->scalar_multiplyn(learning_rate / _n)));
-		}
+	// The gradients are in reverse order, starting from the last hidden layer.
+	for (int i = 0; i < hidden_layer_gradients.size(); ++i) {
+		int layer_index = layer_count - 1 - i;
+
+		_arena->gradient_set_matrix(2 * layer_index, hidden_layer_gradients[i]);
+		_arena->gradient_set_vector(2 * layer_index + 1, _network.write[layer_index]->bias_gradient());
 	}
+
+	_arena->apply_gradients(_get_discriminator_offset(), _arena->get_size(), learning_rate / _n);
+
+	_output_layer->set_bias(_output_layer->get_bias() - learning_rate * _output_layer->get_delta()->sum_elements() / _n);
+}
+
+void MLPPGAN::update_generator_parameters(const Vector<Ref<MLPPMatrix>> &hidden_layer_gradients, real_t learning_rate) {
+	if (_network.empty()) {
+		return;
+	}
+
+	_update_arena();
+
+	int layer_count = _network.size();
+
+	for (int i = _network.size() / 2; i >= 0; i--) {
+		_arena->gradient_set_matrix(2 * i, hidden_layer_gradients[layer_count - 1 - i]);
+		_arena->gradient_set_vector(2 * i + 1, _network.write[i]->bias_gradient());
+	}
+
+	_arena->apply_gradients(0, _get_discriminator_offset(), learning_rate / _n);
 }
 
 MLPPGAN::ComputeDiscriminatorGradientsResult MLPPGAN::compute_discriminator_gradients(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &output_set) {
@@ -302,7 +342,7 @@ MLPPGAN::ComputeDiscriminatorGradientsResult MLPPGAN::compute_discriminator_grad
 
 	ComputeDiscriminatorGradientsResult res;
 
-	Ref<MLPPVector> cost_deriv = mlpp_cost.run_cost_deriv_vector(_output_layer->get_cost(), y_hat, _output_set);
+	Ref<MLPPVector> cost_deriv = mlpp_cost.run_cost_deriv_vector(_output_layer->get_cost(), y_hat, output_set);
 	Ref<MLPPVector> activ_deriv = avn.run_activation_deriv_vector(_output_layer->get_activation(), _output_layer->get_z());
 
 	_output_layer->set_delta(cost_deriv->hadamard_productn(activ_deriv));
@@ -313,72 +353,68 @@ MLPPGAN::ComputeDiscriminatorGradientsResult MLPPGAN::compute_discriminator_grad
 	if (!_network.empty()) {
 		Ref<MLPPHiddenLayer> layer = _network[_network.size() - 1];
 
-		Ref<MLPPVector> hidden_layer_activ_deriv = avn.run_activation_deriv_vector(layer->get_activation(), layer->get_z());
+		Ref<MLPPMatrix> hidden_layer_activ_deriv = avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z());
 
 		layer->set_delta(_output_layer->get_delta()->outer_product(_output_layer->get_weights())->hadamard_productn(hidden_layer_activ_deriv));
 
 		Ref<MLPPMatrix> hidden_layer_w_grad = layer->get_input()->transposen()->multn(layer->get_delta());
 
 		hidden_layer_w_grad->add(regularization.reg_deriv_termm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg()));
-		res.cumulative_hidden_layer_w_grad->z_slice_add_mlpp_matrix(hidden_layer_w_grad); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
+		res.cumulative_hidden_layer_w_grad.push_back(hidden_layer_w_grad); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
 
 		for (int i = static_cast<int>(_network.size()) - 2; i > static_cast<int>(_network.size()) / 2; i--) {
 			layer = _network[i];
 			Ref<MLPPHiddenLayer> next_layer = _network[i + 1];
 
-			hidden_layer_activ_deriv = avn.run_activation_deriv_vector(layer->get_activation(), layer->get_z());
+			hidden_layer_activ_deriv = avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z());
 
 			layer->set_delta(next_layer->get_delta()->multn(next_layer->get_weights()->transposen())->hadamard_productn(hidden_layer_activ_deriv));
 
 			hidden_layer_w_grad = layer->get_input()->transposen()->multn(layer->get_delta());
 
-			res.cumulative_hidden_layer_w_grad->z_slice_add_mlpp_matrix(hidden_layer_w_grad->addn(regularization.reg_deriv_termm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg()))); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
+			res.cumulative_hidden_layer_w_grad.push_back(hidden_layer_w_grad->addn(regularization.reg_deriv_termm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg()))); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
 		}
 	}
 
 	return res;
 }
 
-Ref<MLPPTensor3> MLPPGAN::compute_generator_gradients(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &output_set) {
+Vector<Ref<MLPPMatrix>> MLPPGAN::compute_generator_gradients(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &output_set) {
 	MLPPCost mlpp_cost;
 	MLPPActivation avn;
 	MLPPReg regularization;
 
-	Ref<MLPPTensor3> cumulative_hidden_layer_w_grad; // Tensor containing ALL hidden grads.
+	Vector<Ref<MLPPMatrix>> cumulative_hidden_layer_w_grad; // Contains ALL hidden grads.
 
-	Ref<MLPPVector> cost_deriv = mlpp_cost.run_cost_deriv_vector(_output_layer->get_cost(), y_hat, _output_set);
+	Ref<MLPPVector> cost_deriv = mlpp_cost.run_cost_deriv_vector(_output_layer->get_cost(), y_hat, output_set);
 	Ref<MLPPVector> activ_deriv = avn.run_activation_deriv_vector(_output_layer->get_activation(), _output_layer->get_z());
 
 	_output_layer->set_delta(cost_deriv->hadamard_productn(activ_deriv));
 
-	Ref<MLPPVector> output_w_grad = _output_layer->get_input()->transposen()->mult_vec(_output_layer->get_delta());
-
-	output_w_grad->add(regularization.reg_deriv_termv(_output_layer->get_weights(), _output_layer->get_lambda(), _output_layer->get_alpha(), _output_layer->get_reg()));
-
 	if (!_network.empty()) {
 		Ref<MLPPHiddenLayer> layer = _network[_network.size() - 1];
 
-		Ref<MLPPVector> hidden_layer_activ_deriv = avn.run_activation_deriv_vector(layer->get_activation(), layer->get_z());
+		Ref<MLPPMatrix> hidden_layer_activ_deriv = avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z());
 
 		layer->set_delta(_output_layer->get_delta()->outer_product(_output_layer->get_weights())->hadamard_productn(hidden_layer_activ_deriv));
 
 		Ref<MLPPMatrix> hidden_layer_w_grad = layer->get_input()->transposen()->multn(layer->get_delta());
 		hidden_layer_w_grad->add(regularization.reg_deriv_termm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg()));
 
-		cumulative_hidden_layer_w_grad->z_slice_add_mlpp_matrix(hidden_layer_w_grad); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
+		cumulative_hidden_layer_w_grad.push_back(hidden_layer_w_grad); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
 
 		for (int i = _network.size() - 2; i >= 0; i--) {
 			layer = _network[i];
 			Ref<MLPPHiddenLayer> next_layer = _network[i + 1];
 
-			hidden_layer_activ_deriv = avn.run_activation_deriv_vector(layer->get_activation(), layer->get_z());
+			hidden_layer_activ_deriv = avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z());
 
 			layer->set_delta(next_layer->get_delta()->multn(next_layer->get_weights()->transposen())->hadamard_productn(hidden_layer_activ_deriv));
 
 			hidden_layer_w_grad = layer->get_input()->transposen()->multn(layer->get_delta());
 			hidden_layer_w_grad->add(regularization.reg_deriv_termm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg()));
 
-			cumulative_hidden_layer_w_grad->z_slice_add_mlpp_matrix(hidden_layer_w_grad); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
+			cumulative_hidden_layer_w_grad.push_back(hidden_layer_w_grad); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
 		}
 	}
 
@@ -386,7 +422,7 @@ Ref<MLPPTensor3> MLPPGAN::compute_generator_gradients(const Ref<MLPPVector> &y_h
 }
 
 void MLPPGAN::print_ui(int epoch, real_t cost_prev, const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &output_set) {
-	MLPPUtilities::cost_info(epoch, cost_prev, cost(y_hat, _output_set));
+	MLPPUtilities::cost_info(epoch, cost_prev, cost(y_hat, output_set));
 
 	PLOG_MSG("Layer " + itos(_network.size() + 1) + ": ");
 	MLPPUtilities::print_ui_vb(_output_layer->get_weights(), _output_layer->get_bias());
@@ -42,7 +42,7 @@
 #include "../hidden_layer/hidden_layer.h"
 #include "../output_layer/output_layer.h"
 
-#include "../core/mlpp_tensor3.h"
+#include "../core/parameter_arena.h"
 
 #include "../core/activation.h"
 #include "../core/utilities.h"
@@ -66,6 +66,9 @@ public:
 
 	void gradient_descent(real_t learning_rate, int max_epoch, bool ui = false);
 
+	// The weights and biases of every layer. The layers view the arena, so changing it changes the network.
+	Ref<MLPPParameterArena> get_parameter_arena();
+
 	real_t score();
 
 	void save(const String &file_name);
@@ -86,21 +89,25 @@ protected:
 
 	void forward_pass();
 
-	void update_discriminator_parameters(const Ref<MLPPTensor3> &hidden_layer_updations, const Ref<MLPPVector> &output_layer_updation, real_t learning_rate);
-	void update_generator_parameters(const Ref<MLPPTensor3> &hidden_layer_updations, real_t learning_rate);
+	void _update_arena();
+	// Where the discriminator's parameters start in the arena.
+	int _get_discriminator_offset() const;
+
+	// The gradients are unscaled, the learning rate is applied in the arena pass.
+	void update_discriminator_parameters(const Vector<Ref<MLPPMatrix>> &hidden_layer_gradients, const Ref<MLPPVector> &output_layer_gradient, real_t learning_rate);
+	void update_generator_parameters(const Vector<Ref<MLPPMatrix>> &hidden_layer_gradients, real_t learning_rate);
 
 	struct ComputeDiscriminatorGradientsResult {
-		Ref<MLPPTensor3> cumulative_hidden_layer_w_grad; // Tensor containing ALL hidden grads.
+		Vector<Ref<MLPPMatrix>> cumulative_hidden_layer_w_grad; // Contains ALL hidden grads.
 		Ref<MLPPVector> output_w_grad;
 
 		ComputeDiscriminatorGradientsResult() {
-			cumulative_hidden_layer_w_grad.instance();
 			output_w_grad.instance();
 		}
 	};
 
 	ComputeDiscriminatorGradientsResult compute_discriminator_gradients(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &output_set);
-	Ref<MLPPTensor3> compute_generator_gradients(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &output_set);
+	Vector<Ref<MLPPMatrix>> compute_generator_gradients(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &output_set);
 
 	void print_ui(int epoch, real_t cost_prev, const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &output_set);
 
@@ -112,6 +119,8 @@ protected:
 	Vector<Ref<MLPPHiddenLayer>> _network;
 	Ref<MLPPOutputLayer> _output_layer;
 
+	Ref<MLPPParameterArena> _arena;
+
 	int _n;
 	int _k;
 };
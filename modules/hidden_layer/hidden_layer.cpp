@@ -154,13 +154,18 @@ void MLPPHiddenLayer::initialize() {
 		return;
 	}
 
-	_weights->resize(Size2i(_n_hidden, _input->size().x));
-	_bias->resize(_n_hidden);
+	// The setters only invalidate the layer, the parameters are only (re)initialized if their shape changed.
+	Size2i weights_size = Size2i(_n_hidden, _input->size().x);
 
-	MLPPUtilities utils;
+	if (_weights->size() != weights_size || _bias->size() != _n_hidden) {
+		_weights->resize(weights_size);
+		_bias->resize(_n_hidden);
 
-	utils.weight_initializationm(_weights, _weight_init);
-	utils.bias_initializationv(_bias);
+		MLPPUtilities utils;
+
+		utils.weight_initializationm(_weights, _weight_init);
+		utils.bias_initializationv(_bias);
+	}
 
 	_initialized = true;
 }
@@ -191,6 +196,68 @@ void MLPPHiddenLayer::test(const Ref<MLPPVector> &x) {
 	_a_test = avn.run_activation_norm_vector(_activation, _z_test);
 }
 
+Ref<MLPPMatrix> MLPPHiddenLayer::input_gradient() {
+	return _delta->multn(_weights->transposen());
+}
+
+Ref<MLPPMatrix> MLPPHiddenLayer::weight_gradient() {
+	return _input->transposen()->multn(_delta);
+}
+
+Ref<MLPPVector> MLPPHiddenLayer::bias_gradient() {
+	Size2i delta_size = _delta->size();
+
+	Ref<MLPPVector> grad;
+	grad.instance();
+	grad->resize(delta_size.x);
+	grad->fill(0);
+
+	const real_t *delta_ptr = _delta->ptr();
+	real_t *grad_ptr = grad->ptrw();
+
+	for (int i = 0; i < delta_size.y; ++i) {
+		for (int j = 0; j < delta_size.x; ++j) {
+			grad_ptr[j] += delta_ptr[i * delta_size.x + j];
+		}
+	}
+
+	return grad;
+}
+
+void MLPPHiddenLayer::release_activations() {
+	_z->reset();
+	_delta->reset();
+
+	if (_a.is_valid()) {
+		_a->reset();
+	}
+}
+
+bool MLPPHiddenLayer::has_activations() {
+	return _z->data_size() > 0 && _a.is_valid() && _a->data_size() > 0;
+}
+
+int MLPPHiddenLayer::record(Ref<MLPPAutodiffTape> p_tape, const int p_input) {
+	ERR_FAIL_COND_V(!p_tape.is_valid(), -1);
+
+	if (!_initialized) {
+		initialize();
+	}
+
+	int z = p_tape->add_row(p_tape->matmul(p_input, p_tape->parameter(_weights)), p_tape->parameter_vector(_bias));
+
+	return p_tape->activation(z, _activation);
+}
+
+Ref<MLPPHiddenLayer> MLPPHiddenLayer::create_replica() {
+	Ref<MLPPHiddenLayer> layer;
+	layer.instance();
+
+	_replica_setup(layer.ptr());
+
+	return layer;
+}
+
 MLPPHiddenLayer::MLPPHiddenLayer(int p_n_hidden, MLPPActivation::ActivationFunction p_activation, Ref<MLPPMatrix> p_input, MLPPUtilities::WeightDistributionType p_weight_init, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha) {
 	_n_hidden = p_n_hidden;
 	_activation = p_activation;
@@ -225,7 +292,7 @@ MLPPHiddenLayer::MLPPHiddenLayer() {
 	_activation = MLPPActivation::ACTIVATION_FUNCTION_LINEAR;
 
 	// Regularization Params
-	//reg = 0;
+	_reg = MLPPReg::REGULARIZATION_TYPE_NONE;
 	_lambda = 0; /* Regularization Parameter */
 	_alpha = 0; /* This is the controlling param for Elastic Net*/
 
@@ -247,6 +314,22 @@ MLPPHiddenLayer::MLPPHiddenLayer() {
 MLPPHiddenLayer::~MLPPHiddenLayer() {
 }
 
+void MLPPHiddenLayer::_replica_setup(MLPPHiddenLayer *r_layer) const {
+	r_layer->_n_hidden = _n_hidden;
+	r_layer->_activation = _activation;
+
+	r_layer->_input = _input;
+
+	r_layer->_weights = _weights;
+	r_layer->_bias = _bias;
+
+	r_layer->_reg = _reg;
+	r_layer->_lambda = _lambda;
+	r_layer->_alpha = _alpha;
+
+	r_layer->_weight_init = _weight_init;
+}
+
 void MLPPHiddenLayer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_n_hidden"), &MLPPHiddenLayer::get_n_hidden);
 	ClassDB::bind_method(D_METHOD("set_n_hidden", "val"), &MLPPHiddenLayer::set_n_hidden);
@@ -309,4 +392,15 @@ void MLPPHiddenLayer::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("forward_pass"), &MLPPHiddenLayer::forward_pass);
 	ClassDB::bind_method(D_METHOD("test", "x"), &MLPPHiddenLayer::test);
+
+	ClassDB::bind_method(D_METHOD("input_gradient"), &MLPPHiddenLayer::input_gradient);
+	ClassDB::bind_method(D_METHOD("weight_gradient"), &MLPPHiddenLayer::weight_gradient);
+	ClassDB::bind_method(D_METHOD("bias_gradient"), &MLPPHiddenLayer::bias_gradient);
+
+	ClassDB::bind_method(D_METHOD("release_activations"), &MLPPHiddenLayer::release_activations);
+	ClassDB::bind_method(D_METHOD("has_activations"), &MLPPHiddenLayer::has_activations);
+
+	ClassDB::bind_method(D_METHOD("record", "tape", "input"), &MLPPHiddenLayer::record);
+
+	ClassDB::bind_method(D_METHOD("create_replica"), &MLPPHiddenLayer::create_replica);
 }
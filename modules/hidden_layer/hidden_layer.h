@@ -41,6 +41,7 @@
 #endif
 
 #include "../core/activation.h"
+#include "../core/autodiff_tape.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -98,10 +99,29 @@ public:
 	void set_weight_init(const MLPPUtilities::WeightDistributionType val);
 
 	bool is_initialized();
-	void initialize();
+	virtual void initialize();
 
-	void forward_pass();
-	void test(const Ref<MLPPVector> &x);
+	virtual void forward_pass();
+	virtual void test(const Ref<MLPPVector> &x);
+
+	// Backpropagation, from delta (the gradient of the cost with respect to z), for a whole batch.
+	// input_gradient() is the gradient with respect to input, the a of the previous layer.
+	virtual Ref<MLPPMatrix> input_gradient();
+	virtual Ref<MLPPMatrix> weight_gradient();
+	virtual Ref<MLPPVector> bias_gradient();
+
+	// Frees z, a and delta, for gradient checkpointing. The next forward_pass() computes z and a again.
+	// a is also the next layer's input, that one gets emptied too.
+	void release_activations();
+	bool has_activations();
+
+	// Records a forward pass of p_input onto p_tape, with the weights and the bias as parameters, so the gradients
+	// of any loss built on top of it come from the tape. Returns the node of a.
+	virtual int record(Ref<MLPPAutodiffTape> p_tape, const int p_input);
+
+	// A layer with the same settings, that shares this layer's weights and bias, but has its own input, z, a and delta.
+	// Lets several threads run batches through the same network.
+	virtual Ref<MLPPHiddenLayer> create_replica();
 
 	MLPPHiddenLayer(int p_n_hidden, MLPPActivation::ActivationFunction p_activation, Ref<MLPPMatrix> p_input, MLPPUtilities::WeightDistributionType p_weight_init, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha);
 
@@ -109,6 +129,8 @@ public:
 	~MLPPHiddenLayer();
 
 protected:
+	void _replica_setup(MLPPHiddenLayer *r_layer) const;
+
 	static void _bind_methods();
 
 	int _n_hidden;
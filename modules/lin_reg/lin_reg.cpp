@@ -31,6 +31,8 @@
 #include "lin_reg.h"
 
 #include "../core/cost.h"
+#include "../core/hogwild_sgd.h"
+#include "../core/mini_batch_sampler.h"
 #include "../core/reg.h"
 #include "../core/stat.h"
 #include "../core/utilities.h"
@@ -86,6 +88,15 @@ void MLPPLinReg::set_alpha(const real_t val) {
 }
 */
 
+int MLPPLinReg::get_hogwild_thread_count() const {
+	return _hogwild_thread_count;
+}
+void MLPPLinReg::set_hogwild_thread_count(const int val) {
+	ERR_FAIL_COND(val < 1);
+
+	_hogwild_thread_count = val;
+}
+
 Ref<MLPPVector> MLPPLinReg::model_set_test(const Ref<MLPPMatrix> &X) {
 	ERR_FAIL_COND_V(!_initialized, Ref<MLPPVector>());
 
@@ -116,7 +127,7 @@ void MLPPLinReg::newton_raphson(real_t learning_rate, int max_epoch, bool ui) {
 		// Calculating the weight gradients (2nd derivative)
 
 		Ref<MLPPVector> first_derivative = _input_set->transposen()->mult_vec(error);
-		Ref<MLPPMatrix> second_derivative = _input_set->transposen()->multn(_input_set);
+		Ref<MLPPMatrix> second_derivative = _input_set->gram_matrixn();
 
 		_weights->sub(second_derivative->inverse()->transposen()->mult_vec(first_derivative)->scalar_multiplyn(learning_rate / _n));
 		_weights = regularization.reg_weightsv(_weights, _lambda, _alpha, _reg);
@@ -179,6 +190,11 @@ void MLPPLinReg::gradient_descent(real_t learning_rate, int max_epoch, bool ui)
 void MLPPLinReg::sgd(real_t learning_rate, int max_epoch, bool ui) {
 	ERR_FAIL_COND(!_initialized);
 
+	if (_hogwild_thread_count > 1) {
+		_hogwild_sgd(learning_rate, max_epoch, ui);
+		return;
+	}
+
 	MLPPReg regularization;
 
 	real_t cost_prev = 0;
@@ -238,126 +254,51 @@ void MLPPLinReg::sgd(real_t learning_rate, int max_epoch, bool ui) {
 	forward_pass();
 }
 
-void MLPPLinReg::mbgd(real_t learning_rate, int max_epoch, int mini_batch_size, bool ui) {
-	ERR_FAIL_COND(!_initialized);
-
-	MLPPReg regularization;
-
+void MLPPLinReg::_hogwild_sgd(real_t learning_rate, int max_epoch, bool ui) {
 	real_t cost_prev = 0;
-	int epoch = 1;
-
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_mini_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_mini_batch = batches.output_sets[i];
 
-			Ref<MLPPVector> y_hat = evaluatem(current_input_mini_batch);
-			cost_prev = cost(y_hat, current_output_mini_batch);
-
-			Ref<MLPPVector> error = y_hat->subn(current_output_mini_batch);
-
-			// Calculating the weight gradients
-			_weights->sub(current_input_mini_batch->transposen()->mult_vec(error)->scalar_multiplyn(learning_rate / current_output_mini_batch->size()));
-			_weights = regularization.reg_weightsv(_weights, _lambda, _alpha, _reg);
-
-			// Calculating the bias gradients
-			_bias -= learning_rate * error->sum_elements() / current_output_mini_batch->size();
-			y_hat = evaluatem(current_input_mini_batch);
-
-			if (ui) {
-				MLPPUtilities::cost_info(epoch, cost_prev, cost(y_hat, current_output_mini_batch));
-				MLPPUtilities::print_ui_vb(_weights, _bias);
-			}
-		}
-
-		epoch++;
-
-		if (epoch > max_epoch) {
-			break;
-		}
+	if (ui) {
+		forward_pass();
+		cost_prev = cost(_y_hat, _output_set);
 	}
 
-	forward_pass();
-}
-
-void MLPPLinReg::momentum(real_t learning_rate, int max_epoch, int mini_batch_size, real_t gamma, bool ui) {
-	ERR_FAIL_COND(!_initialized);
-
-	MLPPReg regularization;
-	real_t cost_prev = 0;
-	int epoch = 1;
-
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	// Initializing necessary components for Momentum.
-	Ref<MLPPVector> v = MLPPVector::create_vec_zero(_weights->size());
-
-	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_mini_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_mini_batch = batches.output_sets[i];
-
-			Ref<MLPPVector> y_hat = evaluatem(current_input_mini_batch);
-			cost_prev = cost(y_hat, current_output_mini_batch);
-
-			Ref<MLPPVector> error = y_hat->subn(current_output_mini_batch);
-
-			// Calculating the weight gradients
-
-			Ref<MLPPVector> gradient = current_input_mini_batch->transposen()->mult_vec(error)->scalar_multiplyn(1 / current_output_mini_batch->size());
+	MLPPHogwildSGD::Settings settings;
+	settings.model_type = MLPPHogwildSGD::MODEL_TYPE_LINEAR;
+	settings.learning_rate = learning_rate;
+	settings.iteration_count = max_epoch;
+	settings.worker_count = _hogwild_thread_count;
+	settings.reg = _reg;
+	settings.lambda = _lambda;
+	settings.alpha = _alpha;
 
-			Ref<MLPPVector> reg_deriv_term = regularization.reg_deriv_termv(_weights, _lambda, _alpha, _reg);
-			Ref<MLPPVector> weight_grad = gradient->addn(reg_deriv_term); // Weight_grad_final
+	MLPPHogwildSGD::train(_input_set, _output_set, _weights, &_bias, settings);
 
-			v = v->scalar_multiplyn(gamma)->addn(weight_grad->scalar_multiplyn(learning_rate));
-			_weights->sub(v);
-
-			// Calculating the bias gradients
-			_bias -= learning_rate * error->sum_elements() / current_output_mini_batch->size(); // As normal
-			y_hat = evaluatem(current_input_mini_batch);
-
-			if (ui) {
-				MLPPUtilities::cost_info(epoch, cost_prev, cost(y_hat, current_output_mini_batch));
-				MLPPUtilities::print_ui_vb(_weights, _bias);
-			}
-		}
-
-		epoch++;
+	forward_pass();
 
-		if (epoch > max_epoch) {
-			break;
-		}
+	if (ui) {
+		MLPPUtilities::cost_info(max_epoch, cost_prev, cost(_y_hat, _output_set));
+		MLPPUtilities::print_ui_vb(_weights, _bias);
 	}
-
-	forward_pass();
 }
 
-void MLPPLinReg::nag(real_t learning_rate, int max_epoch, int mini_batch_size, real_t gamma, bool ui) {
+void MLPPLinReg::mbgd(real_t learning_rate, int max_epoch, int mini_batch_size, bool ui) {
 	ERR_FAIL_COND(!_initialized);
 
 	MLPPReg regularization;
+
 	real_t cost_prev = 0;
 	int epoch = 1;
 
 	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	// Initializing necessary components for Momentum.
-	Ref<MLPPVector> v = MLPPVector::create_vec_zero(_weights->size());
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmv(_input_set, _output_set, mini_batch_size);
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_mini_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_mini_batch = batches.output_sets[i];
+		sampler.begin_epoch();
 
-			_weights->sub(v->scalar_multiplyn(gamma)); // "Aposterori" calculation
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_input_mini_batch = sampler.get_input();
+			Ref<MLPPVector> current_output_mini_batch = sampler.get_output_vector();
 
 			Ref<MLPPVector> y_hat = evaluatem(current_input_mini_batch);
 			cost_prev = cost(y_hat, current_output_mini_batch);
@@ -365,17 +306,11 @@ void MLPPLinReg::nag(real_t learning_rate, int max_epoch, int mini_batch_size, r
 			Ref<MLPPVector> error = y_hat->subn(current_output_mini_batch);
 
 			// Calculating the weight gradients
-
-			Ref<MLPPVector> gradient = current_input_mini_batch->transposen()->mult_vec(error)->scalar_multiplyn(1 / current_output_mini_batch->size());
-			Ref<MLPPVector> reg_deriv_term = regularization.reg_deriv_termv(_weights, _lambda, _alpha, _reg);
-			Ref<MLPPVector> weight_grad = gradient->addn(reg_deriv_term); // Weight_grad_final
-
-			v = v->scalar_multiplyn(gamma)->addn(weight_grad->scalar_multiplyn(learning_rate));
-
-			_weights->sub(v);
+			_weights->sub(current_input_mini_batch->transposen()->mult_vec(error)->scalar_multiplyn(learning_rate / current_output_mini_batch->size()));
+			_weights = regularization.reg_weightsv(_weights, _lambda, _alpha, _reg);
 
 			// Calculating the bias gradients
-			_bias -= learning_rate * error->sum_elements() / current_output_mini_batch->size(); // As normal
+			_bias -= learning_rate * error->sum_elements() / current_output_mini_batch->size();
 			y_hat = evaluatem(current_input_mini_batch);
 
 			if (ui) {
@@ -394,244 +329,53 @@ void MLPPLinReg::nag(real_t learning_rate, int max_epoch, int mini_batch_size, r
 	forward_pass();
 }
 
-void MLPPLinReg::adagrad(real_t learning_rate, int max_epoch, int mini_batch_size, real_t e, bool ui) {
-	ERR_FAIL_COND(!_initialized);
-
-	MLPPReg regularization;
-	real_t cost_prev = 0;
-	int epoch = 1;
-
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	// Initializing necessary components for Adagrad.
-	Ref<MLPPVector> v = MLPPVector::create_vec_zero(_weights->size());
-
-	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_mini_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_mini_batch = batches.output_sets[i];
-
-			Ref<MLPPVector> y_hat = evaluatem(current_input_mini_batch);
-			cost_prev = cost(y_hat, current_output_mini_batch);
-
-			Ref<MLPPVector> error = y_hat->subn(current_output_mini_batch);
-
-			// Calculating the weight gradients
-			Ref<MLPPVector> gradient = current_input_mini_batch->transposen()->mult_vec(error)->scalar_multiplyn(1 / current_output_mini_batch->size());
-			Ref<MLPPVector> reg_deriv_term = regularization.reg_deriv_termv(_weights, _lambda, _alpha, _reg);
-			Ref<MLPPVector> weight_grad = gradient->addn(reg_deriv_term); // Weight_grad_final
-
-			v = weight_grad->hadamard_productn(weight_grad);
-			_weights->sub(weight_grad->division_element_wisen(v->scalar_addn(e)->sqrtn())->scalar_multiplyn(learning_rate));
-
-			// Calculating the bias gradients
-			_bias -= learning_rate * error->sum_elements() / current_output_mini_batch->size(); // As normal
-			y_hat = evaluatem(current_input_mini_batch);
-
-			if (ui) {
-				MLPPUtilities::cost_info(epoch, cost_prev, cost(y_hat, current_output_mini_batch));
-				MLPPUtilities::print_ui_vb(_weights, _bias);
-			}
-		}
-
-		epoch++;
+void MLPPLinReg::momentum(real_t learning_rate, int max_epoch, int mini_batch_size, real_t gamma, bool ui) {
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerMomentum(gamma))), learning_rate, max_epoch, mini_batch_size, ui);
+}
 
-		if (epoch > max_epoch) {
-			break;
-		}
-	}
+void MLPPLinReg::nag(real_t learning_rate, int max_epoch, int mini_batch_size, real_t gamma, bool ui) {
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerMomentum(gamma, true))), learning_rate, max_epoch, mini_batch_size, ui);
+}
 
-	forward_pass();
+void MLPPLinReg::adagrad(real_t learning_rate, int max_epoch, int mini_batch_size, real_t e, bool ui) {
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdagrad(e))), learning_rate, max_epoch, mini_batch_size, ui);
 }
 
 void MLPPLinReg::adadelta(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t e, bool ui) {
-	ERR_FAIL_COND(!_initialized);
-
-	// Adagrad upgrade. Momentum is applied.
-	MLPPReg regularization;
-	real_t cost_prev = 0;
-	int epoch = 1;
-
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	// Initializing necessary components for Adagrad.
-	Ref<MLPPVector> v = MLPPVector::create_vec_zero(_weights->size());
-
-	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_mini_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_mini_batch = batches.output_sets[i];
-
-			Ref<MLPPVector> y_hat = evaluatem(current_input_mini_batch);
-			cost_prev = cost(y_hat, current_output_mini_batch);
-
-			Ref<MLPPVector> error = y_hat->subn(current_output_mini_batch);
-
-			// Calculating the weight gradients
-			Ref<MLPPVector> gradient = current_input_mini_batch->transposen()->mult_vec(error)->scalar_multiplyn(1 / current_output_mini_batch->size());
-			Ref<MLPPVector> reg_deriv_term = regularization.reg_deriv_termv(_weights, _lambda, _alpha, _reg);
-			Ref<MLPPVector> weight_grad = gradient->addn(reg_deriv_term); // Weight_grad_final
-
-			v = v->scalar_multiplyn(b1)->addn(weight_grad->hadamard_productn(weight_grad)->scalar_multiplyn(1 - b1));
-			_weights->sub(weight_grad->division_element_wisen(v->scalar_addn(e)->sqrtn())->scalar_multiplyn(learning_rate));
-
-			// Calculating the bias gradients
-			_bias -= learning_rate * error->sum_elements() / current_output_mini_batch->size(); // As normal
-			y_hat = evaluatem(current_input_mini_batch);
-
-			if (ui) {
-				MLPPUtilities::cost_info(epoch, cost_prev, cost(y_hat, current_output_mini_batch));
-				MLPPUtilities::print_ui_vb(_weights, _bias);
-			}
-		}
-
-		epoch++;
-
-		if (epoch > max_epoch) {
-			break;
-		}
-	}
-
-	forward_pass();
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdadelta(b1, e))), learning_rate, max_epoch, mini_batch_size, ui);
 }
 
 void MLPPLinReg::adam(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui) {
-	ERR_FAIL_COND(!_initialized);
-
-	MLPPReg regularization;
-	real_t cost_prev = 0;
-	int epoch = 1;
-
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	// Initializing necessary components for Adam.
-	Ref<MLPPVector> m = MLPPVector::create_vec_zero(_weights->size());
-	Ref<MLPPVector> v = MLPPVector::create_vec_zero(_weights->size());
-
-	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_mini_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_mini_batch = batches.output_sets[i];
-
-			Ref<MLPPVector> y_hat = evaluatem(current_input_mini_batch);
-			cost_prev = cost(y_hat, current_output_mini_batch);
-
-			Ref<MLPPVector> error = y_hat->subn(current_output_mini_batch);
-
-			// Calculating the weight gradients
-			Ref<MLPPVector> gradient = current_input_mini_batch->transposen()->mult_vec(error)->scalar_multiplyn(1 / current_output_mini_batch->size());
-			Ref<MLPPVector> reg_deriv_term = regularization.reg_deriv_termv(_weights, _lambda, _alpha, _reg);
-			Ref<MLPPVector> weight_grad = gradient->addn(reg_deriv_term); // Weight_grad_final
-
-			m = m->scalar_multiplyn(b1)->addn(weight_grad->scalar_multiplyn(1 - b1));
-			v = v->scalar_multiplyn(b2)->addn(weight_grad->exponentiaten(2)->scalar_multiplyn(1 - b2));
-
-			Ref<MLPPVector> m_hat = m->scalar_multiplyn(1 / (1 - Math::pow(b1, epoch)));
-			Ref<MLPPVector> v_hat = v->scalar_multiplyn(1 / (1 - Math::pow(b2, epoch)));
-
-			_weights->sub(m_hat->division_element_wisen(v_hat->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate));
-
-			// Calculating the bias gradients
-			_bias -= learning_rate * error->sum_elements() / current_output_mini_batch->size(); // As normal
-			y_hat = evaluatem(current_input_mini_batch);
-
-			if (ui) {
-				MLPPUtilities::cost_info(epoch, cost_prev, cost(y_hat, current_output_mini_batch));
-				MLPPUtilities::print_ui_vb(_weights, _bias);
-			}
-		}
-
-		epoch++;
-
-		if (epoch > max_epoch) {
-			break;
-		}
-	}
-
-	forward_pass();
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdam(b1, b2, e))), learning_rate, max_epoch, mini_batch_size, ui);
 }
 
 void MLPPLinReg::adamax(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui) {
-	ERR_FAIL_COND(!_initialized);
-
-	MLPPReg regularization;
-	real_t cost_prev = 0;
-	int epoch = 1;
-
-	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	Ref<MLPPVector> m = MLPPVector::create_vec_zero(_weights->size());
-	Ref<MLPPVector> u = MLPPVector::create_vec_zero(_weights->size());
-
-	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_mini_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_mini_batch = batches.output_sets[i];
-
-			Ref<MLPPVector> y_hat = evaluatem(current_input_mini_batch);
-			cost_prev = cost(y_hat, current_output_mini_batch);
-
-			Ref<MLPPVector> error = y_hat->subn(current_output_mini_batch);
-
-			// Calculating the weight gradients
-			Ref<MLPPVector> gradient = current_input_mini_batch->transposen()->mult_vec(error)->scalar_multiplyn(1 / current_output_mini_batch->size());
-			Ref<MLPPVector> reg_deriv_term = regularization.reg_deriv_termv(_weights, _lambda, _alpha, _reg);
-			Ref<MLPPVector> weight_grad = gradient->addn(reg_deriv_term); // Weight_grad_final
-
-			m = m->scalar_multiplyn(b1)->addn(weight_grad->scalar_multiplyn(1 - b1));
-			u = u->scalar_multiplyn(b2)->maxn(weight_grad->absn());
-
-			Ref<MLPPVector> m_hat = m->scalar_multiplyn(1 / (1 - Math::pow(b1, epoch)));
-			_weights->sub(m_hat->division_element_wisen(u)->scalar_multiplyn(learning_rate));
-
-			// Calculating the bias gradients
-			_bias -= learning_rate * error->sum_elements() / current_output_mini_batch->size(); // As normal
-			y_hat = evaluatem(current_input_mini_batch);
-
-			if (ui) {
-				MLPPUtilities::cost_info(epoch, cost_prev, cost(y_hat, current_output_mini_batch));
-				MLPPUtilities::print_ui_vb(_weights, _bias);
-			}
-		}
-
-		epoch++;
-
-		if (epoch > max_epoch) {
-			break;
-		}
-	}
-
-	forward_pass();
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdamax(b1, b2, e))), learning_rate, max_epoch, mini_batch_size, ui);
 }
 
 void MLPPLinReg::nadam(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui) {
+	train_optimizer(Ref<MLPPOptimizer>(memnew(MLPPOptimizerNadam(b1, b2, e))), learning_rate, max_epoch, mini_batch_size, ui);
+}
+
+void MLPPLinReg::train_optimizer(Ref<MLPPOptimizer> optimizer, real_t learning_rate, int max_epoch, int mini_batch_size, bool ui) {
 	ERR_FAIL_COND(!_initialized);
+	ERR_FAIL_COND(!optimizer.is_valid());
+	ERR_FAIL_COND(mini_batch_size <= 0);
 
 	MLPPReg regularization;
 	real_t cost_prev = 0;
 	int epoch = 1;
 
 	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
-
-	// Initializing necessary components for Adam.
-	Ref<MLPPVector> m = MLPPVector::create_vec_zero(_weights->size());
-	Ref<MLPPVector> v = MLPPVector::create_vec_zero(_weights->size());
-	Ref<MLPPVector> m_final = MLPPVector::create_vec_zero(_weights->size());
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmv(_input_set, _output_set, mini_batch_size);
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_mini_batch = batches.input_sets[i];
-			Ref<MLPPVector> current_output_mini_batch = batches.output_sets[i];
+		sampler.begin_epoch();
+
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_input_mini_batch = sampler.get_input();
+			Ref<MLPPVector> current_output_mini_batch = sampler.get_output_vector();
 
 			Ref<MLPPVector> y_hat = evaluatem(current_input_mini_batch);
 			cost_prev = cost(y_hat, current_output_mini_batch);
@@ -639,25 +383,19 @@ void MLPPLinReg::nadam(real_t learning_rate, int max_epoch, int mini_batch_size,
 			Ref<MLPPVector> error = y_hat->subn(current_output_mini_batch);
 
 			// Calculating the weight gradients
-			Ref<MLPPVector> gradient = current_input_mini_batch->transposen()->mult_vec(error)->scalar_multiplyn(1 / current_output_mini_batch->size());
-			Ref<MLPPVector> reg_deriv_term = regularization.reg_deriv_termv(_weights, _lambda, _alpha, _reg);
-			Ref<MLPPVector> weight_grad = gradient->addn(reg_deriv_term); // Weight_grad_final
-
-			m = m->scalar_multiplyn(b1)->addn(weight_grad->scalar_multiplyn(1 - b1));
-			v = v->scalar_multiplyn(b2)->addn(weight_grad->exponentiaten(2)->scalar_multiplyn(1 - b2));
+			Ref<MLPPVector> weight_grad = current_input_mini_batch->transposen()->mult_vec(error);
+			weight_grad->scalar_multiply(real_t(1) / current_output_mini_batch->size());
+			weight_grad->add(regularization.reg_deriv_termv(_weights, _lambda, _alpha, _reg));
 
-			m_final = m->scalar_multiplyn(b1)->addn(weight_grad->scalar_multiplyn((1 - b1) / (1 - Math::pow(b1, epoch))));
-
-			Ref<MLPPVector> m_hat = m->scalar_multiplyn(1 / (1 - Math::pow(b1, epoch)));
-			Ref<MLPPVector> v_hat = v->scalar_multiplyn(1 / (1 - Math::pow(b2, epoch)));
-
-			_weights->sub(m_final->division_element_wisen(v_hat->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate));
+			optimizer->begin_step();
+			optimizer->update_vector(0, _weights, weight_grad, learning_rate);
 
 			// Calculating the bias gradients
 			_bias -= learning_rate * error->sum_elements() / current_output_mini_batch->size(); // As normal
-			y_hat = evaluatem(current_input_mini_batch);
 
 			if (ui) {
+				y_hat = evaluatem(current_input_mini_batch);
+
 				MLPPUtilities::cost_info(epoch, cost_prev, cost(y_hat, current_output_mini_batch));
 				MLPPUtilities::print_ui_vb(_weights, _bias);
 			}
@@ -697,14 +435,14 @@ void MLPPLinReg::normal_equation() {
 	Ref<MLPPVector> temp;
 	//temp.resize(_k);
 
-	temp = input_set_t->multn(_input_set)->inverse()->mult_vec(input_set_t->mult_vec(_output_set));
+	temp = _input_set->gram_matrixn()->inverse()->mult_vec(input_set_t->mult_vec(_output_set));
 
 	ERR_FAIL_COND_MSG(Math::is_nan(temp->element_get(0)), "ERR: Resulting matrix was noninvertible/degenerate, and so the normal equation could not be performed. Try utilizing gradient descent.");
 
 	if (_reg == MLPPReg::REGULARIZATION_TYPE_RIDGE) {
-		_weights = _input_set->transposen()->multn(_input_set)->addn(MLPPMatrix::create_identity_mat(_k)->scalar_multiplyn(_lambda))->inverse()->mult_vec(_input_set->transposen()->mult_vec(_output_set));
+		_weights = _input_set->gram_matrixn()->addn(MLPPMatrix::create_identity_mat(_k)->scalar_multiplyn(_lambda))->inverse()->mult_vec(_input_set->transposen()->mult_vec(_output_set));
 	} else {
-		_weights = _input_set->transposen()->multn(_input_set)->inverse()->mult_vec(_input_set->transposen()->mult_vec(_output_set));
+		_weights = _input_set->gram_matrixn()->inverse()->mult_vec(_input_set->transposen()->mult_vec(_output_set));
 	}
 
 	_bias = stat.meanv(_output_set) - _weights->dot(x_means);
@@ -742,6 +480,7 @@ void MLPPLinReg::initialize() {
 }
 
 MLPPLinReg::MLPPLinReg(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_set, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha) {
+	_hogwild_thread_count = 1;
 	_input_set = p_input_set;
 	_output_set = p_output_set;
 	_n = p_input_set->size().y;
@@ -765,6 +504,7 @@ MLPPLinReg::MLPPLinReg(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector>
 }
 
 MLPPLinReg::MLPPLinReg() {
+	_hogwild_thread_count = 1;
 	_initialized = false;
 }
 MLPPLinReg::~MLPPLinReg() {
@@ -42,6 +42,7 @@
 #include "../core/mlpp_matrix.h"
 #include "../core/mlpp_vector.h"
 
+#include "../core/optimizer.h"
 #include "../core/reg.h"
 
 class MLPPLinReg : public Reference {
@@ -65,6 +66,10 @@ public:
 	void set_alpha(const real_t val);
 	*/
 
+	// 1 (the default) keeps the single threaded sgd(), above 1 it trains with MLPPHogwildSGD.
+	int get_hogwild_thread_count() const;
+	void set_hogwild_thread_count(const int val);
+
 	Ref<MLPPVector> model_set_test(const Ref<MLPPMatrix> &X);
 	real_t model_test(const Ref<MLPPVector> &x);
 
@@ -80,6 +85,9 @@ public:
 	void nadam(real_t learning_rate, int max_epoch, int mini_batch_size, real_t b1, real_t b2, real_t e, bool ui = false);
 	void mbgd(real_t learning_rate, int max_epoch, int mini_batch_size, bool ui = false);
 
+	// Mini-batch training with any optimizer, the methods above use this. The optimizer keeps its state between calls.
+	void train_optimizer(Ref<MLPPOptimizer> optimizer, real_t learning_rate, int max_epoch, int mini_batch_size, bool ui = false);
+
 	void normal_equation();
 
 	real_t score();
@@ -102,6 +110,8 @@ protected:
 
 	void forward_pass();
 
+	void _hogwild_sgd(real_t learning_rate, int max_epoch, bool ui);
+
 	static void _bind_methods();
 
 	Ref<MLPPMatrix> _input_set;
@@ -110,6 +120,8 @@ protected:
 	Ref<MLPPVector> _weights;
 	real_t _bias;
 
+	int _hogwild_thread_count;
+
 	int _n;
 	int _k;
 
@@ -32,6 +32,8 @@
 
 #include "../core/activation.h"
 #include "../core/cost.h"
+#include "../core/hogwild_sgd.h"
+#include "../core/mini_batch_sampler.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -85,6 +87,15 @@ void MLPPLogReg::set_alpha(const real_t val) {
 }
 */
 
+int MLPPLogReg::get_hogwild_thread_count() const {
+	return _hogwild_thread_count;
+}
+void MLPPLogReg::set_hogwild_thread_count(const int val) {
+	ERR_FAIL_COND(val < 1);
+
+	_hogwild_thread_count = val;
+}
+
 Ref<MLPPVector> MLPPLogReg::model_set_test(const Ref<MLPPMatrix> &X) {
 	ERR_FAIL_COND_V(!_initialized, Ref<MLPPVector>());
 
@@ -174,6 +185,11 @@ void MLPPLogReg::mle(real_t learning_rate, int max_epoch, bool ui) {
 void MLPPLogReg::sgd(real_t learning_rate, int max_epoch, bool ui) {
 	ERR_FAIL_COND(!_initialized);
 
+	if (_hogwild_thread_count > 1) {
+		_hogwild_sgd(learning_rate, max_epoch, ui);
+		return;
+	}
+
 	MLPPReg regularization;
 	real_t cost_prev = 0;
 	int epoch = 1;
@@ -232,6 +248,33 @@ void MLPPLogReg::sgd(real_t learning_rate, int max_epoch, bool ui) {
 	forward_pass();
 }
 
+void MLPPLogReg::_hogwild_sgd(real_t learning_rate, int max_epoch, bool ui) {
+	real_t cost_prev = 0;
+
+	if (ui) {
+		forward_pass();
+		cost_prev = cost(_y_hat, _output_set);
+	}
+
+	MLPPHogwildSGD::Settings settings;
+	settings.model_type = MLPPHogwildSGD::MODEL_TYPE_LOGISTIC;
+	settings.learning_rate = learning_rate;
+	settings.iteration_count = max_epoch;
+	settings.worker_count = _hogwild_thread_count;
+	settings.reg = _reg;
+	settings.lambda = _lambda;
+	settings.alpha = _alpha;
+
+	MLPPHogwildSGD::train(_input_set, _output_set, _weights, &_bias, settings);
+
+	forward_pass();
+
+	if (ui) {
+		MLPPUtilities::cost_info(max_epoch, cost_prev, cost(_y_hat, _output_set));
+		MLPPUtilities::print_ui_vb(_weights, _bias);
+	}
+}
+
 void MLPPLogReg::mbgd(real_t learning_rate, int max_epoch, int mini_batch_size, bool UI) {
 	ERR_FAIL_COND(!_initialized);
 
@@ -240,13 +283,15 @@ void MLPPLogReg::mbgd(real_t learning_rate, int max_epoch, int mini_batch_size,
 	int epoch = 1;
 
 	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch bacthes = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmv(_input_set, _output_set, mini_batch_size);
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_mini_batch_input_entry = bacthes.input_sets[i];
-			Ref<MLPPVector> current_mini_batch_output_entry = bacthes.output_sets[i];
+		sampler.begin_epoch();
+
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_mini_batch_input_entry = sampler.get_input();
+			Ref<MLPPVector> current_mini_batch_output_entry = sampler.get_output_vector();
 
 			Ref<MLPPVector> y_hat = evaluatem(current_mini_batch_input_entry);
 			cost_prev = cost(y_hat, current_mini_batch_output_entry);
@@ -305,6 +350,7 @@ void MLPPLogReg::initialize() {
 }
 
 MLPPLogReg::MLPPLogReg(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_set, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha) {
+	_hogwild_thread_count = 1;
 	_input_set = p_input_set;
 	_output_set = p_output_set;
 	_n = p_input_set->size().y;
@@ -328,6 +374,7 @@ MLPPLogReg::MLPPLogReg(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector>
 }
 
 MLPPLogReg::MLPPLogReg() {
+	_hogwild_thread_count = 1;
 	_initialized = false;
 }
 MLPPLogReg::~MLPPLogReg() {
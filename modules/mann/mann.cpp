@@ -38,6 +38,7 @@
 
 #include "../core/activation.h"
 #include "../core/cost.h"
+#include "../core/parallel.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -76,6 +77,8 @@ Ref<MLPPMatrix> MLPPMANN::model_set_test(const Ref<MLPPMatrix> &X) {
 
 			layer->set_input(prev_layer->get_a());
 			layer->forward_pass();
+
+			_checkpoint_release(i - 1, false);
 		}
 
 		_output_layer->set_input(_network.write[_network.size() - 1]->get_a());
@@ -111,6 +114,25 @@ Ref<MLPPVector> MLPPMANN::model_test(const Ref<MLPPVector> &x) {
 	return _output_layer->get_a_test();
 }
 
+Ref<MLPPInferenceModel> MLPPMANN::create_inference_model() {
+	ERR_FAIL_COND_V(!_output_layer.is_valid(), Ref<MLPPInferenceModel>());
+
+	Ref<MLPPInferenceModel> model;
+	model.instance();
+
+	for (int i = 0; i < _network.size(); ++i) {
+		Ref<MLPPHiddenLayer> layer = _network[i];
+
+		ERR_FAIL_COND_V_MSG(Ref<MLPPConvLayer>(layer).is_valid() || Ref<MLPPPoolLayer>(layer).is_valid(), Ref<MLPPInferenceModel>(), "Conv and pool layers are not supported.");
+
+		model->add_layer(layer->get_weights(), layer->get_bias(), layer->get_activation());
+	}
+
+	model->add_layer(_output_layer->get_weights(), _output_layer->get_bias(), _output_layer->get_activation());
+
+	return model;
+}
+
 void MLPPMANN::gradient_descent(real_t learning_rate, int max_epoch, bool ui) {
 	ERR_FAIL_COND(!_initialized);
 
@@ -121,51 +143,75 @@ void MLPPMANN::gradient_descent(real_t learning_rate, int max_epoch, bool ui) {
 	real_t cost_prev = 0;
 	int epoch = 1;
 
+	Vector<DataParallelShard> shards;
+
+	if (_data_parallel_thread_count > 1) {
+		shards = _create_data_parallel_shards(_data_parallel_thread_count);
+	}
+
 	forward_pass();
 
 	while (true) {
 		cost_prev = cost(_y_hat, _output_set);
 
-		if (_output_layer->get_activation() == MLPPActivation::ACTIVATION_FUNCTION_SOFTMAX) {
-			_output_layer->set_delta(_y_hat->subn(_output_set));
+		_update_arena();
+
+		if (!shards.empty()) {
+			_data_parallel_gradients(shards);
 		} else {
-			Ref<MLPPMatrix> r1 = mlpp_cost.run_cost_deriv_matrix(_output_layer->get_cost(), _y_hat, _output_set);
-			Ref<MLPPMatrix> r2 = avn.run_activation_deriv_matrix(_output_layer->get_activation(), _output_layer->get_z());
+			if (_output_layer->get_activation() == MLPPActivation::ACTIVATION_FUNCTION_SOFTMAX) {
+				_output_layer->set_delta(_y_hat->subn(_output_set));
+			} else {
+				Ref<MLPPMatrix> r1 = mlpp_cost.run_cost_deriv_matrix(_output_layer->get_cost(), _y_hat, _output_set);
+				Ref<MLPPMatrix> r2 = avn.run_activation_deriv_matrix(_output_layer->get_activation(), _output_layer->get_z());
 
-			_output_layer->set_delta(r1->hadamard_productn(r2));
-		}
+				_output_layer->set_delta(r1->hadamard_productn(r2));
+			}
 
-		Ref<MLPPMatrix> output_w_grad = _output_layer->get_input()->transposen()->multn(_output_layer->get_delta());
+			_arena->gradient_set_matrix(0, _output_layer->get_input()->transposen()->multn(_output_layer->get_delta()));
+			_arena->gradient_set_vector(1, _output_layer->bias_gradient());
 
-		_output_layer->set_weights(_output_layer->get_weights()->subn(output_w_grad->scalar_multiplyn(learning_rate / _n)));
-		_output_layer->set_weights(regularization.reg_weightsm(_output_layer->get_weights(), _output_layer->get_lambda(), _output_layer->get_alpha(),
-				_output_layer->get_reg()));
+			for (int i = _network.size() - 1; i >= 0; i--) {
+				Ref<MLPPHiddenLayer> layer = _network[i];
 
-		_output_layer->set_bias(_output_layer->get_bias()->subtract_matrix_rowsn(_output_layer->get_delta()->scalar_multiplyn(learning_rate / _n)));
+				_checkpoint_restore(i);
 
-		if (!_network.empty()) {
-			Ref<MLPPHiddenLayer> layer = _network[_network.size() - 1];
+				Ref<MLPPMatrix> next_gradient;
 
-			layer->set_delta(_output_layer->get_delta()->multn(_output_layer->get_weights()->transposen())->hadamard_productn(avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z())));
+				if (i == _network.size() - 1) {
+					next_gradient = _output_layer->get_delta()->multn(_output_layer->get_weights()->transposen());
+				} else {
+					next_gradient = _network.write[i + 1]->input_gradient();
+				}
 
-			Ref<MLPPMatrix> hidden_layer_w_grad = layer->get_input()->transposen()->multn(layer->get_delta());
+				layer->set_delta(next_gradient->hadamard_productn(avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z())));
 
-			layer->set_weights(layer->get_weights()->subn(hidden_layer_w_grad->scalar_multiplyn(learning_rate / _n)));
-			layer->set_weights(regularization.reg_weightsm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg()));
+				_arena->gradient_set_matrix(2 + 2 * i, layer->weight_gradient());
+				_arena->gradient_set_vector(3 + 2 * i, layer->bias_gradient());
 
-			layer->set_bias(layer->get_bias()->subtract_matrix_rowsn(layer->get_delta()->scalar_multiplyn(learning_rate / _n)));
+				if (i + 1 < _network.size()) {
+					_checkpoint_release(i + 1, true);
+				}
+			}
 
-			for (int i = _network.size() - 2; i >= 0; i--) {
-				layer = _network[i];
-				Ref<MLPPHiddenLayer> next_layer = _network[i + 1];
+			if (!_network.empty()) {
+				_checkpoint_release(0, true);
+			}
+		}
 
-				layer->set_delta(next_layer->get_delta()->multn(next_layer->get_weights())->hadamard_productn(avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z())));
+		// Every weight and bias in one pass.
+		_arena->apply_gradients(0, _arena->get_size(), learning_rate / _n);
 
-				hidden_layer_w_grad = layer->get_input()->transposen()->multn(layer->get_delta());
+		// reg_weightsm() returns new matrices, the results are copied back into the arena.
+		if (_output_layer->get_reg() != MLPPReg::REGULARIZATION_TYPE_NONE) {
+			_output_layer->get_weights()->set_from_mlpp_matrix(regularization.reg_weightsm(_output_layer->get_weights(), _output_layer->get_lambda(), _output_layer->get_alpha(), _output_layer->get_reg()));
+		}
 
-				layer->set_weights(layer->get_weights()->subn(hidden_layer_w_grad->scalar_multiplyn(learning_rate / _n)));
-				layer->set_weights(regularization.reg_weightsm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg()));
-				layer->set_bias(layer->get_bias()->subtract_matrix_rowsn(layer->get_delta()->scalar_multiplyn(learning_rate / _n)));
+		for (int i = 0; i < _network.size(); i++) {
+			Ref<MLPPHiddenLayer> layer = _network[i];
+
+			if (layer->get_reg() != MLPPReg::REGULARIZATION_TYPE_NONE) {
+				layer->get_weights()->set_from_mlpp_matrix(regularization.reg_weightsm(layer->get_weights(), layer->get_lambda(), layer->get_alpha(), layer->get_reg()));
 			}
 		}
 
@@ -195,6 +241,32 @@ void MLPPMANN::gradient_descent(real_t learning_rate, int max_epoch, bool ui) {
 	}
 }
 
+int MLPPMANN::get_data_parallel_thread_count() const {
+	return _data_parallel_thread_count;
+}
+void MLPPMANN::set_data_parallel_thread_count(const int val) {
+	ERR_FAIL_COND(val < 1);
+
+	_data_parallel_thread_count = val;
+}
+
+int MLPPMANN::get_checkpoint_interval() const {
+	return _checkpoint_interval;
+}
+void MLPPMANN::set_checkpoint_interval(const int val) {
+	ERR_FAIL_COND(val < 1);
+
+	_checkpoint_interval = val;
+}
+
+Ref<MLPPParameterArena> MLPPMANN::get_parameter_arena() {
+	ERR_FAIL_COND_V(!_output_layer.is_valid(), Ref<MLPPParameterArena>());
+
+	_update_arena();
+
+	return _arena;
+}
+
 real_t MLPPMANN::score() {
 	ERR_FAIL_COND_V(!_initialized, 0);
 
@@ -232,6 +304,32 @@ void MLPPMANN::add_layer(int n_hidden, MLPPActivation::ActivationFunction activa
 	}
 }
 
+void MLPPMANN::add_conv_layer(const Size3i &input_size, int filter_count, int filter_size, int stride, int padding, MLPPActivation::ActivationFunction activation, MLPPUtilities::WeightDistributionType weight_init, MLPPReg::RegularizationType reg, real_t lambda, real_t alpha) {
+	Size3i size = input_size;
+
+	if (size == Size3i()) {
+		size = _get_image_layer_output_size();
+	}
+
+	Ref<MLPPMatrix> input = _network.empty() ? _input_set : _network.write[_network.size() - 1]->get_a();
+
+	_network.push_back(Ref<MLPPHiddenLayer>(memnew(MLPPConvLayer(size, filter_count, filter_size, stride, padding, activation, input, weight_init, reg, lambda, alpha))));
+	_network.write[_network.size() - 1]->forward_pass();
+}
+
+void MLPPMANN::add_pool_layer(const Size3i &input_size, int pool_size, int stride, MLPPConvolutions::PoolType pool_type) {
+	Size3i size = input_size;
+
+	if (size == Size3i()) {
+		size = _get_image_layer_output_size();
+	}
+
+	Ref<MLPPMatrix> input = _network.empty() ? _input_set : _network.write[_network.size() - 1]->get_a();
+
+	_network.push_back(Ref<MLPPHiddenLayer>(memnew(MLPPPoolLayer(size, pool_size, stride, pool_type, input))));
+	_network.write[_network.size() - 1]->forward_pass();
+}
+
 void MLPPMANN::add_output_layer(MLPPActivation::ActivationFunction activation, MLPPCost::CostTypes loss, MLPPUtilities::WeightDistributionType weight_init, MLPPReg::RegularizationType reg, real_t lambda, real_t alpha) {
 	if (!_network.empty()) {
 		_output_layer = Ref<MLPPMultiOutputLayer>(memnew(MLPPMultiOutputLayer(_n_output, _network.write[_network.size() - 1]->get_n_hidden(), activation, loss, _network.write[_network.size() - 1]->get_a(), weight_init, reg, lambda, alpha)));
@@ -261,10 +359,24 @@ MLPPMANN::MLPPMANN(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPMatrix> &p_
 	_k = _input_set->size().x;
 	_n_output = _output_set->size().x;
 
+	_data_parallel_thread_count = 1;
+	_checkpoint_interval = 1;
+
+	_arena.instance();
+
 	_initialized = true;
 }
 
 MLPPMANN::MLPPMANN() {
+	_n = 0;
+	_k = 0;
+	_n_output = 0;
+
+	_data_parallel_thread_count = 1;
+	_checkpoint_interval = 1;
+
+	_arena.instance();
+
 	_initialized = false;
 }
 
@@ -288,6 +400,231 @@ real_t MLPPMANN::cost(const Ref<MLPPMatrix> &y_hat, const Ref<MLPPMatrix> &y) {
 	return mlpp_cost.run_cost_norm_matrix(_output_layer->get_cost(), y_hat, y) + total_reg_term + regularization.reg_termm(_output_layer->get_weights(), _output_layer->get_lambda(), _output_layer->get_alpha(), _output_layer->get_reg());
 }
 
+// Entries 0 and 1 are the output layer's weights and bias, followed by the weights and bias of every hidden layer.
+void MLPPMANN::_update_arena() {
+	int layer_count = _network.size();
+
+	bool bound = _arena->get_entry_count() == 2 + 2 * layer_count && _arena->has_matrix(0, _output_layer->get_weights()) && _arena->has_vector(1, _output_layer->get_bias());
+
+	for (int i = 0; i < layer_count && bound; ++i) {
+		Ref<MLPPHiddenLayer> layer = _network[i];
+
+		bound = _arena->has_matrix(2 + 2 * i, layer->get_weights()) && _arena->has_vector(3 + 2 * i, layer->get_bias());
+	}
+
+	if (bound) {
+		return;
+	}
+
+	_arena->clear();
+
+	_arena->add_matrix(_output_layer->get_weights());
+	_arena->add_vector(_output_layer->get_bias());
+
+	for (int i = 0; i < layer_count; ++i) {
+		_arena->add_matrix(_network.write[i]->get_weights());
+		_arena->add_vector(_network.write[i]->get_bias());
+	}
+
+	_arena->build();
+}
+
+Vector<MLPPMANN::DataParallelShard> MLPPMANN::_create_data_parallel_shards(int p_count) {
+	Vector<DataParallelShard> shards;
+	shards.resize(p_count);
+
+	for (int i = 0; i < p_count; ++i) {
+		DataParallelShard &shard = shards.write[i];
+
+		for (int j = 0; j < _network.size(); ++j) {
+			shard.network.push_back(_network.write[j]->create_replica());
+		}
+
+		shard.output_layer = _output_layer->create_replica();
+
+		shard.input.instance();
+		shard.output.instance();
+	}
+
+	return shards;
+}
+
+void MLPPMANN::_data_parallel_gradients(Vector<DataParallelShard> &shards) {
+	int size = _arena->get_size();
+	int shard_count = shards.size();
+
+	Vector<real_t *> buffers;
+	buffers.resize(shard_count);
+
+	for (int i = 0; i < shard_count; ++i) {
+		DataParallelShard &shard = shards.write[i];
+
+		shard.gradients.resize(size);
+		buffers.write[i] = shard.gradients.ptrw();
+	}
+
+	DataParallelData data;
+	data.shards = shards.ptrw();
+	data.shard_count = shard_count;
+
+	MLPPParallel::do_work(shard_count, this, &MLPPMANN::_data_parallel_range, &data);
+
+	MLPPParallel::tree_sum(buffers.ptr(), shard_count, size);
+
+	memcpy(_arena->gradients_ptrw(), buffers[0], sizeof(real_t) * size);
+}
+
+void MLPPMANN::_data_parallel_range(int p_from, int p_to, DataParallelData *p_data) {
+	for (int i = p_from; i < p_to; ++i) {
+		int from;
+		int to;
+		MLPPParallel::range_get(_n, p_data->shard_count, i, from, to);
+
+		_shard_compute_gradients(p_data->shards[i], from, to);
+	}
+}
+
+// Same as gradient_descent()'s backpropagation, for rows [p_from, p_to) of the input set,
+// on the shard's own layers, straight into the shard's gradient buffer.
+void MLPPMANN::_shard_compute_gradients(DataParallelShard &shard, int p_from, int p_to) {
+	real_t *gradients = shard.gradients.ptrw();
+	int row_count = p_to - p_from;
+
+	if (row_count <= 0) {
+		for (int i = 0; i < shard.gradients.size(); ++i) {
+			gradients[i] = 0;
+		}
+
+		return;
+	}
+
+	shard.input->resize(Size2i(_k, row_count));
+	memcpy(shard.input->ptrw(), _input_set->ptr() + p_from * _k, sizeof(real_t) * row_count * _k);
+
+	shard.output->resize(Size2i(_n_output, row_count));
+	memcpy(shard.output->ptrw(), _output_set->ptr() + p_from * _n_output, sizeof(real_t) * row_count * _n_output);
+
+	Ref<MLPPMatrix> layer_input = shard.input;
+
+	for (int i = 0; i < shard.network.size(); ++i) {
+		Ref<MLPPHiddenLayer> layer = shard.network[i];
+
+		layer->set_input(layer_input);
+		layer->forward_pass();
+
+		layer_input = layer->get_a();
+	}
+
+	Ref<MLPPMultiOutputLayer> output_layer = shard.output_layer;
+
+	output_layer->set_input(layer_input);
+	output_layer->forward_pass();
+
+	MLPPCost mlpp_cost;
+	MLPPActivation avn;
+
+	if (output_layer->get_activation() == MLPPActivation::ACTIVATION_FUNCTION_SOFTMAX) {
+		output_layer->set_delta(output_layer->get_a()->subn(shard.output));
+	} else {
+		Ref<MLPPMatrix> r1 = mlpp_cost.run_cost_deriv_matrix(output_layer->get_cost(), output_layer->get_a(), shard.output);
+		Ref<MLPPMatrix> r2 = avn.run_activation_deriv_matrix(output_layer->get_activation(), output_layer->get_z());
+
+		output_layer->set_delta(r1->hadamard_productn(r2));
+	}
+
+	Ref<MLPPMatrix> output_w_grad = output_layer->get_input()->transposen()->multn(output_layer->get_delta());
+	Ref<MLPPVector> output_b_grad = output_layer->bias_gradient();
+
+	memcpy(gradients + _arena->get_entry_offset(0), output_w_grad->ptr(), sizeof(real_t) * output_w_grad->data_size());
+	memcpy(gradients + _arena->get_entry_offset(1), output_b_grad->ptr(), sizeof(real_t) * output_b_grad->size());
+
+	int layer_count = shard.network.size();
+
+	for (int i = layer_count - 1; i >= 0; i--) {
+		Ref<MLPPHiddenLayer> layer = shard.network[i];
+
+		Ref<MLPPMatrix> next_gradient;
+
+		if (i == layer_count - 1) {
+			next_gradient = output_layer->get_delta()->multn(output_layer->get_weights()->transposen());
+		} else {
+			next_gradient = shard.network.write[i + 1]->input_gradient();
+		}
+
+		layer->set_delta(next_gradient->hadamard_productn(avn.run_activation_deriv_matrix(layer->get_activation(), layer->get_z())));
+
+		Ref<MLPPMatrix> w_grad = layer->weight_gradient();
+		Ref<MLPPVector> b_grad = layer->bias_gradient();
+
+		memcpy(gradients + _arena->get_entry_offset(2 + 2 * i), w_grad->ptr(), sizeof(real_t) * w_grad->data_size());
+		memcpy(gradients + _arena->get_entry_offset(3 + 2 * i), b_grad->ptr(), sizeof(real_t) * b_grad->size());
+	}
+}
+
+// Same as in MLPPANN.
+bool MLPPMANN::_checkpoint_is_image_layer(int p_index) {
+	Ref<MLPPHiddenLayer> layer = _network[p_index];
+
+	return Ref<MLPPConvLayer>(layer).is_valid() || Ref<MLPPPoolLayer>(layer).is_valid();
+}
+
+bool MLPPMANN::_checkpoint_is_live(int p_index) {
+	return _checkpoint_is_image_layer(p_index) || _network.write[p_index]->has_activations();
+}
+
+void MLPPMANN::_checkpoint_release(int p_index, bool p_backward_done) {
+	if (_checkpoint_interval <= 1 || _checkpoint_is_image_layer(p_index)) {
+		return;
+	}
+
+	bool checkpoint = p_index == _network.size() - 1 || (p_index + 1) % _checkpoint_interval == 0;
+
+	if (p_backward_done || !checkpoint) {
+		_network.write[p_index]->release_activations();
+	}
+}
+
+void MLPPMANN::_checkpoint_restore(int p_index) {
+	if (_checkpoint_interval <= 1) {
+		return;
+	}
+
+	if (_checkpoint_is_live(p_index) && (p_index == 0 || _checkpoint_is_live(p_index - 1))) {
+		return;
+	}
+
+	int from = p_index;
+	while (from > 0 && !_checkpoint_is_live(from - 1)) {
+		--from;
+	}
+
+	for (int i = from; i <= p_index; ++i) {
+		Ref<MLPPHiddenLayer> layer = _network[i];
+
+		if (i > 0) {
+			layer->set_input(_network.write[i - 1]->get_a());
+		}
+
+		layer->forward_pass();
+	}
+}
+
+Size3i MLPPMANN::_get_image_layer_output_size() {
+	ERR_FAIL_COND_V_MSG(_network.empty(), Size3i(), "input_size has to be set for the first layer!");
+
+	Ref<MLPPConvLayer> conv_layer = _network[_network.size() - 1];
+
+	if (conv_layer.is_valid()) {
+		return conv_layer->get_output_size();
+	}
+
+	Ref<MLPPPoolLayer> pool_layer = _network[_network.size() - 1];
+
+	ERR_FAIL_COND_V_MSG(!pool_layer.is_valid(), Size3i(), "input_size has to be set after a fully connected layer!");
+
+	return pool_layer->get_output_size();
+}
+
 void MLPPMANN::forward_pass() {
 	if (!_network.empty()) {
 		Ref<MLPPHiddenLayer> layer = _network[0];
@@ -301,6 +638,8 @@ void MLPPMANN::forward_pass() {
 
 			layer->set_input(prev_layer->get_a());
 			layer->forward_pass();
+
+			_checkpoint_release(i - 1, false);
 		}
 
 		_output_layer->set_input(_network.write[_network.size() - 1]->get_a());
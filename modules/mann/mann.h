@@ -39,12 +39,16 @@
 #include "core/object/reference.h"
 #endif
 
+#include "../core/inference_model.h"
+#include "../core/parameter_arena.h"
 #include "../core/reg.h"
 
 #include "../core/mlpp_matrix.h"
 #include "../core/mlpp_vector.h"
 
+#include "../conv_layer/conv_layer.h"
 #include "../hidden_layer/hidden_layer.h"
+#include "../pool_layer/pool_layer.h"
 #include "../multi_output_layer/multi_output_layer.h"
 
 class MLPPMANN : public Reference {
@@ -62,12 +66,32 @@ public:
 	Ref<MLPPMatrix> model_set_test(const Ref<MLPPMatrix> &X);
 	Ref<MLPPVector> model_test(const Ref<MLPPVector> &x);
 
+	// See MLPPANN::create_inference_model().
+	Ref<MLPPInferenceModel> create_inference_model();
+
 	void gradient_descent(real_t learning_rate, int max_epoch, bool ui = false);
+
+	// Shards the batch of gradient_descent() over this many threads, see MLPPANN::set_data_parallel_thread_count().
+	// 1 (the default) trains on the calling thread.
+	int get_data_parallel_thread_count() const;
+	void set_data_parallel_thread_count(const int val);
+
+	// Gradient checkpointing for gradient_descent(), see MLPPANN::set_checkpoint_interval(). 1 (the default) keeps
+	// every layer's activations.
+	int get_checkpoint_interval() const;
+	void set_checkpoint_interval(const int val);
+
+	// The weights and biases of every layer. The layers view the arena, so changing it changes the network.
+	Ref<MLPPParameterArena> get_parameter_arena();
+
 	real_t score();
 
 	void save(const String &file_name);
 
 	void add_layer(int n_hidden, MLPPActivation::ActivationFunction activation, MLPPUtilities::WeightDistributionType weight_init = MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::RegularizationType reg = MLPPReg::REGULARIZATION_TYPE_NONE, real_t lambda = 0.5, real_t alpha = 0.5);
+	// input_size can be left as Size3i() after a conv or pool layer, it's taken from that layer's output size then.
+	void add_conv_layer(const Size3i &input_size, int filter_count, int filter_size, int stride, int padding, MLPPActivation::ActivationFunction activation, MLPPUtilities::WeightDistributionType weight_init = MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::RegularizationType reg = MLPPReg::REGULARIZATION_TYPE_NONE, real_t lambda = 0.5, real_t alpha = 0.5);
+	void add_pool_layer(const Size3i &input_size, int pool_size, int stride, MLPPConvolutions::PoolType pool_type);
 	void add_output_layer(MLPPActivation::ActivationFunction activation, MLPPCost::CostTypes loss, MLPPUtilities::WeightDistributionType weight_init = MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::RegularizationType reg = MLPPReg::REGULARIZATION_TYPE_NONE, real_t lambda = 0.5, real_t alpha = 0.5);
 
 	bool is_initialized();
@@ -82,6 +106,35 @@ private:
 	real_t cost(const Ref<MLPPMatrix> &y_hat, const Ref<MLPPMatrix> &y);
 
 	void forward_pass();
+	Size3i _get_image_layer_output_size();
+	void _update_arena();
+
+	bool _checkpoint_is_image_layer(int p_index);
+	bool _checkpoint_is_live(int p_index);
+	void _checkpoint_release(int p_index, bool p_backward_done);
+	void _checkpoint_restore(int p_index);
+
+	struct DataParallelShard {
+		Vector<Ref<MLPPHiddenLayer>> network;
+		Ref<MLPPMultiOutputLayer> output_layer;
+
+		Ref<MLPPMatrix> input;
+		Ref<MLPPMatrix> output;
+
+		// In the arena's layout.
+		Vector<real_t> gradients;
+	};
+
+	struct DataParallelData {
+		DataParallelShard *shards;
+		int shard_count;
+	};
+
+	Vector<DataParallelShard> _create_data_parallel_shards(int p_count);
+	// Sums the gradients of every shard into the arena.
+	void _data_parallel_gradients(Vector<DataParallelShard> &shards);
+	void _data_parallel_range(int p_from, int p_to, DataParallelData *p_data);
+	void _shard_compute_gradients(DataParallelShard &shard, int p_from, int p_to);
 
 	static void _bind_methods();
 
@@ -92,10 +145,15 @@ private:
 	Vector<Ref<MLPPHiddenLayer>> _network;
 	Ref<MLPPMultiOutputLayer> _output_layer;
 
+	Ref<MLPPParameterArena> _arena;
+
 	int _n;
 	int _k;
 	int _n_output;
 
+	int _data_parallel_thread_count;
+	int _checkpoint_interval;
+
 	bool _initialized;
 };
 
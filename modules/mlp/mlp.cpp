@@ -38,6 +38,7 @@
 
 #include "../core/activation.h"
 #include "../core/cost.h"
+#include "../core/mini_batch_sampler.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -106,6 +107,18 @@ real_t MLPPMLP::model_test(const Ref<MLPPVector> &x) {
 	return evaluatev(x);
 }
 
+Ref<MLPPInferenceModel> MLPPMLP::create_inference_model() {
+	ERR_FAIL_COND_V(!_initialized, Ref<MLPPInferenceModel>());
+
+	Ref<MLPPInferenceModel> model;
+	model.instance();
+
+	model->add_layer(_weights1, _bias1, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+	model->add_layer_single(_weights2, _bias2, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+
+	return model;
+}
+
 void MLPPMLP::gradient_descent(real_t learning_rate, int max_epoch, bool UI) {
 	ERR_FAIL_COND(!_initialized);
 
@@ -219,9 +232,8 @@ void MLPPMLP::sgd(real_t learning_rate, int max_epoch, bool UI) {
 		// Weight updation for layer 1
 		Ref<MLPPVector> D1_1 = _weights2->scalar_multiplyn(error);
 		Ref<MLPPVector> D1_2 = D1_1->hadamard_productn(avn.sigmoid_derivv(lz2));
-		Ref<MLPPMatrix> D1_3 = input_set_row_tmp->outer_product(D1_2);
 
-		_weights1->sub(D1_3->scalar_multiplyn(learning_rate));
+		_weights1->outer_product_add(input_set_row_tmp, D1_2, -learning_rate);
 		_weights1->set_from_mlpp_matrix(regularization.reg_weightsm(_weights1, _lambda, _alpha, _reg));
 		// Bias updation for layer 1
 
@@ -261,14 +273,15 @@ void MLPPMLP::mbgd(real_t learning_rate, int max_epoch, int mini_batch_size, boo
 	la2.instance();
 
 	// Creating the mini-batches
-	int n_mini_batch = _n / mini_batch_size;
-
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmv(_input_set, _output_set, mini_batch_size);
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input = batches.input_sets[i];
-			Ref<MLPPVector> current_output = batches.output_sets[i];
+		sampler.begin_epoch();
+
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_input = sampler.get_input();
+			Ref<MLPPVector> current_output = sampler.get_output_vector();
 
 			Ref<MLPPVector> ly_hat = evaluatem(current_input);
 			propagatem(current_input, lz2, la2);
@@ -496,6 +509,7 @@ void MLPPMLP::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("model_set_test", "X"), &MLPPMLP::model_set_test);
 	ClassDB::bind_method(D_METHOD("model_test", "x"), &MLPPMLP::model_test);
+	ClassDB::bind_method(D_METHOD("create_inference_model"), &MLPPMLP::create_inference_model);
 
 	ClassDB::bind_method(D_METHOD("gradient_descent", "learning_rate", "max_epoch", "UI"), &MLPPMLP::gradient_descent, false);
 	ClassDB::bind_method(D_METHOD("sgd", "learning_rate", "max_epoch", "UI"), &MLPPMLP::sgd, false);
@@ -42,6 +42,7 @@
 #include "core/object/reference.h"
 #endif
 
+#include "../core/inference_model.h"
 #include "../core/reg.h"
 
 #include "../core/mlpp_matrix.h"
@@ -76,6 +77,9 @@ public:
 	Ref<MLPPVector> model_set_test(const Ref<MLPPMatrix> &X);
 	real_t model_test(const Ref<MLPPVector> &x);
 
+	// An MLPPInferenceModel of the current weights.
+	Ref<MLPPInferenceModel> create_inference_model();
+
 	bool is_initialized();
 	void initialize();
 
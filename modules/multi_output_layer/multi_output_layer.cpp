@@ -158,6 +158,57 @@ void MLPPMultiOutputLayer::test(const Ref<MLPPVector> &x) {
 	_a_test = avn.run_activation_norm_vector(_activation, _z_test);
 }
 
+Ref<MLPPVector> MLPPMultiOutputLayer::bias_gradient() {
+	Size2i delta_size = _delta->size();
+
+	Ref<MLPPVector> grad;
+	grad.instance();
+	grad->resize(delta_size.x);
+	grad->fill(0);
+
+	const real_t *delta_ptr = _delta->ptr();
+	real_t *grad_ptr = grad->ptrw();
+
+	for (int i = 0; i < delta_size.y; ++i) {
+		for (int j = 0; j < delta_size.x; ++j) {
+			grad_ptr[j] += delta_ptr[i * delta_size.x + j];
+		}
+	}
+
+	return grad;
+}
+
+int MLPPMultiOutputLayer::record(Ref<MLPPAutodiffTape> p_tape, const int p_input) {
+	ERR_FAIL_COND_V(!p_tape.is_valid(), -1);
+
+	int z = p_tape->add_row(p_tape->matmul(p_input, p_tape->parameter(_weights)), p_tape->parameter_vector(_bias));
+
+	return p_tape->activation(z, _activation);
+}
+
+Ref<MLPPMultiOutputLayer> MLPPMultiOutputLayer::create_replica() {
+	Ref<MLPPMultiOutputLayer> layer;
+	layer.instance();
+
+	layer->_n_output = _n_output;
+	layer->_n_hidden = _n_hidden;
+	layer->_activation = _activation;
+	layer->_cost = _cost;
+
+	layer->_input = _input;
+
+	layer->_weights = _weights;
+	layer->_bias = _bias;
+
+	layer->_reg = _reg;
+	layer->_lambda = _lambda;
+	layer->_alpha = _alpha;
+
+	layer->_weight_init = _weight_init;
+
+	return layer;
+}
+
 MLPPMultiOutputLayer::MLPPMultiOutputLayer(int n_output, int p_n_hidden, MLPPActivation::ActivationFunction p_activation, MLPPCost::CostTypes cost, Ref<MLPPMatrix> p_input, MLPPUtilities::WeightDistributionType p_weight_init, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha) {
 	_n_output = n_output;
 	_n_hidden = p_n_hidden;
@@ -198,7 +249,7 @@ MLPPMultiOutputLayer::MLPPMultiOutputLayer() {
 	_activation = MLPPActivation::ACTIVATION_FUNCTION_LINEAR;
 
 	// Regularization Params
-	//reg = 0;
+	_reg = MLPPReg::REGULARIZATION_TYPE_NONE;
 	_lambda = 0; /* Regularization Parameter */
 	_alpha = 0; /* This is the controlling param for Elastic Net*/
 
@@ -285,4 +336,10 @@ void MLPPMultiOutputLayer::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("forward_pass"), &MLPPMultiOutputLayer::forward_pass);
 	ClassDB::bind_method(D_METHOD("test", "x"), &MLPPMultiOutputLayer::test);
+
+	ClassDB::bind_method(D_METHOD("bias_gradient"), &MLPPMultiOutputLayer::bias_gradient);
+
+	ClassDB::bind_method(D_METHOD("record", "tape", "input"), &MLPPMultiOutputLayer::record);
+
+	ClassDB::bind_method(D_METHOD("create_replica"), &MLPPMultiOutputLayer::create_replica);
 }
@@ -41,6 +41,7 @@
 #endif
 
 #include "../core/activation.h"
+#include "../core/autodiff_tape.h"
 #include "../core/cost.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
@@ -103,6 +104,15 @@ public:
 	void forward_pass();
 	void test(const Ref<MLPPVector> &x);
 
+	// The sums of the delta's columns.
+	Ref<MLPPVector> bias_gradient();
+
+	// Records a forward pass of p_input onto p_tape, like MLPPHiddenLayer::record(). Returns the node of a.
+	int record(Ref<MLPPAutodiffTape> p_tape, const int p_input);
+
+	// A layer with the same settings, that shares this layer's weights and bias, but has its own input, z, a and delta.
+	Ref<MLPPMultiOutputLayer> create_replica();
+
 	MLPPMultiOutputLayer(int n_output, int p_n_hidden, MLPPActivation::ActivationFunction p_activation, MLPPCost::CostTypes cost, Ref<MLPPMatrix> p_input, MLPPUtilities::WeightDistributionType p_weight_init, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha);
 
 	MLPPMultiOutputLayer();
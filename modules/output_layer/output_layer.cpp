@@ -159,12 +159,15 @@ void MLPPOutputLayer::initialize() {
 		return;
 	}
 
-	_weights->resize(_n_hidden);
+	// Same as MLPPHiddenLayer::initialize().
+	if (_weights->size() != _n_hidden) {
+		_weights->resize(_n_hidden);
 
-	MLPPUtilities utils;
+		MLPPUtilities utils;
 
-	utils.weight_initializationv(_weights, _weight_init);
-	_bias = utils.bias_initializationr();
+		utils.weight_initializationv(_weights, _weight_init);
+		_bias = utils.bias_initializationr();
+	}
 
 	_initialized = true;
 }
@@ -191,6 +194,28 @@ void MLPPOutputLayer::test(const Ref<MLPPVector> &x) {
 	_a_test = avn.run_activation_norm_real(_activation, _z_test);
 }
 
+Ref<MLPPOutputLayer> MLPPOutputLayer::create_replica() {
+	Ref<MLPPOutputLayer> layer;
+	layer.instance();
+
+	layer->_n_hidden = _n_hidden;
+	layer->_activation = _activation;
+	layer->_cost = _cost;
+
+	layer->_input = _input;
+
+	layer->_weights = _weights;
+	layer->_bias = _bias;
+
+	layer->_reg = _reg;
+	layer->_lambda = _lambda;
+	layer->_alpha = _alpha;
+
+	layer->_weight_init = _weight_init;
+
+	return layer;
+}
+
 MLPPOutputLayer::MLPPOutputLayer(int p_n_hidden, MLPPActivation::ActivationFunction p_activation, MLPPCost::CostTypes p_cost, Ref<MLPPMatrix> p_input, MLPPUtilities::WeightDistributionType p_weight_init, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha) {
 	_n_hidden = p_n_hidden;
 	_activation = p_activation;
@@ -231,7 +256,7 @@ MLPPOutputLayer::MLPPOutputLayer() {
 	_activation = MLPPActivation::ACTIVATION_FUNCTION_LINEAR;
 
 	// Regularization Params
-	//reg = 0;
+	_reg = MLPPReg::REGULARIZATION_TYPE_NONE;
 	_lambda = 0; /* Regularization Parameter */
 	_alpha = 0; /* This is the controlling param for Elastic Net*/
 
@@ -319,4 +344,6 @@ void MLPPOutputLayer::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("forward_pass"), &MLPPOutputLayer::forward_pass);
 	ClassDB::bind_method(D_METHOD("test", "x"), &MLPPOutputLayer::test);
+
+	ClassDB::bind_method(D_METHOD("create_replica"), &MLPPOutputLayer::create_replica);
 }
@@ -103,6 +103,10 @@ public:
 	void forward_pass();
 	void test(const Ref<MLPPVector> &x);
 
+	// A layer with the same settings, that shares this layer's weights, but has its own input, z, a and delta.
+	// The bias is a copy, as it's a scalar.
+	Ref<MLPPOutputLayer> create_replica();
+
 	MLPPOutputLayer(int p_n_hidden, MLPPActivation::ActivationFunction p_activation, MLPPCost::CostTypes p_cost, Ref<MLPPMatrix> p_input, MLPPUtilities::WeightDistributionType p_weight_init, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha);
 
 	MLPPOutputLayer();
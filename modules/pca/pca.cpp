@@ -31,6 +31,7 @@
 #include "pca.h"
 
 #include "../core/data.h"
+#include "../core/lin_alg.h"
 
 Ref<MLPPMatrix> MLPPPCA::get_input_set() {
 	return _input_set;
@@ -46,11 +47,48 @@ void MLPPPCA::set_k(const int val) {
 	_k = val;
 }
 
+MLPPPCA::SVDSolver MLPPPCA::get_svd_solver() {
+	return _svd_solver;
+}
+void MLPPPCA::set_svd_solver(const SVDSolver val) {
+	_svd_solver = val;
+}
+
+int MLPPPCA::get_oversampling() {
+	return _oversampling;
+}
+void MLPPPCA::set_oversampling(const int val) {
+	_oversampling = val;
+}
+
+int MLPPPCA::get_power_iterations() {
+	return _power_iterations;
+}
+void MLPPPCA::set_power_iterations(const int val) {
+	_power_iterations = val;
+}
+
 Ref<MLPPMatrix> MLPPPCA::principal_components() {
 	ERR_FAIL_COND_V(!_input_set.is_valid() || _k == 0, Ref<MLPPMatrix>());
 
 	MLPPData data;
 
+	if (_svd_solver == SVD_SOLVER_RANDOMIZED) {
+		// The left singular vectors of the centered data are the eigenvectors of the covariance matrix,
+		// so only the top _k of them have to be computed.
+		MLPPLinAlg alg;
+
+		_x_normalized = data.mean_centering(_input_set);
+
+		MLPPLinAlg::SVDResult svr_res = alg.randomized_svd(_x_normalized, _k, _oversampling, _power_iterations);
+		ERR_FAIL_COND_V(!svr_res.U.is_valid(), Ref<MLPPMatrix>());
+
+		_u_reduce = svr_res.U;
+		_z = _u_reduce->transposen()->multn(_x_normalized);
+
+		return _z;
+	}
+
 	MLPPMatrix::SVDResult svr_res = _input_set->cov()->svd();
 	_x_normalized = data.mean_centering(_input_set);
 
@@ -117,6 +155,10 @@ MLPPPCA::MLPPPCA(const Ref<MLPPMatrix> &p_input_set, int p_k) {
 	_k = p_k;
 	_input_set = p_input_set;
 
+	_svd_solver = SVD_SOLVER_FULL;
+	_oversampling = 10;
+	_power_iterations = 2;
+
 	_x_normalized.instance();
 	_u_reduce.instance();
 	_z.instance();
@@ -125,6 +167,10 @@ MLPPPCA::MLPPPCA(const Ref<MLPPMatrix> &p_input_set, int p_k) {
 MLPPPCA::MLPPPCA() {
 	_k = 0;
 
+	_svd_solver = SVD_SOLVER_FULL;
+	_oversampling = 10;
+	_power_iterations = 2;
+
 	_x_normalized.instance();
 	_u_reduce.instance();
 	_z.instance();
@@ -141,6 +187,21 @@ void MLPPPCA::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_k", "val"), &MLPPPCA::set_k);
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "k"), "set_k", "get_k");
 
+	ClassDB::bind_method(D_METHOD("get_svd_solver"), &MLPPPCA::get_svd_solver);
+	ClassDB::bind_method(D_METHOD("set_svd_solver", "val"), &MLPPPCA::set_svd_solver);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "svd_solver", PROPERTY_HINT_ENUM, "Full,Randomized"), "set_svd_solver", "get_svd_solver");
+
+	ClassDB::bind_method(D_METHOD("get_oversampling"), &MLPPPCA::get_oversampling);
+	ClassDB::bind_method(D_METHOD("set_oversampling", "val"), &MLPPPCA::set_oversampling);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "oversampling"), "set_oversampling", "get_oversampling");
+
+	ClassDB::bind_method(D_METHOD("get_power_iterations"), &MLPPPCA::get_power_iterations);
+	ClassDB::bind_method(D_METHOD("set_power_iterations", "val"), &MLPPPCA::set_power_iterations);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "power_iterations"), "set_power_iterations", "get_power_iterations");
+
 	ClassDB::bind_method(D_METHOD("principal_components"), &MLPPPCA::principal_components);
 	ClassDB::bind_method(D_METHOD("score"), &MLPPPCA::score);
+
+	BIND_ENUM_CONSTANT(SVD_SOLVER_FULL);
+	BIND_ENUM_CONSTANT(SVD_SOLVER_RANDOMIZED);
 }
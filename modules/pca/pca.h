@@ -46,12 +46,26 @@ class MLPPPCA : public Reference {
 	GDCLASS(MLPPPCA, Reference);
 
 public:
+	enum SVDSolver {
+		SVD_SOLVER_FULL = 0,
+		SVD_SOLVER_RANDOMIZED,
+	};
+
 	Ref<MLPPMatrix> get_input_set();
 	void set_input_set(const Ref<MLPPMatrix> &val);
 
 	int get_k();
 	void set_k(const int val);
 
+	SVDSolver get_svd_solver();
+	void set_svd_solver(const SVDSolver val);
+
+	int get_oversampling();
+	void set_oversampling(const int val);
+
+	int get_power_iterations();
+	void set_power_iterations(const int val);
+
 	Ref<MLPPMatrix> principal_components();
 	real_t score();
 
@@ -66,9 +80,15 @@ protected:
 	Ref<MLPPMatrix> _input_set;
 	int _k;
 
+	SVDSolver _svd_solver;
+	int _oversampling;
+	int _power_iterations;
+
 	Ref<MLPPMatrix> _x_normalized;
 	Ref<MLPPMatrix> _u_reduce;
 	Ref<MLPPMatrix> _z;
 };
 
+VARIANT_ENUM_CAST(MLPPPCA::SVDSolver);
+
 #endif /* PCA_hpp */
@@ -0,0 +1,303 @@
+/*************************************************************************/
+/*  pool_layer.cpp                                                       */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "pool_layer.h"
+
+Size3i MLPPPoolLayer::get_input_size() const {
+	return _input_size;
+}
+void MLPPPoolLayer::set_input_size(const Size3i &val) {
+	_input_size = val;
+	_initialized = false;
+}
+
+int MLPPPoolLayer::get_pool_size() const {
+	return _pool_size;
+}
+void MLPPPoolLayer::set_pool_size(const int val) {
+	_pool_size = val;
+	_initialized = false;
+}
+
+int MLPPPoolLayer::get_stride() const {
+	return _stride;
+}
+void MLPPPoolLayer::set_stride(const int val) {
+	_stride = val;
+	_initialized = false;
+}
+
+MLPPConvolutions::PoolType MLPPPoolLayer::get_pool_type() const {
+	return _pool_type;
+}
+void MLPPPoolLayer::set_pool_type(const MLPPConvolutions::PoolType val) {
+	_pool_type = val;
+	_initialized = false;
+}
+
+Size3i MLPPPoolLayer::get_output_size() const {
+	return _output_size;
+}
+
+void MLPPPoolLayer::initialize() {
+	if (_initialized) {
+		return;
+	}
+
+	ERR_FAIL_COND(_input_size.x <= 0 || _input_size.y <= 0 || _input_size.z <= 0);
+	ERR_FAIL_COND(_pool_size <= 0 || _stride <= 0);
+
+	_output_size = Size3i((_input_size.x - _pool_size) / _stride + 1, (_input_size.y - _pool_size) / _stride + 1, _input_size.z);
+
+	ERR_FAIL_COND(_output_size.x <= 0 || _output_size.y <= 0);
+
+	_n_hidden = _output_size.x * _output_size.y * _output_size.z;
+
+	_initialized = true;
+}
+
+void MLPPPoolLayer::forward_pass() {
+	if (!_initialized) {
+		initialize();
+	}
+
+	ERR_FAIL_COND(!_initialized);
+
+	int input_data_size = _input_size.x * _input_size.y * _input_size.z;
+
+	ERR_FAIL_COND(_input->size().x != input_data_size);
+
+	int batch_size = _input->size().y;
+
+	_z->resize(Size2i(_n_hidden, batch_size));
+
+	bool store_indices = _pool_type != MLPPConvolutions::POOL_TYPE_AVERAGE;
+
+	if (store_indices) {
+		_indices.resize(batch_size * _n_hidden);
+	} else {
+		_indices.clear();
+	}
+
+	const real_t *input_ptr = _input->ptr();
+	real_t *z_ptr = _z->ptrw();
+	int *indices_ptr = store_indices ? _indices.ptrw() : NULL;
+
+	for (int b = 0; b < batch_size; ++b) {
+		_pool_sample(input_ptr + b * input_data_size, z_ptr + b * _n_hidden, indices_ptr ? indices_ptr + b * _n_hidden : NULL);
+	}
+
+	// Linear activation
+	_a = _z;
+}
+
+void MLPPPoolLayer::test(const Ref<MLPPVector> &x) {
+	if (!_initialized) {
+		initialize();
+	}
+
+	ERR_FAIL_COND(!_initialized);
+	ERR_FAIL_COND(!x.is_valid() || x->size() != _input_size.x * _input_size.y * _input_size.z);
+
+	_z_test->resize(_n_hidden);
+
+	_pool_sample(x->ptr(), _z_test->ptrw(), NULL);
+
+	_a_test = _z_test;
+}
+
+// Min and max pooling route every delta to the input it was taken from, average pooling spreads it over the window.
+Ref<MLPPMatrix> MLPPPoolLayer::input_gradient() {
+	if (!_initialized) {
+		initialize();
+	}
+
+	ERR_FAIL_COND_V(!_initialized, Ref<MLPPMatrix>());
+	ERR_FAIL_COND_V(_delta->size() != Size2i(_n_hidden, _input->size().y), Ref<MLPPMatrix>());
+
+	int input_data_size = _input_size.x * _input_size.y * _input_size.z;
+	int batch_size = _input->size().y;
+
+	Ref<MLPPMatrix> grad;
+	grad.instance();
+	grad->resize(_input->size());
+	grad->fill(0);
+
+	const real_t *delta_ptr = _delta->ptr();
+	real_t *grad_ptr = grad->ptrw();
+
+	if (_pool_type != MLPPConvolutions::POOL_TYPE_AVERAGE) {
+		ERR_FAIL_COND_V(_indices.size() != batch_size * _n_hidden, grad);
+
+		const int *indices_ptr = _indices.ptr();
+
+		for (int b = 0; b < batch_size; ++b) {
+			for (int i = 0; i < _n_hidden; ++i) {
+				grad_ptr[b * input_data_size + indices_ptr[b * _n_hidden + i]] += delta_ptr[b * _n_hidden + i];
+			}
+		}
+
+		return grad;
+	}
+
+	const real_t inv_window_size = 1 / static_cast<real_t>(_pool_size * _pool_size);
+
+	for (int b = 0; b < batch_size; ++b) {
+		for (int c = 0; c < _output_size.z; ++c) {
+			real_t *grad_slice = grad_ptr + b * input_data_size + c * _input_size.x * _input_size.y;
+
+			for (int oy = 0; oy < _output_size.y; ++oy) {
+				for (int ox = 0; ox < _output_size.x; ++ox) {
+					real_t d = delta_ptr[b * _n_hidden + (c * _output_size.y + oy) * _output_size.x + ox] * inv_window_size;
+
+					for (int k = 0; k < _pool_size; ++k) {
+						real_t *grad_row = grad_slice + (oy * _stride + k) * _input_size.x + ox * _stride;
+
+						for (int l = 0; l < _pool_size; ++l) {
+							grad_row[l] += d;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return grad;
+}
+
+Ref<MLPPMatrix> MLPPPoolLayer::weight_gradient() {
+	Ref<MLPPMatrix> grad;
+	grad.instance();
+	return grad;
+}
+
+Ref<MLPPVector> MLPPPoolLayer::bias_gradient() {
+	Ref<MLPPVector> grad;
+	grad.instance();
+	return grad;
+}
+
+MLPPPoolLayer::MLPPPoolLayer(const Size3i &p_input_size, int p_pool_size, int p_stride, MLPPConvolutions::PoolType p_pool_type, Ref<MLPPMatrix> p_input) {
+	_input_size = p_input_size;
+	_pool_size = p_pool_size;
+	_stride = p_stride;
+	_pool_type = p_pool_type;
+
+	_input = p_input;
+
+	initialize();
+}
+
+int MLPPPoolLayer::record(Ref<MLPPAutodiffTape> p_tape, const int p_input) {
+	ERR_FAIL_V_MSG(-1, "MLPPPoolLayer doesn't support MLPPAutodiffTape recording.");
+}
+
+Ref<MLPPHiddenLayer> MLPPPoolLayer::create_replica() {
+	Ref<MLPPPoolLayer> layer;
+	layer.instance();
+
+	_replica_setup(layer.ptr());
+
+	layer->_input_size = _input_size;
+	layer->_pool_size = _pool_size;
+	layer->_stride = _stride;
+	layer->_pool_type = _pool_type;
+
+	return layer;
+}
+
+MLPPPoolLayer::MLPPPoolLayer() {
+	_pool_size = 2;
+	_stride = 2;
+	_pool_type = MLPPConvolutions::POOL_TYPE_MAX;
+}
+MLPPPoolLayer::~MLPPPoolLayer() {
+}
+
+void MLPPPoolLayer::_pool_sample(const real_t *p_input, real_t *r_output, int *r_indices) const {
+	const int slice_size = _input_size.x * _input_size.y;
+	const real_t inv_window_size = 1 / static_cast<real_t>(_pool_size * _pool_size);
+
+	int o = 0;
+
+	for (int c = 0; c < _output_size.z; ++c) {
+		for (int oy = 0; oy < _output_size.y; ++oy) {
+			for (int ox = 0; ox < _output_size.x; ++ox) {
+				int first = c * slice_size + oy * _stride * _input_size.x + ox * _stride;
+
+				real_t result = _pool_type == MLPPConvolutions::POOL_TYPE_AVERAGE ? 0 : p_input[first];
+				int result_index = first;
+
+				for (int k = 0; k < _pool_size; ++k) {
+					int row = first + k * _input_size.x;
+
+					for (int l = 0; l < _pool_size; ++l) {
+						real_t val = p_input[row + l];
+
+						if (_pool_type == MLPPConvolutions::POOL_TYPE_AVERAGE) {
+							result += val;
+						} else if ((_pool_type == MLPPConvolutions::POOL_TYPE_MAX && val > result) || (_pool_type == MLPPConvolutions::POOL_TYPE_MIN && val < result)) {
+							result = val;
+							result_index = row + l;
+						}
+					}
+				}
+
+				if (_pool_type == MLPPConvolutions::POOL_TYPE_AVERAGE) {
+					result *= inv_window_size;
+				} else if (r_indices) {
+					r_indices[o] = result_index;
+				}
+
+				r_output[o++] = result;
+			}
+		}
+	}
+}
+
+void MLPPPoolLayer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_input_size"), &MLPPPoolLayer::get_input_size);
+	ClassDB::bind_method(D_METHOD("set_input_size", "val"), &MLPPPoolLayer::set_input_size);
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR3I, "input_size"), "set_input_size", "get_input_size");
+
+	ClassDB::bind_method(D_METHOD("get_pool_size"), &MLPPPoolLayer::get_pool_size);
+	ClassDB::bind_method(D_METHOD("set_pool_size", "val"), &MLPPPoolLayer::set_pool_size);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "pool_size"), "set_pool_size", "get_pool_size");
+
+	ClassDB::bind_method(D_METHOD("get_stride"), &MLPPPoolLayer::get_stride);
+	ClassDB::bind_method(D_METHOD("set_stride", "val"), &MLPPPoolLayer::set_stride);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "stride"), "set_stride", "get_stride");
+
+	ClassDB::bind_method(D_METHOD("get_pool_type"), &MLPPPoolLayer::get_pool_type);
+	ClassDB::bind_method(D_METHOD("set_pool_type", "val"), &MLPPPoolLayer::set_pool_type);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "pool_type"), "set_pool_type", "get_pool_type");
+
+	ClassDB::bind_method(D_METHOD("get_output_size"), &MLPPPoolLayer::get_output_size);
+}
@@ -0,0 +1,106 @@
+#ifndef MLPP_POOL_LAYER_H
+#define MLPP_POOL_LAYER_H
+
+/*************************************************************************/
+/*  pool_layer.h                                                         */
+/*************************************************************************/
+/*                         This file is part of:                         */
+/*                    PMLPP Machine Learning Library                     */
+/*                   https://github.com/Relintai/pmlpp                   */
+/*************************************************************************/
+/* Copyright (c) 2023-present Péter Magyar.                              */
+/* Copyright (c) 2022-2023 Marc Melikyan                                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifdef USING_SFW
+#include "sfw.h"
+#else
+#include "core/math/math_defs.h"
+
+#include "core/object/reference.h"
+#endif
+
+#include "../hidden_layer/hidden_layer.h"
+
+#include "../core/convolutions.h"
+#include "../core/mlpp_matrix.h"
+#include "../core/mlpp_vector.h"
+
+// A pooling layer for the MLPPHiddenLayer stacks of MLPPANN and MLPPMANN, the images are flattened the same way as for MLPPConvLayer.
+// pool_size x pool_size windows with stride, every channel on its own. It has no parameters, weights and bias are empty,
+// and the activation is linear.
+class MLPPPoolLayer : public MLPPHiddenLayer {
+	GDCLASS(MLPPPoolLayer, MLPPHiddenLayer);
+
+public:
+	// x: width, y: height, z: channels
+	Size3i get_input_size() const;
+	void set_input_size(const Size3i &val);
+
+	int get_pool_size() const;
+	void set_pool_size(const int val);
+
+	int get_stride() const;
+	void set_stride(const int val);
+
+	MLPPConvolutions::PoolType get_pool_type() const;
+	void set_pool_type(const MLPPConvolutions::PoolType val);
+
+	Size3i get_output_size() const;
+
+	void initialize();
+
+	void forward_pass();
+	void test(const Ref<MLPPVector> &x);
+
+	Ref<MLPPMatrix> input_gradient();
+	Ref<MLPPMatrix> weight_gradient();
+	Ref<MLPPVector> bias_gradient();
+
+	// MLPPAutodiffTape has no convolution or pooling operations, so this layer can't be recorded.
+	int record(Ref<MLPPAutodiffTape> p_tape, const int p_input);
+
+	Ref<MLPPHiddenLayer> create_replica();
+
+	MLPPPoolLayer(const Size3i &p_input_size, int p_pool_size, int p_stride, MLPPConvolutions::PoolType p_pool_type, Ref<MLPPMatrix> p_input);
+
+	MLPPPoolLayer();
+	~MLPPPoolLayer();
+
+protected:
+	// Pools one sample. For min and max pooling, r_indices gets the input index of every output (for the backward pass).
+	void _pool_sample(const real_t *p_input, real_t *r_output, int *r_indices) const;
+
+	static void _bind_methods();
+
+	Size3i _input_size;
+	int _pool_size;
+	int _stride;
+	MLPPConvolutions::PoolType _pool_type;
+
+	Size3i _output_size;
+
+	// batch_size x n_hidden, the input index every output was taken from, min and max pooling only.
+	Vector<int> _indices;
+};
+
+#endif
@@ -32,6 +32,8 @@
 
 #include "../core/activation.h"
 #include "../core/cost.h"
+#include "../core/hogwild_sgd.h"
+#include "../core/mini_batch_sampler.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -112,6 +114,15 @@ void MLPPProbitReg::data_bias_set(const real_t val) {
 	_bias = val;
 }
 
+int MLPPProbitReg::get_hogwild_thread_count() const {
+	return _hogwild_thread_count;
+}
+void MLPPProbitReg::set_hogwild_thread_count(const int val) {
+	ERR_FAIL_COND(val < 1);
+
+	_hogwild_thread_count = val;
+}
+
 Ref<MLPPVector> MLPPProbitReg::model_set_test(const Ref<MLPPMatrix> &X) {
 	ERR_FAIL_COND_V(needs_init(), Ref<MLPPVector>());
 
@@ -203,6 +214,11 @@ void MLPPProbitReg::train_mle(real_t learning_rate, int max_epoch, bool ui) {
 void MLPPProbitReg::train_sgd(real_t learning_rate, int max_epoch, bool ui) {
 	ERR_FAIL_COND(needs_init());
 
+	if (_hogwild_thread_count > 1) {
+		_hogwild_sgd(learning_rate, max_epoch, ui);
+		return;
+	}
+
 	// NOTE: ∂y_hat/∂z is sparse
 	MLPPActivation avn;
 	MLPPReg regularization;
@@ -266,6 +282,33 @@ void MLPPProbitReg::train_sgd(real_t learning_rate, int max_epoch, bool ui) {
 	forward_pass();
 }
 
+void MLPPProbitReg::_hogwild_sgd(real_t learning_rate, int max_epoch, bool ui) {
+	real_t cost_prev = 0;
+
+	if (ui) {
+		forward_pass();
+		cost_prev = cost(_y_hat, _output_set);
+	}
+
+	MLPPHogwildSGD::Settings settings;
+	settings.model_type = MLPPHogwildSGD::MODEL_TYPE_PROBIT;
+	settings.learning_rate = learning_rate;
+	settings.iteration_count = max_epoch;
+	settings.worker_count = _hogwild_thread_count;
+	settings.reg = _reg;
+	settings.lambda = _lambda;
+	settings.alpha = _alpha;
+
+	MLPPHogwildSGD::train(_input_set, _output_set, _weights, &_bias, settings);
+
+	forward_pass();
+
+	if (ui) {
+		MLPPUtilities::cost_info(max_epoch, cost_prev, cost(_y_hat, _output_set));
+		MLPPUtilities::print_ui_vb(_weights, _bias);
+	}
+}
+
 void MLPPProbitReg::train_mbgd(real_t learning_rate, int max_epoch, int mini_batch_size, bool ui) {
 	ERR_FAIL_COND(needs_init());
 
@@ -273,39 +316,33 @@ void MLPPProbitReg::train_mbgd(real_t learning_rate, int max_epoch, int mini_bat
 	MLPPReg regularization;
 	real_t cost_prev = 0;
 	int epoch = 1;
-	int n = _input_set->size().y;
-
-	Ref<MLPPVector> z_tmp;
-	z_tmp.instance();
-	z_tmp->resize(1);
 
 	// Creating the mini-batches
-	int n_mini_batch = n / mini_batch_size;
-
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmv(_input_set, _output_set, mini_batch_size);
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input = batches.input_sets[i];
-			Ref<MLPPVector> current_output = batches.output_sets[i];
+		sampler.begin_epoch();
 
-			Ref<MLPPVector> y_hat = evaluatem(current_input);
-			real_t z = propagatev(current_output);
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_input = sampler.get_input();
+			Ref<MLPPVector> current_output = sampler.get_output_vector();
 
-			z_tmp->element_set(0, z);
+			Ref<MLPPVector> y_hat = evaluatem(current_input);
+			Ref<MLPPVector> z = propagatem(current_input);
 
 			cost_prev = cost(y_hat, current_output);
 
 			Ref<MLPPVector> error = y_hat->subn(current_output);
 
 			// Calculating the weight gradients
-			_weights->sub(current_input->transposen()->mult_vec(error->hadamard_productn(avn.gaussian_cdf_derivv(z_tmp)))->scalar_multiplyn(learning_rate / batches.input_sets.size()));
+			_weights->sub(current_input->transposen()->mult_vec(error->hadamard_productn(avn.gaussian_cdf_derivv(z)))->scalar_multiplyn(learning_rate / current_output->size()));
 			_weights = regularization.reg_weightsv(_weights, _lambda, _alpha, _reg);
 
 			// Calculating the bias gradients
 
-			_bias -= learning_rate * error->hadamard_productn(avn.gaussian_cdf_derivv(z_tmp))->sum_elements() / batches.input_sets.size();
-			y_hat = evaluatev(current_input);
+			_bias -= learning_rate * error->hadamard_productn(avn.gaussian_cdf_derivv(z))->sum_elements() / current_output->size();
+			y_hat = evaluatem(current_input);
 
 			if (ui) {
 				MLPPUtilities::cost_info(epoch, cost_prev, cost(y_hat, current_output));
@@ -370,6 +407,7 @@ void MLPPProbitReg::initialize() {
 }
 
 MLPPProbitReg::MLPPProbitReg(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_set, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha) {
+	_hogwild_thread_count = 1;
 	_input_set = p_input_set;
 	_output_set = p_output_set;
 
@@ -386,6 +424,7 @@ MLPPProbitReg::MLPPProbitReg(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPV
 }
 
 MLPPProbitReg::MLPPProbitReg() {
+	_hogwild_thread_count = 1;
 	// Regularization Params
 	_reg = MLPPReg::REGULARIZATION_TYPE_NONE;
 	_lambda = 0.5;
@@ -455,6 +494,10 @@ void MLPPProbitReg::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_alpha", "val"), &MLPPProbitReg::set_alpha);
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "alpha"), "set_alpha", "get_alpha");
 
+	ClassDB::bind_method(D_METHOD("get_hogwild_thread_count"), &MLPPProbitReg::get_hogwild_thread_count);
+	ClassDB::bind_method(D_METHOD("set_hogwild_thread_count", "val"), &MLPPProbitReg::set_hogwild_thread_count);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "hogwild_thread_count"), "set_hogwild_thread_count", "get_hogwild_thread_count");
+
 	ADD_GROUP("Data", "data");
 	ClassDB::bind_method(D_METHOD("data_z_get"), &MLPPProbitReg::data_z_get);
 	ClassDB::bind_method(D_METHOD("data_z_set", "val"), &MLPPProbitReg::set_output_set);
@@ -33,6 +33,7 @@
 #include "../core/activation.h"
 #include "../core/cost.h"
 #include "../core/data.h"
+#include "../core/mini_batch_sampler.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -142,6 +143,18 @@ Ref<MLPPVector> MLPPSoftmaxNet::model_test(const Ref<MLPPVector> &x) {
 	return evaluatev(x);
 }
 
+Ref<MLPPInferenceModel> MLPPSoftmaxNet::create_inference_model() {
+	ERR_FAIL_COND_V(needs_init(), Ref<MLPPInferenceModel>());
+
+	Ref<MLPPInferenceModel> model;
+	model.instance();
+
+	model->add_layer(_weights1, _bias1, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+	model->add_layer(_weights2, _bias2, MLPPActivation::ACTIVATION_FUNCTION_ADJ_SOFTMAX);
+
+	return model;
+}
+
 Ref<MLPPMatrix> MLPPSoftmaxNet::model_set_test(const Ref<MLPPMatrix> &X) {
 	ERR_FAIL_COND_V(!_input_set.is_valid() || !_output_set.is_valid(), Ref<MLPPVector>());
 	ERR_FAIL_COND_V(needs_init(), Ref<MLPPVector>());
@@ -256,9 +269,8 @@ void MLPPSoftmaxNet::train_sgd(real_t learning_rate, int max_epoch, bool ui) {
 
 		// Weight updation for layer 2
 
-		Ref<MLPPMatrix> D2_1 = error->outer_product(prop_res.a2);
-
-		_weights2->sub(D2_1->transposen()->scalar_multiplyn(learning_rate));
+		// W2 -= lr * a2 * errorT
+		_weights2->outer_product_add(prop_res.a2, error, -learning_rate);
 		_weights2 = regularization.reg_weightsm(_weights2, _lambda, _alpha, _reg);
 
 		// Bias updation for layer 2
@@ -267,9 +279,8 @@ void MLPPSoftmaxNet::train_sgd(real_t learning_rate, int max_epoch, bool ui) {
 		// Weight updation for layer 1
 		Ref<MLPPVector> D1_1 = _weights2->mult_vec(error);
 		Ref<MLPPVector> D1_2 = D1_1->hadamard_productn(avn.sigmoid_derivv(prop_res.z2));
-		Ref<MLPPMatrix> D1_3 = input_set_row_tmp->outer_product(D1_2);
 
-		_weights1->sub(D1_3->scalar_multiplyn(learning_rate));
+		_weights1->outer_product_add(input_set_row_tmp, D1_2, -learning_rate);
 		_weights1 = regularization.reg_weightsm(_weights1, _lambda, _alpha, _reg);
 		// Bias updation for layer 1
 
@@ -304,17 +315,16 @@ void MLPPSoftmaxNet::train_mbgd(real_t learning_rate, int max_epoch, int mini_ba
 	real_t cost_prev = 0;
 	int epoch = 1;
 
-	int n = _input_set->size().y;
-
 	// Creating the mini-batches
-	int n_mini_batch = n / mini_batch_size;
-
-	MLPPUtilities::CreateMiniBatchMMBatch batches = MLPPUtilities::create_mini_batchesmm(_input_set, _output_set, n_mini_batch);
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmm(_input_set, _output_set, mini_batch_size);
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_mini_batch = batches.input_sets[i];
-			Ref<MLPPMatrix> current_output_mini_batch = batches.output_sets[i];
+		sampler.begin_epoch();
+
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_input_mini_batch = sampler.get_input();
+			Ref<MLPPMatrix> current_output_mini_batch = sampler.get_output_matrix();
 
 			Ref<MLPPMatrix> y_hat = evaluatem(current_input_mini_batch);
 
@@ -591,6 +601,7 @@ void MLPPSoftmaxNet::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "data_a2", PROPERTY_HINT_RESOURCE_TYPE, "MLPPMatrix"), "data_a2_set", "data_a2_get");
 
 	ClassDB::bind_method(D_METHOD("model_test", "x"), &MLPPSoftmaxNet::model_test);
+	ClassDB::bind_method(D_METHOD("create_inference_model"), &MLPPSoftmaxNet::create_inference_model);
 	ClassDB::bind_method(D_METHOD("model_set_test", "X"), &MLPPSoftmaxNet::model_set_test);
 
 	ClassDB::bind_method(D_METHOD("train_gradient_descent", "learning_rate", "max_epoch", "ui"), &MLPPSoftmaxNet::train_gradient_descent, false);
@@ -39,6 +39,7 @@
 #include "core/object/resource.h"
 #endif
 
+#include "../core/inference_model.h"
 #include "../core/mlpp_matrix.h"
 #include "../core/mlpp_vector.h"
 
@@ -90,6 +91,9 @@ public:
 	Ref<MLPPVector> model_test(const Ref<MLPPVector> &x);
 	Ref<MLPPMatrix> model_set_test(const Ref<MLPPMatrix> &X);
 
+	// An MLPPInferenceModel of the current weights.
+	Ref<MLPPInferenceModel> create_inference_model();
+
 	void train_gradient_descent(real_t learning_rate, int max_epoch, bool ui = false);
 	void train_sgd(real_t learning_rate, int max_epoch, bool ui = false);
 	void train_mbgd(real_t learning_rate, int max_epoch, int mini_batch_size, bool ui = false);
@@ -32,6 +32,7 @@
 
 #include "../core/activation.h"
 #include "../core/cost.h"
+#include "../core/mini_batch_sampler.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -195,16 +196,13 @@ void MLPPSoftmaxReg::train_sgd(real_t learning_rate, int max_epoch, bool ui) {
 
 		cost_prev = cost(y_hat_matrix_tmp, output_set_row_matrix_tmp);
 
-		// Calculating the weight gradients
-		Ref<MLPPMatrix> w_gradient = input_set_row_tmp->outer_product(y_hat->subn(output_set_row_tmp));
+		// Calculating the bias gradients (the weight gradient is input_set_row_tmp * b_gradientT)
+		Ref<MLPPVector> b_gradient = y_hat->subn(output_set_row_tmp);
 
 		// Weight Updation
-		_weights->sub(w_gradient->scalar_multiplyn(learning_rate));
+		_weights->outer_product_add(input_set_row_tmp, b_gradient, -learning_rate);
 		_weights = regularization.reg_weightsm(_weights, _lambda, _alpha, _reg);
 
-		// Calculating the bias gradients
-		Ref<MLPPVector> b_gradient = y_hat->subn(output_set_row_tmp);
-
 		// Bias updation
 		_bias->sub(b_gradient->scalar_multiplyn(learning_rate));
 
@@ -232,16 +230,17 @@ void MLPPSoftmaxReg::train_mbgd(real_t learning_rate, int max_epoch, int mini_ba
 	MLPPReg regularization;
 	real_t cost_prev = 0;
 	int epoch = 1;
-	int n = _input_set->size().y;
 
 	// Creating the mini-batches
-	int n_mini_batch = n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMMBatch batches = MLPPUtilities::create_mini_batchesmm(_input_set, _output_set, n_mini_batch);
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmm(_input_set, _output_set, mini_batch_size);
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_inputs = batches.input_sets[i];
-			Ref<MLPPMatrix> current_outputs = batches.output_sets[i];
+		sampler.begin_epoch();
+
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_inputs = sampler.get_input();
+			Ref<MLPPMatrix> current_outputs = sampler.get_output_matrix();
 
 			Ref<MLPPMatrix> y_hat = evaluatem(current_inputs);
 			cost_prev = cost(y_hat, current_outputs);
@@ -32,7 +32,9 @@
 
 #include "../core/activation.h"
 #include "../core/cost.h"
+#include "../core/hogwild_sgd.h"
 #include "../core/lin_alg.h"
+#include "../core/mini_batch_sampler.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -87,6 +89,15 @@ void MLPPSVC::data_bias_set(const real_t val) {
 	_bias = val;
 }
 
+int MLPPSVC::get_hogwild_thread_count() const {
+	return _hogwild_thread_count;
+}
+void MLPPSVC::set_hogwild_thread_count(const int val) {
+	ERR_FAIL_COND(val < 1);
+
+	_hogwild_thread_count = val;
+}
+
 Ref<MLPPVector> MLPPSVC::model_set_test(const Ref<MLPPMatrix> &X) {
 	ERR_FAIL_COND_V(needs_init(), Ref<MLPPVector>());
 
@@ -143,6 +154,11 @@ void MLPPSVC::train_sgd(real_t learning_rate, int max_epoch, bool ui) {
 	ERR_FAIL_COND(!_input_set.is_valid() || !_output_set.is_valid());
 	ERR_FAIL_COND(needs_init());
 
+	if (_hogwild_thread_count > 1) {
+		_hogwild_sgd(learning_rate, max_epoch, ui);
+		return;
+	}
+
 	int n = _input_set->size().y;
 
 	MLPPCost mlpp_cost;
@@ -213,6 +229,35 @@ void MLPPSVC::train_sgd(real_t learning_rate, int max_epoch, bool ui) {
 	forward_pass();
 }
 
+void MLPPSVC::_hogwild_sgd(real_t learning_rate, int max_epoch, bool ui) {
+	real_t cost_prev = 0;
+
+	if (ui) {
+		forward_pass();
+		cost_prev = cost(_z, _output_set, _weights, _c);
+	}
+
+	MLPPHogwildSGD::Settings settings;
+	settings.model_type = MLPPHogwildSGD::MODEL_TYPE_HINGE;
+	settings.learning_rate = learning_rate;
+	settings.iteration_count = max_epoch;
+	settings.worker_count = _hogwild_thread_count;
+	// Same ridge term as train_sgd().
+	settings.reg = MLPPReg::REGULARIZATION_TYPE_RIDGE;
+	settings.lambda = learning_rate;
+	settings.alpha = 0;
+	settings.c = _c;
+
+	MLPPHogwildSGD::train(_input_set, _output_set, _weights, &_bias, settings);
+
+	forward_pass();
+
+	if (ui) {
+		MLPPUtilities::cost_info(max_epoch, cost_prev, cost(_z, _output_set, _weights, _c));
+		MLPPUtilities::print_ui_vb(_weights, _bias);
+	}
+}
+
 void MLPPSVC::train_mbgd(real_t learning_rate, int max_epoch, int mini_batch_size, bool ui) {
 	ERR_FAIL_COND(!_input_set.is_valid() || !_output_set.is_valid());
 	ERR_FAIL_COND(needs_init());
@@ -227,22 +272,24 @@ void MLPPSVC::train_mbgd(real_t learning_rate, int max_epoch, int mini_batch_siz
 	int epoch = 1;
 
 	// Creating the mini-batches
-	int n_mini_batch = n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmv(_input_set, _output_set, mini_batch_size);
 
 	forward_pass();
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch_entry = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch_entry = batches.output_sets[i];
+		sampler.begin_epoch();
+
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_input_batch_entry = sampler.get_input();
+			Ref<MLPPVector> current_output_batch_entry = sampler.get_output_vector();
 
 			Ref<MLPPVector> y_hat = evaluatem(current_input_batch_entry);
 			Ref<MLPPVector> z = propagatem(current_input_batch_entry);
 			cost_prev = cost(z, current_output_batch_entry, _weights, _c);
 
 			// Calculating the weight gradients
-			_weights->subn(current_input_batch_entry->transposen()->mult_vec(mlpp_cost.hinge_loss_derivwv(z, current_output_batch_entry, _c))->scalar_multiplyn(learning_rate / n));
+			_weights->sub(current_input_batch_entry->transposen()->mult_vec(mlpp_cost.hinge_loss_derivwv(z, current_output_batch_entry, _c))->scalar_multiplyn(learning_rate / n));
 			_weights = regularization.reg_weightsv(_weights, learning_rate / n, 0, MLPPReg::REGULARIZATION_TYPE_RIDGE);
 
 			// Calculating the bias gradients
@@ -314,6 +361,7 @@ void MLPPSVC::initialize() {
 }
 
 MLPPSVC::MLPPSVC(const Ref<MLPPMatrix> &input_set, const Ref<MLPPVector> &output_set, real_t c) {
+	_hogwild_thread_count = 1;
 	_input_set = input_set;
 	_output_set = output_set;
 	_c = c;
@@ -327,6 +375,7 @@ MLPPSVC::MLPPSVC(const Ref<MLPPMatrix> &input_set, const Ref<MLPPVector> &output
 }
 
 MLPPSVC::MLPPSVC() {
+	_hogwild_thread_count = 1;
 	_c = 0;
 
 	_z.instance();
@@ -384,6 +433,10 @@ void MLPPSVC::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_c", "val"), &MLPPSVC::set_c);
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "c"), "set_c", "get_c");
 
+	ClassDB::bind_method(D_METHOD("get_hogwild_thread_count"), &MLPPSVC::get_hogwild_thread_count);
+	ClassDB::bind_method(D_METHOD("set_hogwild_thread_count", "val"), &MLPPSVC::set_hogwild_thread_count);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "hogwild_thread_count"), "set_hogwild_thread_count", "get_hogwild_thread_count");
+
 	ClassDB::bind_method(D_METHOD("data_z_get"), &MLPPSVC::data_z_get);
 	ClassDB::bind_method(D_METHOD("data_z_set", "val"), &MLPPSVC::set_output_set);
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "data_z", PROPERTY_HINT_RESOURCE_TYPE, "MLPPVector"), "data_z_set", "data_z_get");
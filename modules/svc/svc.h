@@ -72,6 +72,10 @@ public:
 	real_t data_bias_get() const;
 	void data_bias_set(const real_t val);
 
+	// 1 (the default) keeps the single threaded train_sgd(), above 1 it trains with MLPPHogwildSGD.
+	int get_hogwild_thread_count() const;
+	void set_hogwild_thread_count(const int val);
+
 	Ref<MLPPVector> model_set_test(const Ref<MLPPMatrix> &X);
 	real_t model_test(const Ref<MLPPVector> &x);
 
@@ -100,6 +104,8 @@ protected:
 
 	void forward_pass();
 
+	void _hogwild_sgd(real_t learning_rate, int max_epoch, bool ui);
+
 	static void _bind_methods();
 
 	Ref<MLPPMatrix> _input_set;
@@ -110,6 +116,8 @@ protected:
 	Ref<MLPPVector> _y_hat;
 	Ref<MLPPVector> _weights;
 	real_t _bias;
+
+	int _hogwild_thread_count;
 };
 
 #endif /* SVC_hpp */
@@ -32,6 +32,8 @@
 
 #include "../core/activation.h"
 #include "../core/cost.h"
+#include "../core/hogwild_sgd.h"
+#include "../core/mini_batch_sampler.h"
 #include "../core/reg.h"
 #include "../core/utilities.h"
 
@@ -150,6 +152,15 @@ void MLPPTanhReg::initialize() {
 	_bias = utils.bias_initializationr();
 }
 
+int MLPPTanhReg::get_hogwild_thread_count() const {
+	return _hogwild_thread_count;
+}
+void MLPPTanhReg::set_hogwild_thread_count(const int val) {
+	ERR_FAIL_COND(val < 1);
+
+	_hogwild_thread_count = val;
+}
+
 Ref<MLPPVector> MLPPTanhReg::model_set_test(const Ref<MLPPMatrix> &X) {
 	ERR_FAIL_COND_V(needs_init(), Ref<MLPPVector>());
 
@@ -207,6 +218,11 @@ void MLPPTanhReg::train_sgd(real_t learning_rate, int max_epoch, bool ui) {
 	ERR_FAIL_COND(!_input_set.is_valid() || !_output_set.is_valid());
 	ERR_FAIL_COND(needs_init());
 
+	if (_hogwild_thread_count > 1) {
+		_hogwild_sgd(learning_rate, max_epoch, ui);
+		return;
+	}
+
 	int n = _input_set->size().y;
 
 	MLPPReg regularization;
@@ -245,7 +261,7 @@ void MLPPTanhReg::train_sgd(real_t learning_rate, int max_epoch, bool ui) {
 		real_t error = y_hat - output_set_entry;
 
 		// Weight Updation
-		_weights->subn(input_set_row_tmp->scalar_multiplyn(learning_rate * error * (1 - y_hat * y_hat)));
+		_weights->sub(input_set_row_tmp->scalar_multiplyn(learning_rate * error * (1 - y_hat * y_hat)));
 		_weights = regularization.reg_weightsv(_weights, _lambda, _alpha, _reg);
 
 		// Bias updation
@@ -268,6 +284,33 @@ void MLPPTanhReg::train_sgd(real_t learning_rate, int max_epoch, bool ui) {
 	forward_pass();
 }
 
+void MLPPTanhReg::_hogwild_sgd(real_t learning_rate, int max_epoch, bool ui) {
+	real_t cost_prev = 0;
+
+	if (ui) {
+		forward_pass();
+		cost_prev = cost(_y_hat, _output_set);
+	}
+
+	MLPPHogwildSGD::Settings settings;
+	settings.model_type = MLPPHogwildSGD::MODEL_TYPE_TANH;
+	settings.learning_rate = learning_rate;
+	settings.iteration_count = max_epoch;
+	settings.worker_count = _hogwild_thread_count;
+	settings.reg = _reg;
+	settings.lambda = _lambda;
+	settings.alpha = _alpha;
+
+	MLPPHogwildSGD::train(_input_set, _output_set, _weights, &_bias, settings);
+
+	forward_pass();
+
+	if (ui) {
+		MLPPUtilities::cost_info(max_epoch, cost_prev, cost(_y_hat, _output_set));
+		MLPPUtilities::print_ui_vb(_weights, _bias);
+	}
+}
+
 void MLPPTanhReg::train_mbgd(real_t learning_rate, int max_epoch, int mini_batch_size, bool ui) {
 	ERR_FAIL_COND(!_input_set.is_valid() || !_output_set.is_valid());
 	ERR_FAIL_COND(needs_init());
@@ -281,13 +324,15 @@ void MLPPTanhReg::train_mbgd(real_t learning_rate, int max_epoch, int mini_batch
 	int epoch = 1;
 
 	// Creating the mini-batches
-	int n_mini_batch = n / mini_batch_size;
-	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(_input_set, _output_set, n_mini_batch);
+	MLPPMiniBatchSampler sampler;
+	sampler.setupmv(_input_set, _output_set, mini_batch_size);
 
 	while (true) {
-		for (int i = 0; i < n_mini_batch; i++) {
-			Ref<MLPPMatrix> current_input_batch_entry = batches.input_sets[i];
-			Ref<MLPPVector> current_output_batch_entry = batches.output_sets[i];
+		sampler.begin_epoch();
+
+		while (sampler.next()) {
+			Ref<MLPPMatrix> current_input_batch_entry = sampler.get_input();
+			Ref<MLPPVector> current_output_batch_entry = sampler.get_output_vector();
 
 			Ref<MLPPVector> y_hat = evaluatem(current_input_batch_entry);
 			Ref<MLPPVector> z = propagatem(current_input_batch_entry);
@@ -301,7 +346,7 @@ void MLPPTanhReg::train_mbgd(real_t learning_rate, int max_epoch, int mini_batch
 			_weights = regularization.reg_weightsv(_weights, _lambda, _alpha, _reg);
 
 			// Calculating the bias gradients
-			_bias -= learning_rate * error->hadamard_productn(avn.tanh_derivv(_z))->sum_elements() / n;
+			_bias -= learning_rate * error->hadamard_productn(avn.tanh_derivv(z))->sum_elements() / n;
 
 			forward_pass();
 
@@ -333,6 +378,7 @@ real_t MLPPTanhReg::score() {
 }
 
 MLPPTanhReg::MLPPTanhReg(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVector> &p_output_set, MLPPReg::RegularizationType p_reg, real_t p_lambda, real_t p_alpha) {
+	_hogwild_thread_count = 1;
 	_input_set = p_input_set;
 	_output_set = p_output_set;
 	_reg = p_reg;
@@ -349,6 +395,7 @@ MLPPTanhReg::MLPPTanhReg(const Ref<MLPPMatrix> &p_input_set, const Ref<MLPPVecto
 }
 
 MLPPTanhReg::MLPPTanhReg() {
+	_hogwild_thread_count = 1;
 	_reg = MLPPReg::REGULARIZATION_TYPE_NONE;
 	_lambda = 0;
 	_alpha = 0;
@@ -417,6 +464,10 @@ void MLPPTanhReg::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_alpha", "val"), &MLPPTanhReg::set_alpha);
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "alpha"), "set_alpha", "get_alpha");
 
+	ClassDB::bind_method(D_METHOD("get_hogwild_thread_count"), &MLPPTanhReg::get_hogwild_thread_count);
+	ClassDB::bind_method(D_METHOD("set_hogwild_thread_count", "val"), &MLPPTanhReg::set_hogwild_thread_count);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "hogwild_thread_count"), "set_hogwild_thread_count", "get_hogwild_thread_count");
+
 	ADD_GROUP("Data", "data");
 	ClassDB::bind_method(D_METHOD("data_z_get"), &MLPPTanhReg::data_z_get);
 	ClassDB::bind_method(D_METHOD("data_z_set", "val"), &MLPPTanhReg::set_output_set);
@@ -78,6 +78,10 @@ public:
 	bool needs_init() const;
 	void initialize();
 
+	// 1 (the default) keeps the single threaded train_sgd(), above 1 it trains with MLPPHogwildSGD.
+	int get_hogwild_thread_count() const;
+	void set_hogwild_thread_count(const int val);
+
 	Ref<MLPPVector> model_set_test(const Ref<MLPPMatrix> &X);
 	real_t model_test(const Ref<MLPPVector> &x);
 
@@ -103,6 +107,8 @@ protected:
 
 	void forward_pass();
 
+	void _hogwild_sgd(real_t learning_rate, int max_epoch, bool ui);
+
 	static void _bind_methods();
 
 	Ref<MLPPMatrix> _input_set;
@@ -117,6 +123,8 @@ protected:
 	Ref<MLPPVector> _y_hat;
 	Ref<MLPPVector> _weights;
 	real_t _bias;
+
+	int _hogwild_thread_count;
 };
 
 #endif /* TanhReg_hpp */
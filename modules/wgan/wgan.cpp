@@ -49,6 +49,17 @@ void MLPPWGAN::set_output_set(const Ref<MLPPMatrix> &val) { _output_set = val; }
 int MLPPWGAN::get_k() const { return _k; }
 void MLPPWGAN::set_k(const int val) { _k = val; }
 
+real_t MLPPWGAN::get_clip_value() const { return _clip_value; }
+void MLPPWGAN::set_clip_value(const real_t val) { _clip_value = val; }
+
+Ref<MLPPParameterArena> MLPPWGAN::get_parameter_arena() {
+  ERR_FAIL_COND_V(!_output_layer.is_valid(), Ref<MLPPParameterArena>());
+
+  _update_arena();
+
+  return _arena;
+}
+
 Ref<MLPPMatrix> MLPPWGAN::generate_example(int n) {
   return model_set_test_generator(MLPPMatrix::create_gaussian_noise(n, _k));
 }
@@ -90,23 +101,17 @@ void MLPPWGAN::gradient_descent(real_t learning_rate, int max_epoch, bool ui) {
 
       DiscriminatorGradientResult discriminator_gradient_results =
           compute_discriminator_gradients(ly_hat, loutput_set);
-      Vector<Ref<MLPPMatrix>> cumulative_discriminator_hidden_layer_w_grad =
-          discriminator_gradient_results.cumulative_hidden_layer_w_grad;
-      Ref<MLPPVector> output_discriminator_w_grad =
-          discriminator_gradient_results.output_w_grad;
-
-      real_t lrpn = learning_rate / n;
-
-      for (int j = 0; j < cumulative_discriminator_hidden_layer_w_grad.size();
-           ++j) {
-        cumulative_discriminator_hidden_layer_w_grad.write[j]->scalar_multiply(
-            lrpn);
-      }
 
-      output_discriminator_w_grad->scalar_multiply(learning_rate / n);
       update_discriminator_parameters(
-          cumulative_discriminator_hidden_layer_w_grad,
-          output_discriminator_w_grad, learning_rate);
+          discriminator_gradient_results.cumulative_hidden_layer_w_grad,
+          discriminator_gradient_results.output_w_grad, learning_rate);
+
+      // Keeps the critic (approximately) Lipschitz, one pass over its part of
+      // the arena.
+      if (_clip_value > 0) {
+        _arena->clip_parameters(_get_discriminator_offset(),
+                                _arena->get_size(), _clip_value);
+      }
     }
 
     // Training of the generator.
@@ -117,13 +122,7 @@ void MLPPWGAN::gradient_descent(real_t learning_rate, int max_epoch, bool ui) {
     loutput_set = MLPPVector::create_vec_one(n);
 
     Vector<Ref<MLPPMatrix>> cumulative_generator_hidden_layer_w_grad =
-        compute_generator_gradients(_y_hat, loutput_set);
-
-    real_t lrpn = learning_rate / n;
-
-    for (int i = 0; i < cumulative_generator_hidden_layer_w_grad.size(); ++i) {
-      cumulative_generator_hidden_layer_w_grad.write[i]->scalar_multiply(lrpn);
-    }
+        compute_generator_gradients(ly_hat, loutput_set);
 
     update_generator_parameters(cumulative_generator_hidden_layer_w_grad,
                                 learning_rate);
@@ -242,14 +241,18 @@ void MLPPWGAN::add_output_layer(
 MLPPWGAN::MLPPWGAN(int p_k, const Ref<MLPPMatrix> &p_output_set) {
   _output_set = p_output_set;
   _k = p_k;
+  _clip_value = 0;
 
   _y_hat.instance();
+  _arena.instance();
 }
 
 MLPPWGAN::MLPPWGAN() {
   _k = 0;
+  _clip_value = 0;
 
   _y_hat.instance();
+  _arena.instance();
 }
 
 MLPPWGAN::~MLPPWGAN() {}
@@ -336,61 +339,92 @@ void MLPPWGAN::forward_pass() {
   _y_hat->set_from_mlpp_vector(_output_layer->get_a());
 }
 
-void MLPPWGAN::update_discriminator_parameters(
-    const Vector<Ref<MLPPMatrix>> &hidden_layer_updations,
-    const Ref<MLPPVector> &output_layer_updation, real_t learning_rate) {
-  int n = _output_set->size().y;
+// Every hidden layer's weights and bias in network order, then the output
+// layer's weights. The generator's layers come first, so both halves of the
+// network are contiguous ranges.
+void MLPPWGAN::_update_arena() {
+  int layer_count = _network.size();
 
-  _output_layer->set_weights(
-      _output_layer->get_weights()->subn(output_layer_updation));
-  _output_layer->set_bias(_output_layer->get_bias() -
-                          learning_rate *
-                              _output_layer->get_delta()->sum_elements() / n);
+  bool bound = _arena->get_entry_count() == 2 * layer_count + 1 &&
+               _arena->has_vector(2 * layer_count, _output_layer->get_weights());
 
-  if (!_network.empty()) {
-    Ref<MLPPHiddenLayer> layer = _network[_network.size() - 1];
+  for (int i = 0; i < layer_count && bound; ++i) {
+    Ref<MLPPHiddenLayer> layer = _network[i];
+
+    bound = _arena->has_matrix(2 * i, layer->get_weights()) &&
+            _arena->has_vector(2 * i + 1, layer->get_bias());
+  }
 
-    Ref<MLPPMatrix> slice = hidden_layer_updations[0];
+  if (bound) {
+    return;
+  }
 
-    layer->set_weights(layer->get_weights()->subn(slice));
-    layer->set_bias(layer->get_bias()->subtract_matrix_rowsn(
-        layer->get_delta()->scalar_multiplyn(learning_rate / n)));
+  _arena->clear();
 
-    for (int i = _network.size() - 2; i > _network.size() / 2; i--) {
-      layer = _network[i];
+  for (int i = 0; i < layer_count; ++i) {
+    _arena->add_matrix(_network.write[i]->get_weights());
+    _arena->add_vector(_network.write[i]->get_bias());
+  }
 
-      slice = hidden_layer_updations[(_network.size() - 2) - i + 1];
+  _arena->add_vector(_output_layer->get_weights());
 
-      layer->set_weights(layer->get_weights()->subn(slice));
-      layer->set_bias(layer->get_bias()->subtract_matrix_rowsn(
-          layer->get_delta()->scalar_multiplyn(learning_rate / n)));
-    }
+  _arena->build();
+}
+
+int MLPPWGAN::_get_discriminator_offset() const {
+  if (_network.empty()) {
+    return 0;
   }
+
+  return _arena->get_entry_offset(2 * (_network.size() / 2 + 1));
+}
+
+void MLPPWGAN::update_discriminator_parameters(
+    const Vector<Ref<MLPPMatrix>> &hidden_layer_gradients,
+    const Ref<MLPPVector> &output_layer_gradient, real_t learning_rate) {
+  _update_arena();
+
+  int n = _output_set->size().y;
+  int layer_count = _network.size();
+
+  _arena->gradient_set_vector(2 * layer_count, output_layer_gradient);
+
+  // The gradients are in reverse order, starting from the last hidden layer.
+  for (int i = 0; i < hidden_layer_gradients.size(); ++i) {
+    int layer_index = layer_count - 1 - i;
+
+    _arena->gradient_set_matrix(2 * layer_index, hidden_layer_gradients[i]);
+    _arena->gradient_set_vector(2 * layer_index + 1,
+                                _network.write[layer_index]->bias_gradient());
+  }
+
+  _arena->apply_gradients(_get_discriminator_offset(), _arena->get_size(),
+                          learning_rate / n);
+
+  _output_layer->set_bias(_output_layer->get_bias() -
+                          learning_rate *
+                              _output_layer->get_delta()->sum_elements() / n);
 }
 
 void MLPPWGAN::update_generator_parameters(
-    const Vector<Ref<MLPPMatrix>> &hidden_layer_updations,
+    const Vector<Ref<MLPPMatrix>> &hidden_layer_gradients,
     real_t learning_rate) {
-  if (!_network.empty()) {
-    int n = _output_set->size().y;
-
-    Ref<MLPPMatrix> slice;
+  if (_network.empty()) {
+    return;
+  }
 
-    for (int i = _network.size() / 2; i >= 0; i--) {
-      Ref<MLPPHiddenLayer> layer = _network[i];
+  _update_arena();
 
-      slice = hidden_layer_updations[(_network.size() - 2) - i + 1];
+  int n = _output_set->size().y;
+  int layer_count = _network.size();
 
-      // std::cout << network[i].weights.size() << "x" <<
-      // network[i].weights[0].size() << std::endl; std::cout <<
-      // hiddenLayerUpdations[(network.size() - 2) - i + 1].size() << "x" <<
-      // hiddenLayerUpdations[(network.size() - 2) - i + 1][0].size() <<
-      // std::endl;
-      layer->set_weights(layer->get_weights()->subn(slice));
-      layer->set_bias(layer->get_bias()->subtract_matrix_rowsn(
-          layer->get_delta()->scalar_multiplyn(learning_rate / n)));
-    }
+  for (int i = _network.size() / 2; i >= 0; i--) {
+    _arena->gradient_set_matrix(2 * i,
+                                hidden_layer_gradients[layer_count - 1 - i]);
+    _arena->gradient_set_vector(2 * i + 1, _network.write[i]->bias_gradient());
   }
+
+  _arena->apply_gradients(0, _get_discriminator_offset(), learning_rate / n);
 }
 
 MLPPWGAN::DiscriminatorGradientResult
@@ -557,6 +591,15 @@ void MLPPWGAN::_bind_methods() {
   ClassDB::bind_method(D_METHOD("set_k", "val"), &MLPPWGAN::set_k);
   ADD_PROPERTY(PropertyInfo(Variant::INT, "k"), "set_k", "get_k");
 
+  ClassDB::bind_method(D_METHOD("get_clip_value"), &MLPPWGAN::get_clip_value);
+  ClassDB::bind_method(D_METHOD("set_clip_value", "val"),
+                       &MLPPWGAN::set_clip_value);
+  ADD_PROPERTY(PropertyInfo(Variant::REAL, "clip_value"), "set_clip_value",
+               "get_clip_value");
+
+  ClassDB::bind_method(D_METHOD("get_parameter_arena"),
+                       &MLPPWGAN::get_parameter_arena);
+
   ClassDB::bind_method(D_METHOD("generate_example", "n"),
                        &MLPPWGAN::generate_example);
   ClassDB::bind_method(
@@ -42,8 +42,8 @@
 #endif
 
 #include "../core/mlpp_matrix.h"
-#include "../core/mlpp_tensor3.h"
 #include "../core/mlpp_vector.h"
+#include "../core/parameter_arena.h"
 
 #include "../hidden_layer/hidden_layer.h"
 #include "../output_layer/output_layer.h"
@@ -63,6 +63,13 @@ public:
 	int get_k() const;
 	void set_k(const int val);
 
+	// The critic's parameters are clipped to [-clip_value, clip_value] after every critic iteration. 0 disables clipping.
+	real_t get_clip_value() const;
+	void set_clip_value(const real_t val);
+
+	// The weights and biases of every layer. The layers view the arena, so changing it changes the network.
+	Ref<MLPPParameterArena> get_parameter_arena();
+
 	Ref<MLPPMatrix> generate_example(int n);
 	void gradient_descent(real_t learning_rate, int max_epoch, bool ui = false);
 	real_t score();
@@ -88,8 +95,14 @@ protected:
 	real_t cost(const Ref<MLPPVector> &y_hat, const Ref<MLPPVector> &y);
 
 	void forward_pass();
-	void update_discriminator_parameters(const Vector<Ref<MLPPMatrix>> &hidden_layer_updations, const Ref<MLPPVector> &output_layer_updation, real_t learning_rate);
-	void update_generator_parameters(const Vector<Ref<MLPPMatrix>> &hidden_layer_updations, real_t learning_rate);
+
+	void _update_arena();
+	// Where the discriminator's parameters start in the arena.
+	int _get_discriminator_offset() const;
+
+	// The gradients are unscaled, the learning rate is applied in the arena pass.
+	void update_discriminator_parameters(const Vector<Ref<MLPPMatrix>> &hidden_layer_gradients, const Ref<MLPPVector> &output_layer_gradient, real_t learning_rate);
+	void update_generator_parameters(const Vector<Ref<MLPPMatrix>> &hidden_layer_gradients, real_t learning_rate);
 
 	struct DiscriminatorGradientResult {
 		Vector<Ref<MLPPMatrix>> cumulative_hidden_layer_w_grad; // Tensor containing ALL hidden grads.
@@ -109,10 +122,13 @@ protected:
 
 	Ref<MLPPMatrix> _output_set;
 	int _k;
+	real_t _clip_value;
 
 	Vector<Ref<MLPPHiddenLayer>> _network;
 	Ref<MLPPOutputLayer> _output_layer;
 
+	Ref<MLPPParameterArena> _arena;
+
 	Ref<MLPPVector> _y_hat;
 };
 
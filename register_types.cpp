@@ -36,20 +36,28 @@
 #include "lin_alg/mlpp_vector.h"
 
 #include "activation/activation.h"
+#include "autodiff_tape/autodiff_tape.h"
 #include "convolutions/convolutions.h"
 #include "cost/cost.h"
 #include "gauss_markov_checker/gauss_markov_checker.h"
 #include "hypothesis_testing/hypothesis_testing.h"
+#include "inference_batcher/inference_batcher.h"
+#include "inference_model/inference_model.h"
 #include "lin_alg/lin_alg.h"
+#include "mini_batch_sampler/mini_batch_sampler.h"
 #include "numerical_analysis/numerical_analysis.h"
+#include "optimizer/optimizer.h"
+#include "parameter_arena/parameter_arena.h"
 #include "regularization/reg.h"
 #include "stat/stat.h"
 #include "transforms/transforms.h"
 #include "utilities/utilities.h"
 
+#include "conv_layer/conv_layer.h"
 #include "hidden_layer/hidden_layer.h"
 #include "multi_output_layer/multi_output_layer.h"
 #include "output_layer/output_layer.h"
+#include "pool_layer/pool_layer.h"
 
 #include "ann/ann.h"
 #include "auto_encoder/auto_encoder.h"
@@ -99,9 +107,29 @@ void register_pmlpp_types(ModuleRegistrationLevel p_level) {
 		ClassDB::register_class<MLPPConvolutions>();
 		ClassDB::register_class<MLPPLinAlg>();
 
+		ClassDB::register_class<MLPPOptimizer>();
+		ClassDB::register_class<MLPPOptimizerSGD>();
+		ClassDB::register_class<MLPPOptimizerMomentum>();
+		ClassDB::register_class<MLPPOptimizerAdagrad>();
+		ClassDB::register_class<MLPPOptimizerAdadelta>();
+		ClassDB::register_class<MLPPOptimizerAdamBase>();
+		ClassDB::register_class<MLPPOptimizerAdam>();
+		ClassDB::register_class<MLPPOptimizerAdamax>();
+		ClassDB::register_class<MLPPOptimizerNadam>();
+		ClassDB::register_class<MLPPOptimizerAMSGrad>();
+		ClassDB::register_class<MLPPParameterArena>();
+		ClassDB::register_class<MLPPMiniBatchSampler>();
+		ClassDB::register_class<MLPPAutodiffTape>();
+		ClassDB::register_class<MLPPInferenceContext>();
+		ClassDB::register_class<MLPPInferenceModel>();
+		ClassDB::register_class<MLPPInferenceRequest>();
+		ClassDB::register_class<MLPPInferenceBatcher>();
+
 		ClassDB::register_class<MLPPHiddenLayer>();
 		ClassDB::register_class<MLPPOutputLayer>();
 		ClassDB::register_class<MLPPMultiOutputLayer>();
+		ClassDB::register_class<MLPPConvLayer>();
+		ClassDB::register_class<MLPPPoolLayer>();
 
 		ClassDB::register_class<MLPPKNN>();
 		ClassDB::register_class<MLPPKMeans>();
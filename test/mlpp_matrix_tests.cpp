@@ -60,6 +60,12 @@ void MLPPMatrixTests::run_tests() {
 
 	PLOG_TRACE("test_mlpp_matrix_mul()");
 	test_mlpp_matrix_mul();
+
+	PLOG_TRACE("test_mlpp_matrix_gram()");
+	test_mlpp_matrix_gram();
+
+	PLOG_TRACE("test_mlpp_matrix_power()");
+	test_mlpp_matrix_power();
 }
 
 void MLPPMatrixTests::test_mlpp_matrix() {
@@ -359,6 +365,84 @@ void MLPPMatrixTests::test_mlpp_matrix_mul() {
 	is_approx_equals_mat(rmata, rmatc, "rmata->mult(rmatb);");
 }
 
+void MLPPMatrixTests::test_mlpp_matrix_gram() {
+	const real_t A[] = {
+		1, 2, //
+		3, 4, //
+		5, 6, //
+		7, 8, //
+	};
+
+	const real_t ATA[] = {
+		84, 100, //
+		100, 120, //
+	};
+
+	const real_t B[] = {
+		1, 2, 3, 4, //
+		5, 6, 7, 8, //
+	};
+
+	const real_t BCOV[] = {
+		5.0 / 3.0, 5.0 / 3.0, //
+		5.0 / 3.0, 5.0 / 3.0, //
+	};
+
+	Ref<MLPPMatrix> rmata(memnew(MLPPMatrix(A, 4, 2)));
+	Ref<MLPPMatrix> rmatata(memnew(MLPPMatrix(ATA, 2, 2)));
+	Ref<MLPPMatrix> rmatb(memnew(MLPPMatrix(B, 2, 4)));
+	Ref<MLPPMatrix> rmatbcov(memnew(MLPPMatrix(BCOV, 2, 2)));
+
+	is_approx_equals_mat(rmata->gram_matrixn(), rmatata, "rmata->gram_matrixn()");
+	is_approx_equals_mat(rmata->row_gram_matrixn(), rmata->multn(rmata->transposen()), "rmata->row_gram_matrixn()");
+	is_approx_equals_mat(rmatb->cov(), rmatbcov, "rmatb->cov()");
+}
+
+void MLPPMatrixTests::test_mlpp_matrix_power() {
+	const real_t A[] = {
+		1, 1, //
+		1, 0, //
+	};
+
+	const real_t A10[] = {
+		89, 55, //
+		55, 34, //
+	};
+
+	const real_t AM3[] = {
+		-1, 2, //
+		2, -3, //
+	};
+
+	const real_t C[] = {
+		3, 5, 7, //
+		5, 9, 13, //
+	};
+
+	const real_t VA[] = { 1, 2 };
+	const real_t VB[] = { 1, 2, 3 };
+
+	Ref<MLPPMatrix> rmata(memnew(MLPPMatrix(A, 2, 2)));
+	Ref<MLPPMatrix> rmata10(memnew(MLPPMatrix(A10, 2, 2)));
+	Ref<MLPPMatrix> rmatam3(memnew(MLPPMatrix(AM3, 2, 2)));
+	Ref<MLPPMatrix> rmatc(memnew(MLPPMatrix(C, 2, 3)));
+
+	Ref<MLPPVector> rveca(memnew(MLPPVector(VA, 2)));
+	Ref<MLPPVector> rvecb(memnew(MLPPVector(VB, 3)));
+
+	is_approx_equals_mat(rmata->matrix_powern(1), rmata, "rmata->matrix_powern(1)");
+	is_approx_equals_mat(rmata->matrix_powern(10), rmata10, "rmata->matrix_powern(10)");
+	is_approx_equals_mat(rmata->matrix_powern(-3), rmatam3, "rmata->matrix_powern(-3)");
+
+	Ref<MLPPMatrix> rmatd;
+	rmatd.instance();
+	rmatd->resize(Size2i(3, 2));
+	rmatd->fill(1);
+	rmatd->outer_product_add(rveca, rvecb, 2);
+
+	is_approx_equals_mat(rmatd, rmatc, "rmatd->outer_product_add(rveca, rvecb, 2)");
+}
+
 MLPPMatrixTests::MLPPMatrixTests() {
 }
 
@@ -370,4 +454,6 @@ void MLPPMatrixTests::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("test_mlpp_matrix"), &MLPPMatrixTests::test_mlpp_matrix);
 	ClassDB::bind_method(D_METHOD("test_mlpp_matrix_mul"), &MLPPMatrixTests::test_mlpp_matrix_mul);
+	ClassDB::bind_method(D_METHOD("test_mlpp_matrix_gram"), &MLPPMatrixTests::test_mlpp_matrix_gram);
+	ClassDB::bind_method(D_METHOD("test_mlpp_matrix_power"), &MLPPMatrixTests::test_mlpp_matrix_power);
 }
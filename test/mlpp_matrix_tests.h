@@ -68,6 +68,8 @@ public:
 	void test_row_remove_unordered();
 
 	void test_mlpp_matrix_mul();
+	void test_mlpp_matrix_gram();
+	void test_mlpp_matrix_power();
 
 	MLPPMatrixTests();
 	~MLPPMatrixTests();
@@ -48,26 +48,36 @@
 #include "../core/mlpp_vector.h"
 
 #include "../core/activation.h"
+#include "../core/autodiff_tape.h"
 #include "../modules/ann/ann.h"
 #include "../modules/auto_encoder/auto_encoder.h"
 #include "../modules/bernoulli_nb/bernoulli_nb.h"
 #include "../modules/c_log_log_reg/c_log_log_reg.h"
+#include "../modules/conv_layer/conv_layer.h"
 #include "../core/convolutions.h"
 #include "../core/cost.h"
 #include "../core/data.h"
+#include "../core/inference_batcher.h"
 #include "../modules/dual_svc/dual_svc.h"
 #include "../modules/exp_reg/exp_reg.h"
 #include "../modules/gan/gan.h"
+#include "../modules/pool_layer/pool_layer.h"
 #include "../modules/gaussian_nb/gaussian_nb.h"
+#include "../modules/hidden_layer/hidden_layer.h"
 #include "../modules/kmeans/kmeans.h"
 #include "../modules/knn/knn.h"
 #include "../core/lin_alg.h"
 #include "../modules/lin_reg/lin_reg.h"
 #include "../modules/log_reg/log_reg.h"
 #include "../modules/mann/mann.h"
+#include "../core/mini_batch_sampler.h"
 #include "../modules/mlp/mlp.h"
+#include "../modules/multi_output_layer/multi_output_layer.h"
 #include "../modules/multinomial_nb/multinomial_nb.h"
 #include "../core/numerical_analysis.h"
+#include "../core/optimizer.h"
+#include "../core/parallel.h"
+#include "../core/parameter_arena.h"
 #include "../modules/outlier_finder/outlier_finder.h"
 #include "../modules/pca/pca.h"
 #include "../modules/probit_reg/probit_reg.h"
@@ -225,6 +235,85 @@ void MLPPTests::test_linear_algebra() {
 	Ref<MLPPMatrix> id_10_res(memnew(MLPPMatrix(id_10_res_arr, 10, 10)));
 
 	is_approx_equals_mat(alg.identitym(10), id_10_res, "alg.identitym(10)");
+
+	const real_t spd_arr[] = {
+		4, 1, //
+		1, 3, //
+	};
+	const real_t spd_b_arr[] = { 6, 7 };
+	const real_t spd_x_arr[] = { 1, 2 };
+
+	Ref<MLPPMatrix> spd(memnew(MLPPMatrix(spd_arr, 2, 2)));
+	Ref<MLPPVector> spd_b(memnew(MLPPVector(spd_b_arr, 2)));
+	Ref<MLPPVector> spd_x(memnew(MLPPVector(spd_x_arr, 2)));
+
+	is_approx_equals_vec(alg.conjugate_gradientm(spd, spd_b).x, spd_x, "alg.conjugate_gradientm(spd, spd_b)");
+	is_approx_equals_vec(alg.conjugate_gradientm(spd, spd_b, Ref<MLPPVector>(), MLPPLinAlg::PRECONDITIONER_INCOMPLETE_CHOLESKY).x, spd_x, "alg.conjugate_gradientm(spd, spd_b, IC)");
+
+	const real_t ls_arr[] = {
+		1, 0, //
+		0, 1, //
+		1, 1, //
+	};
+	const real_t ls_b_arr[] = { 1, 2, 3 };
+
+	Ref<MLPPMatrix> ls(memnew(MLPPMatrix(ls_arr, 3, 2)));
+	Ref<MLPPVector> ls_b(memnew(MLPPVector(ls_b_arr, 3)));
+
+	is_approx_equals_vec(alg.lsqrm(ls, ls_b).x, spd_x, "alg.lsqrm(ls, ls_b)");
+
+	const real_t jacobi_arr[] = {
+		10, 1, 0, //
+		1, 4, 1, //
+		0, 1, 0.5, //
+	};
+	const real_t jacobi_x_arr[] = { 1, -2, 3 };
+
+	Ref<MLPPMatrix> jacobi(memnew(MLPPMatrix(jacobi_arr, 3, 3)));
+	Ref<MLPPVector> jacobi_x(memnew(MLPPVector(jacobi_x_arr, 3)));
+	Ref<MLPPVector> jacobi_b = jacobi->mult_vec(jacobi_x);
+
+	is_approx_equals_vec(alg.conjugate_gradientm(jacobi, jacobi_b, Ref<MLPPVector>(), MLPPLinAlg::PRECONDITIONER_JACOBI).x, jacobi_x, "alg.conjugate_gradientm(jacobi, jacobi_b, JACOBI)");
+
+	// Warm start from the solution: converged before the first iteration.
+	MLPPLinAlg::IterativeSolverResult warm_start = alg.conjugate_gradientm(jacobi, jacobi_b, jacobi_x);
+	is_approx_equalsd(warm_start.iterations, 0, "alg.conjugate_gradientm(jacobi, jacobi_b, jacobi_x).iterations");
+	is_approx_equals_vec(warm_start.x, jacobi_x, "alg.conjugate_gradientm(jacobi, jacobi_b, jacobi_x)");
+
+	// damp = 1 is ridge regression: (A^T * A + I) * x = A^T * b.
+	const real_t ls_ridge_x_arr[] = { 0.875, 1.375 };
+	Ref<MLPPVector> ls_ridge_x(memnew(MLPPVector(ls_ridge_x_arr, 2)));
+
+	is_approx_equals_vec(alg.lsqrm(ls, ls_b, 1).x, ls_ridge_x, "alg.lsqrm(ls, ls_b, 1)");
+
+	is_approx_equals_vec(alg.solve(jacobi, jacobi_b, MLPPLinAlg::SOLVER_CONJUGATE_GRADIENT), jacobi_x, "alg.solve(jacobi, jacobi_b, SOLVER_CONJUGATE_GRADIENT)");
+	is_approx_equals_vec(alg.solve(jacobi, jacobi_b, MLPPLinAlg::SOLVER_LSQR), jacobi_x, "alg.solve(jacobi, jacobi_b, SOLVER_LSQR)");
+	is_approx_equals_vec(alg.solve(ls, ls_b, MLPPLinAlg::SOLVER_LSQR), spd_x, "alg.solve(ls, ls_b, SOLVER_LSQR)");
+
+	const real_t rank_2_arr[] = {
+		1, 2, 3, //
+		2, 4, 6, //
+		1, 0, 1, //
+		0, 2, 2, //
+	};
+	const real_t indefinite_arr[] = {
+		1, 2, //
+		2, 1, //
+	};
+
+	Ref<MLPPMatrix> rank_2(memnew(MLPPMatrix(rank_2_arr, 4, 3)));
+	Ref<MLPPMatrix> indefinite(memnew(MLPPMatrix(indefinite_arr, 2, 2)));
+
+	is_approx_equalsd(alg.rank(rank_2), 2, "alg.rank(rank_2)");
+	is_approx_equalsd(alg.rank(ls), 2, "alg.rank(ls)");
+	is_approx_equalsd(alg.linear_independence_checker(ls->transposen()), 1, "alg.linear_independence_checker(ls->transposen())");
+	is_approx_equalsd(alg.linear_independence_checker(ls), 0, "alg.linear_independence_checker(ls)");
+	is_approx_equalsd(alg.positive_definite_checker(spd), 1, "alg.positive_definite_checker(spd)");
+	is_approx_equalsd(alg.positive_definite_checker(indefinite), 0, "alg.positive_definite_checker(indefinite)");
+	is_approx_equalsd(alg.negative_definite_checker(alg.scalar_multiplynm(-1, spd)), 1, "alg.negative_definite_checker(-spd)");
+	is_approx_equalsd(alg.negative_definite_checker(spd), 0, "alg.negative_definite_checker(spd)");
+	is_approx_equalsd(alg.zero_eigenvalue(indefinite), 0, "alg.zero_eigenvalue(indefinite)");
+	is_approx_equalsd(alg.zero_eigenvalue(rank_2->gram_matrixn()), 1, "alg.zero_eigenvalue(rank_2^T * rank_2)");
 }
 
 void MLPPTests::test_univariate_linear_regression() {
@@ -668,252 +757,2247 @@ void MLPPTests::test_wgan(bool ui) {
 	output_set->set_from_std_vectors(outputSet);
 	output_set = output_set->transposen();
 
-	MLPPWGAN gan(2, output_set); // our gan is a wasserstein gan (wgan)
-	gan.create_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
-	gan.create_layer(2, MLPPActivation::ACTIVATION_FUNCTION_RELU);
-	gan.create_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
-	gan.add_output_layer(); // User can specify weight init- if necessary.
-	gan.gradient_descent(0.1, 55000, ui);
+	MLPPWGAN gan(2, output_set); // our gan is a wasserstein gan (wgan)
+	gan.create_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+	gan.create_layer(2, MLPPActivation::ACTIVATION_FUNCTION_RELU);
+	gan.create_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+	gan.add_output_layer(); // User can specify weight init- if necessary.
+	gan.gradient_descent(0.1, 55000, ui);
+
+	String str = "GENERATED INPUT: (Gaussian-sampled noise):\n";
+	str += gan.generate_example(100)->to_string();
+	PLOG_MSG(str);
+}
+void MLPPTests::test_ann(bool ui) {
+	MLPPLinAlg alg;
+
+	std::vector<std::vector<real_t>> inputSet = { { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 1 } }; // XOR
+	std::vector<real_t> outputSet = { 0, 1, 1, 0 };
+
+	Ref<MLPPMatrix> input_set;
+	input_set.instance();
+	input_set->set_from_std_vectors(inputSet);
+
+	Ref<MLPPVector> output_set;
+	output_set.instance();
+	output_set->set_from_std_vector(outputSet);
+
+	MLPPANN ann(input_set, output_set);
+	ann.add_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+	ann.add_layer(8, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID); // Add more layers as needed.
+	ann.add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, MLPPCost::COST_TYPE_LOGISTIC_LOSS);
+	ann.gradient_descent(1, 20000, ui);
+
+	Ref<MLPPVector> predictions = ann.model_set_test(input_set);
+	PLOG_MSG(predictions->to_string()); // Testing out the model's preds for train set.
+	PLOG_MSG("ACCURACY: " + String::num(100 * ann.score()) + "%"); // Accuracy.
+}
+void MLPPTests::test_optimizers() {
+	const int size = 7;
+	const int step_count = 3;
+	const real_t learning_rate = 0.1;
+	const real_t gamma = 0.9;
+	const real_t b1 = 0.9;
+	const real_t b2 = 0.999;
+	const real_t e = 1e-8;
+
+	Vector<Ref<MLPPVector>> grads;
+
+	for (int i = 0; i < step_count; ++i) {
+		Ref<MLPPVector> g;
+		g.instance();
+		g->resize(size);
+
+		for (int j = 0; j < size; ++j) {
+			g->element_set(j, Math::sin(static_cast<real_t>(i * size + j) * real_t(1.3)));
+		}
+
+		grads.push_back(g);
+	}
+
+	Ref<MLPPVector> initial;
+	initial.instance();
+	initial->resize(size);
+
+	for (int j = 0; j < size; ++j) {
+		initial->element_set(j, Math::cos(static_cast<real_t>(j)));
+	}
+
+	// Reference results, from the same vector math the models used before the optimizers.
+	Vector<Ref<MLPPOptimizer>> optimizers;
+	Vector<Ref<MLPPVector>> expected;
+
+	for (int k = 0; k < 9; ++k) {
+		Ref<MLPPVector> w = initial->duplicate_fast();
+		Ref<MLPPVector> m;
+		m.instance();
+		m->resize(size);
+		m->fill(0);
+		Ref<MLPPVector> v = m->duplicate_fast();
+		Ref<MLPPVector> v_max = m->duplicate_fast();
+
+		for (int t = 1; t <= step_count; ++t) {
+			Ref<MLPPVector> g = grads[t - 1];
+			Ref<MLPPVector> g2 = g->hadamard_productn(g);
+
+			real_t m_corr = 1 / (1 - Math::pow(b1, static_cast<real_t>(t)));
+			real_t v_corr = 1 / (1 - Math::pow(b2, static_cast<real_t>(t)));
+
+			if (k >= 5) {
+				m = m->scalar_multiplyn(b1)->addn(g->scalar_multiplyn(1 - b1));
+			}
+
+			switch (k) {
+				case 0: // SGD
+					w->sub(g->scalar_multiplyn(learning_rate));
+					break;
+				case 1: // Momentum
+					v = v->scalar_multiplyn(gamma)->addn(g->scalar_multiplyn(learning_rate));
+					w->sub(v);
+					break;
+				case 2: // Nesterov
+					v = v->scalar_multiplyn(gamma)->addn(g->scalar_multiplyn(learning_rate));
+					w->sub(v->scalar_multiplyn(gamma)->addn(g->scalar_multiplyn(learning_rate)));
+					break;
+				case 3: // Adagrad
+					v->add(g2);
+					w->sub(g->division_element_wisen(v->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate));
+					break;
+				case 4: // Adadelta
+					v = v->scalar_multiplyn(b1)->addn(g2->scalar_multiplyn(1 - b1));
+					w->sub(g->division_element_wisen(v->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate));
+					break;
+				case 5: // Adam
+					v = v->scalar_multiplyn(b2)->addn(g2->scalar_multiplyn(1 - b2));
+					w->sub(m->scalar_multiplyn(m_corr)->division_element_wisen(v->scalar_multiplyn(v_corr)->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate));
+					break;
+				case 6: // Adamax
+					v = v->scalar_multiplyn(b2)->maxn(g->absn());
+					w->sub(m->scalar_multiplyn(m_corr)->division_element_wisen(v->scalar_addn(e))->scalar_multiplyn(learning_rate));
+					break;
+				case 7: { // Nadam
+					v = v->scalar_multiplyn(b2)->addn(g2->scalar_multiplyn(1 - b2));
+					Ref<MLPPVector> m_final = m->scalar_multiplyn(b1)->addn(g->scalar_multiplyn(1 - b1))->scalar_multiplyn(m_corr);
+					w->sub(m_final->division_element_wisen(v->scalar_multiplyn(v_corr)->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate));
+				} break;
+				case 8: // AMSGrad
+					v = v->scalar_multiplyn(b2)->addn(g2->scalar_multiplyn(1 - b2));
+					v_max = v_max->maxn(v);
+					w->sub(m->division_element_wisen(v_max->sqrtn()->scalar_addn(e))->scalar_multiplyn(learning_rate));
+					break;
+			}
+		}
+
+		expected.push_back(w);
+	}
+
+	optimizers.push_back(Ref<MLPPOptimizer>(memnew(MLPPOptimizerSGD())));
+	optimizers.push_back(Ref<MLPPOptimizer>(memnew(MLPPOptimizerMomentum(gamma))));
+	optimizers.push_back(Ref<MLPPOptimizer>(memnew(MLPPOptimizerMomentum(gamma, true))));
+	optimizers.push_back(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdagrad(e))));
+	optimizers.push_back(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdadelta(b1, e))));
+	optimizers.push_back(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdam(b1, b2, e))));
+	optimizers.push_back(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAdamax(b1, b2, e))));
+	optimizers.push_back(Ref<MLPPOptimizer>(memnew(MLPPOptimizerNadam(b1, b2, e))));
+	optimizers.push_back(Ref<MLPPOptimizer>(memnew(MLPPOptimizerAMSGrad(b1, b2, e))));
+
+	const char *names[] = { "SGD", "Momentum", "Nesterov", "Adagrad", "Adadelta", "Adam", "Adamax", "Nadam", "AMSGrad" };
+
+	for (int k = 0; k < optimizers.size(); ++k) {
+		Ref<MLPPOptimizer> optimizer = optimizers[k];
+		Ref<MLPPVector> w = initial->duplicate_fast();
+
+		// A second slot, updated with the same gradients, to check that the slots don't share state.
+		Ref<MLPPVector> w2 = initial->duplicate_fast();
+
+		for (int t = 0; t < step_count; ++t) {
+			optimizer->begin_step();
+			optimizer->update_vector(0, w, grads[t], learning_rate);
+			optimizer->update_vector(1, w2, grads[t], learning_rate);
+		}
+
+		is_approx_equals_vec(w, expected[k], String("test_optimizers() ") + names[k]);
+		is_approx_equals_vec(w2, expected[k], String("test_optimizers() ") + names[k] + " slot 1");
+	}
+
+	// A buffer large enough to be split between threads has to give the same results as a small one.
+	const int large_size = 40000;
+
+	Ref<MLPPVector> large_w;
+	large_w.instance();
+	large_w->resize(large_size);
+
+	Ref<MLPPVector> large_g;
+	large_g.instance();
+	large_g->resize(large_size);
+
+	for (int j = 0; j < large_size; ++j) {
+		large_w->element_set(j, Math::cos(static_cast<real_t>(j)));
+		large_g->element_set(j, Math::sin(static_cast<real_t>(j) * real_t(0.1)));
+	}
+
+	Ref<MLPPMatrix> large_wm;
+	large_wm.instance();
+	large_wm->resize(Size2i(large_size / 4, 4));
+
+	Ref<MLPPMatrix> large_gm;
+	large_gm.instance();
+	large_gm->resize(Size2i(large_size / 4, 4));
+
+	for (int j = 0; j < large_size; ++j) {
+		large_wm->element_set_index(j, large_w->element_get(j));
+		large_gm->element_set_index(j, large_g->element_get(j));
+	}
+
+	Ref<MLPPOptimizerAdam> adam = Ref<MLPPOptimizerAdam>(memnew(MLPPOptimizerAdam(b1, b2, e)));
+
+	Ref<MLPPVector> tail_w;
+	tail_w.instance();
+	tail_w->resize(16);
+
+	Ref<MLPPVector> tail_g;
+	tail_g.instance();
+	tail_g->resize(16);
+
+	for (int j = 0; j < 16; ++j) {
+		tail_w->element_set(j, large_w->element_get(large_size - 16 + j));
+		tail_g->element_set(j, large_g->element_get(large_size - 16 + j));
+	}
+
+	for (int t = 0; t < step_count; ++t) {
+		adam->begin_step();
+		adam->update_vector(0, large_w, large_g, learning_rate);
+		adam->update_matrix(1, large_wm, large_gm, learning_rate);
+		adam->update_vector(2, tail_w, tail_g, learning_rate);
+	}
+
+	Ref<MLPPVector> large_tail;
+	large_tail.instance();
+	large_tail->resize(16);
+
+	for (int j = 0; j < 16; ++j) {
+		large_tail->element_set(j, large_w->element_get(large_size - 16 + j));
+	}
+
+	is_approx_equals_vec(large_tail, tail_w, "test_optimizers() Adam large buffer");
+	is_approx_equals_vec(large_wm->flatten(), large_w, "test_optimizers() Adam large matrix");
+}
+void MLPPTests::test_parameter_arena() {
+	Ref<MLPPMatrix> m;
+	m.instance();
+	m->set_from_std_vectors({ { 1, 2, 3 }, { 4, 5, 6 } });
+
+	Ref<MLPPVector> v;
+	v.instance();
+	v->set_from_std_vector({ 7, -8 });
+
+	Ref<MLPPMatrix> m_copy = m->duplicate_fast();
+	Ref<MLPPVector> v_copy = v->duplicate_fast();
+
+	Ref<MLPPParameterArena> arena;
+	arena.instance();
+	arena->add_matrix(m);
+	arena->add_vector(v);
+	arena->build();
+
+	Ref<MLPPVector> all;
+	all.instance();
+	all->set_from_std_vector({ 1, 2, 3, 4, 5, 6, 7, -8 });
+
+	is_approx_equals_mat(m, m_copy, "test_parameter_arena() matrix kept its values");
+	is_approx_equals_vec(v, v_copy, "test_parameter_arena() vector kept its values");
+	is_approx_equals_vec(arena->get_parameters(), all, "test_parameter_arena() get_parameters()");
+	is_approx_equalsd(arena->has_matrix(0, m) && arena->has_vector(1, v), 1, "test_parameter_arena() has_matrix(), has_vector()");
+
+	// The entries view the arena.
+	arena->parameters_ptrw()[7] = 8;
+	is_approx_equalsd(v->element_get(1), 8, "test_parameter_arena() vector is a view");
+
+	Ref<MLPPVector> checkpoint = arena->checkpoint();
+
+	Ref<MLPPMatrix> mg;
+	mg.instance();
+	mg->set_from_std_vectors({ { 1, 1, 1 }, { 1, 1, 1 } });
+	Ref<MLPPVector> vg;
+	vg.instance();
+	vg->set_from_std_vector({ 2, 2 });
+
+	arena->gradient_set_matrix(0, mg);
+	arena->gradient_set_vector(1, vg);
+
+	is_approx_equalsd(arena->gradient_norm(), Math::sqrt(real_t(14)), "test_parameter_arena() gradient_norm()");
+
+	arena->apply_gradients(0, arena->get_size(), 0.5);
+
+	Ref<MLPPVector> stepped;
+	stepped.instance();
+	stepped->set_from_std_vector({ 0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6, 7 });
+	is_approx_equals_vec(arena->get_parameters(), stepped, "test_parameter_arena() apply_gradients()");
+
+	// Only the vector's range.
+	arena->clip_parameters(arena->get_entry_offset(1), arena->get_size(), 3);
+
+	Ref<MLPPVector> v_clipped;
+	v_clipped.instance();
+	v_clipped->set_from_std_vector({ 3, 3 });
+	is_approx_equals_vec(v, v_clipped, "test_parameter_arena() clip_parameters()");
+	is_approx_equalsd(m->element_get(1, 2), 5.5, "test_parameter_arena() clip_parameters() range");
+
+	is_approx_equalsd(arena->clip_gradient_norm(1), Math::sqrt(real_t(14)), "test_parameter_arena() clip_gradient_norm()");
+	is_approx_equalsd(arena->gradient_norm(), 1, "test_parameter_arena() clip_gradient_norm() result");
+
+	arena->restore(checkpoint);
+	all->element_set(7, 8);
+	is_approx_equals_vec(arena->get_parameters(), all, "test_parameter_arena() restore()");
+
+	// Resizing detaches an entry, the networks rebuild their arenas when that happens.
+	m->resize(Size2i(2, 2));
+	is_approx_equalsd(m->is_view() || arena->has_matrix(0, m), 0, "test_parameter_arena() resize detaches");
+
+	arena->clear();
+	is_approx_equalsd(v->is_view(), 0, "test_parameter_arena() clear()");
+	is_approx_equalsd(v->element_get(1), 8, "test_parameter_arena() clear() keeps values");
+
+	// WGAN weight clipping runs over the critic's part of the arena.
+	std::vector<std::vector<real_t>> outputSet = {
+		{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 },
+		{ 2, 4, 6, 8, 10, 12, 14, 16, 18, 20 }
+	};
+
+	Ref<MLPPMatrix> output_set;
+	output_set.instance();
+	output_set->set_from_std_vectors(outputSet);
+	output_set = output_set->transposen();
+
+	MLPPWGAN gan(2, output_set);
+	gan.create_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+	gan.create_layer(2, MLPPActivation::ACTIVATION_FUNCTION_RELU);
+	gan.create_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+	gan.add_output_layer();
+	gan.set_clip_value(0.01);
+	gan.gradient_descent(0.1, 3);
+
+	Ref<MLPPMatrix> critic_weights = gan.get_layer(2)->get_weights();
+	real_t max_abs = 0;
+
+	for (int i = 0; i < critic_weights->data_size(); ++i) {
+		max_abs = MAX(max_abs, ABS(critic_weights->ptr()[i]));
+	}
+
+	is_approx_equalsd(max_abs <= real_t(0.01), 1, "test_parameter_arena() WGAN clip_value");
+	is_approx_equalsd(critic_weights->is_view(), 1, "test_parameter_arena() WGAN layers view the arena");
+}
+// Rows of (sin(0.7 * i), cos(1.3 * i), (i % 5) / 5), the inputs of the ANN training and inference tests.
+static Ref<MLPPMatrix> ann_test_input_set(int p_row_count) {
+	Ref<MLPPMatrix> input_set;
+	input_set.instance();
+	input_set->resize(Size2i(3, p_row_count));
+
+	for (int i = 0; i < p_row_count; ++i) {
+		input_set->element_set(i, 0, Math::sin(static_cast<real_t>(i) * real_t(0.7)));
+		input_set->element_set(i, 1, Math::cos(static_cast<real_t>(i) * real_t(1.3)));
+		input_set->element_set(i, 2, static_cast<real_t>(i % 5) / 5);
+	}
+
+	return input_set;
+}
+
+// 1 where a + b * c > 0, 0 otherwise.
+static Ref<MLPPVector> ann_test_output_set(const Ref<MLPPMatrix> &p_input_set) {
+	int row_count = p_input_set->size().y;
+
+	Ref<MLPPVector> output_set;
+	output_set.instance();
+	output_set->resize(row_count);
+
+	for (int i = 0; i < row_count; ++i) {
+		real_t a = p_input_set->element_get(i, 0);
+		real_t b = p_input_set->element_get(i, 1);
+		real_t c = p_input_set->element_get(i, 2);
+
+		output_set->element_set(i, a + b * c > 0 ? 1 : 0);
+	}
+
+	return output_set;
+}
+
+// Run 0 saves the initial parameters of p_ann, later runs start from them, so the runs can be compared.
+// Then trains with adam() on the same batch order in every run.
+static void ann_test_train_adam(Ref<MLPPANN> p_ann, int p_run, Ref<MLPPVector> &r_initial_parameters, real_t &r_initial_bias, int p_epochs, int p_mini_batch_size) {
+	Ref<MLPPParameterArena> arena = p_ann->get_parameter_arena();
+
+	if (p_run == 0) {
+		r_initial_parameters = arena->checkpoint();
+		r_initial_bias = p_ann->get_output_layer()->get_bias();
+	} else {
+		arena->restore(r_initial_parameters);
+		p_ann->get_output_layer()->set_bias(r_initial_bias);
+	}
+
+	MLPPMiniBatchSampler::set_default_seed(42);
+	p_ann->adam(0.1, p_epochs, p_mini_batch_size, 0.9, 0.999, 1e-8);
+	MLPPMiniBatchSampler::set_default_seed(0);
+}
+
+void MLPPTests::test_data_parallel_training() {
+	const int row_count = 24;
+
+	Ref<MLPPMatrix> input_set = ann_test_input_set(row_count);
+	Ref<MLPPVector> output_set = ann_test_output_set(input_set);
+
+	Ref<MLPPVector> initial_parameters;
+	real_t initial_bias = 0;
+
+	Ref<MLPPVector> results[3];
+
+	// Single threaded, then 3 shards twice, all from the same initial parameters.
+	for (int k = 0; k < 3; ++k) {
+		Ref<MLPPANN> ann = Ref<MLPPANN>(memnew(MLPPANN(input_set, output_set)));
+		ann->add_layer(6, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::REGULARIZATION_TYPE_RIDGE, 0.01);
+		ann->add_layer(4, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+		ann->add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, MLPPCost::COST_TYPE_LOGISTIC_LOSS);
+
+		if (k > 0) {
+			ann->set_data_parallel_thread_count(3);
+		}
+
+		ann_test_train_adam(ann, k, initial_parameters, initial_bias, 20, 8);
+
+		results[k] = ann->get_parameter_arena()->checkpoint();
+		results[k]->push_back(ann->get_output_layer()->get_bias());
+	}
+
+	is_approx_equals_vec_tolerance(results[0], results[1], 1e-4, "test_data_parallel_training() 3 shards, same as single threaded");
+	is_approx_equals_vec_tolerance(results[1], results[2], 0, "test_data_parallel_training() 3 shards, deterministic");
+
+	// MLPPMANN shards its whole batch, 24 rows don't split evenly into 5 shards.
+	Ref<MLPPMatrix> mann_output_set;
+	mann_output_set.instance();
+	mann_output_set->resize(Size2i(2, row_count));
+
+	for (int i = 0; i < row_count; ++i) {
+		mann_output_set->element_set(i, 0, output_set->element_get(i));
+		mann_output_set->element_set(i, 1, input_set->element_get(i, 0) * input_set->element_get(i, 2));
+	}
+
+	Ref<MLPPVector> mann_results[2];
+
+	for (int k = 0; k < 2; ++k) {
+		Ref<MLPPMANN> mann = Ref<MLPPMANN>(memnew(MLPPMANN(input_set, mann_output_set)));
+		mann->add_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+		mann->add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_LINEAR, MLPPCost::COST_TYPE_MSE);
+
+		Ref<MLPPParameterArena> arena = mann->get_parameter_arena();
+
+		if (k == 0) {
+			initial_parameters = arena->checkpoint();
+		} else {
+			arena->restore(initial_parameters);
+			mann->set_data_parallel_thread_count(5);
+		}
+
+		mann->gradient_descent(0.01, 20);
+
+		mann_results[k] = arena->checkpoint();
+	}
+
+	is_approx_equals_vec_tolerance(mann_results[0], mann_results[1], 1e-4, "test_data_parallel_training() MLPPMANN 5 shards, same as single threaded");
+}
+void MLPPTests::test_mini_batch_sampler() {
+	// Row i is filled with i, and its output is i too, so every batch row can be checked against its output.
+	// 300 rows of 63 columns, 256 row batches are big enough for the background thread.
+	const int sizes[2][3] = { { 10, 3, 4 }, { 300, 63, 256 } };
+
+	for (int s = 0; s < 2; ++s) {
+		int row_count = sizes[s][0];
+		int column_count = sizes[s][1];
+		int batch_size = sizes[s][2];
+
+		Ref<MLPPMatrix> input_set;
+		input_set.instance();
+		input_set->resize(Size2i(column_count, row_count));
+
+		Ref<MLPPVector> output_set;
+		output_set.instance();
+		output_set->resize(row_count);
+
+		for (int i = 0; i < row_count; ++i) {
+			for (int j = 0; j < column_count; ++j) {
+				input_set->element_set(i, j, i);
+			}
+
+			output_set->element_set(i, i);
+		}
+
+		MLPPMiniBatchSampler sampler;
+		sampler.setupmv(input_set, output_set, batch_size);
+
+		int batch_count = (row_count + batch_size - 1) / batch_size;
+		is_approx_equalsd(sampler.get_batch_count(), batch_count, "test_mini_batch_sampler() get_batch_count()");
+
+		for (int shuffle = 1; shuffle >= 0; --shuffle) {
+			sampler.set_shuffle(shuffle);
+
+			for (int epoch = 0; epoch < 2; ++epoch) {
+				Vector<int> seen;
+				seen.resize(row_count);
+				seen.fill(0);
+
+				int batches = 0;
+				int matching = 0;
+				int in_order = 0;
+				int last_size = 0;
+
+				sampler.begin_epoch();
+
+				while (sampler.next()) {
+					Ref<MLPPMatrix> input = sampler.get_input();
+					Ref<MLPPVector> output = sampler.get_output_vector();
+
+					for (int i = 0; i < input->size().y; ++i) {
+						int row = static_cast<int>(output->element_get(i));
+
+						seen.write[row] += 1;
+
+						if (input->element_get(i, 0) == row && input->element_get(i, column_count - 1) == row) {
+							++matching;
+						}
+
+						if (row == batches * batch_size + i) {
+							++in_order;
+						}
+					}
+
+					last_size = input->size().y;
+					++batches;
+				}
+
+				int seen_once = 0;
+				for (int i = 0; i < row_count; ++i) {
+					seen_once += seen[i] == 1 ? 1 : 0;
+				}
+
+				is_approx_equalsd(batches, batch_count, "test_mini_batch_sampler() batches in an epoch");
+				is_approx_equalsd(last_size, row_count - (batch_count - 1) * batch_size, "test_mini_batch_sampler() ragged last batch");
+				is_approx_equalsd(seen_once, row_count, "test_mini_batch_sampler() every row once per epoch");
+				is_approx_equalsd(matching, row_count, "test_mini_batch_sampler() inputs and outputs stay paired");
+
+				if (!shuffle) {
+					is_approx_equalsd(in_order, row_count, "test_mini_batch_sampler() no shuffle keeps the row order");
+					is_approx_equalsd(sampler.get_input()->is_view(), 1, "test_mini_batch_sampler() no shuffle uses views");
+				}
+			}
+		}
+	}
+
+	// create_mini_batchesmv() used to copy the outputs of the first batch into every batch.
+	Ref<MLPPMatrix> input_set;
+	input_set.instance();
+	input_set->resize(Size2i(1, 6));
+
+	Ref<MLPPVector> output_set;
+	output_set.instance();
+	output_set->resize(6);
+
+	for (int i = 0; i < 6; ++i) {
+		input_set->element_set(i, 0, i);
+		output_set->element_set(i, i);
+	}
+
+	MLPPUtilities::CreateMiniBatchMVBatch batches = MLPPUtilities::create_mini_batchesmv(input_set, output_set, 3);
+
+	is_approx_equalsd(batches.output_sets[2]->element_get(1), 5, "test_mini_batch_sampler() create_mini_batchesmv() outputs");
+}
+void MLPPTests::test_hogwild_sgd() {
+	const int row_count = 64;
+	const int feature_count = 16;
+
+	// Sparse rows, 2 features set out of 16, so the workers rarely touch the same weights.
+	Ref<MLPPMatrix> input_set;
+	input_set.instance();
+	input_set->resize(Size2i(feature_count, row_count));
+	input_set->fill(0);
+
+	Ref<MLPPVector> output_set;
+	output_set.instance();
+	output_set->resize(row_count);
+
+	Ref<MLPPVector> labels;
+	labels.instance();
+	labels->resize(row_count);
+
+	// -1 / 1 labels for MLPPTanhReg, and MLPPSVC.
+	Ref<MLPPVector> signed_labels;
+	signed_labels.instance();
+	signed_labels->resize(row_count);
+
+	for (int i = 0; i < row_count; ++i) {
+		int a = i % feature_count;
+		int b = (i * 5 + 3) % feature_count;
+
+		input_set->element_set(i, a, 1);
+		input_set->element_set(i, b, 1);
+
+		// Weights are j / 4 - 2, and the bias is 0.5.
+		real_t y = 0.5;
+		for (int j = 0; j < feature_count; ++j) {
+			y += input_set->element_get(i, j) * (static_cast<real_t>(j) / 4 - 2);
+		}
+
+		output_set->element_set(i, y);
+		labels->element_set(i, y > 0 ? 1 : 0);
+		signed_labels->element_set(i, y > 0 ? 1 : -1);
+	}
+
+	MLPPLinReg lin_reg(input_set, output_set);
+	lin_reg.set_hogwild_thread_count(4);
+	lin_reg.sgd(0.05, 40000);
+
+	is_approx_equals_vec_tolerance(lin_reg.model_set_test(input_set), output_set, 0.05, "test_hogwild_sgd() MLPPLinReg");
+
+	MLPPLogReg log_reg(input_set, labels);
+	log_reg.set_hogwild_thread_count(4);
+	log_reg.sgd(0.1, 40000);
+
+	is_approx_equalsd(log_reg.score(), 1, "test_hogwild_sgd() MLPPLogReg");
+
+	MLPPProbitReg probit_reg(input_set, labels);
+	probit_reg.set_hogwild_thread_count(4);
+	probit_reg.train_sgd(0.1, 40000);
+
+	is_approx_equalsd(probit_reg.score(), 1, "test_hogwild_sgd() MLPPProbitReg");
+
+	MLPPTanhReg tanh_reg(input_set, signed_labels);
+	tanh_reg.set_hogwild_thread_count(4);
+	tanh_reg.train_sgd(0.1, 40000);
+
+	is_approx_equalsd(tanh_reg.score(), 1, "test_hogwild_sgd() MLPPTanhReg");
+
+	MLPPSVC svc(input_set, signed_labels, 1);
+	svc.set_hogwild_thread_count(4);
+	svc.train_sgd(0.01, 40000);
+
+	is_approx_equalsd(svc.score(), 1, "test_hogwild_sgd() MLPPSVC");
+}
+
+// Forward only: the cross entropy of a tanh hidden layer and a softmax output layer.
+static real_t autodiff_tape_test_loss(Ref<MLPPHiddenLayer> p_hidden, Ref<MLPPMultiOutputLayer> p_output, const Ref<MLPPMatrix> &p_input, const Ref<MLPPMatrix> &p_target) {
+	Ref<MLPPAutodiffTape> tape;
+	tape.instance();
+
+	int a = p_output->record(tape, p_hidden->record(tape, tape->constant(p_input)));
+
+	return tape->get_scalar(tape->cross_entropy(a, tape->constant(p_target)));
+}
+
+void MLPPTests::test_autodiff_tape() {
+	const int row_count = 5;
+
+	Ref<MLPPMatrix> input_set;
+	input_set.instance();
+	input_set->resize(Size2i(3, row_count));
+
+	Ref<MLPPMatrix> target;
+	target.instance();
+	target->resize(Size2i(2, row_count));
+	target->fill(0);
+
+	for (int i = 0; i < row_count; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			input_set->element_set(i, j, Math::sin(static_cast<real_t>(i * 3 + j)));
+		}
+
+		target->element_set(i, i % 2, 1);
+	}
+
+	Ref<MLPPHiddenLayer> hidden = Ref<MLPPHiddenLayer>(memnew(MLPPHiddenLayer(4, MLPPActivation::ACTIVATION_FUNCTION_TANH, input_set, MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::REGULARIZATION_TYPE_NONE, 0, 0)));
+	Ref<MLPPMultiOutputLayer> output = Ref<MLPPMultiOutputLayer>(memnew(MLPPMultiOutputLayer(2, 4, MLPPActivation::ACTIVATION_FUNCTION_SOFTMAX, MLPPCost::COST_TYPE_CROSS_ENTROPY, Ref<MLPPMatrix>(), MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::REGULARIZATION_TYPE_NONE, 0, 0)));
+
+	Ref<MLPPAutodiffTape> tape;
+	tape.instance();
+
+	int x = tape->constant(input_set);
+	int y = tape->constant(target);
+	int h = hidden->record(tape, x);
+	int loss = tape->cross_entropy(output->record(tape, h), y);
+
+	// Same as the layer's own forward pass.
+	hidden->forward_pass();
+	is_approx_equals_mat(tape->get_value(h), hidden->get_a(), "test_autodiff_tape() hidden layer forward");
+
+	real_t loss_value = tape->get_scalar(loss);
+
+	tape->backward(loss);
+
+	is_approx_equalsd(tape->get_scalar(loss), loss_value, "test_autodiff_tape() loss kept after backward()");
+	// x, y, the 4 parameters and the loss, every intermediate got freed.
+	is_approx_equalsd(tape->get_live_buffer_count(), 7, "test_autodiff_tape() intermediates freed");
+	// Constants get no gradients.
+	is_approx_equalsd(tape->get_gradient(x).is_valid(), 0, "test_autodiff_tape() no gradient for constants");
+
+	// Central differences.
+	const real_t eps = 1e-3;
+
+	Ref<MLPPMatrix> params[2] = { hidden->get_weights(), output->get_weights() };
+	Ref<MLPPVector> biases[2] = { hidden->get_bias(), output->get_bias() };
+
+	Ref<MLPPVector> analytic;
+	analytic.instance();
+	Ref<MLPPVector> numeric;
+	numeric.instance();
+
+	for (int k = 0; k < 2; ++k) {
+		Ref<MLPPMatrix> grad = tape->get_parameter_gradient(params[k]);
+		real_t *p = params[k]->ptrw();
+
+		for (int i = 0; i < params[k]->data_size(); ++i) {
+			real_t v = p[i];
+
+			p[i] = v + eps;
+			real_t lp = autodiff_tape_test_loss(hidden, output, input_set, target);
+			p[i] = v - eps;
+			real_t lm = autodiff_tape_test_loss(hidden, output, input_set, target);
+			p[i] = v;
+
+			analytic->push_back(grad->element_get_index(i));
+			numeric->push_back((lp - lm) / (2 * eps));
+		}
+
+		Ref<MLPPVector> bias_grad = tape->get_parameter_gradient_vector(biases[k]);
+		real_t *b = biases[k]->ptrw();
+
+		for (int i = 0; i < biases[k]->size(); ++i) {
+			real_t v = b[i];
+
+			b[i] = v + eps;
+			real_t lp = autodiff_tape_test_loss(hidden, output, input_set, target);
+			b[i] = v - eps;
+			real_t lm = autodiff_tape_test_loss(hidden, output, input_set, target);
+			b[i] = v;
+
+			analytic->push_back(bias_grad->element_get(i));
+			numeric->push_back((lp - lm) / (2 * eps));
+		}
+	}
+
+	is_approx_equals_vec_tolerance(analytic, numeric, 1e-3, "test_autodiff_tape() gradients match central differences");
+
+	// mse and sum, against the closed forms.
+	Ref<MLPPMatrix> w;
+	w.instance();
+	w->resize(Size2i(1, 3));
+	w->fill(0.5);
+
+	Ref<MLPPMatrix> y_col;
+	y_col.instance();
+	y_col->resize(Size2i(1, row_count));
+	y_col->fill(1);
+
+	tape->clear();
+	int mse = tape->mse(tape->matmul(tape->constant(input_set), tape->parameter(w)), tape->constant(y_col));
+	tape->backward(mse);
+
+	// d/dw sum((Xw - y)^2) / (2n) = X^T (Xw - y) / n
+	Ref<MLPPMatrix> expected = input_set->transposen()->multn(input_set->multn(w)->subn(y_col));
+	expected->scalar_multiply(real_t(1) / row_count);
+
+	is_approx_equals_mat(tape->get_parameter_gradient(w), expected, "test_autodiff_tape() mse gradient");
+}
+
+void MLPPTests::test_compiled_ann() {
+	const int row_count = 23;
+
+	Ref<MLPPMatrix> input_set = ann_test_input_set(row_count);
+	Ref<MLPPVector> output_set = ann_test_output_set(input_set);
+
+	Ref<MLPPVector> initial_parameters;
+	real_t initial_bias = 0;
+
+	Ref<MLPPVector> results[2];
+	Ref<MLPPVector> predictions[2];
+
+	// On the layers, then compiled for batches of 5, so the batches of 8 and the full batch run in chunks.
+	for (int k = 0; k < 2; ++k) {
+		Ref<MLPPANN> ann = Ref<MLPPANN>(memnew(MLPPANN(input_set, output_set)));
+		ann->add_layer(6, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::REGULARIZATION_TYPE_RIDGE, 0.01);
+		ann->add_layer(4, MLPPActivation::ACTIVATION_FUNCTION_TANH);
+		ann->add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, MLPPCost::COST_TYPE_LOGISTIC_LOSS);
+
+		if (k > 0) {
+			is_approx_equalsd(ann->compile(5), 1, "test_compiled_ann() compile()");
+		}
+
+		ann_test_train_adam(ann, k, initial_parameters, initial_bias, 20, 8);
+		ann->gradient_descent(0.1, 10);
+
+		results[k] = ann->get_parameter_arena()->checkpoint();
+		results[k]->push_back(ann->get_output_layer()->get_bias());
+		predictions[k] = ann->model_set_test(input_set);
+	}
+
+	is_approx_equals_vec_tolerance(results[0], results[1], 1e-4, "test_compiled_ann() training, same as on the layers");
+	is_approx_equals_vec_tolerance(predictions[0], predictions[1], 1e-4, "test_compiled_ann() model_set_test(), same as on the layers");
+}
+
+void MLPPTests::test_gradient_checkpointing() {
+	const int row_count = 17;
+
+	Ref<MLPPMatrix> input_set = ann_test_input_set(row_count);
+	Ref<MLPPVector> output_set = ann_test_output_set(input_set);
+
+	Ref<MLPPMatrix> output_set_mann;
+	output_set_mann.instance();
+	output_set_mann->resize(Size2i(2, row_count));
+
+	for (int i = 0; i < row_count; ++i) {
+		output_set_mann->element_set(i, 0, input_set->element_get(i, 0) * input_set->element_get(i, 1));
+		output_set_mann->element_set(i, 1, input_set->element_get(i, 2));
+	}
+
+	// 5 hidden layers, everything kept, then checkpoints every 2nd and 3rd layer. The results have to match exactly.
+	const int intervals[3] = { 1, 2, 3 };
+
+	Ref<MLPPVector> initial_parameters;
+	real_t initial_bias = 0;
+
+	Ref<MLPPVector> results[3];
+	Ref<MLPPVector> predictions[3];
+
+	for (int k = 0; k < 3; ++k) {
+		Ref<MLPPANN> ann = Ref<MLPPANN>(memnew(MLPPANN(input_set, output_set)));
+		ann->add_layer(6, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::REGULARIZATION_TYPE_RIDGE, 0.01);
+		ann->add_layer(5, MLPPActivation::ACTIVATION_FUNCTION_TANH);
+		ann->add_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+		ann->add_layer(4, MLPPActivation::ACTIVATION_FUNCTION_TANH);
+		ann->add_layer(4, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+		ann->add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, MLPPCost::COST_TYPE_LOGISTIC_LOSS);
+		ann->set_checkpoint_interval(intervals[k]);
+
+		ann_test_train_adam(ann, k, initial_parameters, initial_bias, 10, 6);
+		ann->gradient_descent(0.1, 10);
+
+		results[k] = ann->get_parameter_arena()->checkpoint();
+		results[k]->push_back(ann->get_output_layer()->get_bias());
+		predictions[k] = ann->model_set_test(input_set);
+
+		// With an interval of 2 the forward pass keeps layers 1, 3 and the last one (4), and releases 0 and 2.
+		if (intervals[k] == 2) {
+			for (int i = 0; i < ann->get_layer_count(); ++i) {
+				bool checkpoint = i == 1 || i >= 3;
+
+				is_approx_equalsd(ann->get_layer(i)->has_activations(), checkpoint, "test_gradient_checkpointing() ANN has_activations() after model_set_test(), interval 2, layer " + itos(i));
+			}
+		}
+	}
+
+	for (int k = 1; k < 3; ++k) {
+		is_approx_equals_vec_tolerance(results[0], results[k], 1e-6, "test_gradient_checkpointing() ANN training, same as keeping every layer");
+		is_approx_equals_vec_tolerance(predictions[0], predictions[k], 1e-6, "test_gradient_checkpointing() ANN model_set_test(), same as keeping every layer");
+	}
+
+	for (int k = 0; k < 3; ++k) {
+		Ref<MLPPMANN> mann = Ref<MLPPMANN>(memnew(MLPPMANN(input_set, output_set_mann)));
+		mann->add_layer(6, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+		mann->add_layer(5, MLPPActivation::ACTIVATION_FUNCTION_TANH);
+		mann->add_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+		mann->add_layer(4, MLPPActivation::ACTIVATION_FUNCTION_TANH);
+		mann->add_layer(4, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+		mann->add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, MLPPCost::COST_TYPE_MSE);
+		mann->set_checkpoint_interval(intervals[k]);
+
+		Ref<MLPPParameterArena> arena = mann->get_parameter_arena();
+
+		if (k == 0) {
+			initial_parameters = arena->checkpoint();
+		} else {
+			arena->restore(initial_parameters);
+		}
+
+		mann->gradient_descent(0.1, 20);
+
+		results[k] = arena->checkpoint();
+	}
+
+	for (int k = 1; k < 3; ++k) {
+		is_approx_equals_vec_tolerance(results[0], results[k], 1e-6, "test_gradient_checkpointing() MANN gradient_descent(), same as keeping every layer");
+	}
+
+	// Releasing frees z, a and delta, but not the input.
+	Ref<MLPPHiddenLayer> layer = Ref<MLPPHiddenLayer>(memnew(MLPPHiddenLayer(4, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, input_set, MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_DEFAULT, MLPPReg::REGULARIZATION_TYPE_NONE, 0, 0)));
+	layer->forward_pass();
+	is_approx_equalsd(layer->has_activations(), 1, "test_gradient_checkpointing() has_activations() after forward_pass()");
+	layer->release_activations();
+	is_approx_equalsd(layer->has_activations(), 0, "test_gradient_checkpointing() has_activations() after release_activations()");
+	is_approx_equalsd(layer->get_input()->data_size(), input_set->data_size(), "test_gradient_checkpointing() release_activations() keeps the input");
+}
+
+// Every range predicts its rows with its own context, on the same model.
+struct InferenceModelTestWork {
+	Ref<MLPPInferenceModel> model;
+	Ref<MLPPMatrix> input;
+	Ref<MLPPVector> output;
+
+	void predict_range(int p_from, int p_to, void *p_userdata) {
+		Ref<MLPPInferenceContext> context = model->create_context();
+
+		int column_count = input->size().x;
+
+		for (int i = p_from; i < p_to; ++i) {
+			model->predict_ptr(input->ptr() + i * column_count, output->ptrw() + i, context.ptr());
+		}
+	}
+};
+
+void MLPPTests::test_inference_model() {
+	const int row_count = 64;
+
+	Ref<MLPPMatrix> input_set = ann_test_input_set(row_count);
+	Ref<MLPPVector> output_set = ann_test_output_set(input_set);
+
+	Ref<MLPPMatrix> output_set_mann;
+	output_set_mann.instance();
+	output_set_mann->resize(Size2i(2, row_count));
+
+	for (int i = 0; i < row_count; ++i) {
+		output_set_mann->element_set(i, 0, input_set->element_get(i, 0) * input_set->element_get(i, 1));
+		output_set_mann->element_set(i, 1, input_set->element_get(i, 2));
+	}
+
+	Ref<MLPPVector> x;
+	x.instance();
+	x->resize(3);
+
+	Ref<MLPPVector> y_hat;
+	y_hat.instance();
+
+	Ref<MLPPANN> ann = Ref<MLPPANN>(memnew(MLPPANN(input_set, output_set)));
+	ann->add_layer(6, MLPPActivation::ACTIVATION_FUNCTION_TANH);
+	ann->add_layer(4, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+	ann->add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, MLPPCost::COST_TYPE_LOGISTIC_LOSS);
+	ann->gradient_descent(0.1, 10);
+
+	Ref<MLPPInferenceModel> model = ann->create_inference_model();
+	Ref<MLPPInferenceContext> context = model->create_context();
+
+	is_approx_equalsd(model->get_layer_count(), 3, "test_inference_model() ANN get_layer_count()");
+	is_approx_equalsd(model->get_input_size(), 3, "test_inference_model() ANN get_input_size()");
+	is_approx_equalsd(model->get_output_size(), 1, "test_inference_model() ANN get_output_size()");
+
+	Ref<MLPPVector> expected;
+	expected.instance();
+	expected->resize(row_count);
+
+	Ref<MLPPVector> predicted;
+	predicted.instance();
+	predicted->resize(row_count);
+
+	for (int i = 0; i < row_count; ++i) {
+		input_set->row_get_into_mlpp_vector(i, x);
+		expected->element_set(i, ann->model_test(x));
+		predicted->element_set(i, model->predict_real(x, context));
+	}
+
+	is_approx_equals_vec_tolerance(expected, predicted, 1e-6, "test_inference_model() ANN predict_real(), same as model_test()");
+
+	// A snapshot, training the ANN further does not change it.
+	ann->gradient_descent(0.1, 10);
+
+	InferenceModelTestWork work;
+	work.model = model;
+	work.input = input_set;
+	work.output.instance();
+	work.output->resize(row_count);
+
+	int thread_count = MLPPParallel::get_thread_count();
+	MLPPParallel::set_thread_count(4);
+	MLPPParallel::do_work(row_count, &work, &InferenceModelTestWork::predict_range, (void *)NULL);
+	MLPPParallel::set_thread_count(thread_count);
+
+	is_approx_equals_vec_tolerance(predicted, work.output, 0, "test_inference_model() ANN predict_ptr() on 4 threads, after more training");
+
+	// MLP.
+	Ref<MLPPMLP> mlp = Ref<MLPPMLP>(memnew(MLPPMLP(input_set, output_set, 5)));
+	mlp->gradient_descent(0.1, 10);
+
+	model = mlp->create_inference_model();
+	context = model->create_context();
+
+	for (int i = 0; i < row_count; ++i) {
+		input_set->row_get_into_mlpp_vector(i, x);
+		expected->element_set(i, mlp->model_test(x));
+		predicted->element_set(i, model->predict_real(x, context));
+	}
+
+	is_approx_equals_vec_tolerance(expected, predicted, 1e-6, "test_inference_model() MLP predict_real(), same as model_test()");
+
+	// MANN, more than one output, with a softmax for the row wise path.
+	Ref<MLPPMANN> mann = Ref<MLPPMANN>(memnew(MLPPMANN(input_set, output_set_mann)));
+	mann->add_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
+	mann->add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_SOFTMAX, MLPPCost::COST_TYPE_CROSS_ENTROPY);
+	mann->gradient_descent(0.1, 10);
+
+	model = mann->create_inference_model();
+	context = model->create_context();
+
+	expected->resize(row_count * 2);
+	predicted->resize(row_count * 2);
+
+	for (int i = 0; i < row_count; ++i) {
+		input_set->row_get_into_mlpp_vector(i, x);
+		model->predict_into(x, y_hat, context);
+
+		Ref<MLPPVector> model_y_hat = mann->model_test(x);
+
+		for (int j = 0; j < 2; ++j) {
+			expected->element_set(i * 2 + j, model_y_hat->element_get(j));
+			predicted->element_set(i * 2 + j, y_hat->element_get(j));
+		}
+	}
+
+	is_approx_equals_vec_tolerance(expected, predicted, 1e-6, "test_inference_model() MANN predict_into(), same as model_test()");
+}
+
+// Every range submits its rows one by one, and waits for each, like independent callers.
+struct InferenceBatcherTestWork {
+	Ref<MLPPInferenceBatcher> batcher;
+	Ref<MLPPMatrix> input;
+	Ref<MLPPMatrix> output;
+
+	void predict_range(int p_from, int p_to, void *p_userdata) {
+		Ref<MLPPVector> x;
+		x.instance();
+		x->resize(input->size().x);
+
+		for (int i = p_from; i < p_to; ++i) {
+			input->row_get_into_mlpp_vector(i, x);
+			output->row_set_mlpp_vector(i, batcher->predict(x));
+		}
+	}
+};
+
+// p_userdata is the output row.
+static void inference_batcher_test_callback(const real_t *p_output, void *p_userdata) {
+	real_t *output_row = static_cast<real_t *>(p_userdata);
+
+	for (int i = 0; i < 3; ++i) {
+		output_row[i] = p_output[i];
+	}
+}
+
+void MLPPTests::test_inference_batcher() {
+	const int row_count = 64;
+
+	Ref<MLPPMatrix> input_set = ann_test_input_set(row_count);
+
+	// One hot, 3 classes.
+	Ref<MLPPMatrix> output_set;
+	output_set.instance();
+	output_set->resize(Size2i(3, row_count));
+	output_set->fill(0);
+
+	for (int i = 0; i < row_count; ++i) {
+		real_t a = input_set->element_get(i, 0);
+		real_t b = input_set->element_get(i, 1);
+		real_t c = input_set->element_get(i, 2);
+
+		output_set->element_set(i, a > b ? 0 : (c > real_t(0.5) ? 1 : 2), 1);
+	}
+
+	Ref<MLPPSoftmaxNet> net = Ref<MLPPSoftmaxNet>(memnew(MLPPSoftmaxNet(input_set, output_set, 5)));
+	net->train_gradient_descent(0.1, 10);
+
+	Ref<MLPPInferenceModel> model = net->create_inference_model();
+	Ref<MLPPInferenceContext> context = model->create_context();
+
+	Ref<MLPPVector> x;
+	x.instance();
+	x->resize(3);
+
+	Ref<MLPPVector> y_hat;
+	y_hat.instance();
+
+	Ref<MLPPMatrix> expected;
+	expected.instance();
+	expected->resize(Size2i(3, row_count));
+
+	Ref<MLPPMatrix> net_expected;
+	net_expected.instance();
+	net_expected->resize(Size2i(3, row_count));
+
+	for (int i = 0; i < row_count; ++i) {
+		input_set->row_get_into_mlpp_vector(i, x);
+		model->predict_into(x, y_hat, context);
+
+		expected->row_set_mlpp_vector(i, y_hat);
+		net_expected->row_set_mlpp_vector(i, net->model_test(x));
+	}
+
+	Ref<MLPPVector> flat_expected = expected->flatten();
+	is_approx_equals_vec_tolerance(net_expected->flatten(), flat_expected, 1e-6, "test_inference_batcher() softmax net snapshot, same as model_test()");
+
+	// Batches of 16, the same as one by one.
+	is_approx_equals_mat(expected, model->predict_batch(input_set, model->create_context(16)), "test_inference_batcher() predict_batch()");
+
+	Ref<MLPPInferenceBatcher> batcher;
+	batcher.instance();
+	batcher->start(model, 16, 100000);
+
+	// Submitted all at once, they have to be batched.
+	Vector<Ref<MLPPInferenceRequest>> requests;
+
+	for (int i = 0; i < row_count; ++i) {
+		input_set->row_get_into_mlpp_vector(i, x);
+		requests.push_back(batcher->submit(x));
+	}
+
+	Ref<MLPPMatrix> result;
+	result.instance();
+	result->resize(Size2i(3, row_count));
+
+	for (int i = 0; i < row_count; ++i) {
+		Ref<MLPPInferenceRequest> request = requests[i];
+
+		request->wait();
+		result->row_set_mlpp_vector(i, request->get_output());
+	}
+
+	is_approx_equals_mat(expected, result, "test_inference_batcher() submit()");
+	is_approx_equalsd(batcher->get_sample_count(), row_count, "test_inference_batcher() get_sample_count()");
+	is_approx_equalsd(batcher->get_batch_count() < row_count, 1, "test_inference_batcher() samples get batched");
+
+	// From 4 threads, waiting for every sample, so only a short wait is worth it.
+	batcher->stop();
+	batcher->start(model, 16, 1000);
+
+	InferenceBatcherTestWork work;
+	work.batcher = batcher;
+	work.input = input_set;
+	work.output.instance();
+	work.output->resize(Size2i(3, row_count));
+
+	int thread_count = MLPPParallel::get_thread_count();
+	MLPPParallel::set_thread_count(4);
+	MLPPParallel::do_work(row_count, &work, &InferenceBatcherTestWork::predict_range, (void *)NULL);
+	MLPPParallel::set_thread_count(thread_count);
+
+	is_approx_equals_mat(expected, work.output, "test_inference_batcher() predict() from 4 threads");
+
+	// Callbacks, stop() runs everything that is still waiting.
+	result->fill(0);
+
+	for (int i = 0; i < row_count; ++i) {
+		batcher->submit_callback(input_set->ptr() + i * 3, &inference_batcher_test_callback, result->ptrw() + i * 3);
+	}
+
+	batcher->stop();
+
+	is_approx_equals_mat(expected, result, "test_inference_batcher() submit_callback()");
+	is_approx_equalsd(batcher->is_running(), 0, "test_inference_batcher() stop()");
+}
+
+void MLPPTests::test_dynamically_sized_mann(bool ui) {
+	MLPPLinAlg alg;
+	MLPPData data;
+
+	// DYNAMICALLY SIZED MANN (Multidimensional Output ANN)
+	std::vector<std::vector<real_t>> inputSet = { { 1, 2, 3 }, { 2, 4, 6 }, { 3, 6, 9 }, { 4, 8, 12 } };
+	std::vector<std::vector<real_t>> outputSet = { { 1, 5 }, { 2, 10 }, { 3, 15 }, { 4, 20 } };
+
+	Ref<MLPPMatrix> input_set;
+	input_set.instance();
+	input_set->set_from_std_vectors(inputSet);
+
+	Ref<MLPPMatrix> output_set;
+	output_set.instance();
+	output_set->set_from_std_vectors(outputSet);
+
+	MLPPMANN mann(input_set, output_set);
+	mann.add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_LINEAR, MLPPCost::COST_TYPE_MSE);
+	mann.gradient_descent(0.001, 80000, false);
+	PLOG_MSG(mann.model_set_test(input_set)->to_string());
+	PLOG_MSG("ACCURACY: " + String::num(100 * mann.score()) + "%");
+}
+void MLPPTests::test_train_test_split_mann(bool ui) {
+	MLPPLinAlg alg;
+	MLPPLinAlg algn;
+	MLPPData data;
+
+	// TRAIN TEST SPLIT CHECK
+	std::vector<std::vector<real_t>> inputSet1 = { { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 }, { 3, 5, 9, 12, 15, 18, 21, 24, 27, 30 } };
+	std::vector<std::vector<real_t>> outputSet1 = { { 2, 4, 6, 8, 10, 12, 14, 16, 18, 20 } };
+
+	Ref<MLPPMatrix> input_set_1;
+	input_set_1.instance();
+	input_set_1->set_from_std_vectors(inputSet1);
+
+	Ref<MLPPMatrix> output_set_1;
+	output_set_1.instance();
+	output_set_1->set_from_std_vectors(outputSet1);
+
+	Ref<MLPPDataComplex> d;
+	d.instance();
+
+	d->set_input(algn.transposenm(input_set_1));
+	d->set_output(algn.transposenm(output_set_1));
+
+	MLPPData::SplitComplexData split_data = data.train_test_split(d, 0.2);
+
+	PLOG_MSG(split_data.train->get_input()->to_string());
+	PLOG_MSG(split_data.train->get_output()->to_string());
+	PLOG_MSG(split_data.test->get_input()->to_string());
+	PLOG_MSG(split_data.test->get_output()->to_string());
+
+	MLPPMANN mann(split_data.train->get_input(), split_data.train->get_output());
+	mann.add_layer(100, MLPPActivation::ACTIVATION_FUNCTION_RELU, MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_XAVIER_NORMAL);
+	mann.add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_SOFTMAX, MLPPCost::COST_TYPE_CROSS_ENTROPY, MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_XAVIER_NORMAL);
+	mann.gradient_descent(0.1, 80000, ui);
+	PLOG_MSG(mann.model_set_test(split_data.test->get_input())->to_string());
+	PLOG_MSG("ACCURACY: " + String::num(100 * mann.score()) + "%");
+}
+
+void MLPPTests::test_naive_bayes() {
+	MLPPLinAlg alg;
+	MLPPLinAlg algn;
+
+	// NAIVE BAYES
+	std::vector<std::vector<real_t>> inputSet = { { 1, 1, 1, 1, 1 }, { 0, 0, 1, 1, 1 }, { 0, 0, 1, 0, 1 } };
+	std::vector<real_t> outputSet = { 0, 1, 0, 1, 1 };
+
+	Ref<MLPPMatrix> input_set;
+	input_set.instance();
+	input_set->set_from_std_vectors(inputSet);
+	input_set = input_set->transposen();
+
+	Ref<MLPPVector> output_set;
+	output_set.instance();
+	output_set->set_from_std_vector(outputSet);
+
+	ERR_PRINT("MLPPMultinomialNB");
+
+	MLPPMultinomialNB MNB(input_set, output_set, 2);
+	PLOG_MSG(MNB.model_set_test(input_set)->to_string());
+
+	ERR_PRINT("MLPPBernoulliNB");
+
+	MLPPBernoulliNB BNB(input_set, output_set);
+	PLOG_MSG(BNB.model_set_test(input_set)->to_string());
+
+	ERR_PRINT("MLPPGaussianNB");
+
+	MLPPGaussianNB GNB(input_set, output_set, 2);
+	PLOG_MSG(GNB.model_set_test(input_set)->to_string());
+}
+void MLPPTests::test_k_means(bool ui) {
+	// KMeans
+	std::vector<std::vector<real_t>> inputSet = { { 32, 0, 7 }, { 2, 28, 17 }, { 0, 9, 23 } };
+
+	Ref<MLPPMatrix> input_set;
+	input_set.instance();
+	input_set->set_from_std_vectors(inputSet);
+
+	Ref<MLPPKMeans> kmeans;
+	kmeans.instance();
+	kmeans->set_input_set(input_set);
+	kmeans->set_k(3);
+	kmeans->set_mean_type(MLPPKMeans::MEAN_TYPE_KMEANSPP);
+
+	kmeans->train(3, ui);
+
+	PLOG_MSG(kmeans->model_set_test(input_set)->to_string());
+	PLOG_MSG(kmeans->silhouette_scores()->to_string());
+}
+void MLPPTests::test_knn(bool ui) {
+	MLPPLinAlg alg;
+
+	// kNN
+	std::vector<std::vector<real_t>> inputSet = {
+		{ 1, 2, 3, 4, 5, 6, 7, 8 },
+		{ 0, 0, 0, 0, 1, 1, 1, 1 }
+	};
+	std::vector<real_t> outputSet = { 0, 0, 0, 0, 1, 1, 1, 1 };
+
+	Ref<MLPPMatrix> ism;
+	ism.instance();
+	ism->set_from_std_vectors(inputSet);
+	ism = ism->transposen();
+
+	//ERR_PRINT(ism->to_string());
+
+	Ref<MLPPVector> osm;
+	osm.instance();
+	osm->set_from_std_vector(outputSet);
+
+	//ERR_PRINT(osm->to_string());
+
+	Ref<MLPPKNN> knn;
+	knn.instance();
+
+	knn->set_k(7);
+	knn->set_input_set(ism);
+	knn->set_output_set(osm);
+
+	PoolIntArray res = knn->model_set_test(ism);
+
+	ERR_PRINT(String(Variant(res)));
+	ERR_PRINT("ACCURACY: " + itos(100 * knn->score()) + "%");
+
+	//(alg.transpose(inputSet), outputSet, 8);
+	//alg.printVector(knn.modelSetTest(alg.transpose(inputSet)));
+	//std::cout << "ACCURACY: " << 100 * knn.score() << "%" << std::endl;
+}
+
+void MLPPTests::test_convolution_tensors_etc() {
+	MLPPLinAlg alg;
+	MLPPLinAlg algn;
+	MLPPData data;
+	MLPPConvolutions conv;
+	MLPPTransforms trans;
+
+	// CONVOLUTION, POOLING, ETC..
+	const real_t input_arr[] = {
+		1,
+	};
+
+	Ref<MLPPMatrix> input = Ref<MLPPMatrix>(memnew(MLPPMatrix(input_arr, 1, 1)));
+
+	Ref<MLPPTensor3> tensor_set;
+	tensor_set.instance();
+	tensor_set->resize(Size3i(1, 1, 0));
+	tensor_set->z_slice_add_mlpp_matrix(input);
+	tensor_set->z_slice_add_mlpp_matrix(input);
+	tensor_set->z_slice_add_mlpp_matrix(input);
+
+	ERR_PRINT("TODO data.rgb2xyz(tensor_set)");
+	//ERR_PRINT(data.rgb2xyz(tensor_set)->to_string());
+
+	const real_t input2_arr[] = {
+		62, 55, 55, 54, 49, 48, 47, 55, //
+		62, 57, 54, 52, 48, 47, 48, 53, //
+		61, 60, 52, 49, 48, 47, 49, 54, //
+		63, 61, 60, 60, 63, 65, 68, 65, //
+		67, 67, 70, 74, 79, 85, 91, 92, //
+		82, 95, 101, 106, 114, 115, 112, 117, //
+		96, 111, 115, 119, 128, 128, 130, 127, //
+		109, 121, 127, 133, 139, 141, 140, 133, //
+	};
+
+	Ref<MLPPMatrix> input2 = Ref<MLPPMatrix>(memnew(MLPPMatrix(input2_arr, 8, 8)));
+
+	ERR_PRINT(trans.discrete_cosine_transform(input2)->to_string());
+
+	ERR_PRINT(conv.convolve_2d(input2, conv.get_prewitt_vertical(), 1)->to_string()); // Can use padding
+	ERR_PRINT(conv.pool_2d(input2, 4, 4, MLPPConvolutions::POOL_TYPE_MAX)->to_string()); // Can use Max, Min, or Average pooling.
+
+	Ref<MLPPTensor3> tensor_set2;
+	tensor_set2.instance();
+	tensor_set2->resize(Size3i(8, 8, 0));
+	tensor_set2->z_slice_add_mlpp_matrix(input2);
+	tensor_set2->z_slice_add_mlpp_matrix(input2);
+
+	ERR_PRINT(conv.global_pool_3d(tensor_set2, MLPPConvolutions::POOL_TYPE_AVERAGE)->to_string()); // Can use Max, Min, or Average global pooling.
+
+	const real_t laplacian_arr[] = {
+		1, 1, 1, //
+		1, -4, 1, //
+		1, 1, 1 //
+	};
+
+	Ref<MLPPMatrix> laplacian = Ref<MLPPMatrix>(memnew(MLPPMatrix(laplacian_arr, 3, 3)));
+
+	ERR_PRINT(conv.convolve_2d(conv.gaussian_filter_2d(5, 1), laplacian, 1)->to_string());
+}
+void MLPPTests::test_convolutions() {
+	MLPPConvolutions conv;
+
+	const real_t input_arr[] = {
+		1, 2, 3, 4, //
+		5, 6, 7, 8, //
+		9, 10, 11, 12, //
+	};
+	const real_t box_arr[] = {
+		1, 1, //
+		1, 1, //
+	};
+	const real_t box_s2_p1_res_arr[] = {
+		1, 5, 4, //
+		14, 34, 20, //
+	};
+
+	Ref<MLPPMatrix> input(memnew(MLPPMatrix(input_arr, 3, 4)));
+	Ref<MLPPMatrix> box(memnew(MLPPMatrix(box_arr, 2, 2)));
+	Ref<MLPPMatrix> box_s2_p1_res(memnew(MLPPMatrix(box_s2_p1_res_arr, 2, 3)));
+
+	is_approx_equals_mat(conv.convolve_2d(input, box, 2, 1), box_s2_p1_res, "conv.convolve_2d(input, box, 2, 1)");
+
+	// Multi channel, multi filter batch against a direct implementation.
+	const Size3i input_size = Size3i(7, 5, 3);
+	const int filter_count = 5;
+	const int F = 3;
+	const int S = 1;
+	const int P = 1;
+
+	Ref<MLPPTensor3> filter;
+	filter.instance();
+	filter->resize(Size3i(F, F, input_size.z * filter_count));
+
+	for (int i = 0; i < filter->data_size(); ++i) {
+		filter->element_set_index(i, Math::sin(static_cast<real_t>(i)));
+	}
+
+	Vector<Ref<MLPPTensor3>> inputs;
+
+	for (int b = 0; b < 3; ++b) {
+		Ref<MLPPTensor3> in;
+		in.instance();
+		in->resize(input_size);
+
+		for (int i = 0; i < in->data_size(); ++i) {
+			in->element_set_index(i, Math::cos(static_cast<real_t>(i * (b + 1))));
+		}
+
+		inputs.push_back(in);
+	}
+
+	Vector<Ref<MLPPTensor3>> outputs = conv.convolve_3d_batch(inputs, filter, S, P);
+
+	for (int b = 0; b < inputs.size(); ++b) {
+		Ref<MLPPTensor3> in = inputs[b];
+
+		Ref<MLPPTensor3> expected;
+		expected.instance();
+		expected->resize(Size3i((input_size.x - F + 2 * P) / S + 1, (input_size.y - F + 2 * P) / S + 1, filter_count));
+
+		for (int f = 0; f < filter_count; ++f) {
+			for (int i = 0; i < expected->size().y; ++i) {
+				for (int j = 0; j < expected->size().x; ++j) {
+					real_t sum = 0;
+
+					for (int c = 0; c < input_size.z; ++c) {
+						for (int k = 0; k < F; ++k) {
+							for (int l = 0; l < F; ++l) {
+								int y = i * S - P + k;
+								int x = j * S - P + l;
+
+								if (y >= 0 && y < input_size.y && x >= 0 && x < input_size.x) {
+									sum += in->element_get(c, y, x) * filter->element_get(f * input_size.z + c, k, l);
+								}
+							}
+						}
+					}
+
+					expected->element_set(f, i, j, sum);
+				}
+			}
+		}
+
+		is_approx_equals_vec(outputs[b]->flatten(), expected->flatten(), "conv.convolve_3d_batch(inputs, filter, S, P)[" + itos(b) + "]");
+	}
+
+	// Winograd F(2x2, 3x3) against im2col. Odd output sizes, so partial output tiles are covered too.
+	for (int p = 0; p < 2; ++p) {
+		conv.set_convolution_algorithm(MLPPConvolutions::CONVOLUTION_ALGORITHM_IM2COL);
+		Ref<MLPPTensor3> im2col_res = conv.convolve_3d(inputs[1], filter, 1, p);
+		Ref<MLPPMatrix> im2col_sobel_res = conv.convolve_2d(input, conv.get_sobel_vertical(), 1, p);
+
+		conv.set_convolution_algorithm(MLPPConvolutions::CONVOLUTION_ALGORITHM_WINOGRAD);
+		Ref<MLPPTensor3> winograd_res = conv.convolve_3d(inputs[1], filter, 1, p);
+		Ref<MLPPMatrix> winograd_sobel_res = conv.convolve_2d(input, conv.get_sobel_vertical(), 1, p);
+
+		is_approx_equals_vec_tolerance(winograd_res->flatten(), im2col_res->flatten(), 1e-4, "conv.convolve_3d(inputs[1], filter, 1, " + itos(p) + ") winograd");
+		is_approx_equals_vec_tolerance(winograd_sobel_res->flatten(), im2col_sobel_res->flatten(), 1e-4, "conv.convolve_2d(input, sobel, 1, " + itos(p) + ") winograd");
+	}
+
+	// FFT against im2col, with a large filter, strides, and padding.
+	Ref<MLPPMatrix> gaussian = conv.gaussian_filter_2d(7, 1);
+	Ref<MLPPMatrix> image;
+	image.instance();
+	image->resize(Size2i(19, 13));
+
+	for (int i = 0; i < image->data_size(); ++i) {
+		image->element_set_index(i, Math::sin(static_cast<real_t>(i) * real_t(0.3)));
+	}
+
+	for (int s = 1; s <= 2; ++s) {
+		conv.set_convolution_algorithm(MLPPConvolutions::CONVOLUTION_ALGORITHM_IM2COL);
+		Ref<MLPPMatrix> im2col_res = conv.convolve_2d(image, gaussian, s, 3);
+		Ref<MLPPTensor3> im2col_res_3d = conv.convolve_3d(inputs[0], filter, s, 2);
+
+		conv.set_convolution_algorithm(MLPPConvolutions::CONVOLUTION_ALGORITHM_FFT);
+		Ref<MLPPMatrix> fft_res = conv.convolve_2d(image, gaussian, s, 3);
+		Ref<MLPPTensor3> fft_res_3d = conv.convolve_3d(inputs[0], filter, s, 2);
+
+		is_approx_equals_vec_tolerance(fft_res->flatten(), im2col_res->flatten(), 1e-4, "conv.convolve_2d(image, gaussian, " + itos(s) + ", 3) fft");
+		is_approx_equals_vec_tolerance(fft_res_3d->flatten(), im2col_res_3d->flatten(), 1e-4, "conv.convolve_3d(inputs[0], filter, " + itos(s) + ", 2) fft");
+	}
+
+	// The same batch stacked along z, with every algorithm.
+	Ref<MLPPTensor3> stacked_inputs;
+	stacked_inputs.instance();
+	stacked_inputs->resize(Size3i(input_size.x, input_size.y, input_size.z * inputs.size()));
+
+	for (int b = 0; b < inputs.size(); ++b) {
+		for (int i = 0; i < inputs[b]->data_size(); ++i) {
+			stacked_inputs->element_set_index(b * inputs[b]->data_size() + i, inputs[b]->element_get_index(i));
+		}
+	}
+
+	const MLPPConvolutions::ConvolutionAlgorithm stacked_algorithms[] = { MLPPConvolutions::CONVOLUTION_ALGORITHM_IM2COL, MLPPConvolutions::CONVOLUTION_ALGORITHM_WINOGRAD, MLPPConvolutions::CONVOLUTION_ALGORITHM_FFT };
+
+	for (int a = 0; a < 3; ++a) {
+		conv.set_convolution_algorithm(stacked_algorithms[a]);
+
+		Ref<MLPPTensor3> stacked_outputs = conv.convolve_3d_stacked(stacked_inputs, input_size.z, filter, S, P);
+
+		is_approx_equalsd(stacked_outputs->size().z, filter_count * inputs.size(), "conv.convolve_3d_stacked(stacked_inputs, input_size.z, filter, S, P) z size algorithm: " + itos(stacked_algorithms[a]));
+
+		for (int b = 0; b < outputs.size(); ++b) {
+			Ref<MLPPVector> stacked_output;
+			stacked_output.instance();
+			stacked_output->resize(outputs[b]->data_size());
+
+			for (int i = 0; i < outputs[b]->data_size(); ++i) {
+				stacked_output->element_set(i, stacked_outputs->element_get_index(b * outputs[b]->data_size() + i));
+			}
+
+			is_approx_equals_vec_tolerance(stacked_output, outputs[b]->flatten(), 1e-4, "conv.convolve_3d_stacked(stacked_inputs, input_size.z, filter, S, P)[" + itos(b) + "] algorithm: " + itos(stacked_algorithms[a]));
+		}
+	}
+
+	// Separable filters
+	Ref<MLPPVector> vertical;
+	vertical.instance();
+	Ref<MLPPVector> horizontal;
+	horizontal.instance();
+
+	const real_t laplacian_arr[] = {
+		1, 1, 1, //
+		1, -4, 1, //
+		1, 1, 1 //
+	};
+
+	Ref<MLPPMatrix> laplacian(memnew(MLPPMatrix(laplacian_arr, 3, 3)));
+
+	is_approx_equalsd(conv.separable_filter_decompose(conv.get_sobel_horizontal(), vertical, horizontal), 1, "conv.separable_filter_decompose(conv.get_sobel_horizontal())");
+	is_approx_equals_mat(vertical->outer_product(horizontal), conv.get_sobel_horizontal(), "vertical->outer_product(horizontal)");
+	is_approx_equalsd(conv.separable_filter_decompose(laplacian, vertical, horizontal), 0, "conv.separable_filter_decompose(laplacian)");
+
+	Ref<MLPPVector> gaussian_1d = conv.gaussian_filter_1d(7, 1);
+	is_approx_equals_mat(gaussian_1d->outer_product(gaussian_1d), gaussian, "gaussian_1d->outer_product(gaussian_1d)");
+
+	// Even sizes are centered between the two middle taps.
+	Ref<MLPPVector> gaussian_1d_even = conv.gaussian_filter_1d(4, 1);
+	Ref<MLPPMatrix> gaussian_even = conv.gaussian_filter_2d(4, 1);
+	is_approx_equals_mat(gaussian_1d_even->outer_product(gaussian_1d_even), gaussian_even, "gaussian_1d_even->outer_product(gaussian_1d_even)");
+	is_approx_equalsd(gaussian_1d_even->element_get(1), gaussian_1d_even->element_get(2), "conv.gaussian_filter_1d(4, 1) symmetric");
+	is_approx_equalsd(gaussian_even->element_get(0, 0), gaussian_even->element_get(3, 3), "conv.gaussian_filter_2d(4, 1) symmetric");
+
+	for (int s = 1; s <= 2; ++s) {
+		conv.set_convolution_algorithm(MLPPConvolutions::CONVOLUTION_ALGORITHM_IM2COL);
+		Ref<MLPPMatrix> im2col_res = conv.convolve_2d(image, gaussian, s, 2);
+		Ref<MLPPMatrix> im2col_sobel_res = conv.convolve_2d(image, conv.get_sobel_vertical(), s, 1);
+
+		conv.set_convolution_algorithm(MLPPConvolutions::CONVOLUTION_ALGORITHM_SEPARABLE);
+		Ref<MLPPMatrix> separable_res = conv.convolve_2d(image, gaussian, s, 2);
+		Ref<MLPPMatrix> separable_sobel_res = conv.convolve_2d(image, conv.get_sobel_vertical(), s, 1);
+
+		is_approx_equals_vec_tolerance(separable_res->flatten(), im2col_res->flatten(), 1e-4, "conv.convolve_2d(image, gaussian, " + itos(s) + ", 2) separable");
+		is_approx_equals_vec_tolerance(separable_sobel_res->flatten(), im2col_sobel_res->flatten(), 1e-4, "conv.convolve_2d(image, sobel, " + itos(s) + ", 1) separable");
+		is_approx_equals_vec_tolerance(conv.convolve_2d_separable(image, gaussian_1d, gaussian_1d, s, 2)->flatten(), im2col_res->flatten(), 1e-4, "conv.convolve_2d_separable(image, gaussian_1d, gaussian_1d, " + itos(s) + ", 2)");
+	}
+
+	// The separable check is cached per filter, a changed filter of the same size must not hit it.
+	Ref<MLPPMatrix> gaussian_changed = gaussian->duplicate_fast();
+	gaussian_changed->element_set(0, 0, 1);
+
+	conv.set_convolution_algorithm(MLPPConvolutions::CONVOLUTION_ALGORITHM_IM2COL);
+	Ref<MLPPMatrix> im2col_changed_res = conv.convolve_2d(image, gaussian_changed, 1, 2);
+
+	conv.set_convolution_algorithm(MLPPConvolutions::CONVOLUTION_ALGORITHM_SEPARABLE);
+	conv.convolve_2d(image, gaussian, 1, 2);
+	is_approx_equals_vec_tolerance(conv.convolve_2d(image, gaussian_changed, 1, 2)->flatten(), im2col_changed_res->flatten(), 1e-4, "conv.convolve_2d(image, gaussian_changed, 1, 2) separable cache");
+
+	// Border modes, against the same image padded explicitly, and convolved / pooled without padding.
+	const int BP = 3;
+	const MLPPConvolutions::ConvolutionAlgorithm algorithms[] = {
+		MLPPConvolutions::CONVOLUTION_ALGORITHM_IM2COL,
+		MLPPConvolutions::CONVOLUTION_ALGORITHM_WINOGRAD,
+		MLPPConvolutions::CONVOLUTION_ALGORITHM_FFT,
+		MLPPConvolutions::CONVOLUTION_ALGORITHM_SEPARABLE,
+	};
+
+	for (int mode = MLPPConvolutions::BORDER_MODE_ZERO; mode <= MLPPConvolutions::BORDER_MODE_WRAP; ++mode) {
+		Ref<MLPPMatrix> padded_image;
+		padded_image.instance();
+		padded_image->resize(Size2i(image->size().x + 2 * BP, image->size().y + 2 * BP));
+		padded_image->fill(0);
+
+		for (int i = 0; i < padded_image->size().y; ++i) {
+			for (int j = 0; j < padded_image->size().x; ++j) {
+				int y = i - BP;
+				int x = j - BP;
+				int h = image->size().y;
+				int w = image->size().x;
+
+				if (mode == MLPPConvolutions::BORDER_MODE_ZERO && (y < 0 || y >= h || x < 0 || x >= w)) {
+					continue;
+				} else if (mode == MLPPConvolutions::BORDER_MODE_REPLICATE) {
+					y = CLAMP(y, 0, h - 1);
+					x = CLAMP(x, 0, w - 1);
+				} else if (mode == MLPPConvolutions::BORDER_MODE_REFLECT) {
+					y = y < 0 ? -y : (y >= h ? 2 * (h - 1) - y : y);
+					x = x < 0 ? -x : (x >= w ? 2 * (w - 1) - x : x);
+				} else if (mode == MLPPConvolutions::BORDER_MODE_WRAP) {
+					y = (y + h) % h;
+					x = (x + w) % w;
+				}
+
+				padded_image->element_set(i, j, image->element_get(y, x));
+			}
+		}
+
+		String mode_str = " border mode " + itos(mode);
+
+		for (int s = 1; s <= 2; ++s) {
+			conv.set_border_mode(MLPPConvolutions::BORDER_MODE_ZERO);
+			conv.set_convolution_algorithm(MLPPConvolutions::CONVOLUTION_ALGORITHM_IM2COL);
+			Ref<MLPPMatrix> expected = conv.convolve_2d(padded_image, gaussian, s, 0);
+			Ref<MLPPMatrix> expected_sobel = conv.convolve_2d(padded_image, conv.get_sobel_vertical(), s, 0);
+			Ref<MLPPMatrix> expected_pool = conv.pool_2d(padded_image, 3, s, MLPPConvolutions::POOL_TYPE_MAX);
+			Ref<MLPPMatrix> expected_average_pool = conv.pool_2d(padded_image, 2, s, MLPPConvolutions::POOL_TYPE_AVERAGE);
+
+			conv.set_border_mode(static_cast<MLPPConvolutions::BorderMode>(mode));
+
+			for (int a = 0; a < 4; ++a) {
+				conv.set_convolution_algorithm(algorithms[a]);
+
+				String str = " algorithm " + itos(algorithms[a]) + mode_str;
+
+				is_approx_equals_vec_tolerance(conv.convolve_2d(image, gaussian, s, BP)->flatten(), expected->flatten(), 1e-4, "conv.convolve_2d(image, gaussian, " + itos(s) + ", BP)" + str);
+				is_approx_equals_vec_tolerance(conv.convolve_2d(image, conv.get_sobel_vertical(), s, BP)->flatten(), expected_sobel->flatten(), 1e-4, "conv.convolve_2d(image, sobel, " + itos(s) + ", BP)" + str);
+			}
+
+			is_approx_equals_vec_tolerance(conv.pool_2d(image, 3, s, MLPPConvolutions::POOL_TYPE_MAX, BP)->flatten(), expected_pool->flatten(), 1e-4, "conv.pool_2d(image, 3, " + itos(s) + ", MAX, BP)" + mode_str);
+			is_approx_equals_vec_tolerance(conv.pool_2d(image, 2, s, MLPPConvolutions::POOL_TYPE_AVERAGE, BP)->flatten(), expected_average_pool->flatten(), 1e-4, "conv.pool_2d(image, 2, " + itos(s) + ", AVERAGE, BP)" + mode_str);
+		}
+	}
+
+	conv.set_border_mode(MLPPConvolutions::BORDER_MODE_ZERO);
+	conv.set_convolution_algorithm(MLPPConvolutions::CONVOLUTION_ALGORITHM_AUTO);
+
+	// Pooling (sliding window, integral image, and direct kernels) against a direct implementation.
+	for (int type = MLPPConvolutions::POOL_TYPE_AVERAGE; type <= MLPPConvolutions::POOL_TYPE_MAX; ++type) {
+		for (int s = 1; s <= 4; ++s) {
+			const int PF = 4;
+			const int PP = 1;
+
+			Ref<MLPPTensor3> pooled = conv.pool_3d(inputs[2], PF, s, static_cast<MLPPConvolutions::PoolType>(type), PP);
+
+			Ref<MLPPTensor3> expected;
+			expected.instance();
+			expected->resize(Size3i((input_size.x - PF + 2 * PP) / s + 1, (input_size.y - PF + 2 * PP) / s + 1, input_size.z));
+
+			for (int c = 0; c < input_size.z; ++c) {
+				for (int i = 0; i < expected->size().y; ++i) {
+					for (int j = 0; j < expected->size().x; ++j) {
+						real_t sum = 0;
+						real_t min_val = 1e10;
+						real_t max_val = -1e10;
+
+						for (int k = 0; k < PF; ++k) {
+							for (int l = 0; l < PF; ++l) {
+								int y = i * s - PP + k;
+								int x = j * s - PP + l;
+								real_t val = 0;
+
+								if (y >= 0 && y < input_size.y && x >= 0 && x < input_size.x) {
+									val = inputs[2]->element_get(c, y, x);
+								}
+
+								sum += val;
+								min_val = MIN(min_val, val);
+								max_val = MAX(max_val, val);
+							}
+						}
+
+						if (type == MLPPConvolutions::POOL_TYPE_AVERAGE) {
+							expected->element_set(c, i, j, sum / (PF * PF));
+						} else if (type == MLPPConvolutions::POOL_TYPE_MIN) {
+							expected->element_set(c, i, j, min_val);
+						} else {
+							expected->element_set(c, i, j, max_val);
+						}
+					}
+				}
+			}
+
+			is_approx_equals_vec_tolerance(pooled->flatten(), expected->flatten(), 1e-5, "conv.pool_3d(inputs[2], 4, " + itos(s) + ", " + itos(type) + ", 1)");
+		}
+	}
+
+	const real_t global_pool_input_arr[] = {
+		1, -2, //
+		3, 6, //
+
+		-1, 0, //
+		4, 5, //
+	};
+
+	Ref<MLPPTensor3> global_pool_input;
+	global_pool_input.instance();
+	global_pool_input->resize(Size3i(2, 2, 2));
+
+	for (int i = 0; i < 8; ++i) {
+		global_pool_input->element_set_index(i, global_pool_input_arr[i]);
+	}
+
+	const real_t global_pool_min_arr[] = { -2, -1 };
+	const real_t global_pool_average_arr[] = { 2, 2 };
+
+	is_approx_equals_vec(conv.global_pool_3d(global_pool_input, MLPPConvolutions::POOL_TYPE_MIN), Ref<MLPPVector>(memnew(MLPPVector(global_pool_min_arr, 2))), "conv.global_pool_3d(global_pool_input, MIN)");
+	is_approx_equals_vec(conv.global_pool_3d(global_pool_input, MLPPConvolutions::POOL_TYPE_AVERAGE), Ref<MLPPVector>(memnew(MLPPVector(global_pool_average_arr, 2))), "conv.global_pool_3d(global_pool_input, AVERAGE)");
+
+	// Fused gradients and harris, against the unfused pipeline.
+	Ref<MLPPMatrix> x_deriv = conv.dx(image);
+	Ref<MLPPMatrix> y_deriv = conv.dy(image);
+	Ref<MLPPMatrix> gaussian_3 = conv.gaussian_filter_2d(3, 1);
+
+	Vector<Ref<MLPPMatrix>> m = conv.compute_mv(image);
+
+	is_approx_equals_vec_tolerance(m[0]->flatten(), conv.convolve_2d(x_deriv->hadamard_productn(x_deriv), gaussian_3, 1, 1)->flatten(), 1e-4, "conv.compute_mv(image)[0]");
+	is_approx_equals_vec_tolerance(m[1]->flatten(), conv.convolve_2d(y_deriv->hadamard_productn(y_deriv), gaussian_3, 1, 1)->flatten(), 1e-4, "conv.compute_mv(image)[1]");
+	is_approx_equals_vec_tolerance(m[2]->flatten(), conv.convolve_2d(x_deriv->hadamard_productn(y_deriv), gaussian_3, 1, 1)->flatten(), 1e-4, "conv.compute_mv(image)[2]");
+
+	Ref<MLPPMatrix> trace = m[0]->addn(m[1]);
+	Ref<MLPPMatrix> response = m[0]->hadamard_productn(m[1])->subn(m[2]->hadamard_productn(m[2]))->subn(trace->hadamard_productn(trace)->scalar_multiplyn(0.05));
+
+	is_approx_equals_vec_tolerance(conv.harris_corners(image).response->flatten(), response->flatten(), 1e-4, "conv.harris_corners(image).response");
+
+	MLPPConvolutions::GradientResult gradient = conv.grad_magnitude_orientation(image);
+
+	is_approx_equals_mat(gradient.magnitude, x_deriv->hadamard_productn(x_deriv)->addn(y_deriv->hadamard_productn(y_deriv))->sqrtn(), "conv.grad_magnitude_orientation(image).magnitude");
+	is_approx_equals_mat(conv.grad_orientation(image), gradient.orientation, "conv.grad_orientation(image)");
+	is_approx_equalsd(gradient.orientation->element_get(4, 5), Math::atan2(y_deriv->element_get(4, 5), x_deriv->element_get(4, 5)), "conv.grad_magnitude_orientation(image).orientation");
+
+	// A bright square has exactly one keypoint at each of its corners.
+	Ref<MLPPMatrix> square;
+	square.instance();
+	square->resize(Size2i(16, 12));
+	square->fill(0);
+
+	for (int i = 3; i < 9; ++i) {
+		for (int j = 4; j < 12; ++j) {
+			square->element_set(i, j, 1);
+		}
+	}
+
+	MLPPConvolutions::HarrisResult harris = conv.harris_corners(square, 0.05, 0.01);
+
+	is_approx_equalsd(harris.keypoints.size(), 4, "conv.harris_corners(square).keypoints.size()");
+
+	for (int i = 0; i < harris.keypoints.size(); ++i) {
+		Vector2i p = harris.keypoints[i];
+		bool near_corner = (ABS(p.y - 3) <= 1 || ABS(p.y - 8) <= 1) && (ABS(p.x - 4) <= 1 || ABS(p.x - 11) <= 1);
+
+		is_approx_equalsd(near_corner, 1, "conv.harris_corners(square).keypoints[" + itos(i) + "] near a corner");
+	}
+}
+
+void MLPPTests::test_fft() {
+	MLPPTransforms trans;
+
+	// Mixed radix sizes (4 * 3, 16, 5 * 5 * 3 * 2) and a prime one, against a direct DFT.
+	const int sizes[] = { 12, 16, 150, 7 };
+
+	for (int s = 0; s < 4; ++s) {
+		int n = sizes[s];
+
+		Ref<MLPPVector> real;
+		real.instance();
+		real->resize(n);
+		Ref<MLPPVector> imag;
+		imag.instance();
+		imag->resize(n);
+
+		for (int i = 0; i < n; ++i) {
+			real->element_set(i, Math::sin(static_cast<real_t>(i) * real_t(0.7)) + real_t(0.25));
+			imag->element_set(i, Math::cos(static_cast<real_t>(i * i) * real_t(0.1)));
+		}
+
+		Ref<MLPPVector> expected_real;
+		expected_real.instance();
+		expected_real->resize(n);
+		Ref<MLPPVector> expected_imag;
+		expected_imag.instance();
+		expected_imag->resize(n);
+
+		for (int k = 0; k < n; ++k) {
+			double sr = 0;
+			double si = 0;
+
+			for (int i = 0; i < n; ++i) {
+				double phase = -2.0 * Math_PI * ((static_cast<int64_t>(k) * i) % n) / n;
+
+				sr += real->element_get(i) * Math::cos(phase) - imag->element_get(i) * Math::sin(phase);
+				si += real->element_get(i) * Math::sin(phase) + imag->element_get(i) * Math::cos(phase);
+			}
+
+			expected_real->element_set(k, sr);
+			expected_imag->element_set(k, si);
+		}
+
+		MLPPTransforms::FFTResult res = trans.fft(real, imag);
+
+		is_approx_equals_vec_tolerance(res.real, expected_real, 1e-3, "trans.fft(real, imag).real n: " + itos(n));
+		is_approx_equals_vec_tolerance(res.imag, expected_imag, 1e-3, "trans.fft(real, imag).imag n: " + itos(n));
+
+		MLPPTransforms::FFTResult inv = trans.ifft(res.real, res.imag);
+
+		is_approx_equals_vec_tolerance(inv.real, real, 1e-4, "trans.ifft(trans.fft(real, imag)).real n: " + itos(n));
+		is_approx_equals_vec_tolerance(inv.imag, imag, 1e-4, "trans.ifft(trans.fft(real, imag)).imag n: " + itos(n));
+	}
+
+	const real_t a_arr[] = {
+		1, 2, 3, //
+		4, 5, 6, //
+	};
+	// Rows: sum, and the DFT of the columns of the row sums / differences.
+	const real_t a_fft_real_arr[] = {
+		21, -3, -3, //
+		-9, 0, 0, //
+	};
+	const real_t a_fft_imag_arr[] = {
+		0, 1.732051, -1.732051, //
+		0, 0, 0, //
+	};
+
+	Ref<MLPPMatrix> a(memnew(MLPPMatrix(a_arr, 2, 3)));
+	Ref<MLPPMatrix> a_fft_real(memnew(MLPPMatrix(a_fft_real_arr, 2, 3)));
+	Ref<MLPPMatrix> a_fft_imag(memnew(MLPPMatrix(a_fft_imag_arr, 2, 3)));
+
+	MLPPTransforms::FFT2DResult res_2d = trans.fft_2d(a);
+
+	is_approx_equals_mat(res_2d.real, a_fft_real, "trans.fft_2d(a).real");
+	is_approx_equals_mat(res_2d.imag, a_fft_imag, "trans.fft_2d(a).imag");
+	is_approx_equals_mat(trans.ifft_2d(res_2d.real, res_2d.imag).real, a, "trans.ifft_2d(trans.fft_2d(a)).real");
+
+	is_approx_equalsd(MLPPTransforms::fft_good_size(97), 100, "MLPPTransforms::fft_good_size(97)");
+}
+
+void MLPPTests::test_dct() {
+	MLPPTransforms trans;
+
+	// Even, odd, and prime sizes against the direct orthonormal DCT-II.
+	const int sizes[] = { 8, 12, 15, 7, 1 };
+
+	for (int s = 0; s < 5; ++s) {
+		int n = sizes[s];
+
+		Ref<MLPPVector> x;
+		x.instance();
+		x->resize(n);
+
+		for (int i = 0; i < n; ++i) {
+			x->element_set(i, Math::sin(static_cast<real_t>(i) * real_t(0.9)) + real_t(0.5));
+		}
+
+		Ref<MLPPVector> expected;
+		expected.instance();
+		expected->resize(n);
+
+		for (int k = 0; k < n; ++k) {
+			double sum = 0;
+
+			for (int i = 0; i < n; ++i) {
+				sum += x->element_get(i) * Math::cos(Math_PI * (2 * i + 1) * k / (2.0 * n));
+			}
+
+			expected->element_set(k, sum * Math::sqrt((k == 0 ? 1.0 : 2.0) / n));
+		}
+
+		Ref<MLPPVector> res = trans.dct(x);
+
+		is_approx_equals_vec_tolerance(res, expected, 1e-4, "trans.dct(x) n: " + itos(n));
+		is_approx_equals_vec_tolerance(trans.idct(res), x, 1e-4, "trans.idct(trans.dct(x)) n: " + itos(n));
+	}
+
+	// Non square 2D, against the 1D transform of the rows, then the columns.
+	Ref<MLPPMatrix> a;
+	a.instance();
+	a->resize(Size2i(6, 5));
+
+	for (int i = 0; i < a->data_size(); ++i) {
+		a->element_set_index(i, Math::cos(static_cast<real_t>(i * i) * real_t(0.05)) * 100);
+	}
+
+	Ref<MLPPMatrix> expected_2d;
+	expected_2d.instance();
+	expected_2d->resize(a->size());
+
+	for (int i = 0; i < a->size().y; ++i) {
+		expected_2d->row_set_mlpp_vector(i, trans.dct(a->row_get_mlpp_vector(i)));
+	}
+
+	for (int j = 0; j < a->size().x; ++j) {
+		Ref<MLPPVector> column;
+		column.instance();
+		column->resize(a->size().y);
+
+		for (int i = 0; i < a->size().y; ++i) {
+			column->element_set(i, expected_2d->element_get(i, j));
+		}
+
+		column = trans.dct(column);
+
+		for (int i = 0; i < a->size().y; ++i) {
+			expected_2d->element_set(i, j, column->element_get(i));
+		}
+	}
+
+	Ref<MLPPMatrix> a_dct = trans.dct_2d(a);
+
+	is_approx_equals_vec_tolerance(a_dct->flatten(), expected_2d->flatten(), 1e-3, "trans.dct_2d(a)");
+	is_approx_equals_vec_tolerance(trans.idct_2d(a_dct)->flatten(), a->flatten(), 1e-3, "trans.idct_2d(trans.dct_2d(a))");
+
+	// 8x8 blocks, against dct_2d() of every block.
+	Ref<MLPPTensor3> frames;
+	frames.instance();
+	frames->resize(Size3i(16, 8, 2));
+
+	for (int i = 0; i < frames->data_size(); ++i) {
+		frames->element_set_index(i, Math::sin(static_cast<real_t>(i) * real_t(0.37)) * 128);
+	}
+
+	Ref<MLPPTensor3> frames_dct = trans.dct_blocks_3d(frames);
+
+	Ref<MLPPMatrix> block;
+	block.instance();
+	block->resize(Size2i(8, 8));
+
+	for (int z = 0; z < 2; ++z) {
+		for (int b = 0; b < 2; ++b) {
+			for (int i = 0; i < 8; ++i) {
+				for (int j = 0; j < 8; ++j) {
+					block->element_set(i, j, frames->element_get(z, i, b * 8 + j));
+				}
+			}
+
+			Ref<MLPPMatrix> block_dct = trans.dct_2d(block);
+
+			for (int i = 0; i < 8; ++i) {
+				for (int j = 0; j < 8; ++j) {
+					block->element_set(i, j, frames_dct->element_get(z, i, b * 8 + j));
+				}
+			}
+
+			is_approx_equals_vec_tolerance(block->flatten(), block_dct->flatten(), 1e-3, "trans.dct_blocks_3d(frames) slice: " + itos(z) + " block: " + itos(b));
+		}
+	}
+
+	is_approx_equals_vec_tolerance(trans.idct_blocks_3d(frames_dct)->flatten(), frames->flatten(), 1e-3, "trans.idct_blocks_3d(trans.dct_blocks_3d(frames))");
+
+	Ref<MLPPMatrix> frame;
+	frame.instance();
+	frame->resize(Size2i(16, 8));
+	frames->z_slice_get_into_mlpp_matrix(1, frame);
+
+	Ref<MLPPMatrix> frame_dct;
+	frame_dct.instance();
+	frame_dct->resize(Size2i(16, 8));
+	frames_dct->z_slice_get_into_mlpp_matrix(1, frame_dct);
+
+	is_approx_equals_vec_tolerance(trans.dct_blocks_2d(frame)->flatten(), frame_dct->flatten(), 1e-3, "trans.dct_blocks_2d(frame)");
+	is_approx_equals_vec_tolerance(trans.idct_blocks_2d(frame_dct)->flatten(), frame->flatten(), 1e-3, "trans.idct_blocks_2d(frame_dct)");
+}
+
+void MLPPTests::test_conv_layer(bool ui) {
+	MLPPConvolutions conv;
+
+	const Size3i input_size = Size3i(5, 4, 2);
+	const int input_data_size = input_size.x * input_size.y * input_size.z;
+	const int batch_size = 3;
+	const int filter_count = 3;
+	const int filter_size = 3;
+
+	Ref<MLPPMatrix> input;
+	input.instance();
+	input->resize(Size2i(input_data_size, batch_size));
+
+	for (int i = 0; i < input->data_size(); ++i) {
+		input->element_set_index(i, Math::sin(static_cast<real_t>(i) * real_t(0.7)));
+	}
+
+	Ref<MLPPConvLayer> layer;
+	layer.instance();
+	layer->set_input_size(input_size);
+	layer->set_filter_count(filter_count);
+	layer->set_filter_size(filter_size);
+	layer->set_stride(1);
+	layer->set_padding(1);
+	layer->set_activation(MLPPActivation::ACTIVATION_FUNCTION_LINEAR);
+	layer->set_input(input);
+	layer->initialize();
+
+	Ref<MLPPMatrix> weights;
+	weights.instance();
+	weights->resize(Size2i(input_size.z * filter_size * filter_size, filter_count));
+
+	for (int i = 0; i < weights->data_size(); ++i) {
+		weights->element_set_index(i, Math::cos(static_cast<real_t>(i) * real_t(0.3)));
+	}
+
+	Ref<MLPPVector> bias;
+	bias.instance();
+	bias->resize(filter_count);
+	bias->element_set(0, 0.5);
+	bias->element_set(1, -0.25);
+	bias->element_set(2, 1);
+
+	layer->set_weights(weights);
+	layer->set_bias(bias);
+	layer->forward_pass();
+
+	Size3i output_size = layer->get_output_size();
+	int output_data_size = output_size.x * output_size.y * output_size.z;
+
+	is_approx_equalsd(output_size.x, 5, "MLPPConvLayer output width");
+	is_approx_equalsd(output_size.y, 4, "MLPPConvLayer output height");
+	is_approx_equalsd(layer->get_n_hidden(), output_data_size, "MLPPConvLayer n_hidden");
+
+	// Forward pass against MLPPConvolutions
+	Ref<MLPPTensor3> filters;
+	filters.instance();
+	filters->resize(Size3i(filter_size, filter_size, filter_count * input_size.z));
+
+	for (int i = 0; i < weights->data_size(); ++i) {
+		filters->element_set_index(i, weights->element_get_index(i));
+	}
+
+	for (int b = 0; b < batch_size; ++b) {
+		Ref<MLPPTensor3> sample;
+		sample.instance();
+		sample->resize(input_size);
+
+		for (int i = 0; i < input_data_size; ++i) {
+			sample->element_set_index(i, input->element_get(b, i));
+		}
+
+		Ref<MLPPTensor3> expected = conv.convolve_3d(sample, filters, 1, 1);
+
+		Ref<MLPPVector> expected_z;
+		expected_z.instance();
+		expected_z->resize(output_data_size);
+
+		Ref<MLPPVector> z;
+		z.instance();
+		z->resize(output_data_size);
+
+		for (int i = 0; i < output_data_size; ++i) {
+			expected_z->element_set(i, expected->element_get_index(i) + bias->element_get(i / (output_size.x * output_size.y)));
+			z->element_set(i, layer->get_z()->element_get(b, i));
+		}
 
-	String str = "GENERATED INPUT: (Gaussian-sampled noise):\n";
-	str += gan.generate_example(100)->to_string();
-	PLOG_MSG(str);
-}
-void MLPPTests::test_ann(bool ui) {
-	MLPPLinAlg alg;
+		is_approx_equals_vec_tolerance(z, expected_z, 1e-3, "MLPPConvLayer forward_pass() sample: " + itos(b));
 
-	std::vector<std::vector<real_t>> inputSet = { { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 1 } }; // XOR
-	std::vector<real_t> outputSet = { 0, 1, 1, 0 };
+		layer->test(sample->flatten());
+		is_approx_equals_vec_tolerance(layer->get_a_test(), expected_z, 1e-3, "MLPPConvLayer test() sample: " + itos(b));
+	}
 
-	Ref<MLPPMatrix> input_set;
-	input_set.instance();
-	input_set->set_from_std_vectors(inputSet);
+	// Gradients of cost = sum(z * r) against central differences. The layer is linear, so these are exact up to rounding.
+	Ref<MLPPMatrix> r;
+	r.instance();
+	r->resize(Size2i(output_data_size, batch_size));
 
-	Ref<MLPPVector> output_set;
-	output_set.instance();
-	output_set->set_from_std_vector(outputSet);
+	for (int i = 0; i < r->data_size(); ++i) {
+		r->element_set_index(i, Math::cos(static_cast<real_t>(i) * real_t(1.3)));
+	}
 
-	MLPPANN ann(input_set, output_set);
-	ann.add_layer(5, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID);
-	ann.add_layer(8, MLPPActivation::ACTIVATION_FUNCTION_SIGMOID); // Add more layers as needed.
-	ann.add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, MLPPCost::COST_TYPE_LOGISTIC_LOSS);
-	ann.gradient_descent(1, 20000, ui);
+	layer->set_delta(r);
 
-	Ref<MLPPVector> predictions = ann.model_set_test(input_set);
-	PLOG_MSG(predictions->to_string()); // Testing out the model's preds for train set.
-	PLOG_MSG("ACCURACY: " + String::num(100 * ann.score()) + "%"); // Accuracy.
-}
-void MLPPTests::test_dynamically_sized_mann(bool ui) {
-	MLPPLinAlg alg;
-	MLPPData data;
+	Ref<MLPPMatrix> weight_grad = layer->weight_gradient();
+	Ref<MLPPVector> bias_grad = layer->bias_gradient();
+	Ref<MLPPMatrix> input_grad = layer->input_gradient();
 
-	// DYNAMICALLY SIZED MANN (Multidimensional Output ANN)
-	std::vector<std::vector<real_t>> inputSet = { { 1, 2, 3 }, { 2, 4, 6 }, { 3, 6, 9 }, { 4, 8, 12 } };
-	std::vector<std::vector<real_t>> outputSet = { { 1, 5 }, { 2, 10 }, { 3, 15 }, { 4, 20 } };
+	const real_t eps = 0.5;
 
-	Ref<MLPPMatrix> input_set;
-	input_set.instance();
-	input_set->set_from_std_vectors(inputSet);
+	Ref<MLPPVector> numerical_weight_grad;
+	numerical_weight_grad.instance();
+	numerical_weight_grad->resize(weights->data_size());
 
-	Ref<MLPPMatrix> output_set;
-	output_set.instance();
-	output_set->set_from_std_vectors(outputSet);
+	for (int i = 0; i < weights->data_size(); ++i) {
+		real_t w = weights->element_get_index(i);
 
-	MLPPMANN mann(input_set, output_set);
-	mann.add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_LINEAR, MLPPCost::COST_TYPE_MSE);
-	mann.gradient_descent(0.001, 80000, false);
-	PLOG_MSG(mann.model_set_test(input_set)->to_string());
-	PLOG_MSG("ACCURACY: " + String::num(100 * mann.score()) + "%");
-}
-void MLPPTests::test_train_test_split_mann(bool ui) {
-	MLPPLinAlg alg;
-	MLPPLinAlg algn;
-	MLPPData data;
+		weights->element_set_index(i, w + eps);
+		layer->set_weights(weights);
+		layer->forward_pass();
+		real_t cost_plus = layer->get_z()->hadamard_productn(r)->flatten()->sum_elements();
 
-	// TRAIN TEST SPLIT CHECK
-	std::vector<std::vector<real_t>> inputSet1 = { { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 }, { 3, 5, 9, 12, 15, 18, 21, 24, 27, 30 } };
-	std::vector<std::vector<real_t>> outputSet1 = { { 2, 4, 6, 8, 10, 12, 14, 16, 18, 20 } };
+		weights->element_set_index(i, w - eps);
+		layer->set_weights(weights);
+		layer->forward_pass();
+		real_t cost_minus = layer->get_z()->hadamard_productn(r)->flatten()->sum_elements();
 
-	Ref<MLPPMatrix> input_set_1;
-	input_set_1.instance();
-	input_set_1->set_from_std_vectors(inputSet1);
+		weights->element_set_index(i, w);
 
-	Ref<MLPPMatrix> output_set_1;
-	output_set_1.instance();
-	output_set_1->set_from_std_vectors(outputSet1);
+		numerical_weight_grad->element_set(i, (cost_plus - cost_minus) / (2 * eps));
+	}
 
-	Ref<MLPPDataComplex> d;
-	d.instance();
+	layer->set_weights(weights);
 
-	d->set_input(algn.transposenm(input_set_1));
-	d->set_output(algn.transposenm(output_set_1));
+	is_approx_equals_vec_tolerance(weight_grad->flatten(), numerical_weight_grad, 1e-2, "MLPPConvLayer weight_gradient()");
 
-	MLPPData::SplitComplexData split_data = data.train_test_split(d, 0.2);
+	Ref<MLPPVector> numerical_bias_grad;
+	numerical_bias_grad.instance();
+	numerical_bias_grad->resize(filter_count);
 
-	PLOG_MSG(split_data.train->get_input()->to_string());
-	PLOG_MSG(split_data.train->get_output()->to_string());
-	PLOG_MSG(split_data.test->get_input()->to_string());
-	PLOG_MSG(split_data.test->get_output()->to_string());
+	for (int i = 0; i < filter_count; ++i) {
+		real_t val = bias->element_get(i);
 
-	MLPPMANN mann(split_data.train->get_input(), split_data.train->get_output());
-	mann.add_layer(100, MLPPActivation::ACTIVATION_FUNCTION_RELU, MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_XAVIER_NORMAL);
-	mann.add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_SOFTMAX, MLPPCost::COST_TYPE_CROSS_ENTROPY, MLPPUtilities::WEIGHT_DISTRIBUTION_TYPE_XAVIER_NORMAL);
-	mann.gradient_descent(0.1, 80000, ui);
-	PLOG_MSG(mann.model_set_test(split_data.test->get_input())->to_string());
-	PLOG_MSG("ACCURACY: " + String::num(100 * mann.score()) + "%");
-}
+		bias->element_set(i, val + eps);
+		layer->set_bias(bias);
+		layer->forward_pass();
+		real_t cost_plus = layer->get_z()->hadamard_productn(r)->flatten()->sum_elements();
 
-void MLPPTests::test_naive_bayes() {
-	MLPPLinAlg alg;
-	MLPPLinAlg algn;
+		bias->element_set(i, val - eps);
+		layer->set_bias(bias);
+		layer->forward_pass();
+		real_t cost_minus = layer->get_z()->hadamard_productn(r)->flatten()->sum_elements();
 
-	// NAIVE BAYES
-	std::vector<std::vector<real_t>> inputSet = { { 1, 1, 1, 1, 1 }, { 0, 0, 1, 1, 1 }, { 0, 0, 1, 0, 1 } };
-	std::vector<real_t> outputSet = { 0, 1, 0, 1, 1 };
+		bias->element_set(i, val);
 
-	Ref<MLPPMatrix> input_set;
-	input_set.instance();
-	input_set->set_from_std_vectors(inputSet);
-	input_set = input_set->transposen();
+		numerical_bias_grad->element_set(i, (cost_plus - cost_minus) / (2 * eps));
+	}
 
-	Ref<MLPPVector> output_set;
-	output_set.instance();
-	output_set->set_from_std_vector(outputSet);
+	layer->set_bias(bias);
 
-	ERR_PRINT("MLPPMultinomialNB");
+	is_approx_equals_vec_tolerance(bias_grad, numerical_bias_grad, 1e-2, "MLPPConvLayer bias_gradient()");
 
-	MLPPMultinomialNB MNB(input_set, output_set, 2);
-	PLOG_MSG(MNB.model_set_test(input_set)->to_string());
+	Ref<MLPPVector> numerical_input_grad;
+	numerical_input_grad.instance();
+	numerical_input_grad->resize(input->data_size());
 
-	ERR_PRINT("MLPPBernoulliNB");
+	for (int i = 0; i < input->data_size(); ++i) {
+		real_t val = input->element_get_index(i);
 
-	MLPPBernoulliNB BNB(input_set, output_set);
-	PLOG_MSG(BNB.model_set_test(input_set)->to_string());
+		input->element_set_index(i, val + eps);
+		layer->forward_pass();
+		real_t cost_plus = layer->get_z()->hadamard_productn(r)->flatten()->sum_elements();
 
-	ERR_PRINT("MLPPGaussianNB");
+		input->element_set_index(i, val - eps);
+		layer->forward_pass();
+		real_t cost_minus = layer->get_z()->hadamard_productn(r)->flatten()->sum_elements();
 
-	MLPPGaussianNB GNB(input_set, output_set, 2);
-	PLOG_MSG(GNB.model_set_test(input_set)->to_string());
-}
-void MLPPTests::test_k_means(bool ui) {
-	// KMeans
-	std::vector<std::vector<real_t>> inputSet = { { 32, 0, 7 }, { 2, 28, 17 }, { 0, 9, 23 } };
+		input->element_set_index(i, val);
 
-	Ref<MLPPMatrix> input_set;
-	input_set.instance();
-	input_set->set_from_std_vectors(inputSet);
+		numerical_input_grad->element_set(i, (cost_plus - cost_minus) / (2 * eps));
+	}
 
-	Ref<MLPPKMeans> kmeans;
-	kmeans.instance();
-	kmeans->set_input_set(input_set);
-	kmeans->set_k(3);
-	kmeans->set_mean_type(MLPPKMeans::MEAN_TYPE_KMEANSPP);
+	is_approx_equals_vec_tolerance(input_grad->flatten(), numerical_input_grad, 1e-2, "MLPPConvLayer input_gradient()");
 
-	kmeans->train(3, ui);
+	// Pool layer
+	const MLPPConvolutions::PoolType pool_types[] = { MLPPConvolutions::POOL_TYPE_MAX, MLPPConvolutions::POOL_TYPE_MIN, MLPPConvolutions::POOL_TYPE_AVERAGE };
 
-	PLOG_MSG(kmeans->model_set_test(input_set)->to_string());
-	PLOG_MSG(kmeans->silhouette_scores()->to_string());
-}
-void MLPPTests::test_knn(bool ui) {
-	MLPPLinAlg alg;
+	for (int t = 0; t < 3; ++t) {
+		Ref<MLPPPoolLayer> pool_layer = Ref<MLPPPoolLayer>(memnew(MLPPPoolLayer(Size3i(4, 4, 2), 2, 2, pool_types[t], Ref<MLPPMatrix>())));
 
-	// kNN
-	std::vector<std::vector<real_t>> inputSet = {
-		{ 1, 2, 3, 4, 5, 6, 7, 8 },
-		{ 0, 0, 0, 0, 1, 1, 1, 1 }
-	};
-	std::vector<real_t> outputSet = { 0, 0, 0, 0, 1, 1, 1, 1 };
+		Ref<MLPPMatrix> pool_input;
+		pool_input.instance();
+		pool_input->resize(Size2i(32, 2));
 
-	Ref<MLPPMatrix> ism;
-	ism.instance();
-	ism->set_from_std_vectors(inputSet);
-	ism = ism->transposen();
+		for (int i = 0; i < pool_input->data_size(); ++i) {
+			// Distinct values, so min and max are well defined.
+			pool_input->element_set_index(i, static_cast<real_t>((i * 37) % 64) * real_t(0.1));
+		}
 
-	//ERR_PRINT(ism->to_string());
+		pool_layer->set_input(pool_input);
+		pool_layer->forward_pass();
 
-	Ref<MLPPVector> osm;
-	osm.instance();
-	osm->set_from_std_vector(outputSet);
+		for (int b = 0; b < 2; ++b) {
+			Ref<MLPPTensor3> sample;
+			sample.instance();
+			sample->resize(Size3i(4, 4, 2));
 
-	//ERR_PRINT(osm->to_string());
+			for (int i = 0; i < 32; ++i) {
+				sample->element_set_index(i, pool_input->element_get(b, i));
+			}
 
-	Ref<MLPPKNN> knn;
-	knn.instance();
+			Ref<MLPPVector> a;
+			a.instance();
+			a->resize(8);
 
-	knn->set_k(7);
-	knn->set_input_set(ism);
-	knn->set_output_set(osm);
+			for (int i = 0; i < 8; ++i) {
+				a->element_set(i, pool_layer->get_a()->element_get(b, i));
+			}
 
-	PoolIntArray res = knn->model_set_test(ism);
+			is_approx_equals_vec(a, conv.pool_3d(sample, 2, 2, pool_types[t])->flatten(), "MLPPPoolLayer forward_pass() type: " + itos(t) + " sample: " + itos(b));
+		}
 
-	ERR_PRINT(String(Variant(res)));
-	ERR_PRINT("ACCURACY: " + itos(100 * knn->score()) + "%");
+		Ref<MLPPMatrix> pool_r;
+		pool_r.instance();
+		pool_r->resize(Size2i(8, 2));
 
-	//(alg.transpose(inputSet), outputSet, 8);
-	//alg.printVector(knn.modelSetTest(alg.transpose(inputSet)));
-	//std::cout << "ACCURACY: " << 100 * knn.score() << "%" << std::endl;
-}
+		for (int i = 0; i < pool_r->data_size(); ++i) {
+			pool_r->element_set_index(i, static_cast<real_t>(i + 1));
+		}
 
-void MLPPTests::test_convolution_tensors_etc() {
-	MLPPLinAlg alg;
-	MLPPLinAlg algn;
-	MLPPData data;
-	MLPPConvolutions conv;
-	MLPPTransforms trans;
+		pool_layer->set_delta(pool_r);
+		Ref<MLPPMatrix> pool_input_grad = pool_layer->input_gradient();
 
-	// CONVOLUTION, POOLING, ETC..
-	const real_t input_arr[] = {
-		1,
-	};
+		// Small steps, the argmax must not change.
+		const real_t pool_eps = 0.01;
 
-	Ref<MLPPMatrix> input = Ref<MLPPMatrix>(memnew(MLPPMatrix(input_arr, 1, 1)));
+		Ref<MLPPVector> numerical_pool_grad;
+		numerical_pool_grad.instance();
+		numerical_pool_grad->resize(pool_input->data_size());
 
-	Ref<MLPPTensor3> tensor_set;
-	tensor_set.instance();
-	tensor_set->resize(Size3i(1, 1, 0));
-	tensor_set->z_slice_add_mlpp_matrix(input);
-	tensor_set->z_slice_add_mlpp_matrix(input);
-	tensor_set->z_slice_add_mlpp_matrix(input);
+		for (int i = 0; i < pool_input->data_size(); ++i) {
+			real_t val = pool_input->element_get_index(i);
 
-	ERR_PRINT("TODO data.rgb2xyz(tensor_set)");
-	//ERR_PRINT(data.rgb2xyz(tensor_set)->to_string());
+			pool_input->element_set_index(i, val + pool_eps);
+			pool_layer->forward_pass();
+			real_t cost_plus = pool_layer->get_z()->hadamard_productn(pool_r)->flatten()->sum_elements();
 
-	const real_t input2_arr[] = {
-		62, 55, 55, 54, 49, 48, 47, 55, //
-		62, 57, 54, 52, 48, 47, 48, 53, //
-		61, 60, 52, 49, 48, 47, 49, 54, //
-		63, 61, 60, 60, 63, 65, 68, 65, //
-		67, 67, 70, 74, 79, 85, 91, 92, //
-		82, 95, 101, 106, 114, 115, 112, 117, //
-		96, 111, 115, 119, 128, 128, 130, 127, //
-		109, 121, 127, 133, 139, 141, 140, 133, //
-	};
+			pool_input->element_set_index(i, val - pool_eps);
+			pool_layer->forward_pass();
+			real_t cost_minus = pool_layer->get_z()->hadamard_productn(pool_r)->flatten()->sum_elements();
 
-	Ref<MLPPMatrix> input2 = Ref<MLPPMatrix>(memnew(MLPPMatrix(input2_arr, 8, 8)));
+			pool_input->element_set_index(i, val);
 
-	ERR_PRINT(trans.discrete_cosine_transform(input2)->to_string());
+			numerical_pool_grad->element_set(i, (cost_plus - cost_minus) / (2 * pool_eps));
+		}
 
-	ERR_PRINT(conv.convolve_2d(input2, conv.get_prewitt_vertical(), 1)->to_string()); // Can use padding
-	ERR_PRINT(conv.pool_2d(input2, 4, 4, MLPPConvolutions::POOL_TYPE_MAX)->to_string()); // Can use Max, Min, or Average pooling.
+		is_approx_equals_vec_tolerance(pool_input_grad->flatten(), numerical_pool_grad, 5e-2, "MLPPPoolLayer input_gradient() type: " + itos(t));
+	}
 
-	Ref<MLPPTensor3> tensor_set2;
-	tensor_set2.instance();
-	tensor_set2->resize(Size3i(8, 8, 0));
-	tensor_set2->z_slice_add_mlpp_matrix(input2);
-	tensor_set2->z_slice_add_mlpp_matrix(input2);
+	// A small image classifier, vertical (1) vs horizontal (0) lines.
+	Ref<MLPPMatrix> input_set;
+	input_set.instance();
+	input_set->resize(Size2i(36, 12));
+	input_set->fill(0);
 
-	ERR_PRINT(conv.global_pool_3d(tensor_set2, MLPPConvolutions::POOL_TYPE_AVERAGE)->to_string()); // Can use Max, Min, or Average global pooling.
+	Ref<MLPPVector> output_set;
+	output_set.instance();
+	output_set->resize(12);
 
-	const real_t laplacian_arr[] = {
-		1, 1, 1, //
-		1, -4, 1, //
-		1, 1, 1 //
-	};
+	for (int i = 0; i < 12; ++i) {
+		bool vertical = i % 2 == 0;
+		int line = i / 2;
 
-	Ref<MLPPMatrix> laplacian = Ref<MLPPMatrix>(memnew(MLPPMatrix(laplacian_arr, 3, 3)));
+		for (int j = 0; j < 6; ++j) {
+			input_set->element_set(i, vertical ? j * 6 + line : line * 6 + j, 1);
+		}
 
-	ERR_PRINT(conv.convolve_2d(conv.gaussian_filter_2d(5, 1), laplacian, 1)->to_string());
+		output_set->element_set(i, vertical ? 1 : 0);
+	}
+
+	MLPPANN ann(input_set, output_set);
+	ann.add_conv_layer(Size3i(6, 6, 1), 2, 3, 1, 1, MLPPActivation::ACTIVATION_FUNCTION_RELU);
+	ann.add_pool_layer(Size3i(), 2, 2, MLPPConvolutions::POOL_TYPE_MAX);
+	ann.add_output_layer(MLPPActivation::ACTIVATION_FUNCTION_SIGMOID, MLPPCost::COST_TYPE_LOGISTIC_LOSS);
+	ann.gradient_descent(0.1, 1000, ui);
+
+	PLOG_MSG("MLPPConvLayer ANN ACCURACY: " + String::num(100 * ann.score()) + "%");
 }
+
 void MLPPTests::test_pca_svd_eigenvalues_eigenvectors(bool ui) {
 	MLPPLinAlg alg;
 
@@ -964,6 +3048,56 @@ void MLPPTests::test_pca_svd_eigenvalues_eigenvectors(bool ui) {
 	str += dr.principal_components()->to_string();
 	str += "\nSCORE: " + String::num(dr.score()) + "\n";
 	PLOG_MSG(str);
+
+	// Randomized PCA, only the top k components get computed.
+	MLPPPCA rdr(input_set, 1);
+	rdr.set_svd_solver(MLPPPCA::SVD_SOLVER_RANDOMIZED);
+
+	str = "\nDimensionally reduced representation (randomized):\n";
+	str += rdr.principal_components()->to_string();
+	str += "\nSCORE: " + String::num(rdr.score()) + "\n";
+	PLOG_MSG(str);
+
+	// Randomized SVD against svd(). One non zero per row and column keeps both Gram matrices diagonal, which svd()'s
+	// Jacobi eigen solver handles exactly. The top 3 singular values are well separated from the rest.
+	const int rsvd_rank = 3;
+	const real_t rsvd_values[] = { 9, 7, 5, 0.05, 0.03 };
+
+	Ref<MLPPMatrix> low_rank = alg.zeromatnm(6, 5);
+
+	for (int j = 0; j < 5; ++j) {
+		low_rank->element_set(j + 1, j, (j % 2 == 0) ? rsvd_values[j] : -rsvd_values[j]);
+	}
+
+	MLPPLinAlg::SVDResult full_svd = alg.svd(low_rank);
+	MLPPLinAlg::SVDResult rand_svd = alg.randomized_svd(low_rank, rsvd_rank);
+
+	Ref<MLPPVector> full_s;
+	full_s.instance();
+	full_s->resize(rsvd_rank);
+
+	Ref<MLPPVector> rand_s;
+	rand_s.instance();
+	rand_s->resize(rsvd_rank);
+
+	// Singular vectors are only defined up to sign, the projectors onto the spanned subspaces are unique.
+	Ref<MLPPMatrix> full_projector = alg.zeromatnm(6, 6);
+	Ref<MLPPMatrix> rand_projector = alg.zeromatnm(6, 6);
+
+	for (int r = 0; r < rsvd_rank; ++r) {
+		full_s->element_set(r, full_svd.S->element_get(r, r));
+		rand_s->element_set(r, rand_svd.S->element_get(r, r));
+
+		for (int i = 0; i < 6; ++i) {
+			for (int j = 0; j < 6; ++j) {
+				full_projector->element_set(i, j, full_projector->element_get(i, j) + full_svd.U->element_get(i, r) * full_svd.U->element_get(j, r));
+				rand_projector->element_set(i, j, rand_projector->element_get(i, j) + rand_svd.U->element_get(i, r) * rand_svd.U->element_get(j, r));
+			}
+		}
+	}
+
+	is_approx_equals_vec_tolerance(rand_s, full_s, 1e-3, "test_pca_svd_eigenvalues_eigenvectors() randomized_svd() singular values");
+	is_approx_equals_vec_tolerance(rand_projector->flatten(), full_projector->flatten(), 1e-3, "test_pca_svd_eigenvalues_eigenvectors() randomized_svd() subspace");
 }
 
 void MLPPTests::test_nlp_and_data(bool ui) {
@@ -1760,6 +3894,37 @@ IAEDVEC_FAILED:
 	PLOG_ERR(fail_str);
 }
 
+void MLPPTests::is_approx_equals_vec_tolerance(Ref<MLPPVector> a, Ref<MLPPVector> b, real_t tolerance, const String &str) {
+	ERR_FAIL_COND(!a.is_valid());
+	ERR_FAIL_COND(!b.is_valid());
+
+	if (a->size() != b->size()) {
+		goto IAEDVECT_FAILED;
+	}
+
+	for (int i = 0; i < a->size(); ++i) {
+		if (!Math::is_equal_approx(a->element_get(i), b->element_get(i), tolerance)) {
+			goto IAEDVECT_FAILED;
+		}
+	}
+
+	PLOG_TRACE("TEST PASSED: " + str);
+
+	return;
+
+IAEDVECT_FAILED:
+
+	String fail_str = "TEST FAILED: ";
+	fail_str += str;
+	fail_str += "\nGot:\n";
+	fail_str += a->to_string();
+	fail_str += "\nShould be:\n";
+	fail_str += b->to_string();
+	fail_str += "\n.";
+
+	PLOG_ERR(fail_str);
+}
+
 MLPPTests::MLPPTests() {
 	_breast_cancer_data_path = "res://datasets/BreastCancer.csv";
 	_breast_cancer_svm_data_path = "res://datasets/BreastCancerSVM.csv";
@@ -1803,6 +3968,16 @@ void MLPPTests::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("test_wgan_old", "ui"), &MLPPTests::test_wgan_old, false);
 	ClassDB::bind_method(D_METHOD("test_wgan", "ui"), &MLPPTests::test_wgan, false);
 	ClassDB::bind_method(D_METHOD("test_ann", "ui"), &MLPPTests::test_ann, false);
+	ClassDB::bind_method(D_METHOD("test_optimizers"), &MLPPTests::test_optimizers);
+	ClassDB::bind_method(D_METHOD("test_parameter_arena"), &MLPPTests::test_parameter_arena);
+	ClassDB::bind_method(D_METHOD("test_data_parallel_training"), &MLPPTests::test_data_parallel_training);
+	ClassDB::bind_method(D_METHOD("test_hogwild_sgd"), &MLPPTests::test_hogwild_sgd);
+	ClassDB::bind_method(D_METHOD("test_mini_batch_sampler"), &MLPPTests::test_mini_batch_sampler);
+	ClassDB::bind_method(D_METHOD("test_autodiff_tape"), &MLPPTests::test_autodiff_tape);
+	ClassDB::bind_method(D_METHOD("test_compiled_ann"), &MLPPTests::test_compiled_ann);
+	ClassDB::bind_method(D_METHOD("test_gradient_checkpointing"), &MLPPTests::test_gradient_checkpointing);
+	ClassDB::bind_method(D_METHOD("test_inference_model"), &MLPPTests::test_inference_model);
+	ClassDB::bind_method(D_METHOD("test_inference_batcher"), &MLPPTests::test_inference_batcher);
 	ClassDB::bind_method(D_METHOD("test_dynamically_sized_mann", "ui"), &MLPPTests::test_dynamically_sized_mann, false);
 	ClassDB::bind_method(D_METHOD("test_train_test_split_mann", "ui"), &MLPPTests::test_train_test_split_mann, false);
 
@@ -1811,6 +3986,10 @@ void MLPPTests::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("test_knn", "ui"), &MLPPTests::test_knn, false);
 
 	ClassDB::bind_method(D_METHOD("test_convolution_tensors_etc"), &MLPPTests::test_convolution_tensors_etc);
+	ClassDB::bind_method(D_METHOD("test_convolutions"), &MLPPTests::test_convolutions);
+	ClassDB::bind_method(D_METHOD("test_fft"), &MLPPTests::test_fft);
+	ClassDB::bind_method(D_METHOD("test_dct"), &MLPPTests::test_dct);
+	ClassDB::bind_method(D_METHOD("test_conv_layer", "ui"), &MLPPTests::test_conv_layer, false);
 	ClassDB::bind_method(D_METHOD("test_pca_svd_eigenvalues_eigenvectors", "ui"), &MLPPTests::test_pca_svd_eigenvalues_eigenvectors, false);
 
 	ClassDB::bind_method(D_METHOD("test_nlp_and_data", "ui"), &MLPPTests::test_nlp_and_data, false);
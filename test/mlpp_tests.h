@@ -81,6 +81,16 @@ public:
 	void test_wgan_old(bool ui = false);
 	void test_wgan(bool ui = false);
 	void test_ann(bool ui = false);
+	void test_optimizers();
+	void test_parameter_arena();
+	void test_data_parallel_training();
+	void test_hogwild_sgd();
+	void test_mini_batch_sampler();
+	void test_autodiff_tape();
+	void test_compiled_ann();
+	void test_gradient_checkpointing();
+	void test_inference_model();
+	void test_inference_batcher();
 	void test_dynamically_sized_mann(bool ui = false);
 	void test_train_test_split_mann(bool ui = false);
 
@@ -89,6 +99,10 @@ public:
 	void test_knn(bool ui = false);
 
 	void test_convolution_tensors_etc();
+	void test_convolutions();
+	void test_fft();
+	void test_dct();
+	void test_conv_layer(bool ui = false);
 	void test_pca_svd_eigenvalues_eigenvectors(bool ui = false);
 
 	void test_nlp_and_data(bool ui = false);
@@ -106,6 +120,7 @@ public:
 
 	void is_approx_equals_mat(Ref<MLPPMatrix> a, Ref<MLPPMatrix> b, const String &str);
 	void is_approx_equals_vec(Ref<MLPPVector> a, Ref<MLPPVector> b, const String &str);
+	void is_approx_equals_vec_tolerance(Ref<MLPPVector> a, Ref<MLPPVector> b, real_t tolerance, const String &str);
 
 	MLPPTests();
 	~MLPPTests();